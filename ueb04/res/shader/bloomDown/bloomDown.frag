@@ -0,0 +1,68 @@
+#version 410 core
+
+/**
+ * Bloom Downsample Shader.
+ * Erzeugt eine Stufe mit halber Aufloesung ueber einen 13-Tap Filter aus
+ * vier ueberlappenden 4x4 Boxen und einer zentralen Box (siehe bloom.h).
+ * 
+ * Copyright (C) 2023, FH Wedel
+ * Autor: Joshua-Scott Schoettke, Ilana Schmara
+ */
+
+// Nur die Farbe wird ausgegeben
+out vec4 FragColor;
+
+// Quelle des Passes
+uniform sampler2D u_source;
+
+// Groesze der Zielstufe in Texeln
+uniform vec2 u_targetSize;
+
+// Genutzter Anteil aller Stufen (dynamische Aufloesung)
+uniform vec2 u_renderScale;
+
+/**
+ * Sampelt die Quelle, ohne den gerenderten Bereich zu verlassen.
+ * 
+ * @param uv die Texturkoordinate
+ * @return die Farbe der Quelle
+ */
+vec3 sampleSource(vec2 uv)
+{
+    vec2 halfTexel = 0.5 / vec2(textureSize(u_source, 0));
+    return texture(u_source, clamp(uv, halfTexel, u_renderScale - halfTexel)).rgb;
+}
+
+/*
+ * Hauptfunktion
+ */
+void main()
+{
+    vec2 uv = gl_FragCoord.xy / u_targetSize;
+    vec2 texel = 1.0 / vec2(textureSize(u_source, 0));
+
+    // Aeusseres 5x5 Raster im Abstand von zwei Texeln
+    vec3 a = sampleSource(uv + texel * vec2(-2.0,  2.0));
+    vec3 b = sampleSource(uv + texel * vec2( 0.0,  2.0));
+    vec3 c = sampleSource(uv + texel * vec2( 2.0,  2.0));
+    vec3 d = sampleSource(uv + texel * vec2(-2.0,  0.0));
+    vec3 e = sampleSource(uv);
+    vec3 f = sampleSource(uv + texel * vec2( 2.0,  0.0));
+    vec3 g = sampleSource(uv + texel * vec2(-2.0, -2.0));
+    vec3 h = sampleSource(uv + texel * vec2( 0.0, -2.0));
+    vec3 i = sampleSource(uv + texel * vec2( 2.0, -2.0));
+
+    // Inneres Quadrat
+    vec3 j = sampleSource(uv + texel * vec2(-1.0,  1.0));
+    vec3 k = sampleSource(uv + texel * vec2( 1.0,  1.0));
+    vec3 l = sampleSource(uv + texel * vec2(-1.0, -1.0));
+    vec3 m = sampleSource(uv + texel * vec2( 1.0, -1.0));
+
+    // Die zentrale Box zaehlt zur Haelfte, die vier Eckboxen je ein Achtel.
+    vec3 result = e * 0.125;
+    result += (a + c + g + i) * 0.03125;
+    result += (b + d + f + h) * 0.0625;
+    result += (j + k + l + m) * 0.125;
+
+    FragColor = vec4(result, 1.0);
+}
\ No newline at end of file
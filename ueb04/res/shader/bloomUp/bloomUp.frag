@@ -0,0 +1,63 @@
+#version 410 core
+
+/**
+ * Bloom Upsample Shader.
+ * Vergroeszert eine Stufe mit einem 3x3 Tent-Filter. Das Ergebnis wird per
+ * Blending auf die naechstgroeszere Stufe addiert (siehe bloom.h).
+ * 
+ * Copyright (C) 2023, FH Wedel
+ * Autor: Joshua-Scott Schoettke, Ilana Schmara
+ */
+
+// Nur die Farbe wird ausgegeben
+out vec4 FragColor;
+
+// Quelle des Passes
+uniform sampler2D u_source;
+
+// Groesze der Zielstufe in Texeln
+uniform vec2 u_targetSize;
+
+// Genutzter Anteil aller Stufen (dynamische Aufloesung)
+uniform vec2 u_renderScale;
+
+// Radius des Filters in Texeln der Quelle
+uniform float u_radius;
+
+/**
+ * Sampelt die Quelle, ohne den gerenderten Bereich zu verlassen.
+ * 
+ * @param uv die Texturkoordinate
+ * @return die Farbe der Quelle
+ */
+vec3 sampleSource(vec2 uv)
+{
+    vec2 halfTexel = 0.5 / vec2(textureSize(u_source, 0));
+    return texture(u_source, clamp(uv, halfTexel, u_renderScale - halfTexel)).rgb;
+}
+
+/*
+ * Hauptfunktion
+ */
+void main()
+{
+    vec2 uv = gl_FragCoord.xy / u_targetSize;
+    vec2 offset = u_radius / vec2(textureSize(u_source, 0));
+
+    vec3 a = sampleSource(uv + vec2(-offset.x,  offset.y));
+    vec3 b = sampleSource(uv + vec2(      0.0,  offset.y));
+    vec3 c = sampleSource(uv + vec2( offset.x,  offset.y));
+    vec3 d = sampleSource(uv + vec2(-offset.x,       0.0));
+    vec3 e = sampleSource(uv);
+    vec3 f = sampleSource(uv + vec2( offset.x,       0.0));
+    vec3 g = sampleSource(uv + vec2(-offset.x, -offset.y));
+    vec3 h = sampleSource(uv + vec2(      0.0, -offset.y));
+    vec3 i = sampleSource(uv + vec2( offset.x, -offset.y));
+
+    // Gewichte 1-2-1 in beiden Richtungen
+    vec3 result = e * 4.0;
+    result += (b + d + f + h) * 2.0;
+    result += (a + c + g + i);
+
+    FragColor = vec4(result / 16.0, 1.0);
+}
\ No newline at end of file
@@ -0,0 +1,283 @@
+#version 410 core
+
+/**
+ * Clustered Deferred Punktlicht Shader.
+ * Berechnet alle Punktlichter, die auf der CPU dem Cluster des Fragmentes
+ * zugeordnet wurden, in einem einzigen Pass (siehe cluster.h).
+ * 
+ * Copyright (C) 2023, FH Wedel
+ * Autor: Joshua-Scott Schoettke, Ilana Schmara
+ */
+
+// Kantenlaenge einer Kachel, muss CLUSTER_TILE_SIZE entsprechen
+const int TILE_SIZE = 64;
+
+// Anzahl der Tiefenscheiben, muss CLUSTER_SLICES entsprechen
+const int SLICES = 24;
+
+// Anzahl der Texel je Licht, muss LIGHT_BUFFER_TEXELS entsprechen
+const int LIGHT_TEXELS = 5;
+
+// Nur die Farbe wird ausgegeben.
+layout (location = 0) out vec4 fragColor;
+
+uniform sampler2D u_Position;
+uniform sampler2D u_Normal;
+uniform sampler2D u_AlbedoSpec;
+
+// Kompakter GBuffer (siehe gbuffer.h): Position aus der Tiefe rekonstruieren
+uniform bool u_compactGBuffer;
+uniform sampler2D u_Depth;
+
+// Je Cluster: Offset in die Indexliste und Anzahl der Lichter
+uniform usamplerBuffer u_clusterGrid;
+
+// Lichtindizes aller Cluster
+uniform usamplerBuffer u_clusterIndices;
+
+// Aufbau des Cluster-Gitters
+uniform int u_clusterTilesX;
+uniform int u_clusterTilesY;
+uniform float u_clusterNear;
+uniform float u_clusterSliceScale;
+
+// Lichtdaten (siehe light.h)
+uniform samplerBuffer u_lights;
+
+struct PointLight
+{
+    vec3 pos;
+    vec3 color;
+    
+    vec3 amb;
+    vec3 diff;
+    vec3 spec;
+
+    float constant;
+    float linear;
+    float quadratic;
+    float radius;
+    int shadowSlot;
+};
+
+// Kamera und Bildschirm, einmal pro Frame gesetzt (siehe framedata.h)
+layout (std140) uniform FrameData
+{
+    mat4 u_viewMatrix;
+    mat4 u_projectionMatrix;
+    mat4 u_viewProjectionMatrix;
+    mat4 u_inverseViewMatrix;
+    mat4 u_inverseProjectionMatrix;
+    mat4 u_screenToWorld;
+    vec3 u_viewPos;
+    vec2 u_screenSize;
+    vec2 u_renderSize;
+};
+
+// Ambienter Anteil 
+uniform float u_matAmbient;
+
+// Spekularer Anteil
+uniform float u_matSpecular;
+
+// Diffuser Anteil
+uniform float u_matDiffuse;
+
+// Schatten der Punktlichter (siehe shadow.h)
+const int MAX_POINT_SHADOWS = 8;
+uniform samplerCubeArrayShadow u_pointShadowMap;
+uniform float u_pointShadowFar[MAX_POINT_SHADOWS];
+uniform bool u_pointShadowsEnabled;
+
+ // ambient
+ const float ambientFactor = 0.1;
+
+
+vec2 CalcTexCoord()
+{
+   return gl_FragCoord.xy / u_screenSize;
+} 
+
+/**
+ * Dekodiert eine oktaedrisch kodierte Normale aus dem kompakten GBuffer.
+ * 
+ * @param encoded die kodierte Normale im Bereich [0, 1]
+ * @return die normierte Normale
+ */
+vec3 decodeNormal(vec2 encoded)
+{
+    vec2 f = encoded * 2.0 - 1.0;
+    vec3 n = vec3(f, 1.0 - abs(f.x) - abs(f.y));
+    float t = max(-n.z, 0.0);
+    n.x += n.x >= 0.0 ? -t : t;
+    n.y += n.y >= 0.0 ? -t : t;
+    return normalize(n);
+}
+
+/**
+ * Liest Position und Normale des Fragmentes aus dem GBuffer. Im kompakten
+ * GBuffer wird die Position aus der Tiefe rekonstruiert.
+ * 
+ * @param texCoord die Texturkoordinate im GBuffer
+ * @param worldPos Rueckgabe der Position im World-Space
+ * @param normal Rueckgabe der normierten Normale
+ * @return false, wenn an dieser Stelle keine Geometrie liegt
+ */
+bool readGeometry(vec2 texCoord, out vec3 worldPos, out vec3 normal)
+{
+    if (u_compactGBuffer)
+    {
+        float depth = texture(u_Depth, texCoord).r;
+        vec4 homogeneous = u_screenToWorld * vec4(texCoord, depth, 1.0);
+        worldPos = homogeneous.xyz / homogeneous.w;
+        normal = decodeNormal(texture(u_Normal, texCoord).rg);
+        return depth < 1.0;
+    }
+
+    worldPos = texture(u_Position, texCoord).xyz;
+    normal = texture(u_Normal, texCoord).xyz;
+    if (dot(normal, normal) == 0.0)
+    {
+        return false;
+    }
+    normal = normalize(normal);
+    return true;
+}
+
+/**
+ * Liest ein Punktlicht aus dem Lichtbuffer.
+ * 
+ * @param index der Index des Lichtes
+ * @return das Punktlicht
+ */
+PointLight fetchPointLight(int index)
+{
+    int base = index * LIGHT_TEXELS;
+    vec4 texel0 = texelFetch(u_lights, base);
+    vec4 texel1 = texelFetch(u_lights, base + 1);
+    vec4 texel2 = texelFetch(u_lights, base + 2);
+    vec4 texel3 = texelFetch(u_lights, base + 3);
+    vec4 texel4 = texelFetch(u_lights, base + 4);
+
+    PointLight light;
+    light.pos = texel0.xyz;
+    light.radius = texel0.w;
+    light.color = texel1.rgb;
+    light.constant = texel1.w;
+    light.amb = texel2.rgb;
+    light.linear = texel2.w;
+    light.diff = texel3.rgb;
+    light.quadratic = texel3.w;
+    light.spec = texel4.rgb;
+    light.shadowSlot = int(texel4.w);
+    return light;
+}
+
+/**
+ * Bestimmt ueber den Tiefenvergleich der Hardware, wie stark eine Position
+ * vom Punktlicht beleuchtet wird. Lichter ohne Slot werfen keinen Schatten.
+ * 
+ * @param pointLight das Licht
+ * @param worldPos die Position im World-Space
+ * @param norm die Normale
+ * @param lightDirection die normalisierte Richtung zum Licht
+ * @return 1.0 fuer volle Beleuchtung, 0.0 fuer vollen Schatten
+ */
+float pointShadow(PointLight pointLight, vec3 worldPos, vec3 norm, vec3 lightDirection)
+{
+    if (!u_pointShadowsEnabled || pointLight.shadowSlot < 0)
+    {
+        return 1.0;
+    }
+
+    vec3 fromLight = worldPos - pointLight.pos;
+    float farPlane = u_pointShadowFar[pointLight.shadowSlot];
+
+    // Flach beleuchtete Flaechen brauchen einen groeszeren Bias.
+    float bias = max(0.01 * (1.0 - dot(norm, lightDirection)), 0.002);
+    float reference = length(fromLight) / farPlane - bias;
+
+    return texture(u_pointShadowMap, vec4(fromLight, float(pointLight.shadowSlot)), reference);
+}
+
+/**
+ * Lichtberechnung nach Phong mit Abschwaechung ueber die Distanz.
+ * Entspricht der Berechnung im Punktlicht Shader.
+ * 
+ * @param pointLight das Licht
+ * @param worldPos die Position im World-Space
+ * @param norm die Normale
+ * @param color die Albedo-Farbe
+ * @param specular die spekulare Intensitaet
+ */
+vec3 phong(PointLight pointLight, vec3 worldPos, vec3 norm, vec3 color, float specular)
+{
+    vec3 lightDirection = pointLight.pos - worldPos;
+    float Distance = length(lightDirection);
+    if (Distance > pointLight.radius)
+    {
+        return vec3(0.0);
+    }
+    lightDirection = normalize(lightDirection);
+
+    float shadow = pointShadow(pointLight, worldPos, norm, lightDirection);
+
+    float attenuation = 1.0 / (pointLight.constant + pointLight.linear * Distance 
+                            + pointLight.quadratic * Distance * Distance);
+
+    vec3 ambient = ambientFactor * color * pointLight.color * u_matAmbient * pointLight.amb;
+
+    // diffuse 
+    float diff = max(dot(norm, lightDirection), 0.0);
+
+    vec3 diffuse = diff * color * pointLight.color * u_matDiffuse * pointLight.diff;
+
+    // specular
+    vec3 viewDir = normalize(u_viewPos - worldPos);
+    vec3 reflectDir = reflect(-lightDirection, norm); 
+    float spec = pow(max(dot(viewDir, reflectDir), 0.0), 16.0);
+    
+    specular *= (pointLight.color * spec).b * u_matSpecular * pointLight.spec.b;
+
+    return (ambient + (diffuse + specular) * shadow) * attenuation;
+}
+
+/**
+ * Hauptfunktion des Fragment-Shaders.
+ * Hier wird der Cluster des Fragmentes bestimmt und dessen Lichtliste
+ * durchlaufen.
+ */
+void main()
+{
+    vec2 TexCoord = CalcTexCoord();
+    vec3 WorldPos;
+    vec3 Normal;
+
+    // An dieser Stelle liegt keine Geometrie.
+    if (!readGeometry(TexCoord, WorldPos, Normal))
+    {
+        discard;
+    }
+
+    vec3 Color = texture(u_AlbedoSpec, TexCoord).xyz;
+    float Specular = texture(u_AlbedoSpec, TexCoord).a;
+
+    // Tiefenscheibe ueber die Distanz entlang der Blickrichtung bestimmen
+    float depth = -(u_viewMatrix * vec4(WorldPos, 1.0)).z;
+    int slice = int(floor(log(max(depth, u_clusterNear) / u_clusterNear) * u_clusterSliceScale));
+    slice = clamp(slice, 0, SLICES - 1);
+
+    ivec2 tile = ivec2(gl_FragCoord.xy) / TILE_SIZE;
+    int cluster = (slice * u_clusterTilesY + tile.y) * u_clusterTilesX + tile.x;
+    uvec2 range = texelFetch(u_clusterGrid, cluster).xy;
+
+    vec3 result = vec3(0.0);
+    for (uint i = 0u; i < range.y; i++)
+    {
+        int index = int(texelFetch(u_clusterIndices, int(range.x + i)).r);
+        PointLight light = fetchPointLight(index);
+        result += phong(light, WorldPos, Normal, Color, Specular);
+    }
+
+    fragColor = vec4(result, 1.0);
+}
\ No newline at end of file
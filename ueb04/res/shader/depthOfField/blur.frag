@@ -0,0 +1,91 @@
+#version 410 core
+
+/**
+ * DepthOfField Blur Shader.
+ * Zeichnet beide Ebenen in halber Aufloesung mit einem Gather-Filter weich
+ * (siehe dof.h).
+ * 
+ * Copyright (C) 2023, FH Wedel
+ * Autor: Joshua-Scott Schoettke, Ilana Schmara
+ */
+
+// Weichgezeichnete vordere und hintere Ebene
+layout (location = 0) out vec4 NearColor;
+layout (location = 1) out vec4 FarColor;
+
+// Ergebnisse des Setup Passes
+uniform sampler2D u_near;
+uniform sampler2D u_far;
+
+// Groesze der Ziele in Texeln
+uniform vec2 u_targetSize;
+
+// Genutzter Anteil der Ziele (dynamische Aufloesung)
+uniform vec2 u_renderScale;
+
+// Groeszter Radius der Unschaerfe in Texeln
+uniform float u_maxRadius;
+
+// Anzahl der Samples auf der Spirale
+const int SAMPLE_COUNT = 24;
+const float GOLDEN_ANGLE = 2.39996323;
+
+/**
+ * Sampelt eine Ebene, ohne den gerenderten Bereich zu verlassen.
+ * 
+ * @param layer die Ebene
+ * @param uv die Texturkoordinate
+ * @return Farbe und Unschaerfekreis
+ */
+vec4 sampleLayer(sampler2D layer, vec2 uv)
+{
+    vec2 halfTexel = 0.5 / u_targetSize;
+    return texture(layer, clamp(uv, halfTexel, u_renderScale - halfTexel));
+}
+
+/*
+ * Hauptfunktion
+ */
+void main()
+{
+    vec2 uv = gl_FragCoord.xy / u_targetSize;
+    vec2 texel = 1.0 / u_targetSize;
+
+    // Die hintere Ebene sammelt innerhalb des eigenen Unschaerfekreises.
+    vec4 centerFar = sampleLayer(u_far, uv);
+    float farRadius = centerFar.a * u_maxRadius;
+    vec3 farSum = centerFar.rgb * centerFar.a;
+    float farWeight = centerFar.a;
+
+    // Die vordere Ebene sammelt immer im groeszten Radius, damit auch scharfe
+    // Pixel vom Vordergrund ueberdeckt werden koennen.
+    vec3 nearSum = vec3(0.0);
+    float nearWeight = 0.0;
+    float nearCoc = 0.0;
+
+    for (int i = 0; i < SAMPLE_COUNT; i++)
+    {
+        // Gleichmaeszig verteilte Punkte auf einer Spirale in der Einheitsscheibe
+        float radius = sqrt((float(i) + 0.5) / float(SAMPLE_COUNT));
+        float angle = float(i) * GOLDEN_ANGLE;
+        vec2 direction = vec2(cos(angle), sin(angle)) * radius;
+
+        // Ein Sample zaehlt nur, wenn sein eigener Kreis bis hierher reicht.
+        vec4 far = sampleLayer(u_far, uv + direction * farRadius * texel);
+        float farCover = clamp(far.a * u_maxRadius - radius * farRadius + 1.0, 0.0, 1.0);
+        farSum += far.rgb * far.a * farCover;
+        farWeight += far.a * farCover;
+
+        vec4 near = sampleLayer(u_near, uv + direction * u_maxRadius * texel);
+        float nearCover = clamp(near.a * u_maxRadius - radius * u_maxRadius + 1.0, 0.0, 1.0);
+        nearSum += near.rgb * nearCover;
+        nearWeight += nearCover;
+        nearCoc = max(nearCoc, near.a * nearCover);
+    }
+
+    // Der Deckungsgrad blendet den Rand des Vordergrunds weich aus.
+    float nearAlpha = clamp(2.0 * nearWeight / float(SAMPLE_COUNT), 0.0, 1.0);
+    NearColor = vec4(nearWeight > 0.0 ? nearSum / nearWeight : vec3(0.0),
+                     nearAlpha * clamp(nearCoc * u_maxRadius, 0.0, 1.0));
+    FarColor = vec4(farWeight > 0.0 ? farSum / farWeight : centerFar.rgb, centerFar.a);
+}
\ No newline at end of file
@@ -1,10 +1,132 @@
 #version 410 core
 
 /**
- * Null Shader.
+ * DepthOfField Shader.
+ * Pass-Effekt der PostProcess Kette. Vergroeszert beide Ebenen der
+ * Tiefenunschaerfe und mischt sie mit dem scharfen Bild (siehe dof.h). Die
+ * hintere Ebene wird dabei bilateral vergroeszert, damit sie nicht ueber
+ * Tiefenkanten auf den scharfen Vordergrund blutet.
  * 
  * Copyright (C) 2023, FH Wedel
  * Autor: Joshua-Scott Schoettke, Ilana Schmara
  */
 
- void main() {}
\ No newline at end of file
+// Nur die Farbe wird ausgegeben
+out vec4 FragColor;
+
+// Eingabe der Kette (siehe postprocess.h)
+uniform sampler2D u_source;
+uniform vec2 u_viewportSize;
+uniform vec2 u_renderScale;
+
+// Ergebnisse des Blur Passes und Tiefe in halber Aufloesung
+uniform sampler2D u_near;
+uniform sampler2D u_far;
+uniform sampler2D u_halfDepth;
+
+// Tiefe des GBuffers
+uniform sampler2D u_depth;
+
+// Kamera und Bildschirm, einmal pro Frame gesetzt (siehe framedata.h)
+layout (std140) uniform FrameData
+{
+    mat4 u_viewMatrix;
+    mat4 u_projectionMatrix;
+    mat4 u_viewProjectionMatrix;
+    mat4 u_inverseViewMatrix;
+    mat4 u_inverseProjectionMatrix;
+    mat4 u_screenToWorld;
+    vec3 u_viewPos;
+    vec2 u_screenSize;
+    vec2 u_renderSize;
+};
+
+// Abstand der Fokusebene und Staerke der Unschaerfe
+uniform float u_focusDistance;
+uniform float u_aperture;
+
+// Groeszter Radius der Unschaerfe in Texeln der halben Aufloesung
+uniform float u_maxRadius;
+
+/**
+ * Rechnet einen Wert des Tiefenpuffers in den Abstand zur Kamera um.
+ * 
+ * @param depth der Wert aus dem Tiefenpuffer
+ * @return die lineare Tiefe
+ */
+float linearDepth(float depth)
+{
+    float ndc = depth * 2.0 - 1.0;
+    return u_projectionMatrix[3][2] / (ndc + u_projectionMatrix[2][2]);
+}
+
+/**
+ * Berechnet den Unschaerfekreis (siehe dof.h). Negative Werte liegen vor,
+ * positive hinter der Fokusebene.
+ * 
+ * @param depth die lineare Tiefe
+ * @return der Unschaerfekreis in [-1, 1]
+ */
+float circleOfConfusion(float depth)
+{
+    return clamp(u_aperture * (depth - u_focusDistance) / depth, -1.0, 1.0);
+}
+
+/**
+ * Vergroeszert die hintere Ebene. Die vier naechsten Texel werden bilinear
+ * und zusaetzlich nach der Aehnlichkeit ihrer Tiefe gewichtet.
+ * 
+ * @param uv die Texturkoordinate
+ * @param depth die lineare Tiefe des Pixels
+ * @return die weichgezeichnete hintere Ebene
+ */
+vec4 upsampleFar(vec2 uv, float depth)
+{
+    vec2 halfSize = vec2(textureSize(u_halfDepth, 0));
+    ivec2 maxTexel = ivec2(ceil(halfSize * u_renderScale)) - 1;
+    vec2 position = uv * halfSize - 0.5;
+    ivec2 base = ivec2(floor(position));
+    vec2 f = fract(position);
+
+    vec4 sum = vec4(0.0);
+    float weightSum = 0.0;
+    for (int i = 0; i < 4; i++)
+    {
+        ivec2 offset = ivec2(i & 1, i >> 1);
+        ivec2 texel = clamp(base + offset, ivec2(0), maxTexel);
+
+        vec2 bilinear = mix(1.0 - f, f, vec2(offset));
+        float halfDepth = texelFetch(u_halfDepth, texel, 0).r;
+        float similarity = exp(-abs(halfDepth - depth) / (depth * 0.05));
+
+        float weight = bilinear.x * bilinear.y * similarity;
+        sum += texelFetch(u_far, texel, 0) * weight;
+        weightSum += weight;
+    }
+
+    // Passt kein Texel zur Tiefe, bleibt nur die normale Filterung.
+    return weightSum > 0.0001 ? sum / weightSum : texture(u_far, uv);
+}
+
+/*
+ * Hauptfunktion
+ */
+void main()
+{
+    vec2 uv = gl_FragCoord.xy / u_viewportSize * u_renderScale;
+    uv = min(uv, u_renderScale - 0.5 / vec2(textureSize(u_source, 0)));
+
+    vec3 color = texture(u_source, uv).rgb;
+    float depth = linearDepth(texture(u_depth, uv).r);
+    float coc = circleOfConfusion(depth);
+
+    // Hinter der Fokusebene ab einem Texel Radius ganz unscharf
+    vec4 far = upsampleFar(uv, depth);
+    color = mix(color, far.rgb, clamp(coc * u_maxRadius, 0.0, 1.0));
+
+    // Der Vordergrund liegt ueber allem und darf ueber Kanten bluten.
+    vec4 near = texture(u_near, uv);
+    color = mix(color, near.rgb, near.a);
+
+    FragColor = vec4(color, 1.0);
+}
\ No newline at end of file
@@ -1,7 +1,8 @@
 #version 410 core
 
 /**
- * Null Shader.
+ * DepthOfField Shader.
+ * Zeichnet ein Vollbild-Quad fuer die Paesse in halber Aufloesung.
  * 
  * Copyright (C) 2023, FH Wedel
  * Autor: Joshua-Scott Schoettke, Ilana Schmara
@@ -9,11 +10,7 @@
 
 layout (location = 0) in vec3 position;
 
-uniform mat4 u_modelMatrix;
-uniform mat4 u_viewMatrix;
-uniform mat4 u_projectionMatrix;
-
 void main()
 {
-    gl_Position = u_projectionMatrix * u_viewMatrix * u_modelMatrix * vec4(position, 1.0);
-} 
\ No newline at end of file
+    gl_Position = vec4(position, 1.0);
+}
\ No newline at end of file
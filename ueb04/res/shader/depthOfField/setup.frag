@@ -0,0 +1,115 @@
+#version 410 core
+
+/**
+ * DepthOfField Setup Shader.
+ * Verkleinert den HDR Buffer auf halbe Aufloesung und trennt ihn dabei in
+ * eine Ebene vor und eine hinter der Fokusebene (siehe dof.h).
+ * 
+ * Copyright (C) 2023, FH Wedel
+ * Autor: Joshua-Scott Schoettke, Ilana Schmara
+ */
+
+// Vordere Ebene (a = Unschaerfekreis), hintere Ebene (a = Unschaerfekreis)
+// und die lineare Tiefe in halber Aufloesung
+layout (location = 0) out vec4 NearColor;
+layout (location = 1) out vec4 FarColor;
+layout (location = 2) out float HalfDepth;
+
+// HDR Buffer
+uniform sampler2D u_source;
+
+// Groesze der Ziele in Texeln
+uniform vec2 u_targetSize;
+
+// Genutzter Anteil der Quelle (dynamische Aufloesung)
+uniform vec2 u_renderScale;
+
+// Tiefe des GBuffers
+uniform sampler2D u_depth;
+
+// Kamera und Bildschirm, einmal pro Frame gesetzt (siehe framedata.h)
+layout (std140) uniform FrameData
+{
+    mat4 u_viewMatrix;
+    mat4 u_projectionMatrix;
+    mat4 u_viewProjectionMatrix;
+    mat4 u_inverseViewMatrix;
+    mat4 u_inverseProjectionMatrix;
+    mat4 u_screenToWorld;
+    vec3 u_viewPos;
+    vec2 u_screenSize;
+    vec2 u_renderSize;
+};
+
+// Abstand der Fokusebene und Staerke der Unschaerfe
+uniform float u_focusDistance;
+uniform float u_aperture;
+
+// Groeszter Radius der Unschaerfe in Texeln der halben Aufloesung
+uniform float u_maxRadius;
+
+/**
+ * Rechnet einen Wert des Tiefenpuffers in den Abstand zur Kamera um.
+ * 
+ * @param depth der Wert aus dem Tiefenpuffer
+ * @return die lineare Tiefe
+ */
+float linearDepth(float depth)
+{
+    float ndc = depth * 2.0 - 1.0;
+    return u_projectionMatrix[3][2] / (ndc + u_projectionMatrix[2][2]);
+}
+
+/**
+ * Berechnet den Unschaerfekreis (siehe dof.h). Negative Werte liegen vor,
+ * positive hinter der Fokusebene.
+ * 
+ * @param depth die lineare Tiefe
+ * @return der Unschaerfekreis in [-1, 1]
+ */
+float circleOfConfusion(float depth)
+{
+    return clamp(u_aperture * (depth - u_focusDistance) / depth, -1.0, 1.0);
+}
+
+/*
+ * Hauptfunktion
+ */
+void main()
+{
+    // Die vier Texel der Quelle unter dem Zielpixel, ohne den gerenderten
+    // Bereich zu verlassen
+    ivec2 base = ivec2(gl_FragCoord.xy) * 2;
+    ivec2 maxTexel = ivec2(ceil(vec2(textureSize(u_source, 0)) * u_renderScale)) - 1;
+
+    vec3 nearSum = vec3(0.0);
+    float nearCoc = 0.0;
+    vec3 farSum = vec3(0.0);
+    float farWeight = 0.0;
+    float minDepth = 1.0e20;
+
+    for (int i = 0; i < 4; i++)
+    {
+        ivec2 texel = min(base + ivec2(i & 1, i >> 1), maxTexel);
+        vec3 color = texelFetch(u_source, texel, 0).rgb;
+        float depth = linearDepth(texelFetch(u_depth, texel, 0).r);
+        float coc = circleOfConfusion(depth);
+
+        // Die vordere Ebene behaelt alle Farben, damit sie spaeter ueber
+        // scharfe Kanten bluten kann.
+        nearSum += color;
+        nearCoc = max(nearCoc, -coc);
+
+        // Scharfe Texel duerfen nicht in die hintere Ebene gelangen.
+        float weight = max(coc, 0.0);
+        farSum += color * weight;
+        farWeight += weight;
+
+        // Die naechste Tiefe bevorzugt beim Vergroeszern den Vordergrund.
+        minDepth = min(minDepth, depth);
+    }
+
+    NearColor = vec4(nearSum * 0.25, nearCoc);
+    FarColor = vec4(farWeight > 0.0 ? farSum / farWeight : vec3(0.0), farWeight * 0.25);
+    HalfDepth = minDepth;
+}
\ No newline at end of file
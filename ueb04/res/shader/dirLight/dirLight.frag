@@ -17,14 +17,62 @@ const float minBIAS = 0.0005;
 uniform sampler2D u_Position;
 uniform sampler2D u_Normal;
 uniform sampler2D u_AlbedoSpec;
+
+// Kompakter GBuffer (siehe gbuffer.h): Position aus der Tiefe rekonstruieren
+uniform bool u_compactGBuffer;
+uniform sampler2D u_Depth;
 uniform sampler2D u_Emission;
-uniform sampler2D u_shadowMap;
 
-uniform mat4 u_modelMatrix;
-uniform mat4 u_lightSpaceMatrix;
+// Kaskaden der Schattenkarte (siehe shadow.h)
+const int MAX_CASCADES = 4;
+uniform sampler2DArrayShadow u_shadowMap;
+uniform mat4 u_lightSpaceMatrices[MAX_CASCADES];
+// Ende jeder Kaskade als Distanz im View-Space
+uniform vec4 u_cascadeSplits;
+// Anzahl der Kaskaden, 0 = keine Schatten
+uniform int u_cascadeCount;
+
+// PCF Kernel: 0 = Hardware 2x2, 1 = 4 Taps bilinear, 2 = Poisson 8,
+// 3 = Poisson 16 (siehe ShadowFilter in input.h)
+const int PCF_HARDWARE = 0;
+const int PCF_BILINEAR4 = 1;
+const int PCF_POISSON8 = 2;
+const int PCF_POISSON16 = 3;
+uniform int u_pcfKernel;
+// Radius der Poisson Kernel in Texeln
+uniform float u_pcfRadius;
 
-// Bildschirmgroesze
-uniform vec2 u_screenSize;
+// Punkte im Einheitskreis mit moeglichst gleichmaessigem Abstand
+const vec2 poisson8[8] = vec2[](
+    vec2(-0.3262, -0.4058), vec2(-0.8401, -0.0736),
+    vec2(-0.6960,  0.4571), vec2(-0.2033,  0.6207),
+    vec2( 0.9623, -0.1950), vec2( 0.4734, -0.4800),
+    vec2( 0.5195,  0.7670), vec2( 0.1855, -0.8931)
+);
+const vec2 poisson16[16] = vec2[](
+    vec2(-0.9420, -0.3991), vec2( 0.9456, -0.7689),
+    vec2(-0.0942, -0.9294), vec2( 0.3450,  0.2939),
+    vec2(-0.9159,  0.4577), vec2(-0.8154, -0.8791),
+    vec2(-0.3828,  0.2768), vec2( 0.9748,  0.7565),
+    vec2( 0.4432, -0.9751), vec2( 0.5374, -0.4737),
+    vec2(-0.2650, -0.4189), vec2( 0.7920,  0.1909),
+    vec2(-0.2419,  0.9971), vec2(-0.8141,  0.9144),
+    vec2( 0.1998,  0.7864), vec2( 0.1438, -0.1410)
+);
+
+// Kamera und Bildschirm, einmal pro Frame gesetzt (siehe framedata.h)
+layout (std140) uniform FrameData
+{
+    mat4 u_viewMatrix;
+    mat4 u_projectionMatrix;
+    mat4 u_viewProjectionMatrix;
+    mat4 u_inverseViewMatrix;
+    mat4 u_inverseProjectionMatrix;
+    mat4 u_screenToWorld;
+    vec3 u_viewPos;
+    vec2 u_screenSize;
+    vec2 u_renderSize;
+};
 
 // Lichtposition.
 uniform vec3 u_lightDirVec;
@@ -41,9 +89,6 @@ uniform float u_matSpecular;
 // Diffuser Anteil
 uniform float u_matDiffuse;
 
-// Kameraposition
-uniform vec3 u_viewPos;
-
  // ambient
  const float ambientFactor = 0.1;
 
@@ -53,46 +98,170 @@ vec2 CalcTexCoord()
    return gl_FragCoord.xy / u_screenSize;
 }
 
-float shadowCalculationBiased(vec4 fragPosLightSpace, vec3 normal, vec3 lightDir)
+/**
+ * Dekodiert eine oktaedrisch kodierte Normale aus dem kompakten GBuffer.
+ * 
+ * @param encoded die kodierte Normale im Bereich [0, 1]
+ * @return die normierte Normale
+ */
+vec3 decodeNormal(vec2 encoded)
+{
+    vec2 f = encoded * 2.0 - 1.0;
+    vec3 n = vec3(f, 1.0 - abs(f.x) - abs(f.y));
+    float t = max(-n.z, 0.0);
+    n.x += n.x >= 0.0 ? -t : t;
+    n.y += n.y >= 0.0 ? -t : t;
+    return normalize(n);
+}
+
+/**
+ * Liest Position und Normale des Fragmentes aus dem GBuffer. Im kompakten
+ * GBuffer wird die Position aus der Tiefe rekonstruiert.
+ * 
+ * @param texCoord die Texturkoordinate im GBuffer
+ * @param worldPos Rueckgabe der Position im World-Space
+ * @param normal Rueckgabe der normierten Normale
+ * @return false, wenn an dieser Stelle keine Geometrie liegt
+ */
+bool readGeometry(vec2 texCoord, out vec3 worldPos, out vec3 normal)
+{
+    if (u_compactGBuffer)
+    {
+        float depth = texture(u_Depth, texCoord).r;
+        vec4 homogeneous = u_screenToWorld * vec4(texCoord, depth, 1.0);
+        worldPos = homogeneous.xyz / homogeneous.w;
+        normal = decodeNormal(texture(u_Normal, texCoord).rg);
+        return depth < 1.0;
+    }
+
+    worldPos = texture(u_Position, texCoord).xyz;
+    normal = texture(u_Normal, texCoord).xyz;
+    if (dot(normal, normal) == 0.0)
+    {
+        return false;
+    }
+    normal = normalize(normal);
+    return true;
+}
+
+/**
+ * Waehlt die Kaskade anhand der Tiefe im View-Space.
+ * 
+ * @param worldPos die Position im World-Space
+ * @return der Index der Kaskade oder -1, wenn ausserhalb aller Kaskaden
+ */
+int selectCascade(vec3 worldPos)
+{
+    float viewDepth = -(u_viewMatrix * vec4(worldPos, 1.0)).z;
+    for (int i = 0; i < u_cascadeCount; i++)
+    {
+        if (viewDepth < u_cascadeSplits[i])
+        {
+            return i;
+        }
+    }
+    return -1;
+}
+
+/**
+ * Sampelt die Schattenkarte mit Tiefenvergleich der Hardware. Durch den
+ * linearen Filter liefert jeder Zugriff bereits vier gewichtete Vergleiche.
+ * 
+ * @param coords Texturkoordinate, Kaskade und Referenztiefe
+ * @param offset Verschiebung in Texeln
+ * @param texelSize Groesze eines Texels
+ * @return der beleuchtete Anteil
+ */
+float sampleShadow(vec4 coords, vec2 offset, vec2 texelSize)
+{
+	return texture(u_shadowMap, vec4(coords.xy + offset * texelSize, coords.z, coords.w));
+}
+
+/**
+ * Berechnet den beleuchteten Anteil ueber den eingestellten PCF Kernel.
+ * Die Poisson Kernel werden pro Pixel gedreht, damit statt Streifen nur
+ * feines Rauschen entsteht.
+ * 
+ * @param coords Texturkoordinate, Kaskade und Referenztiefe
+ * @return der beleuchtete Anteil
+ */
+float filterShadow(vec4 coords)
+{
+	vec2 texelSize = 1.0 / vec2(textureSize(u_shadowMap, 0).xy);
+
+	if (u_pcfKernel == PCF_BILINEAR4)
+	{
+		// Vier bilineare Zugriffe decken 4x4 Texel mit Zeltgewichtung ab.
+		return 0.25 * (sampleShadow(coords, vec2(-0.5, -0.5), texelSize)
+		             + sampleShadow(coords, vec2( 0.5, -0.5), texelSize)
+		             + sampleShadow(coords, vec2(-0.5,  0.5), texelSize)
+		             + sampleShadow(coords, vec2( 0.5,  0.5), texelSize));
+	}
+
+	if (u_pcfKernel == PCF_POISSON8 || u_pcfKernel == PCF_POISSON16)
+	{
+		// Interleaved Gradient Noise als Drehwinkel
+		float noise = fract(52.9829189 * fract(dot(gl_FragCoord.xy, vec2(0.06711056, 0.00583715))));
+		float angle = 6.2831853 * noise;
+		mat2 rotation = mat2(cos(angle), sin(angle), -sin(angle), cos(angle));
+
+		float lit = 0.0;
+		if (u_pcfKernel == PCF_POISSON8)
+		{
+			for (int i = 0; i < 8; i++)
+			{
+				lit += sampleShadow(coords, rotation * poisson8[i] * u_pcfRadius, texelSize);
+			}
+			return lit / 8.0;
+		}
+
+		for (int i = 0; i < 16; i++)
+		{
+			lit += sampleShadow(coords, rotation * poisson16[i] * u_pcfRadius, texelSize);
+		}
+		return lit / 16.0;
+	}
+
+	return sampleShadow(coords, vec2(0.0), texelSize);
+}
+
+float shadowCalculationBiased(vec3 worldPos, vec3 normal, vec3 lightDir)
 {
+	int cascade = selectCascade(worldPos);
+	if (cascade < 0)
+	{
+		return 0.0;
+	}
+
+	// world-space position transformed to the light space of the cascade
+	vec4 fragPosLightSpace = u_lightSpaceMatrices[cascade] * vec4(worldPos, 1.0);
 	// Perspective Devide
 	// transform clip-space coordinates in the range [-w,w] to [-1, 1]
 	vec3 projCoords = fragPosLightSpace.xyz / fragPosLightSpace.w;
 	// transform NDC coordinantes to the range [0,1]
 	projCoords = projCoords * 0.5 +0.5;
-	// Sample the depth map
-	float closestDepth = texture(u_shadowMap, projCoords.xy).r;	//from lights point of view
-	// get current depth at the fragment 
-	float currentDepth = projCoords.z;
-	//Shadow Bias (offsets the depth of the surface [or  the shadow map] by a small bias amount)
-	//float bias = BIAS;
-	float bias = max(maxBIAS * (1.0 - dot(normal,lightDir)), minBIAS); // change amount of bias based on the surface angle towards the light: something we can solve with the dot product
-	
-	float shadow = currentDepth - bias > closestDepth ? 1.0 : 0.0;
 
 	// force shadow when z coordinante is larger than 1.0
 	if(projCoords.z > 1.0)
-    {
-        shadow = 0.0;
-    }
+	{
+		return 0.0;
+	}
+
+	//Shadow Bias (offsets the depth of the surface [or  the shadow map] by a small bias amount)
+	float bias = max(maxBIAS * (1.0 - dot(normal,lightDir)), minBIAS); // change amount of bias based on the surface angle towards the light: something we can solve with the dot product
 
-	return shadow;
+	// Der Vergleich mit der Tiefe aus Sicht des Lichts erfolgt beim Sampeln.
+	return 1.0 - filterShadow(vec4(projCoords.xy, cascade, projCoords.z - bias));
 }
 
 /**
  * Lichtberechnung nach Phong
  * 
+ * @param WorldPos die Position im World-Space
  * @param norm die Normalen
  */
-vec4 phong(vec3 norm, vec2 texCoord, vec3 color, float specular, vec3 emission)
+vec4 phong(vec3 WorldPos, vec3 norm, vec3 color, float specular, vec3 emission)
 {
-    vec4 FragPosLightSpace; // world-space vertex position transformed to light space
-    
-   
-    vec3 WorldPos = texture(u_Position, CalcTexCoord()).xyz;
-
-    FragPosLightSpace = u_lightSpaceMatrix * vec4(WorldPos, 1.0);
-
     // diffuse 
     vec3 lightDir = normalize(u_lightDirVec);
     float diff = max(dot(norm, lightDir), 0.0);
@@ -108,7 +277,7 @@ vec4 phong(vec3 norm, vec2 texCoord, vec3 color, float specular, vec3 emission)
     
     specular *= (u_lightColor * spec).b * u_matSpecular;
 
-	float shadow =  shadowCalculationBiased(FragPosLightSpace, norm, lightDir);
+	float shadow =  shadowCalculationBiased(WorldPos, norm, lightDir);
 
     vec4 result = vec4((ambient + (1.0 - shadow) * (diffuse + specular) + emission), 1.0);
 
@@ -122,11 +291,18 @@ vec4 phong(vec3 norm, vec2 texCoord, vec3 color, float specular, vec3 emission)
  void main()
  {
     vec2 TexCoord = CalcTexCoord();
+    vec3 WorldPos;
+    vec3 Normal;
+
+    // An dieser Stelle liegt keine Geometrie.
+    if (!readGeometry(TexCoord, WorldPos, Normal))
+    {
+        discard;
+    }
+
     vec3 Color = texture(u_AlbedoSpec, TexCoord).xyz;
-    vec3 Normal = texture(u_Normal, TexCoord).xyz;
 	float Specular = texture(u_AlbedoSpec, TexCoord).a;
     vec3 Emission = texture(u_Emission, TexCoord).rgb;
-    Normal = normalize(Normal);
 
-    fragColor =  phong(Normal, TexCoord, Color, Specular, Emission);
+    fragColor =  phong(WorldPos, Normal, Color, Specular, Emission);
 }
\ No newline at end of file
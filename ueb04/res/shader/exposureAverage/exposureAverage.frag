@@ -0,0 +1,57 @@
+#version 410 core
+
+/**
+ * ExposureAverage Shader.
+ * Bestimmt die mittlere Helligkeit aus dem Histogramm und gleicht sie mit
+ * dem letzten Frame ab (siehe exposure.h).
+ * 
+ * Copyright (C) 2023, FH Wedel
+ * Autor: Joshua-Scott Schoettke, Ilana Schmara
+ */
+
+// Mittlere Helligkeit
+out float AverageLuminance;
+
+// Histogramm und Ergebnis des letzten Frames
+uniform sampler2D u_histogram;
+uniform sampler2D u_previous;
+
+// Anzahl der Faecher und erfasster Bereich der log2 Helligkeit
+uniform int u_binCount;
+uniform float u_minLogLum;
+uniform float u_logLumRange;
+
+// Anteil des neuen Werts, der in diesem Frame uebernommen wird
+uniform float u_adaptation;
+
+void main()
+{
+    // Gewichteter Mittelwert der Faecher ohne die schwarzen Pixel
+    float weightedSum = 0.0;
+    float count = 0.0;
+    for (int i = 1; i < u_binCount; i++)
+    {
+        float binCount = texelFetch(u_histogram, ivec2(i, 0), 0).r;
+        weightedSum += float(i - 1) * binCount;
+        count += binCount;
+    }
+
+    // Ein ganz schwarzes Bild behaelt die bisherige Belichtung.
+    float previous = texelFetch(u_previous, ivec2(0), 0).r;
+    if (count < 1.0)
+    {
+        AverageLuminance = previous > 0.0 ? previous : 1.0;
+        return;
+    }
+
+    float logLum = weightedSum / count / float(u_binCount - 2) * u_logLumRange + u_minLogLum;
+
+    // Ohne Verlauf sofort uebernehmen, sonst im log Raum angleichen, damit
+    // das Auge hell und dunkel gleich schnell adaptiert.
+    if (previous > 0.0)
+    {
+        logLum = mix(log2(previous), logLum, u_adaptation);
+    }
+
+    AverageLuminance = exp2(logLum);
+}
\ No newline at end of file
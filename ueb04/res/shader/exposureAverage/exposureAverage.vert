@@ -0,0 +1,16 @@
+#version 410 core
+
+/**
+ * ExposureAverage Shader.
+ * Zeichnet ein Vollbild-Quad.
+ * 
+ * Copyright (C) 2023, FH Wedel
+ * Autor: Joshua-Scott Schoettke, Ilana Schmara
+ */
+
+layout (location = 0) in vec3 position;
+
+void main()
+{
+    gl_Position = vec4(position, 1.0);
+}
\ No newline at end of file
@@ -0,0 +1,16 @@
+#version 410 core
+
+/**
+ * Histogram Shader.
+ * Jeder Punkt zaehlt per additivem Blending eins zu seinem Fach.
+ * 
+ * Copyright (C) 2023, FH Wedel
+ * Autor: Joshua-Scott Schoettke, Ilana Schmara
+ */
+
+out float Count;
+
+void main()
+{
+    Count = 1.0;
+}
\ No newline at end of file
@@ -0,0 +1,40 @@
+#version 410 core
+
+/**
+ * Histogram Shader.
+ * Legt fuer jeden ausgewerteten Pixel einen Punkt auf das Fach seiner
+ * logarithmischen Helligkeit (siehe exposure.h).
+ * 
+ * Copyright (C) 2023, FH Wedel
+ * Autor: Joshua-Scott Schoettke, Ilana Schmara
+ */
+
+// HDR Buffer
+uniform sampler2D u_source;
+
+// Abstand der ausgewerteten Pixel und deren Anzahl pro Zeile
+uniform int u_sampleStep;
+uniform int u_sampleCountX;
+
+// Anzahl der Faecher und erfasster Bereich der log2 Helligkeit
+uniform int u_binCount;
+uniform float u_minLogLum;
+uniform float u_logLumRange;
+
+void main()
+{
+    ivec2 cell = ivec2(gl_VertexID % u_sampleCountX, gl_VertexID / u_sampleCountX);
+    ivec2 texel = min(cell * u_sampleStep + u_sampleStep / 2, textureSize(u_source, 0) - 1);
+    vec3 color = texelFetch(u_source, texel, 0).rgb;
+    float luminance = dot(color, vec3(0.2126, 0.7152, 0.0722));
+
+    // Fach 0 sammelt schwarze Pixel, der Rest teilt sich den Bereich.
+    int bin = 0;
+    if (luminance > 0.0001)
+    {
+        float logLum = clamp((log2(luminance) - u_minLogLum) / u_logLumRange, 0.0, 1.0);
+        bin = int(logLum * float(u_binCount - 2)) + 1;
+    }
+
+    gl_Position = vec4((float(bin) + 0.5) / float(u_binCount) * 2.0 - 1.0, 0.0, 0.0, 1.0);
+}
\ No newline at end of file
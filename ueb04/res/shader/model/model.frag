@@ -31,19 +31,17 @@ struct Material {
     vec3 emission;
     float shininess;
 
-    bool useDiffuseMap;
     sampler2D diffuseMap;
-
-    bool useSpecularMap;
     sampler2D specularMap;
-
-    bool useNormalMap;
     sampler2D normalMap;
-
-    bool useEmissionMap;
     sampler2D emissionMap;
 };
 
+// Welche Texturen das Material nutzt, legt die Variante des Shaders fest:
+// USE_DIFFUSE_MAP, USE_SPECULAR_MAP, USE_NORMAL_MAP, USE_EMISSION_MAP.
+// Dazu kommen USE_TBN (Normalmap anzeigen) und COMPACT_GBUFFER (Normale
+// oktaedrisch kodiert, siehe gbuffer.h).
+
 // Aktives Material.
 uniform Material u_material;
 
@@ -60,8 +58,24 @@ uniform vec3 u_fogColor;
 uniform float u_density;
 */
 
-// Normalmap anzeigen
-uniform bool u_showNormalMap;
+/**
+ * Kodiert eine normierte Normale oktaedrisch in zwei Komponenten im
+ * Bereich [0, 1], damit sie in eine RG16 Textur passt.
+ * 
+ * @param n die normierte Normale
+ * @return die kodierte Normale
+ */
+vec2 encodeNormal(vec3 n)
+{
+    n /= abs(n.x) + abs(n.y) + abs(n.z);
+    vec2 encoded = n.xy;
+    if (n.z < 0.0)
+    {
+        vec2 signs = vec2(n.x >= 0.0 ? 1.0 : -1.0, n.y >= 0.0 ? 1.0 : -1.0);
+        encoded = (1.0 - abs(n.yx)) * signs;
+    }
+    return encoded * 0.5 + 0.5;
+}
 
 /**
  * berechnung der TBN Matrix und korrektur der Normalen
@@ -90,15 +104,14 @@ vec3 tbnMatrix(vec3 norm)
     }
 
     // Normalmapping
-    if(u_material.useNormalMap)
-    {
-        norm = texture(u_material.normalMap, fs_in.TexCoords).rgb;
-        norm = normalize(norm * 2.0 - 1.0);
-        // Fuer Bistro-Szene die 3. Komponente der Normalen berechnen
-        norm.z = sqrt(1.0f - pow(norm.x , 2.0f) - pow(norm.y, 2.0f));
-
-        norm = TBN * norm;
-    }
+#ifdef USE_NORMAL_MAP
+    norm = texture(u_material.normalMap, fs_in.TexCoords).rgb;
+    norm = normalize(norm * 2.0 - 1.0);
+    // Fuer Bistro-Szene die 3. Komponente der Normalen berechnen
+    norm.z = sqrt(1.0f - pow(norm.x , 2.0f) - pow(norm.y, 2.0f));
+
+    norm = TBN * norm;
+#endif
     
     return norm;
 }
@@ -114,41 +127,41 @@ void main()
     fragNorm = normalize(fs_in.Normal);
 
     // Normalenberechnug
-    if (u_showNormalMap)
-    {
-        fragNorm = tbnMatrix(fragNorm);
-    } else {
-        if(u_material.useNormalMap)
-        {
-            fragNorm = texture(u_material.normalMap, fs_in.TexCoords).rgb;
-            fragNorm = normalize(fragNorm);
-        }
-    }
+#ifdef USE_TBN
+    fragNorm = tbnMatrix(fragNorm);
+#elif defined(USE_NORMAL_MAP)
+    fragNorm = texture(u_material.normalMap, fs_in.TexCoords).rgb;
+    fragNorm = normalize(fragNorm);
+#endif
     
     // Diffuse und Ambientberechnug
+#ifdef USE_DIFFUSE_MAP
+    fragAlbedoSpec.rgb = texture(u_material.diffuseMap, fs_in.TexCoords).rgb;
+#else
     fragAlbedoSpec.rgb = u_material.diffuse;
-    if(u_material.useDiffuseMap)
-    {
-        fragAlbedoSpec.rgb = texture(u_material.diffuseMap, fs_in.TexCoords).rgb;
-    }
+#endif
     
     // Spekularberechnug
+#ifdef USE_SPECULAR_MAP
+    fragAlbedoSpec.a = texture(u_material.specularMap, fs_in.TexCoords).b;
+#else
     fragAlbedoSpec.a = u_material.specular.b;
-    if(u_material.useSpecularMap)
-    {
-        fragAlbedoSpec.a = texture(u_material.specularMap, fs_in.TexCoords).b;
-    }
+#endif
     
     // Emissionsberechnug
+#ifdef USE_EMISSION_MAP
+    fragEmission = texture(u_material.emissionMap, fs_in.TexCoords).rgb;
+#else
     fragEmission = u_material.emission;
-    if(u_material.useEmissionMap)
-    {
-        fragEmission = texture(u_material.emissionMap, fs_in.TexCoords).rgb;
-    }
+#endif
 
 
     texCoords = fs_in.TexCoords;
 
+#ifdef COMPACT_GBUFFER
+    fragNorm = vec3(encodeNormal(normalize(fragNorm)), 0.0);
+#endif
+
     /*  
     // Berechnung Exp2-Nebel
     if (u_useFog) 
@@ -13,13 +13,35 @@ layout (location = 3) in vec2 texCoord;
 layout (location = 4) in vec3 tangent;
 layout (location = 5) in vec3 biTangent;
 
-// Kameraposition
-uniform vec3 u_viewPos;
+// Kamera und Bildschirm, einmal pro Frame gesetzt (siehe framedata.h)
+layout (std140) uniform FrameData
+{
+    mat4 u_viewMatrix;
+    mat4 u_projectionMatrix;
+    mat4 u_viewProjectionMatrix;
+    mat4 u_inverseViewMatrix;
+    mat4 u_inverseProjectionMatrix;
+    mat4 u_screenToWorld;
+    vec3 u_viewPos;
+    vec2 u_screenSize;
+    vec2 u_renderSize;
+};
 
 // Lichtposition.
 uniform vec3 u_lightPosVec;
 
 // Eigenschaften, die an den Fragmentshader weitergegeben werden sollen.
+#ifdef MODEL_DIRECT
+// Ohne Tessellation geht es direkt zum Fragment Shader, dessen Schnittstelle
+// sonst der Tessellation Evaluation Shader bedient.
+out TESE_OUT {
+    vec2 TexCoords;
+    vec3 Normal;
+    vec3 FragPos;
+    vec3 T;
+    vec3 B;
+} vs_out;
+#else
 out VS_OUT  {
     vec2 TexCoords;
     vec4 Position;
@@ -29,14 +51,11 @@ out VS_OUT  {
     vec3 T;
     vec3 B;
 } vs_out;
+#endif
 
 // Model Matrix
 uniform mat4 u_modelMatrix;
 
-// View Matrix
-uniform mat4 u_viewMatrix;
-
-
 /**
  * Hauptfunktion des Vertex-Shaders.
  * Hier werden die Daten weiter gereicht.
@@ -51,5 +70,9 @@ void main()
     vs_out.T = normalize(normalMatrix * tangent);
     vs_out.B = normalize(normalMatrix * biTangent);
     vs_out.Normal = normalize(normalMatrix * normal);
+#ifdef MODEL_DIRECT
+    gl_Position = u_viewProjectionMatrix * vec4(vs_out.FragPos, 1.0);
+#else
     vs_out.Position = vec4(position, 1.0); 
+#endif
 }
@@ -13,7 +13,10 @@ layout (location = 0) out vec4 fragColor;
 uniform sampler2D u_Position;
 uniform sampler2D u_Normal;
 uniform sampler2D u_AlbedoSpec;
-uniform sampler2D u_Emission;
+
+// Kompakter GBuffer (siehe gbuffer.h): Position aus der Tiefe rekonstruieren
+uniform bool u_compactGBuffer;
+uniform sampler2D u_Depth;
 uniform sampler2D u_ShadowMap;
 
 struct PointLight
@@ -28,11 +31,24 @@ struct PointLight
     float constant;
     float linear;
     float quadratic;
+    float radius;
+    int shadowSlot;
 };
 uniform PointLight pointLight;
 
-// Bildschirmgroesze
-uniform vec2 u_screenSize;
+// Kamera und Bildschirm, einmal pro Frame gesetzt (siehe framedata.h)
+layout (std140) uniform FrameData
+{
+    mat4 u_viewMatrix;
+    mat4 u_projectionMatrix;
+    mat4 u_viewProjectionMatrix;
+    mat4 u_inverseViewMatrix;
+    mat4 u_inverseProjectionMatrix;
+    mat4 u_screenToWorld;
+    vec3 u_viewPos;
+    vec2 u_screenSize;
+    vec2 u_renderSize;
+};
 
 // Lichtposition.
 uniform vec3 u_lightPosVec;
@@ -49,8 +65,11 @@ uniform float u_matSpecular;
 // Diffuser Anteil
 uniform float u_matDiffuse;
 
-// Kameraposition
-uniform vec3 u_viewPos;
+// Schatten der Punktlichter (siehe shadow.h)
+const int MAX_POINT_SHADOWS = 8;
+uniform samplerCubeArrayShadow u_pointShadowMap;
+uniform float u_pointShadowFar[MAX_POINT_SHADOWS];
+uniform bool u_pointShadowsEnabled;
 
  // ambient
  const float ambientFactor = 0.1;
@@ -62,50 +81,137 @@ vec2 CalcTexCoord()
 } 
 
 /**
- * Lichtberechnung nach Phong
+ * Dekodiert eine oktaedrisch kodierte Normale aus dem kompakten GBuffer.
+ * 
+ * @param encoded die kodierte Normale im Bereich [0, 1]
+ * @return die normierte Normale
+ */
+vec3 decodeNormal(vec2 encoded)
+{
+    vec2 f = encoded * 2.0 - 1.0;
+    vec3 n = vec3(f, 1.0 - abs(f.x) - abs(f.y));
+    float t = max(-n.z, 0.0);
+    n.x += n.x >= 0.0 ? -t : t;
+    n.y += n.y >= 0.0 ? -t : t;
+    return normalize(n);
+}
+
+/**
+ * Liest Position und Normale des Fragmentes aus dem GBuffer. Im kompakten
+ * GBuffer wird die Position aus der Tiefe rekonstruiert.
+ * 
+ * @param texCoord die Texturkoordinate im GBuffer
+ * @param worldPos Rueckgabe der Position im World-Space
+ * @param normal Rueckgabe der normierten Normale
+ * @return false, wenn an dieser Stelle keine Geometrie liegt
+ */
+bool readGeometry(vec2 texCoord, out vec3 worldPos, out vec3 normal)
+{
+    if (u_compactGBuffer)
+    {
+        float depth = texture(u_Depth, texCoord).r;
+        vec4 homogeneous = u_screenToWorld * vec4(texCoord, depth, 1.0);
+        worldPos = homogeneous.xyz / homogeneous.w;
+        normal = decodeNormal(texture(u_Normal, texCoord).rg);
+        return depth < 1.0;
+    }
+
+    worldPos = texture(u_Position, texCoord).xyz;
+    normal = texture(u_Normal, texCoord).xyz;
+    if (dot(normal, normal) == 0.0)
+    {
+        return false;
+    }
+    normal = normalize(normal);
+    return true;
+}
+
+/**
+ * Bestimmt ueber den Tiefenvergleich der Hardware, wie stark eine Position
+ * vom Punktlicht beleuchtet wird. Lichter ohne Slot werfen keinen Schatten.
  * 
- * @param norm die Normalen
+ * @param worldPos die Position im World-Space
+ * @param norm die Normale
+ * @param lightDirection die normalisierte Richtung zum Licht
+ * @return 1.0 fuer volle Beleuchtung, 0.0 fuer vollen Schatten
  */
-vec4 phong(vec3 norm, vec2 texCoord, vec3 color, float specular, vec3 emission)
+float pointShadow(vec3 worldPos, vec3 norm, vec3 lightDirection)
 {
-    vec3 WorldPos = texture(u_Position, CalcTexCoord()).xyz;
-    vec3 lightDirection = WorldPos - pointLight.pos;
+    if (!u_pointShadowsEnabled || pointLight.shadowSlot < 0)
+    {
+        return 1.0;
+    }
+
+    vec3 fromLight = worldPos - pointLight.pos;
+    float farPlane = u_pointShadowFar[pointLight.shadowSlot];
+
+    // Flach beleuchtete Flaechen brauchen einen groeszeren Bias.
+    float bias = max(0.01 * (1.0 - dot(norm, lightDirection)), 0.002);
+    float reference = length(fromLight) / farPlane - bias;
+
+    return texture(u_pointShadowMap, vec4(fromLight, float(pointLight.shadowSlot)), reference);
+}
+
+/**
+ * Lichtberechnung nach Phong mit Abschwaechung ueber die Distanz.
+ * Ausserhalb des Radius traegt das Licht nichts mehr bei.
+ * 
+ * @param worldPos die Position im World-Space
+ * @param norm die Normale
+ * @param color die Albedo-Farbe
+ * @param specular die spekulare Intensitaet
+ */
+vec3 phong(vec3 worldPos, vec3 norm, vec3 color, float specular)
+{
+    vec3 lightDirection = pointLight.pos - worldPos;
     float Distance = length(lightDirection);
+    if (Distance > pointLight.radius)
+    {
+        return vec3(0.0);
+    }
     lightDirection = normalize(lightDirection);
 
+    float shadow = pointShadow(worldPos, norm, lightDirection);
+
+    float attenuation = 1.0 / (pointLight.constant + pointLight.linear * Distance 
+                            + pointLight.quadratic * Distance * Distance);
+
     vec3 ambient = ambientFactor * color * pointLight.color * u_matAmbient * pointLight.amb;
 
     // diffuse 
-    //vec3 lightDir = vec3(abs(normalize(vec4(pointLight.pos, 1.0) - gl_FragCoord))).rgb;
     float diff = max(dot(norm, lightDirection), 0.0);
 
     vec3 diffuse = diff * color * pointLight.color * u_matDiffuse * pointLight.diff;
 
     // specular
-    vec3 viewDir = normalize(u_viewPos - WorldPos);
+    vec3 viewDir = normalize(u_viewPos - worldPos);
     vec3 reflectDir = reflect(-lightDirection, norm); 
     float spec = pow(max(dot(viewDir, reflectDir), 0.0), 16.0);
     
     specular *= (pointLight.color * spec).b * u_matSpecular * pointLight.spec.b;
 
-
-    vec4 result = vec4((ambient + diffuse + specular + emission), 1.0);
-
-    return result;
+    return (ambient + (diffuse + specular) * shadow) * attenuation;
 }
 
 /**
  * Hauptfunktion des Fragment-Shaders.
  * Hier wird die Farbe des Fragmentes ueber die Lichtberechnung bestimmt.
+ * Die Emission wird einmalig im Richtungslicht-Pass addiert.
  */
  void main()
  {
     vec2 TexCoord = CalcTexCoord();
+    vec3 WorldPos;
+    vec3 Normal;
+
+    // An dieser Stelle liegt keine Geometrie.
+    if (!readGeometry(TexCoord, WorldPos, Normal))
+    {
+        discard;
+    }
+
     vec3 Color = texture(u_AlbedoSpec, TexCoord).xyz;
-    vec3 Normal = texture(u_Normal, TexCoord).xyz;
-	float Specular = texture(u_AlbedoSpec, TexCoord).a;
-    vec3 Emission = texture(u_Emission, TexCoord).rgb;
-    Normal = normalize(Normal);
+    float Specular = texture(u_AlbedoSpec, TexCoord).a;
 
-    fragColor =  phong(Normal, TexCoord, Color, Specular, Emission);
+    fragColor = vec4(phong(WorldPos, Normal, Color, Specular), 1.0);
 }
\ No newline at end of file
@@ -12,17 +12,31 @@ layout (location = 0) in vec3 position;
 // Model Matrix
 uniform mat4 u_modelMatrix;
 
-// View Matrix
-uniform mat4 u_viewMatrix;
+// Lichter ohne Radius werden als Vollbild-Quad gezeichnet, dessen
+// Positionen bereits in NDC vorliegen.
+uniform bool u_fullscreen;
 
-// View Matrix
-uniform mat4 u_projectionMatrix;
+// Kamera und Bildschirm, einmal pro Frame gesetzt (siehe framedata.h)
+layout (std140) uniform FrameData
+{
+    mat4 u_viewMatrix;
+    mat4 u_projectionMatrix;
+    mat4 u_viewProjectionMatrix;
+    mat4 u_inverseViewMatrix;
+    mat4 u_inverseProjectionMatrix;
+    mat4 u_screenToWorld;
+    vec3 u_viewPos;
+    vec2 u_screenSize;
+    vec2 u_renderSize;
+};
 
 /**
  * Hauptfunktion des Vertex-Shaders.
- * Hier werden die Daten weiter gereicht.
+ * Hier wird das Lichtvolumen in den Clip-Space transformiert.
  */
  void main()
  {
-    gl_Position = vec4(position, 1.0);
+    gl_Position = u_fullscreen
+        ? vec4(position, 1.0)
+        : u_viewProjectionMatrix * u_modelMatrix * vec4(position, 1.0);
  }
\ No newline at end of file
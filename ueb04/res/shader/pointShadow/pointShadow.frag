@@ -1,10 +1,19 @@
 #version 410 core
 
 /**
- * Null Shader.
+ * Shader fuer die Schatten der Punktlichter.
+ * Gespeichert wird der lineare Abstand zum Licht, geteilt durch die Reichweite.
  * 
  * Copyright (C) 2023, FH Wedel
  * Autor: Joshua-Scott Schoettke, Ilana Schmara
  */
 
- void main() {}
\ No newline at end of file
+in vec3 g_worldPos;
+
+uniform vec3 u_lightPos;
+uniform float u_farPlane;
+
+void main()
+{
+    gl_FragDepth = length(g_worldPos - u_lightPos) / u_farPlane;
+}
\ No newline at end of file
@@ -1,7 +1,8 @@
 #version 410 core
 
 /**
- * Null Shader.
+ * Shader fuer die Schatten der Punktlichter.
+ * Die Projektion auf die Seiten der Cube Map uebernimmt der Geometry Shader.
  * 
  * Copyright (C) 2023, FH Wedel
  * Autor: Joshua-Scott Schoettke, Ilana Schmara
@@ -10,10 +11,11 @@
 layout (location = 0) in vec3 position;
 
 uniform mat4 u_modelMatrix;
-uniform mat4 u_viewMatrix;
-uniform mat4 u_projectionMatrix;
+
+out vec3 v_worldPos;
 
 void main()
 {
-    gl_Position = u_projectionMatrix * u_viewMatrix * u_modelMatrix * vec4(position, 1.0);
-} 
\ No newline at end of file
+    v_worldPos = (u_modelMatrix * vec4(position, 1.0)).xyz;
+    gl_Position = vec4(v_worldPos, 1.0);
+}
\ No newline at end of file
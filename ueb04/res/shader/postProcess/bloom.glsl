@@ -0,0 +1,16 @@
+/**
+ * PostProcess Effekt (siehe postprocess.h).
+ * Addiert das Ergebnis des Bloom (siehe bloom.h) auf die HDR Farbe.
+ * 
+ * Copyright (C) 2023, FH Wedel
+ * Autor: Joshua-Scott Schoettke, Ilana Schmara
+ */
+
+// Ergebnis des Bloom und seine Staerke
+uniform sampler2D u_bloom;
+uniform float u_bloomIntensity;
+
+vec3 bloom(vec3 color, vec2 uv)
+{
+   return color + texture(u_bloom, uv).rgb * u_bloomIntensity;
+}
\ No newline at end of file
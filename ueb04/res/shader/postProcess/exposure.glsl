@@ -0,0 +1,33 @@
+/**
+ * PostProcess Effekt (siehe postprocess.h).
+ * Rechnet die Farbe per Exposure Tone Mapping von HDR auf LDR zurueck.
+ * 
+ * Copyright (C) 2023, FH Wedel
+ * Autor: Joshua-Scott Schoettke, Ilana Schmara
+ */
+
+/* 
+ * Der Exposure Wert fuer das Tone Mapping
+ * Kann ueber die Gui veraendert werden, bei automatischer Belichtung dient
+ * er als Korrekturfaktor.
+ */
+uniform float u_exposure;
+
+// Automatische Belichtung und deren mittlere Helligkeit (siehe exposure.h)
+uniform bool u_autoExposure;
+uniform sampler2D u_averageLuminance;
+
+// Mittleres Grau, auf das die mittlere Helligkeit abgebildet wird
+const float EXPOSURE_KEY = 0.18;
+
+vec3 exposure(vec3 color, vec2 uv)
+{
+   float exposureValue = u_exposure;
+   if (u_autoExposure)
+   {
+      float average = texelFetch(u_averageLuminance, ivec2(0), 0).r;
+      exposureValue *= EXPOSURE_KEY / max(average, 0.0001);
+   }
+
+   return vec3(1.0) - exp(-color * exposureValue);
+}
\ No newline at end of file
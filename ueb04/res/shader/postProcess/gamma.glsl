@@ -0,0 +1,18 @@
+/**
+ * PostProcess Effekt (siehe postprocess.h).
+ * Wendet die Gamma Korrektur an.
+ * 
+ * Copyright (C) 2023, FH Wedel
+ * Autor: Joshua-Scott Schoettke, Ilana Schmara
+ */
+
+/* 
+ * Der Gamma Korrekturwert
+ * Kann ueber die Gui veraendert werden
+ */
+uniform float u_gamma;
+
+vec3 gamma(vec3 color, vec2 uv)
+{
+   return pow(color, vec3(1.0 / u_gamma));
+}
\ No newline at end of file
@@ -0,0 +1,19 @@
+/**
+ * PostProcess Effekt (siehe postprocess.h).
+ * Einfache Farbkorrektur ueber Kontrast und Saettigung.
+ * 
+ * Copyright (C) 2023, FH Wedel
+ * Autor: Joshua-Scott Schoettke, Ilana Schmara
+ */
+
+// Kontrast um das mittlere Grau, 1 = unveraendert
+uniform float u_contrast;
+// Saettigung, 0 = Graustufen, 1 = unveraendert
+uniform float u_saturation;
+
+vec3 grading(vec3 color, vec2 uv)
+{
+   color = (color - 0.5) * u_contrast + 0.5;
+   float luma = dot(color, vec3(0.2126, 0.7152, 0.0722));
+   return clamp(mix(vec3(luma), color, u_saturation), 0.0, 1.0);
+}
\ No newline at end of file
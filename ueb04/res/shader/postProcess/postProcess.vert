@@ -2,14 +2,16 @@
 
 /**
  * postProcess Shader.
+ * Erzeugt ohne Vertexdaten ein Dreieck, das den ganzen Bildschirm abdeckt.
+ * Gezeichnet wird mit glDrawArrays(GL_TRIANGLES, 0, 3).
  * 
  * Copyright (C) 2023, FH Wedel
  * Autor: Joshua-Scott Schoettke, Ilana Schmara
  */
 
- layout (location = 0) in vec3 position;
-
  void main()
  {
-   gl_Position = vec4(position, 1.0);
+   // (0,0), (2,0), (0,2) -> (-1,-1), (3,-1), (-1,3)
+   vec2 pos = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2);
+   gl_Position = vec4(pos * 2.0 - 1.0, 0.0, 1.0);
  }
\ No newline at end of file
@@ -0,0 +1,18 @@
+/**
+ * PostProcess Effekt (siehe postprocess.h).
+ * Dunkelt den Bildrand ab.
+ * 
+ * Copyright (C) 2023, FH Wedel
+ * Autor: Joshua-Scott Schoettke, Ilana Schmara
+ */
+
+// Staerke der Abdunklung in den Ecken, 0 = keine Vignette
+uniform float u_vignetteStrength;
+
+vec3 vignette(vec3 color, vec2 uv)
+{
+   // Abstand zur Bildmitte, uv deckt nur den gerenderten Bereich ab
+   vec2 centered = uv / u_renderScale - 0.5;
+   float falloff = smoothstep(0.8, 0.2, length(centered));
+   return color * mix(1.0, falloff, u_vignetteStrength);
+}
\ No newline at end of file
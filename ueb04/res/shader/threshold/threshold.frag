@@ -2,8 +2,8 @@
 
 /**
  * Threshold Shader.
- * Rechnet die Bildqualitaet von HDR auf LDR zurueck
- * und wendet die Gamma Korrektur an.
+ * Filtert die hellen Bereiche des HDR Buffers fuer den Bloom heraus und
+ * halbiert dabei die Aufloesung (siehe bloom.h).
  * 
  * Copyright (C) 2023, FH Wedel
  * Autor: Joshua-Scott Schoettke, Ilana Schmara
@@ -12,43 +12,71 @@
 // Nur die Farbe wird ausgegeben
 out vec4 FragColor;
 
-// Die Texturkoordinaten
-in vec2 TexCoords;
- 
-/* 
- * Der Exposure Wert fuer das Tone Mapping
- * Kann ueber die Gui veraendert werden
- */
-uniform float u_exposure;
+// Quelle des Passes
+uniform sampler2D u_source;
 
-/* 
- * Der Gamma Korrekturwert
- * Kann ueber die Gui veraendert werden
- */
-uniform float u_gamma;
+// Groesze der Zielstufe in Texeln
+uniform vec2 u_targetSize;
+
+// Genutzter Anteil aller Stufen (dynamische Aufloesung)
+uniform vec2 u_renderScale;
 
-// HDR Buffer
-uniform sampler2D u_hdrBuffer;
+// Helligkeit, ab der eine Farbe zum Bloom beitraegt
+uniform float u_threshold;
 
-// Bildschirmgroesze
-uniform vec2 u_screenSize;
+// Breite des weichen Uebergangs um die Schwelle
+uniform float u_knee;
+
+/**
+ * Sampelt die Quelle, ohne den gerenderten Bereich zu verlassen.
+ * 
+ * @param uv die Texturkoordinate
+ * @return die Farbe der Quelle
+ */
+vec3 sampleSource(vec2 uv)
+{
+    vec2 halfTexel = 0.5 / vec2(textureSize(u_source, 0));
+    return texture(u_source, clamp(uv, halfTexel, u_renderScale - halfTexel)).rgb;
+}
 
-vec2 CalcTexCoord()
+/**
+ * Laesst nur den Anteil einer Farbe oberhalb der Schwelle uebrig. Um die
+ * Schwelle herum wird quadratisch eingeblendet, damit keine harte Kante
+ * entsteht.
+ * 
+ * @param color die HDR Farbe
+ * @return der Anteil fuer den Bloom
+ */
+vec3 softThreshold(vec3 color)
 {
-   return gl_FragCoord.xy / u_screenSize;
-} 
+    float brightness = max(color.r, max(color.g, color.b));
+    float soft = clamp(brightness - u_threshold + u_knee, 0.0, 2.0 * u_knee);
+    soft = soft * soft / (4.0 * u_knee + 0.00001);
+    float contribution = max(soft, brightness - u_threshold) / max(brightness, 0.00001);
+    return color * contribution;
+}
 
 /*
  * Hauptfunktion
  */
- void main()
- {	
-    vec3 hdrColor = texture(u_hdrBuffer, CalcTexCoord()).rgb;
+void main()
+{
+    vec2 uv = gl_FragCoord.xy / u_targetSize;
+    vec2 texel = 1.0 / vec2(textureSize(u_source, 0));
 
-	// exposure tone mapping
-	vec3 mapped = vec3(1.0) - exp(-hdrColor * u_exposure);
-	// gamma correction
-	mapped = pow(mapped, vec3(1.0 / u_gamma));
+    // Vier bilineare Zugriffe mitteln die 4x4 Texel um das Zielpixel. Die
+    // Gewichtung nach Helligkeit unterdrueckt einzelne extrem helle Pixel,
+    // die sonst als flackernde Flecken im Bloom auftauchen.
+    vec2 offsets[4] = vec2[](vec2(-1.0, -1.0), vec2(1.0, -1.0), vec2(-1.0, 1.0), vec2(1.0, 1.0));
+    vec3 result = vec3(0.0);
+    float weightSum = 0.0;
+    for (int i = 0; i < 4; i++)
+    {
+        vec3 color = softThreshold(sampleSource(uv + offsets[i] * texel));
+        float weight = 1.0 / (1.0 + dot(color, vec3(0.2126, 0.7152, 0.0722)));
+        result += color * weight;
+        weightSum += weight;
+    }
 
-    FragColor = vec4(mapped, 1.0);	
- }
\ No newline at end of file
+    FragColor = vec4(result / weightSum, 1.0);
+}
\ No newline at end of file
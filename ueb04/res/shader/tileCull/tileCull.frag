@@ -0,0 +1,107 @@
+#version 410 core
+
+/**
+ * Lichtzuordnung der Kacheln Shader.
+ * Jedes Fragment entspricht einer Kachel. Fuer jedes Punktlicht wird geprueft,
+ * ob seine Kugel das Frustum der Kachel schneidet. Das Ergebnis wird als
+ * Bitmaske ueber vier RGBA32UI Texturen (512 Bit) ausgegeben.
+ * 
+ * Copyright (C) 2023, FH Wedel
+ * Autor: Joshua-Scott Schoettke, Ilana Schmara
+ */
+
+// Kantenlaenge einer Kachel, muss TILED_TILE_SIZE entsprechen
+const int TILE_SIZE = 16;
+
+// Anzahl der Texel je Licht, muss LIGHT_BUFFER_TEXELS entsprechen
+const int LIGHT_TEXELS = 5;
+
+// Bitmaske der Lichter, die die Kachel beeinflussen
+layout (location = 0) out uvec4 fragMask0;
+layout (location = 1) out uvec4 fragMask1;
+layout (location = 2) out uvec4 fragMask2;
+layout (location = 3) out uvec4 fragMask3;
+
+// Tiefenbereich der Kacheln
+uniform sampler2D u_depthRange;
+
+// Lichtdaten (siehe light.h)
+uniform samplerBuffer u_lights;
+
+// Anzahl der Lichter im Buffer
+uniform int u_lightCount;
+
+// Kamera und Bildschirm, einmal pro Frame gesetzt (siehe framedata.h)
+layout (std140) uniform FrameData
+{
+    mat4 u_viewMatrix;
+    mat4 u_projectionMatrix;
+    mat4 u_viewProjectionMatrix;
+    mat4 u_inverseViewMatrix;
+    mat4 u_inverseProjectionMatrix;
+    mat4 u_screenToWorld;
+    vec3 u_viewPos;
+    vec2 u_screenSize;
+    vec2 u_renderSize;
+};
+
+/**
+ * Hauptfunktion des Fragment-Shaders.
+ * Hier wird die Lichtliste der Kachel bestimmt.
+ */
+void main()
+{
+    uint mask[16];
+    for (int i = 0; i < 16; i++)
+    {
+        mask[i] = 0u;
+    }
+
+    ivec2 tile = ivec2(gl_FragCoord.xy);
+    vec2 depthRange = texelFetch(u_depthRange, tile, 0).rg;
+
+    if (depthRange.x <= depthRange.y)
+    {
+        // Die Raender der Kachel in NDC bestimmen.
+        vec2 ndcMin = vec2(tile * TILE_SIZE) / u_renderSize * 2.0 - 1.0;
+        vec2 ndcMax = min(vec2((tile + 1) * TILE_SIZE) / u_renderSize, 1.0) * 2.0 - 1.0;
+
+        // Die seitlichen Ebenen des Kachel-Frustums gehen durch den Ursprung
+        // des View-Space. Die Normalen zeigen nach innen.
+        float px = u_projectionMatrix[0][0];
+        float py = u_projectionMatrix[1][1];
+        vec3 planes[4];
+        planes[0] = normalize(vec3( px, 0.0,  ndcMin.x));
+        planes[1] = normalize(vec3(-px, 0.0, -ndcMax.x));
+        planes[2] = normalize(vec3(0.0,  py,  ndcMin.y));
+        planes[3] = normalize(vec3(0.0, -py, -ndcMax.y));
+
+        for (int i = 0; i < u_lightCount; i++)
+        {
+            vec4 posRadius = texelFetch(u_lights, i * LIGHT_TEXELS);
+            vec3 center = (u_viewMatrix * vec4(posRadius.xyz, 1.0)).xyz;
+            float radius = posRadius.w;
+
+            // Zuerst gegen den Tiefenbereich testen ...
+            float dist = -center.z;
+            bool inside = dist + radius >= depthRange.x 
+                       && dist - radius <= depthRange.y;
+
+            // ... dann gegen die seitlichen Ebenen.
+            for (int p = 0; p < 4 && inside; p++)
+            {
+                inside = dot(planes[p], center) >= -radius;
+            }
+
+            if (inside)
+            {
+                mask[i >> 5] |= 1u << uint(i & 31);
+            }
+        }
+    }
+
+    fragMask0 = uvec4(mask[0], mask[1], mask[2], mask[3]);
+    fragMask1 = uvec4(mask[4], mask[5], mask[6], mask[7]);
+    fragMask2 = uvec4(mask[8], mask[9], mask[10], mask[11]);
+    fragMask3 = uvec4(mask[12], mask[13], mask[14], mask[15]);
+}
@@ -0,0 +1,83 @@
+#version 410 core
+
+/**
+ * Tiefenbereich der Kacheln Shader.
+ * Jedes Fragment entspricht einer Kachel und bestimmt die minimale und
+ * maximale Tiefe der darin enthaltenen Geometrie im View-Space.
+ * 
+ * Copyright (C) 2023, FH Wedel
+ * Autor: Joshua-Scott Schoettke, Ilana Schmara
+ */
+
+// Kantenlaenge einer Kachel, muss TILED_TILE_SIZE entsprechen
+const int TILE_SIZE = 16;
+
+// Tiefenbereich (min, max) als positive Distanz zur Kamera
+layout (location = 0) out vec2 fragDepthRange;
+
+// Tiefenbuffer des GBuffers
+uniform sampler2D u_depth;
+
+// Kamera und Bildschirm, einmal pro Frame gesetzt (siehe framedata.h)
+layout (std140) uniform FrameData
+{
+    mat4 u_viewMatrix;
+    mat4 u_projectionMatrix;
+    mat4 u_viewProjectionMatrix;
+    mat4 u_inverseViewMatrix;
+    mat4 u_inverseProjectionMatrix;
+    mat4 u_screenToWorld;
+    vec3 u_viewPos;
+    vec2 u_screenSize;
+    vec2 u_renderSize;
+};
+
+/**
+ * Rechnet einen Wert aus dem Tiefenbuffer in die Distanz zur Kamera um.
+ *
+ * @param depth der Tiefenwert im Bereich [0, 1]
+ * @return die Distanz entlang der Blickrichtung
+ */
+float linearDepth(float depth)
+{
+    float ndc = depth * 2.0 - 1.0;
+    return u_projectionMatrix[3][2] / (ndc + u_projectionMatrix[2][2]);
+}
+
+/**
+ * Hauptfunktion des Fragment-Shaders.
+ * Hier werden alle Pixel der Kachel durchlaufen.
+ */
+void main()
+{
+    ivec2 tileStart = ivec2(gl_FragCoord.xy) * TILE_SIZE;
+    ivec2 tileEnd = min(tileStart + TILE_SIZE, ivec2(u_renderSize));
+
+    float minDepth = 1.0;
+    float maxDepth = 0.0;
+
+    for (int y = tileStart.y; y < tileEnd.y; y++)
+    {
+        for (int x = tileStart.x; x < tileEnd.x; x++)
+        {
+            float depth = texelFetch(u_depth, ivec2(x, y), 0).r;
+
+            // Der Hintergrund wird nicht beleuchtet und zaehlt daher nicht.
+            if (depth < 1.0)
+            {
+                minDepth = min(minDepth, depth);
+                maxDepth = max(maxDepth, depth);
+            }
+        }
+    }
+
+    if (maxDepth < minDepth)
+    {
+        // Leere Kachel: ein ungueltiger Bereich verwirft alle Lichter.
+        fragDepthRange = vec2(1e30, -1e30);
+    }
+    else
+    {
+        fragDepthRange = vec2(linearDepth(minDepth), linearDepth(maxDepth));
+    }
+}
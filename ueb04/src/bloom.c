@@ -0,0 +1,127 @@
+/**
+ * Modul für den Bloom Effekt.
+ *
+ * Copyright (C) 2023, FH Wedel
+ * Autor: Joshua-Scott Schöttke, Ilana Schmara
+ */
+
+#include "bloom.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "glstate.h"
+
+////////////////////////////// LOKALE DATENTYPEN ///////////////////////////////
+
+// Datenstruktur mit den Stufen des Bloom Effekts.
+struct Bloom
+{
+    GLuint fbo;
+
+    int mipCount;
+    GLuint mips[BLOOM_MAX_MIPS];
+    int widths[BLOOM_MAX_MIPS];
+    int heights[BLOOM_MAX_MIPS];
+};
+
+//////////////////////////// ÖFFENTLICHE FUNKTIONEN ////////////////////////////
+
+Bloom* bloom_createBloom(int width, int height)
+{
+    Bloom* bloom = malloc(sizeof(Bloom));
+    memset(bloom, 0, sizeof(Bloom));
+
+    // Jede Stufe hat die halbe Größe der vorherigen, die erste die halbe
+    // Größe des HDR Buffers. R11G11B10F reicht für das weichgezeichnete Licht
+    // und halbiert die Bandbreite gegenüber RGBA16F.
+    int mipWidth = width;
+    int mipHeight = height;
+    for (int i = 0; i < BLOOM_MAX_MIPS; i++)
+    {
+        mipWidth = (mipWidth + 1) / 2;
+        mipHeight = (mipHeight + 1) / 2;
+        if (mipWidth < BLOOM_MIN_SIZE || mipHeight < BLOOM_MIN_SIZE)
+        {
+            break;
+        }
+
+        bloom->widths[i] = mipWidth;
+        bloom->heights[i] = mipHeight;
+
+        glGenTextures(1, &bloom->mips[i]);
+        glstate_bindTexture(GL_TEXTURE_2D, bloom->mips[i]);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_R11F_G11F_B10F, mipWidth, mipHeight,
+                     0, GL_RGB, GL_FLOAT, NULL);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        common_labelObjectByType(GL_TEXTURE, bloom->mips[i], "Bloom Mip");
+
+        bloom->mipCount++;
+    }
+    glstate_bindTexture(GL_TEXTURE_2D, 0);
+
+    // Die Stufen werden erst beim Rendern angehängt.
+    glGenFramebuffers(1, &bloom->fbo);
+    glstate_bindFramebuffer(GL_FRAMEBUFFER, bloom->fbo);
+    if (bloom->mipCount > 0)
+    {
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0,
+                               GL_TEXTURE_2D, bloom->mips[0], 0);
+
+        GLenum fboState = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+        if (fboState != GL_FRAMEBUFFER_COMPLETE)
+        {
+            fprintf(stderr, "Error: FBO \"Bloom\" not complete (0x%x).\n",
+                    fboState);
+        }
+    }
+    common_labelObjectByType(GL_FRAMEBUFFER, bloom->fbo, "Bloom");
+
+    glstate_bindFramebuffer(GL_FRAMEBUFFER, 0);
+    return bloom;
+}
+
+int bloom_getMipCount(Bloom* bloom)
+{
+    return bloom->mipCount;
+}
+
+void bloom_bindForMip(Bloom* bloom, int mip, vec2 renderRatio, Shader* shader)
+{
+    glstate_bindFramebuffer(GL_FRAMEBUFFER, bloom->fbo);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0,
+                           GL_TEXTURE_2D, bloom->mips[mip], 0);
+
+    // Nur den genutzten Anteil rendern, angeschnittene Texel zählen mit.
+    int width = bloom->widths[mip];
+    int height = bloom->heights[mip];
+    glViewport(0, 0, (GLsizei)ceilf((float)width * renderRatio[0]),
+               (GLsizei)ceilf((float)height * renderRatio[1]));
+
+    vec2 targetSize = { (float)width, (float)height };
+    shader_setVec2(shader, "u_targetSize", &targetSize);
+    shader_setVec2(shader, "u_renderScale", (vec2*)renderRatio);
+}
+
+void bloom_bindMipTexture(Bloom* bloom, int mip, GLenum textureUnit)
+{
+    glstate_activeTexture(textureUnit);
+    glstate_bindTexture(GL_TEXTURE_2D, bloom->mips[mip]);
+}
+
+void bloom_deleteBloom(Bloom* bloom)
+{
+    if (!bloom)
+    {
+        return;
+    }
+
+    glstate_deleteFramebuffers(1, &bloom->fbo);
+    glstate_deleteTextures(bloom->mipCount, bloom->mips);
+
+    free(bloom);
+}
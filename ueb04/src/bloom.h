@@ -0,0 +1,98 @@
+/**
+ * Modul für den Bloom Effekt.
+ *
+ * Die hellen Bereiche des HDR Buffers werden in mehreren Stufen mit jeweils
+ * halber Auflösung weichgezeichnet und anschließend wieder addiert:
+ *
+ *  1. Threshold: Der HDR Buffer wird auf halbe Auflösung in Stufe 0
+ *     gefiltert, dabei bleiben nur Farben oberhalb der Schwelle übrig.
+ *  2. Downsample: Jede weitere Stufe entsteht aus der vorherigen mit einem
+ *     13-Tap Filter.
+ *  3. Upsample: Von der kleinsten Stufe aufwärts wird jede Stufe mit einem
+ *     3x3 Tent-Filter vergrößert und auf die nächstgrößere addiert.
+ *
+ * Das Ergebnis liegt danach in Stufe 0 und wird im PostProcess auf den
+ * HDR Buffer addiert. Da jede Stufe nur ein Viertel der Pixel der vorherigen
+ * hat, kostet die ganze Kette kaum mehr als ein Pass in halber Auflösung,
+ * erreicht aber einen sehr großen Radius.
+ *
+ * Bei dynamischer Auflösung wird in jeder Stufe nur der Anteil renderRatio
+ * gerendert. Die Texturkoordinaten beziehen sich in allen Stufen auf die
+ * volle Größe der Textur, so dass sie mit denen des HDR Buffers
+ * übereinstimmen. Die Shader erhalten dazu:
+ *
+ * uniform vec2 u_targetSize;   // Größe der Zielstufe in Texeln
+ * uniform vec2 u_renderScale;  // genutzter Anteil jeder Stufe
+ *
+ * Copyright (C) 2023, FH Wedel
+ * Autor: Joshua-Scott Schöttke, Ilana Schmara
+ */
+
+#ifndef BLOOM_H
+#define BLOOM_H
+
+#include "common.h"
+#include "shader.h"
+
+////////////////////////////////// KONSTANTEN //////////////////////////////////
+
+// Maximale Anzahl der Stufen. Kleinere Stufen als BLOOM_MIN_SIZE Pixel werden
+// ausgelassen.
+#define BLOOM_MAX_MIPS 6
+#define BLOOM_MIN_SIZE 4
+
+//////////////////////////// ÖFFENTLICHE DATENTYPEN ////////////////////////////
+
+// Datenstruktur mit den Stufen des Bloom Effekts.
+struct Bloom;
+typedef struct Bloom Bloom;
+
+//////////////////////////// ÖFFENTLICHE FUNKTIONEN ////////////////////////////
+
+/**
+ * Erzeugt die Stufen für einen HDR Buffer der angegebenen Größe. Die erste
+ * Stufe hat die halbe Größe des HDR Buffers.
+ *
+ * @param width die Breite des HDR Buffers in Pixeln
+ * @param height die Höhe des HDR Buffers in Pixeln
+ * @return die neuen Bloom Daten
+ */
+Bloom* bloom_createBloom(int width, int height);
+
+/**
+ * Liefert die Anzahl der angelegten Stufen.
+ *
+ * @param bloom die Bloom Daten
+ * @return die Anzahl der Stufen
+ */
+int bloom_getMipCount(Bloom* bloom);
+
+/**
+ * Bindet eine Stufe als Ziel, setzt den Viewport auf ihren genutzten Bereich
+ * und übergibt u_targetSize und u_renderScale an den Shader.
+ * Der Shader MUSS zuvor bereits aktiviert worden sein.
+ *
+ * @param bloom die Bloom Daten
+ * @param mip der Index der Stufe
+ * @param renderRatio der genutzte Anteil (dynamische Auflösung)
+ * @param shader der Shader des Passes
+ */
+void bloom_bindForMip(Bloom* bloom, int mip, vec2 renderRatio, Shader* shader);
+
+/**
+ * Bindet die Textur einer Stufe an die angegebene Textureinheit.
+ *
+ * @param bloom die Bloom Daten
+ * @param mip der Index der Stufe
+ * @param textureUnit die Textureinheit (GL_TEXTURE0 + i)
+ */
+void bloom_bindMipTexture(Bloom* bloom, int mip, GLenum textureUnit);
+
+/**
+ * Löscht die Bloom Daten.
+ *
+ * @param bloom die zu löschenden Bloom Daten
+ */
+void bloom_deleteBloom(Bloom* bloom);
+
+#endif // BLOOM_H
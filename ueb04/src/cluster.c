@@ -0,0 +1,374 @@
+/**
+ * Modul für Clustered Lighting.
+ *
+ * Copyright (C) 2023, FH Wedel
+ * Autor: Joshua-Scott Schöttke, Ilana Schmara
+ */
+
+#include "cluster.h"
+
+#include <math.h>
+#include <string.h>
+#include <sesp/stb_ds.h>
+
+#include "glstate.h"
+#include "threadpool.h"
+
+////////////////////////////// LOKALE DATENTYPEN ///////////////////////////////
+
+// Zwischenergebnisse einer Tiefenscheibe. Jede Scheibe wird von genau einem
+// Thread bearbeitet, daher ist keine Synchronisation nötig.
+struct ClusterSlice
+{
+    // Gefundene Paare aus Kachel und Licht (stb_ds Arrays).
+    GLuint* hitTiles;
+    GLuint* hitLights;
+
+    // Die Lichtindizes der Scheibe, nach Kacheln sortiert (stb_ds Array).
+    GLuint* indices;
+};
+typedef struct ClusterSlice ClusterSlice;
+
+// Datenstruktur mit dem Cluster-Gitter und den Lichtlisten.
+struct ClusteredLighting
+{
+    ThreadPool* pool;
+
+    // Parameter des aktuellen Frames.
+    int width;
+    int height;
+    int tilesX;
+    int tilesY;
+    float nearPlane;
+    float farPlane;
+    float projX;
+    float projY;
+
+    // Lichter im View-Space: xyz = Mittelpunkt, w = Radius.
+    vec4* viewLights;
+    unsigned int lightCount;
+    unsigned int lightCapacity;
+
+    ClusterSlice slices[CLUSTER_SLICES];
+
+    // Je Cluster zwei Werte: Offset und Anzahl.
+    GLuint* grid;
+    unsigned int gridCapacity;
+
+    // Alle Lichtindizes hintereinander (stb_ds Array).
+    GLuint* indices;
+
+    GLuint gridBuffer;
+    GLuint gridTexture;
+    GLuint indexBuffer;
+    GLuint indexTexture;
+};
+
+////////////////////////////// LOKALE FUNKTIONEN ///////////////////////////////
+
+/**
+ * Liefert die Distanz zur Kamera, an der eine Tiefenscheibe beginnt.
+ *
+ * @param cluster die Clustered Lighting Daten
+ * @param slice der Index der Scheibe (0 bis CLUSTER_SLICES)
+ * @return die Distanz entlang der Blickrichtung
+ */
+static float cluster_sliceDepth(ClusteredLighting* cluster, int slice)
+{
+    return cluster->nearPlane
+         * powf(cluster->farPlane / cluster->nearPlane,
+                (float)slice / (float)CLUSTER_SLICES);
+}
+
+/**
+ * Rechnet eine NDC Koordinate in den Index einer Kachel um.
+ *
+ * @param ndc die NDC Koordinate
+ * @param pixels die Bildschirmgröße in dieser Achse
+ * @param tiles die Anzahl der Kacheln in dieser Achse
+ * @return der auf gültige Kacheln begrenzte Index
+ */
+static int cluster_ndcToTile(float ndc, int pixels, int tiles)
+{
+    int tile = (int)floorf((ndc * 0.5f + 0.5f) * (float)pixels
+                           / (float)CLUSTER_TILE_SIZE);
+    return tile < 0 ? 0 : (tile >= tiles ? tiles - 1 : tile);
+}
+
+/**
+ * Ordnet alle Lichter den Clustern einer Tiefenscheibe zu. Wird parallel für
+ * alle Scheiben vom Thread-Pool aufgerufen.
+ *
+ * @param slice der Index der Scheibe
+ * @param userData die Clustered Lighting Daten
+ */
+static void cluster_assignSlice(int slice, void* userData)
+{
+    ClusteredLighting* cluster = userData;
+    ClusterSlice* data = &cluster->slices[slice];
+
+    int tileCount = cluster->tilesX * cluster->tilesY;
+    GLuint* grid = cluster->grid + (size_t)slice * tileCount * 2;
+
+    float sliceNear = cluster_sliceDepth(cluster, slice);
+    float sliceFar = cluster_sliceDepth(cluster, slice + 1);
+
+    stbds_arrsetlen(data->hitTiles, 0);
+    stbds_arrsetlen(data->hitLights, 0);
+    for (int t = 0; t < tileCount; t++)
+    {
+        grid[t * 2 + 1] = 0;
+    }
+
+    for (unsigned int i = 0; i < cluster->lightCount; i++)
+    {
+        float* light = cluster->viewLights[i];
+        float radius = light[3];
+        float depth = -light[2];
+
+        // Lichter außerhalb der Scheibe können direkt verworfen werden.
+        if (depth + radius < sliceNear || depth - radius > sliceFar)
+        {
+            continue;
+        }
+
+        // Die Ausdehnung der Kugel innerhalb der Scheibe in NDC bestimmen,
+        // um nur die Kacheln in ihrer Nähe testen zu müssen.
+        float zMin = fmaxf(sliceNear, depth - radius);
+        float zMax = fminf(sliceFar, depth + radius);
+        float ndcMinX = fminf((light[0] - radius) / zMin, (light[0] - radius) / zMax) * cluster->projX;
+        float ndcMaxX = fmaxf((light[0] + radius) / zMin, (light[0] + radius) / zMax) * cluster->projX;
+        float ndcMinY = fminf((light[1] - radius) / zMin, (light[1] - radius) / zMax) * cluster->projY;
+        float ndcMaxY = fmaxf((light[1] + radius) / zMin, (light[1] + radius) / zMax) * cluster->projY;
+
+        if (ndcMaxX < -1.0f || ndcMinX > 1.0f || ndcMaxY < -1.0f || ndcMinY > 1.0f)
+        {
+            continue;
+        }
+
+        int tileMinX = cluster_ndcToTile(ndcMinX, cluster->width, cluster->tilesX);
+        int tileMaxX = cluster_ndcToTile(ndcMaxX, cluster->width, cluster->tilesX);
+        int tileMinY = cluster_ndcToTile(ndcMinY, cluster->height, cluster->tilesY);
+        int tileMaxY = cluster_ndcToTile(ndcMaxY, cluster->height, cluster->tilesY);
+
+        for (int ty = tileMinY; ty <= tileMaxY; ty++)
+        {
+            // Die y-Grenzen der Kachel als Steigung im View-Space.
+            float slopeMinY = ((float)(ty * CLUSTER_TILE_SIZE) / cluster->height * 2.0f - 1.0f) / cluster->projY;
+            float slopeMaxY = (fminf((float)((ty + 1) * CLUSTER_TILE_SIZE) / cluster->height, 1.0f) * 2.0f - 1.0f) / cluster->projY;
+
+            for (int tx = tileMinX; tx <= tileMaxX; tx++)
+            {
+                float slopeMinX = ((float)(tx * CLUSTER_TILE_SIZE) / cluster->width * 2.0f - 1.0f) / cluster->projX;
+                float slopeMaxX = (fminf((float)((tx + 1) * CLUSTER_TILE_SIZE) / cluster->width, 1.0f) * 2.0f - 1.0f) / cluster->projX;
+
+                // Bounding Box des Clusters im View-Space.
+                vec3 boxMin = {
+                    fminf(slopeMinX * sliceNear, slopeMinX * sliceFar),
+                    fminf(slopeMinY * sliceNear, slopeMinY * sliceFar),
+                    -sliceFar
+                };
+                vec3 boxMax = {
+                    fmaxf(slopeMaxX * sliceNear, slopeMaxX * sliceFar),
+                    fmaxf(slopeMaxY * sliceNear, slopeMaxY * sliceFar),
+                    -sliceNear
+                };
+
+                // Abstand der Kugel zur Box testen.
+                float distSq = 0.0f;
+                for (int axis = 0; axis < 3; axis++)
+                {
+                    float closest = glm_clamp(light[axis], boxMin[axis], boxMax[axis]);
+                    float delta = light[axis] - closest;
+                    distSq += delta * delta;
+                }
+
+                if (distSq <= radius * radius)
+                {
+                    GLuint tile = (GLuint)(ty * cluster->tilesX + tx);
+                    stbds_arrput(data->hitTiles, tile);
+                    stbds_arrput(data->hitLights, (GLuint)i);
+                    grid[tile * 2 + 1]++;
+                }
+            }
+        }
+    }
+
+    // Aus den Anzahlen die Offsets innerhalb der Scheibe berechnen. Die
+    // Anzahlen werden danach beim Einsortieren wieder hochgezählt.
+    GLuint offset = 0;
+    for (int t = 0; t < tileCount; t++)
+    {
+        grid[t * 2] = offset;
+        offset += grid[t * 2 + 1];
+        grid[t * 2 + 1] = 0;
+    }
+
+    stbds_arrsetlen(data->indices, offset);
+    for (size_t h = 0; h < stbds_arrlenu(data->hitTiles); h++)
+    {
+        GLuint tile = data->hitTiles[h];
+        data->indices[grid[tile * 2] + grid[tile * 2 + 1]++] = data->hitLights[h];
+    }
+}
+
+/**
+ * Legt einen Texture Buffer mit dem angegebenen Format an.
+ *
+ * @param buffer Rückgabe des Buffers
+ * @param texture Rückgabe der Textur
+ * @param format das Format der Texel
+ * @param label der Name für RenderDoc
+ */
+static void cluster_createTextureBuffer(GLuint* buffer, GLuint* texture,
+                                        GLenum format, const char* label)
+{
+    GLuint empty[2] = { 0, 0 };
+
+    glGenBuffers(1, buffer);
+    glBindBuffer(GL_TEXTURE_BUFFER, *buffer);
+    glBufferData(GL_TEXTURE_BUFFER, sizeof(empty), empty, GL_STREAM_DRAW);
+    common_labelObjectByType(GL_BUFFER, *buffer, label);
+
+    glGenTextures(1, texture);
+    glstate_bindTexture(GL_TEXTURE_BUFFER, *texture);
+    glTexBuffer(GL_TEXTURE_BUFFER, format, *buffer);
+    common_labelObjectByType(GL_TEXTURE, *texture, label);
+
+    glstate_bindTexture(GL_TEXTURE_BUFFER, 0);
+    glBindBuffer(GL_TEXTURE_BUFFER, 0);
+}
+
+//////////////////////////// ÖFFENTLICHE FUNKTIONEN ////////////////////////////
+
+ClusteredLighting* cluster_createClusteredLighting(void)
+{
+    ClusteredLighting* cluster = malloc(sizeof(ClusteredLighting));
+    memset(cluster, 0, sizeof(ClusteredLighting));
+
+    // Der Hauptthread arbeitet selbst mit, daher ein Thread weniger.
+    cluster->pool = threadpool_createThreadPool(threadpool_getProcessorCount() - 1);
+
+    cluster_createTextureBuffer(&cluster->gridBuffer, &cluster->gridTexture,
+                                GL_RG32UI, "Cluster Grid");
+    cluster_createTextureBuffer(&cluster->indexBuffer, &cluster->indexTexture,
+                                GL_R32UI, "Cluster Light Indices");
+
+    return cluster;
+}
+
+void cluster_updateClusters(ClusteredLighting* cluster, PointLight** lights,
+                            unsigned int count, mat4 viewMatrix,
+                            mat4 projectionMatrix, int width, int height,
+                            float nearPlane, float farPlane)
+{
+    cluster->width = width;
+    cluster->height = height;
+    cluster->tilesX = (width + CLUSTER_TILE_SIZE - 1) / CLUSTER_TILE_SIZE;
+    cluster->tilesY = (height + CLUSTER_TILE_SIZE - 1) / CLUSTER_TILE_SIZE;
+    cluster->nearPlane = nearPlane;
+    cluster->farPlane = farPlane;
+    cluster->projX = projectionMatrix[0][0];
+    cluster->projY = projectionMatrix[1][1];
+
+    unsigned int clusterCount = (unsigned int)(cluster->tilesX * cluster->tilesY) * CLUSTER_SLICES;
+    if (clusterCount > cluster->gridCapacity)
+    {
+        cluster->gridCapacity = clusterCount;
+        cluster->grid = realloc(cluster->grid, sizeof(GLuint) * 2 * clusterCount);
+    }
+
+    // Die Lichter einmalig in den View-Space transformieren.
+    if (count > cluster->lightCapacity)
+    {
+        cluster->lightCapacity = count;
+        cluster->viewLights = realloc(cluster->viewLights, sizeof(vec4) * count);
+    }
+    cluster->lightCount = count;
+    for (unsigned int i = 0; i < count; i++)
+    {
+        glm_mat4_mulv3(viewMatrix, lights[i]->position, 1.0f, cluster->viewLights[i]);
+        cluster->viewLights[i][3] = lights[i]->radius;
+    }
+
+    // Die Scheiben parallel bearbeiten.
+    threadpool_parallelFor(cluster->pool, CLUSTER_SLICES, cluster_assignSlice, cluster);
+
+    // Die Ergebnisse der Scheiben zu einer Liste zusammenfügen.
+    int tileCount = cluster->tilesX * cluster->tilesY;
+    stbds_arrsetlen(cluster->indices, 0);
+    for (int slice = 0; slice < CLUSTER_SLICES; slice++)
+    {
+        ClusterSlice* data = &cluster->slices[slice];
+        GLuint base = (GLuint)stbds_arrlenu(cluster->indices);
+        GLuint* grid = cluster->grid + (size_t)slice * tileCount * 2;
+
+        for (int t = 0; t < tileCount; t++)
+        {
+            grid[t * 2] += base;
+        }
+
+        size_t sliceCount = stbds_arrlenu(data->indices);
+        if (sliceCount > 0)
+        {
+            memcpy(stbds_arraddnptr(cluster->indices, sliceCount),
+                   data->indices, sizeof(GLuint) * sliceCount);
+        }
+    }
+
+    // Ergebnisse hochladen. Ein leerer Buffer ist nicht erlaubt.
+    glBindBuffer(GL_TEXTURE_BUFFER, cluster->gridBuffer);
+    glBufferData(GL_TEXTURE_BUFFER, sizeof(GLuint) * 2 * clusterCount,
+                 cluster->grid, GL_STREAM_DRAW);
+
+    GLuint emptyIndex = 0;
+    size_t indexCount = stbds_arrlenu(cluster->indices);
+    glBindBuffer(GL_TEXTURE_BUFFER, cluster->indexBuffer);
+    glBufferData(GL_TEXTURE_BUFFER, sizeof(GLuint) * (indexCount > 0 ? indexCount : 1),
+                 indexCount > 0 ? cluster->indices : &emptyIndex, GL_STREAM_DRAW);
+    glBindBuffer(GL_TEXTURE_BUFFER, 0);
+}
+
+void cluster_activateClusters(ClusteredLighting* cluster, Shader* shader,
+                              int gridUnit, int indexUnit)
+{
+    glstate_activeTexture(GL_TEXTURE0 + gridUnit);
+    glstate_bindTexture(GL_TEXTURE_BUFFER, cluster->gridTexture);
+    glstate_activeTexture(GL_TEXTURE0 + indexUnit);
+    glstate_bindTexture(GL_TEXTURE_BUFFER, cluster->indexTexture);
+
+    shader_setInt(shader, "u_clusterGrid", gridUnit);
+    shader_setInt(shader, "u_clusterIndices", indexUnit);
+    shader_setInt(shader, "u_clusterTilesX", cluster->tilesX);
+    shader_setInt(shader, "u_clusterTilesY", cluster->tilesY);
+    shader_setFloat(shader, "u_clusterNear", cluster->nearPlane);
+    shader_setFloat(shader, "u_clusterSliceScale",
+        (float)CLUSTER_SLICES / logf(cluster->farPlane / cluster->nearPlane));
+}
+
+void cluster_deleteClusteredLighting(ClusteredLighting* cluster)
+{
+    if (!cluster)
+    {
+        return;
+    }
+
+    threadpool_deleteThreadPool(cluster->pool);
+
+    for (int slice = 0; slice < CLUSTER_SLICES; slice++)
+    {
+        stbds_arrfree(cluster->slices[slice].hitTiles);
+        stbds_arrfree(cluster->slices[slice].hitLights);
+        stbds_arrfree(cluster->slices[slice].indices);
+    }
+    stbds_arrfree(cluster->indices);
+
+    glstate_deleteTextures(1, &cluster->gridTexture);
+    glstate_deleteTextures(1, &cluster->indexTexture);
+    glDeleteBuffers(1, &cluster->gridBuffer);
+    glDeleteBuffers(1, &cluster->indexBuffer);
+
+    free(cluster->grid);
+    free(cluster->viewLights);
+    free(cluster);
+}
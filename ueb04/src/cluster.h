@@ -0,0 +1,99 @@
+/**
+ * Modul für Clustered Lighting.
+ *
+ * Das View-Frustum wird in ein Gitter aus Froxeln (Frustum-Voxeln) aufgeteilt:
+ * Kacheln zu CLUSTER_TILE_SIZE x CLUSTER_TILE_SIZE Pixeln in x und y und
+ * CLUSTER_SLICES exponentiell verteilte Tiefenscheiben in z. Jedes Frame wird
+ * auf der CPU bestimmt, welche Punktlichter welchen Cluster beeinflussen. Die
+ * Tiefenscheiben werden dabei parallel auf alle Kerne verteilt.
+ *
+ * Das Ergebnis wird als zwei Texture Buffer an die Shader übergeben:
+ *
+ * // Je Cluster: x = Offset in die Indexliste, y = Anzahl der Lichter
+ * uniform usamplerBuffer u_clusterGrid;     // RG32UI
+ * // Kompakte Liste der Lichtindizes aller Cluster
+ * uniform usamplerBuffer u_clusterIndices;  // R32UI
+ *
+ * Ein Cluster wird im Shader über den Index
+ * (slice * u_clusterTilesY + tileY) * u_clusterTilesX + tileX gefunden, wobei
+ * slice = floor(log(tiefe / u_clusterNear) * u_clusterSliceScale) ist.
+ * Da keine Compute Shader benötigt werden, funktioniert das Verfahren auch auf
+ * OpenGL 4.1 Hardware.
+ *
+ * Copyright (C) 2023, FH Wedel
+ * Autor: Joshua-Scott Schöttke, Ilana Schmara
+ */
+
+#ifndef CLUSTER_H
+#define CLUSTER_H
+
+#include "common.h"
+#include "light.h"
+#include "shader.h"
+
+////////////////////////////////// KONSTANTEN //////////////////////////////////
+
+// Kantenlänge einer Kachel in Pixeln. Muss mit den Shadern übereinstimmen.
+#define CLUSTER_TILE_SIZE 64
+
+// Anzahl der Tiefenscheiben. Muss mit den Shadern übereinstimmen.
+#define CLUSTER_SLICES 24
+
+//////////////////////////// ÖFFENTLICHE DATENTYPEN ////////////////////////////
+
+// Datenstruktur mit dem Cluster-Gitter und den Lichtlisten.
+struct ClusteredLighting;
+typedef struct ClusteredLighting ClusteredLighting;
+
+//////////////////////////// ÖFFENTLICHE FUNKTIONEN ////////////////////////////
+
+/**
+ * Erzeugt die Daten für das Clustered Lighting. Für die Zuordnung der
+ * Lichter wird ein Thread pro zusätzlichem Prozessorkern gestartet.
+ *
+ * @return die neuen Daten für das Clustered Lighting
+ */
+ClusteredLighting* cluster_createClusteredLighting(void);
+
+/**
+ * Baut das Cluster-Gitter für das aktuelle Frame auf, ordnet ihm die
+ * Punktlichter zu und lädt das Ergebnis auf die GPU.
+ *
+ * @param cluster die Clustered Lighting Daten
+ * @param lights die Punktlichter
+ * @param count die Anzahl der Punktlichter
+ * @param viewMatrix die View Matrix
+ * @param projectionMatrix die (symmetrische) perspektivische Projektion
+ * @param width die Breite des Bildschirms in Pixeln
+ * @param height die Höhe des Bildschirms in Pixeln
+ * @param nearPlane die Near-Plane der Projektion
+ * @param farPlane die Far-Plane der Projektion
+ */
+void cluster_updateClusters(ClusteredLighting* cluster, PointLight** lights,
+                            unsigned int count, mat4 viewMatrix,
+                            mat4 projectionMatrix, int width, int height,
+                            float nearPlane, float farPlane);
+
+/**
+ * Bindet die Cluster-Daten an die angegebenen Textureinheiten und übergibt
+ * die Parameter des Gitters per Uniform an den Shader.
+ * Der Shader MUSS zuvor bereits aktiviert worden sein.
+ *
+ * Für mehr Informationen siehe den Dateikopf.
+ *
+ * @param cluster die Clustered Lighting Daten
+ * @param shader der Shader, an den die Daten übergeben werden sollen
+ * @param gridUnit Index der Textureinheit für das Gitter
+ * @param indexUnit Index der Textureinheit für die Indexliste
+ */
+void cluster_activateClusters(ClusteredLighting* cluster, Shader* shader,
+                              int gridUnit, int indexUnit);
+
+/**
+ * Löscht die Clustered Lighting Daten und beendet die Threads.
+ *
+ * @param cluster die zu löschenden Daten
+ */
+void cluster_deleteClusteredLighting(ClusteredLighting* cluster);
+
+#endif // CLUSTER_H
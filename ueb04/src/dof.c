@@ -0,0 +1,196 @@
+/**
+ * Modul für die Tiefenunschärfe (Depth of Field).
+ *
+ * Copyright (C) 2023, FH Wedel
+ * Autor: Joshua-Scott Schöttke, Ilana Schmara
+ */
+
+#include "dof.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "glstate.h"
+
+////////////////////////////////// KONSTANTEN //////////////////////////////////
+
+// Ziele des Setup Passes
+#define DOF_SETUP_NEAR 0
+#define DOF_SETUP_FAR 1
+#define DOF_SETUP_DEPTH 2
+#define DOF_SETUP_COUNT 3
+
+// Ziele des Blur Passes
+#define DOF_BLUR_NEAR 0
+#define DOF_BLUR_FAR 1
+#define DOF_BLUR_COUNT 2
+
+////////////////////////////// LOKALE DATENTYPEN ///////////////////////////////
+
+// Datenstruktur mit den Zielen der Tiefenunschärfe.
+struct DepthOfField
+{
+    GLuint setupFbo;
+    GLuint blurFbo;
+
+    GLuint setupTextures[DOF_SETUP_COUNT];
+    GLuint blurTextures[DOF_BLUR_COUNT];
+
+    int width;
+    int height;
+};
+
+////////////////////////////// LOKALE FUNKTIONEN ///////////////////////////////
+
+/**
+ * Legt ein Ziel in halber Auflösung an.
+ *
+ * @param dof die Daten der Tiefenunschärfe
+ * @param internalFormat das Format der Textur
+ * @param filter der Filter beim Auslesen
+ * @param label das Label der Textur
+ * @return die neue Textur
+ */
+static GLuint dof_createTarget(DepthOfField* dof, GLint internalFormat,
+                               GLint filter, const char* label)
+{
+    GLuint texture;
+    glGenTextures(1, &texture);
+    glstate_bindTexture(GL_TEXTURE_2D, texture);
+    glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, dof->width, dof->height, 0,
+                 internalFormat == GL_R32F ? GL_RED : GL_RGBA, GL_FLOAT, NULL);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, filter);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, filter);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    common_labelObjectByType(GL_TEXTURE, texture, label);
+    return texture;
+}
+
+/**
+ * Legt einen Framebuffer mit mehreren Zielen an.
+ *
+ * @param textures die Ziele
+ * @param count die Anzahl der Ziele
+ * @param label das Label des Framebuffers
+ * @return der neue Framebuffer
+ */
+static GLuint dof_createFramebuffer(GLuint* textures, int count, const char* label)
+{
+    GLenum drawBuffers[DOF_SETUP_COUNT];
+
+    GLuint fbo;
+    glGenFramebuffers(1, &fbo);
+    glstate_bindFramebuffer(GL_FRAMEBUFFER, fbo);
+    for (int i = 0; i < count; i++)
+    {
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0 + i,
+                               GL_TEXTURE_2D, textures[i], 0);
+        drawBuffers[i] = GL_COLOR_ATTACHMENT0 + i;
+    }
+    glDrawBuffers(count, drawBuffers);
+
+    GLenum fboState = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+    if (fboState != GL_FRAMEBUFFER_COMPLETE)
+    {
+        fprintf(stderr, "Error: FBO \"%s\" not complete (0x%x).\n", label,
+                fboState);
+    }
+    common_labelObjectByType(GL_FRAMEBUFFER, fbo, label);
+
+    glstate_bindFramebuffer(GL_FRAMEBUFFER, 0);
+    return fbo;
+}
+
+/**
+ * Bindet einen Framebuffer und setzt Viewport und Uniforms für den genutzten
+ * Bereich.
+ *
+ * @param dof die Daten der Tiefenunschärfe
+ * @param fbo der Framebuffer
+ * @param renderRatio der genutzte Anteil (dynamische Auflösung)
+ * @param shader der Shader des Passes
+ */
+static void dof_bindTargets(DepthOfField* dof, GLuint fbo, vec2 renderRatio,
+                            Shader* shader)
+{
+    glstate_bindFramebuffer(GL_FRAMEBUFFER, fbo);
+
+    // Nur den genutzten Anteil rendern, angeschnittene Texel zählen mit.
+    glViewport(0, 0, (GLsizei)ceilf((float)dof->width * renderRatio[0]),
+               (GLsizei)ceilf((float)dof->height * renderRatio[1]));
+
+    vec2 targetSize = { (float)dof->width, (float)dof->height };
+    shader_setVec2(shader, "u_targetSize", &targetSize);
+    shader_setVec2(shader, "u_renderScale", (vec2*)renderRatio);
+}
+
+//////////////////////////// ÖFFENTLICHE FUNKTIONEN ////////////////////////////
+
+DepthOfField* dof_createDepthOfField(int width, int height)
+{
+    DepthOfField* dof = malloc(sizeof(DepthOfField));
+    memset(dof, 0, sizeof(DepthOfField));
+
+    dof->width = (width + 1) / 2;
+    dof->height = (height + 1) / 2;
+
+    // Die Farben brauchen HDR und einen Alphakanal für den Unschärfekreis.
+    // Die Tiefe wird beim Vergrößern einzeln gelesen und nicht gefiltert.
+    dof->setupTextures[DOF_SETUP_NEAR] = dof_createTarget(dof, GL_RGBA16F, GL_LINEAR, "DoF Setup Near");
+    dof->setupTextures[DOF_SETUP_FAR] = dof_createTarget(dof, GL_RGBA16F, GL_LINEAR, "DoF Setup Far");
+    dof->setupTextures[DOF_SETUP_DEPTH] = dof_createTarget(dof, GL_R32F, GL_NEAREST, "DoF Depth");
+    dof->blurTextures[DOF_BLUR_NEAR] = dof_createTarget(dof, GL_RGBA16F, GL_LINEAR, "DoF Blur Near");
+    dof->blurTextures[DOF_BLUR_FAR] = dof_createTarget(dof, GL_RGBA16F, GL_LINEAR, "DoF Blur Far");
+    glstate_bindTexture(GL_TEXTURE_2D, 0);
+
+    dof->setupFbo = dof_createFramebuffer(dof->setupTextures, DOF_SETUP_COUNT, "DoF Setup");
+    dof->blurFbo = dof_createFramebuffer(dof->blurTextures, DOF_BLUR_COUNT, "DoF Blur");
+
+    return dof;
+}
+
+void dof_bindForSetup(DepthOfField* dof, vec2 renderRatio, Shader* shader)
+{
+    dof_bindTargets(dof, dof->setupFbo, renderRatio, shader);
+}
+
+void dof_bindForBlur(DepthOfField* dof, vec2 renderRatio, Shader* shader)
+{
+    dof_bindTargets(dof, dof->blurFbo, renderRatio, shader);
+}
+
+void dof_bindSetupTextures(DepthOfField* dof, GLenum nearUnit, GLenum farUnit)
+{
+    glstate_activeTexture(nearUnit);
+    glstate_bindTexture(GL_TEXTURE_2D, dof->setupTextures[DOF_SETUP_NEAR]);
+    glstate_activeTexture(farUnit);
+    glstate_bindTexture(GL_TEXTURE_2D, dof->setupTextures[DOF_SETUP_FAR]);
+}
+
+void dof_bindBlurTextures(DepthOfField* dof, GLenum nearUnit, GLenum farUnit,
+                          GLenum depthUnit)
+{
+    glstate_activeTexture(nearUnit);
+    glstate_bindTexture(GL_TEXTURE_2D, dof->blurTextures[DOF_BLUR_NEAR]);
+    glstate_activeTexture(farUnit);
+    glstate_bindTexture(GL_TEXTURE_2D, dof->blurTextures[DOF_BLUR_FAR]);
+    glstate_activeTexture(depthUnit);
+    glstate_bindTexture(GL_TEXTURE_2D, dof->setupTextures[DOF_SETUP_DEPTH]);
+}
+
+void dof_deleteDepthOfField(DepthOfField* dof)
+{
+    if (!dof)
+    {
+        return;
+    }
+
+    glstate_deleteFramebuffers(1, &dof->setupFbo);
+    glstate_deleteFramebuffers(1, &dof->blurFbo);
+    glstate_deleteTextures(DOF_SETUP_COUNT, dof->setupTextures);
+    glstate_deleteTextures(DOF_BLUR_COUNT, dof->blurTextures);
+
+    free(dof);
+}
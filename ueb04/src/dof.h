@@ -0,0 +1,111 @@
+/**
+ * Modul für die Tiefenunschärfe (Depth of Field).
+ *
+ * Die Unschärfe wird in halber Auflösung berechnet, also mit einem Viertel
+ * der Pixel:
+ *
+ *  1. Setup: Der HDR Buffer wird auf halbe Auflösung verkleinert und dabei
+ *     nach dem Unschärfekreis (Circle of Confusion) in eine Ebene vor und
+ *     eine Ebene hinter der Fokusebene getrennt. Zusätzlich wird die lineare
+ *     Tiefe für das spätere Vergrößern abgelegt.
+ *  2. Blur: Beide Ebenen werden getrennt mit einem Gather-Filter
+ *     weichgezeichnet. Die vordere Ebene darf dabei über scharfe Bereiche
+ *     hinausbluten, die hintere nicht.
+ *  3. Composite: Ein Pass-Effekt der PostProcess Kette vergrößert beide
+ *     Ebenen tiefenabhängig (bilateral) und mischt sie mit dem scharfen Bild.
+ *
+ * Die Shader erhalten wie beim Bloom:
+ *
+ * uniform vec2 u_targetSize;   // Größe der Ziele in Texeln
+ * uniform vec2 u_renderScale;  // genutzter Anteil (dynamische Auflösung)
+ *
+ * Der Unschärfekreis wird in allen Pässen gleich aus der linearen Tiefe d
+ * berechnet: coc = clamp(aperture * (d - focus) / d, -1, 1). Negative Werte
+ * liegen vor, positive hinter der Fokusebene, 1 entspricht
+ * DOF_MAX_RADIUS Texeln in halber Auflösung.
+ *
+ * Copyright (C) 2023, FH Wedel
+ * Autor: Joshua-Scott Schöttke, Ilana Schmara
+ */
+
+#ifndef DOF_H
+#define DOF_H
+
+#include "common.h"
+#include "shader.h"
+
+////////////////////////////////// KONSTANTEN //////////////////////////////////
+
+// Größter Radius der Unschärfe in Texeln der halben Auflösung
+#define DOF_MAX_RADIUS 8.0f
+
+//////////////////////////// ÖFFENTLICHE DATENTYPEN ////////////////////////////
+
+// Datenstruktur mit den Zielen der Tiefenunschärfe.
+struct DepthOfField;
+typedef struct DepthOfField DepthOfField;
+
+//////////////////////////// ÖFFENTLICHE FUNKTIONEN ////////////////////////////
+
+/**
+ * Erzeugt die Ziele für einen HDR Buffer der angegebenen Größe. Alle Ziele
+ * haben die halbe Größe des HDR Buffers.
+ *
+ * @param width die Breite des HDR Buffers in Pixeln
+ * @param height die Höhe des HDR Buffers in Pixeln
+ * @return die neuen Daten
+ */
+DepthOfField* dof_createDepthOfField(int width, int height);
+
+/**
+ * Bindet die Ziele des Setup Passes (vordere Ebene, hintere Ebene, Tiefe),
+ * setzt den Viewport auf den genutzten Bereich und übergibt u_targetSize und
+ * u_renderScale an den Shader.
+ * Der Shader MUSS zuvor bereits aktiviert worden sein.
+ *
+ * @param dof die Daten der Tiefenunschärfe
+ * @param renderRatio der genutzte Anteil (dynamische Auflösung)
+ * @param shader der Shader des Passes
+ */
+void dof_bindForSetup(DepthOfField* dof, vec2 renderRatio, Shader* shader);
+
+/**
+ * Bindet die Ziele des Blur Passes (vordere und hintere Ebene) wie
+ * dof_bindForSetup.
+ * Der Shader MUSS zuvor bereits aktiviert worden sein.
+ *
+ * @param dof die Daten der Tiefenunschärfe
+ * @param renderRatio der genutzte Anteil (dynamische Auflösung)
+ * @param shader der Shader des Passes
+ */
+void dof_bindForBlur(DepthOfField* dof, vec2 renderRatio, Shader* shader);
+
+/**
+ * Bindet die Ergebnisse des Setup Passes an die angegebenen Textureinheiten.
+ *
+ * @param dof die Daten der Tiefenunschärfe
+ * @param nearUnit die Einheit für die vordere Ebene (GL_TEXTURE0 + i)
+ * @param farUnit die Einheit für die hintere Ebene (GL_TEXTURE0 + i)
+ */
+void dof_bindSetupTextures(DepthOfField* dof, GLenum nearUnit, GLenum farUnit);
+
+/**
+ * Bindet die weichgezeichneten Ebenen und die Tiefe in halber Auflösung an
+ * die angegebenen Textureinheiten.
+ *
+ * @param dof die Daten der Tiefenunschärfe
+ * @param nearUnit die Einheit für die vordere Ebene (GL_TEXTURE0 + i)
+ * @param farUnit die Einheit für die hintere Ebene (GL_TEXTURE0 + i)
+ * @param depthUnit die Einheit für die Tiefe (GL_TEXTURE0 + i)
+ */
+void dof_bindBlurTextures(DepthOfField* dof, GLenum nearUnit, GLenum farUnit,
+                          GLenum depthUnit);
+
+/**
+ * Löscht die Daten der Tiefenunschärfe.
+ *
+ * @param dof die zu löschenden Daten
+ */
+void dof_deleteDepthOfField(DepthOfField* dof);
+
+#endif // DOF_H
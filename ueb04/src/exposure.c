@@ -0,0 +1,188 @@
+/**
+ * Modul für die automatische Belichtung.
+ *
+ * Copyright (C) 2023, FH Wedel
+ * Autor: Joshua-Scott Schöttke, Ilana Schmara
+ */
+
+#include "exposure.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include "glstate.h"
+
+////////////////////////////// LOKALE DATENTYPEN ///////////////////////////////
+
+// Datenstruktur mit dem Histogramm und den Ergebnissen.
+struct AutoExposure
+{
+    GLuint histogramFbo;
+    GLuint histogram;
+
+    // Die Ergebnisse wechseln sich jedes Frame ab.
+    GLuint resultFbos[2];
+    GLuint results[2];
+    int current;
+
+    // Leeres VAO für die Punkte des Histogramms
+    GLuint vao;
+};
+
+////////////////////////////// LOKALE FUNKTIONEN ///////////////////////////////
+
+/**
+ * Legt ein einkanaliges Float Ziel samt Framebuffer an.
+ *
+ * @param width die Breite in Texeln
+ * @param texture erhält die neue Textur
+ * @param fbo erhält den neuen Framebuffer
+ * @param label das Label von Textur und Framebuffer
+ */
+static void exposure_createTarget(int width, GLuint* texture, GLuint* fbo,
+                                  const char* label)
+{
+    glGenTextures(1, texture);
+    glstate_bindTexture(GL_TEXTURE_2D, *texture);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_R32F, width, 1, 0, GL_RED, GL_FLOAT, NULL);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    common_labelObjectByType(GL_TEXTURE, *texture, label);
+    glstate_bindTexture(GL_TEXTURE_2D, 0);
+
+    glGenFramebuffers(1, fbo);
+    glstate_bindFramebuffer(GL_FRAMEBUFFER, *fbo);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D,
+                           *texture, 0);
+
+    GLenum fboState = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+    if (fboState != GL_FRAMEBUFFER_COMPLETE)
+    {
+        fprintf(stderr, "Error: FBO \"%s\" not complete (0x%x).\n", label,
+                fboState);
+    }
+    common_labelObjectByType(GL_FRAMEBUFFER, *fbo, label);
+
+    glstate_bindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+/**
+ * Übergibt den erfassten Helligkeitsbereich an einen Shader.
+ *
+ * @param shader der Shader
+ */
+static void exposure_setRangeUniforms(Shader* shader)
+{
+    shader_setFloat(shader, "u_minLogLum", EXPOSURE_MIN_LOG_LUM);
+    shader_setFloat(shader, "u_logLumRange", EXPOSURE_MAX_LOG_LUM - EXPOSURE_MIN_LOG_LUM);
+}
+
+//////////////////////////// ÖFFENTLICHE FUNKTIONEN ////////////////////////////
+
+AutoExposure* exposure_createAutoExposure(void)
+{
+    AutoExposure* exposure = malloc(sizeof(AutoExposure));
+    memset(exposure, 0, sizeof(AutoExposure));
+
+    exposure_createTarget(EXPOSURE_HISTOGRAM_BINS, &exposure->histogram,
+                          &exposure->histogramFbo, "Exposure Histogram");
+    exposure_createTarget(1, &exposure->results[0], &exposure->resultFbos[0],
+                          "Exposure Result");
+    exposure_createTarget(1, &exposure->results[1], &exposure->resultFbos[1],
+                          "Exposure Result");
+
+    // Die Punkte werden im Vertex Shader aus gl_VertexID erzeugt, im Core
+    // Profile muss trotzdem ein VAO gebunden sein.
+    glGenVertexArrays(1, &exposure->vao);
+
+    exposure_reset(exposure);
+    return exposure;
+}
+
+void exposure_renderHistogram(AutoExposure* exposure, Shader* shader,
+                              int renderWidth, int renderHeight)
+{
+    int sampleCount[2] = {
+        (renderWidth + EXPOSURE_SAMPLE_STEP - 1) / EXPOSURE_SAMPLE_STEP,
+        (renderHeight + EXPOSURE_SAMPLE_STEP - 1) / EXPOSURE_SAMPLE_STEP
+    };
+
+    shader_setInt(shader, "u_sampleStep", EXPOSURE_SAMPLE_STEP);
+    shader_setInt(shader, "u_sampleCountX", sampleCount[0]);
+    shader_setInt(shader, "u_binCount", EXPOSURE_HISTOGRAM_BINS);
+    exposure_setRangeUniforms(shader);
+
+    glstate_bindFramebuffer(GL_FRAMEBUFFER, exposure->histogramFbo);
+    glViewport(0, 0, EXPOSURE_HISTOGRAM_BINS, 1);
+
+    float zero[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+    glClearBufferfv(GL_COLOR, 0, zero);
+
+    // Jeder Punkt erhöht sein Fach um eins.
+    glstate_enable(GL_BLEND);
+    glstate_blendEquation(GL_FUNC_ADD);
+    glstate_blendFunc(GL_ONE, GL_ONE);
+
+    glstate_bindVertexArray(exposure->vao);
+    glDrawArrays(GL_POINTS, 0, sampleCount[0] * sampleCount[1]);
+    glstate_bindVertexArray(0);
+
+    glstate_disable(GL_BLEND);
+    glstate_bindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+void exposure_bindForAverage(AutoExposure* exposure, Shader* shader,
+                             int histogramUnit, int previousUnit)
+{
+    int previous = exposure->current;
+    exposure->current = 1 - exposure->current;
+
+    glstate_activeTexture(GL_TEXTURE0 + histogramUnit);
+    glstate_bindTexture(GL_TEXTURE_2D, exposure->histogram);
+    glstate_activeTexture(GL_TEXTURE0 + previousUnit);
+    glstate_bindTexture(GL_TEXTURE_2D, exposure->results[previous]);
+
+    shader_setInt(shader, "u_histogram", histogramUnit);
+    shader_setInt(shader, "u_previous", previousUnit);
+    shader_setInt(shader, "u_binCount", EXPOSURE_HISTOGRAM_BINS);
+    exposure_setRangeUniforms(shader);
+
+    glstate_bindFramebuffer(GL_FRAMEBUFFER, exposure->resultFbos[exposure->current]);
+    glViewport(0, 0, 1, 1);
+}
+
+void exposure_bindResult(AutoExposure* exposure, GLenum textureUnit)
+{
+    glstate_activeTexture(textureUnit);
+    glstate_bindTexture(GL_TEXTURE_2D, exposure->results[exposure->current]);
+}
+
+void exposure_reset(AutoExposure* exposure)
+{
+    // Eine Helligkeit von 0 markiert ein Ergebnis ohne Verlauf.
+    float zero[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+    for (int i = 0; i < 2; i++)
+    {
+        glstate_bindFramebuffer(GL_FRAMEBUFFER, exposure->resultFbos[i]);
+        glClearBufferfv(GL_COLOR, 0, zero);
+    }
+    glstate_bindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+void exposure_deleteAutoExposure(AutoExposure* exposure)
+{
+    if (!exposure)
+    {
+        return;
+    }
+
+    glstate_deleteFramebuffers(1, &exposure->histogramFbo);
+    glstate_deleteFramebuffers(2, exposure->resultFbos);
+    glstate_deleteTextures(1, &exposure->histogram);
+    glstate_deleteTextures(2, exposure->results);
+    glstate_deleteVertexArrays(1, &exposure->vao);
+
+    free(exposure);
+}
@@ -0,0 +1,113 @@
+/**
+ * Modul für die automatische Belichtung.
+ *
+ * Die mittlere Helligkeit des HDR Buffers wird vollständig auf der GPU
+ * bestimmt, so dass nie auf das Ergebnis gewartet werden muss:
+ *
+ *  1. Histogramm: Für jeden EXPOSURE_SAMPLE_STEP-ten Pixel in beide
+ *     Richtungen wird ein Punkt gezeichnet. Der Vertex Shader liest die
+ *     Helligkeit und legt den Punkt auf das passende Fach eines
+ *     EXPOSURE_HISTOGRAM_BINS x 1 großen Ziels, das per additivem Blending
+ *     die Punkte zählt.
+ *  2. Mittelwert: Ein Pass in ein 1x1 großes Ziel bildet den gewichteten
+ *     Mittelwert der logarithmischen Helligkeit und gleicht ihn zeitlich
+ *     mit dem Ergebnis des letzten Frames ab. Dafür gibt es zwei Ziele, die
+ *     sich jedes Frame abwechseln.
+ *
+ * Das Ergebnis wird im PostProcess direkt aus der Textur gelesen.
+ *
+ * Die Shader erhalten:
+ *
+ * uniform float u_minLogLum;    // kleinste erfasste log2 Helligkeit
+ * uniform float u_logLumRange;  // Umfang der erfassten log2 Helligkeit
+ *
+ * Das Fach 0 zählt schwarze Pixel und geht nicht in den Mittelwert ein.
+ *
+ * Copyright (C) 2023, FH Wedel
+ * Autor: Joshua-Scott Schöttke, Ilana Schmara
+ */
+
+#ifndef EXPOSURE_H
+#define EXPOSURE_H
+
+#include "common.h"
+#include "shader.h"
+
+////////////////////////////////// KONSTANTEN //////////////////////////////////
+
+// Anzahl der Fächer des Histogramms
+#define EXPOSURE_HISTOGRAM_BINS 256
+
+// Abstand der ausgewerteten Pixel in beide Richtungen
+#define EXPOSURE_SAMPLE_STEP 4
+
+// Erfasster Bereich der Helligkeit als log2
+#define EXPOSURE_MIN_LOG_LUM (-10.0f)
+#define EXPOSURE_MAX_LOG_LUM 6.0f
+
+//////////////////////////// ÖFFENTLICHE DATENTYPEN ////////////////////////////
+
+// Datenstruktur mit dem Histogramm und den Ergebnissen.
+struct AutoExposure;
+typedef struct AutoExposure AutoExposure;
+
+//////////////////////////// ÖFFENTLICHE FUNKTIONEN ////////////////////////////
+
+/**
+ * Erzeugt die Ziele für die automatische Belichtung.
+ *
+ * @return die neuen Daten
+ */
+AutoExposure* exposure_createAutoExposure(void);
+
+/**
+ * Zeichnet das Histogramm des gerenderten Bereichs. Der Shader MUSS zuvor
+ * bereits aktiviert und u_source gesetzt worden sein.
+ *
+ * @param exposure die Daten der automatischen Belichtung
+ * @param shader der Histogramm Shader
+ * @param renderWidth die Breite des gerenderten Bereichs in Pixeln
+ * @param renderHeight die Höhe des gerenderten Bereichs in Pixeln
+ */
+void exposure_renderHistogram(AutoExposure* exposure, Shader* shader,
+                              int renderWidth, int renderHeight);
+
+/**
+ * Wechselt das Ziel, bindet es mit einem 1x1 Viewport und bindet das
+ * Histogramm sowie das Ergebnis des letzten Frames an die angegebenen
+ * Textureinheiten (u_histogram, u_previous).
+ * Der Shader MUSS zuvor bereits aktiviert worden sein.
+ *
+ * @param exposure die Daten der automatischen Belichtung
+ * @param shader der Shader für den Mittelwert
+ * @param histogramUnit die Einheit für das Histogramm
+ * @param previousUnit die Einheit für das letzte Ergebnis
+ */
+void exposure_bindForAverage(AutoExposure* exposure, Shader* shader,
+                             int histogramUnit, int previousUnit);
+
+/**
+ * Bindet die zuletzt berechnete mittlere Helligkeit an die angegebene
+ * Textureinheit.
+ *
+ * @param exposure die Daten der automatischen Belichtung
+ * @param textureUnit die Textureinheit (GL_TEXTURE0 + i)
+ */
+void exposure_bindResult(AutoExposure* exposure, GLenum textureUnit);
+
+/**
+ * Verwirft den zeitlichen Verlauf, so dass sich die Belichtung im nächsten
+ * Frame sofort einstellt.
+ *
+ * @param exposure die Daten der automatischen Belichtung
+ */
+void exposure_reset(AutoExposure* exposure);
+
+/**
+ * Löscht die Daten der automatischen Belichtung.
+ *
+ * @param exposure die zu löschenden Daten
+ */
+void exposure_deleteAutoExposure(AutoExposure* exposure);
+
+#endif // EXPOSURE_H
@@ -0,0 +1,268 @@
+/**
+ * Modul zum Überwachen eines Verzeichnisses auf geänderte Dateien.
+ *
+ * Copyright (C) 2023, FH Wedel
+ * Autor: Joshua-Scott Schöttke, Ilana Schmara
+ */
+
+#include "filewatch.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef __linux__
+    #include <dirent.h>
+    #include <errno.h>
+    #include <unistd.h>
+    #include <sys/inotify.h>
+    #include <sys/stat.h>
+    #include <sesp/stb_ds.h>
+#endif
+
+#ifdef __linux__
+
+////////////////////////////////// KONSTANTEN //////////////////////////////////
+
+// Ereignisse, die eine fertig geschriebene Datei oder ein neues
+// Verzeichnis melden
+#define FILEWATCH_EVENTS (IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE)
+
+// Größe des Puffers für die Ereignisse eines Aufrufs
+#define FILEWATCH_BUFFER_SIZE 4096
+
+////////////////////////////// LOKALE DATENTYPEN ///////////////////////////////
+
+// Ein überwachtes Verzeichnis.
+typedef struct
+{
+    int wd;
+    char* path;
+} FileWatchDirectory;
+
+// Datenstruktur einer Überwachung.
+struct FileWatcher
+{
+    int fd;
+
+    // Dynamisches Array (stb_ds) aller überwachten Verzeichnisse
+    FileWatchDirectory* directories;
+};
+
+////////////////////////////// LOKALE FUNKTIONEN ///////////////////////////////
+
+/**
+ * Setzt einen Pfad aus Verzeichnis und Name zusammen.
+ *
+ * @param directory das Verzeichnis mit abschließendem '/'
+ * @param name der Name darin
+ * @param suffix wird angehängt, z.B. "/" für Verzeichnisse
+ * @return der neue Pfad, muss mit free freigegeben werden
+ */
+static char* filewatch_joinPath(const char* directory, const char* name,
+                                const char* suffix)
+{
+    size_t length = strlen(directory) + strlen(name) + strlen(suffix) + 1;
+    char* path = malloc(length);
+    snprintf(path, length, "%s%s%s", directory, name, suffix);
+    return path;
+}
+
+/**
+ * Überwacht ein Verzeichnis und rekursiv alle Unterverzeichnisse.
+ *
+ * @param watcher die Überwachung
+ * @param directory der Pfad des Verzeichnisses mit abschließendem '/'
+ */
+static void filewatch_addDirectory(FileWatcher* watcher, const char* directory)
+{
+    int wd = inotify_add_watch(watcher->fd, directory, FILEWATCH_EVENTS);
+    if (wd < 0)
+    {
+        fprintf(stderr, "Warning: Cannot watch \"%s\" (%s).\n", directory,
+                strerror(errno));
+        return;
+    }
+
+    FileWatchDirectory entry = { wd, filewatch_joinPath(directory, "", "") };
+    stbds_arrput(watcher->directories, entry);
+
+    // inotify meldet nur Änderungen direkt im Verzeichnis.
+    DIR* dir = opendir(directory);
+    if (dir == NULL)
+    {
+        return;
+    }
+
+    struct dirent* child;
+    while ((child = readdir(dir)) != NULL)
+    {
+        if (child->d_name[0] == '.')
+        {
+            continue;
+        }
+
+        char* path = filewatch_joinPath(directory, child->d_name, "/");
+        struct stat info;
+        if (stat(path, &info) == 0 && S_ISDIR(info.st_mode))
+        {
+            filewatch_addDirectory(watcher, path);
+        }
+        free(path);
+    }
+    closedir(dir);
+}
+
+/**
+ * Sucht das Verzeichnis zu einer Überwachung.
+ *
+ * @param watcher die Überwachung
+ * @param wd die Kennung aus dem Ereignis
+ * @return der Pfad des Verzeichnisses oder NULL
+ */
+static const char* filewatch_findDirectory(FileWatcher* watcher, int wd)
+{
+    for (ptrdiff_t i = 0; i < stbds_arrlen(watcher->directories); i++)
+    {
+        if (watcher->directories[i].wd == wd)
+        {
+            return watcher->directories[i].path;
+        }
+    }
+
+    return NULL;
+}
+
+//////////////////////////// ÖFFENTLICHE FUNKTIONEN ////////////////////////////
+
+FileWatcher* filewatch_createWatcher(const char* directory)
+{
+    int fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (fd < 0)
+    {
+        fprintf(stderr, "Warning: inotify not available (%s).\n", strerror(errno));
+        return NULL;
+    }
+
+    FileWatcher* watcher = malloc(sizeof(FileWatcher));
+    watcher->fd = fd;
+    watcher->directories = NULL;
+    filewatch_addDirectory(watcher, directory);
+
+    return watcher;
+}
+
+int filewatch_poll(FileWatcher* watcher, FileWatchFunc callback, void* userData)
+{
+    if (watcher == NULL)
+    {
+        return 0;
+    }
+
+    // Beim Speichern entstehen oft mehrere Ereignisse für dieselbe Datei,
+    // daher werden erst alle gesammelt.
+    char** changed = NULL;
+
+    char buffer[FILEWATCH_BUFFER_SIZE]
+        __attribute__((aligned(__alignof__(struct inotify_event))));
+    ssize_t length;
+    while ((length = read(watcher->fd, buffer, sizeof(buffer))) > 0)
+    {
+        for (char* ptr = buffer; ptr < buffer + length;
+             ptr += sizeof(struct inotify_event) + ((struct inotify_event*)ptr)->len)
+        {
+            const struct inotify_event* event = (const struct inotify_event*)ptr;
+            const char* directory = filewatch_findDirectory(watcher, event->wd);
+            if (directory == NULL || event->len == 0)
+            {
+                continue;
+            }
+
+            // Neue Unterverzeichnisse ebenfalls überwachen.
+            if (event->mask & IN_ISDIR)
+            {
+                if (event->mask & (IN_CREATE | IN_MOVED_TO))
+                {
+                    char* path = filewatch_joinPath(directory, event->name, "/");
+                    filewatch_addDirectory(watcher, path);
+                    free(path);
+                }
+                continue;
+            }
+
+            // Eine neu angelegte Datei ist erst nach dem Schreiben fertig.
+            if (!(event->mask & (IN_CLOSE_WRITE | IN_MOVED_TO)))
+            {
+                continue;
+            }
+
+            char* path = filewatch_joinPath(directory, event->name, "");
+            bool known = false;
+            for (ptrdiff_t i = 0; i < stbds_arrlen(changed) && !known; i++)
+            {
+                known = strcmp(changed[i], path) == 0;
+            }
+
+            if (known)
+            {
+                free(path);
+            }
+            else
+            {
+                stbds_arrput(changed, path);
+            }
+        }
+    }
+
+    int count = (int)stbds_arrlen(changed);
+    for (int i = 0; i < count; i++)
+    {
+        callback(changed[i], userData);
+        free(changed[i]);
+    }
+    stbds_arrfree(changed);
+
+    return count;
+}
+
+void filewatch_deleteWatcher(FileWatcher* watcher)
+{
+    if (watcher == NULL)
+    {
+        return;
+    }
+
+    for (ptrdiff_t i = 0; i < stbds_arrlen(watcher->directories); i++)
+    {
+        free(watcher->directories[i].path);
+    }
+    stbds_arrfree(watcher->directories);
+
+    close(watcher->fd);
+    free(watcher);
+}
+
+#else
+
+//////////////////////////// ÖFFENTLICHE FUNKTIONEN ////////////////////////////
+
+FileWatcher* filewatch_createWatcher(const char* directory)
+{
+    (void)directory;
+    return NULL;
+}
+
+int filewatch_poll(FileWatcher* watcher, FileWatchFunc callback, void* userData)
+{
+    (void)watcher;
+    (void)callback;
+    (void)userData;
+    return 0;
+}
+
+void filewatch_deleteWatcher(FileWatcher* watcher)
+{
+    (void)watcher;
+}
+
+#endif
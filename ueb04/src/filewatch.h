@@ -0,0 +1,58 @@
+/**
+ * Modul zum Überwachen eines Verzeichnisses auf geänderte Dateien.
+ *
+ * Unter Linux wird inotify genutzt, inklusive aller Unterverzeichnisse.
+ * Gemeldet werden Dateien, die nach dem Schreiben geschlossen oder in das
+ * Verzeichnis verschoben wurden, so wie Editoren beim Speichern vorgehen.
+ * Auf anderen Systemen wird nichts überwacht, alle Funktionen akzeptieren
+ * dann NULL als Überwachung.
+ *
+ * Copyright (C) 2023, FH Wedel
+ * Autor: Joshua-Scott Schöttke, Ilana Schmara
+ */
+
+#ifndef FILEWATCH_H
+#define FILEWATCH_H
+
+#include <stdbool.h>
+
+//////////////////////////// ÖFFENTLICHE DATENTYPEN ////////////////////////////
+
+// Wird für jede geänderte Datei aufgerufen.
+typedef void (*FileWatchFunc)(const char* file, void* userData);
+
+// Datenstruktur einer Überwachung.
+struct FileWatcher;
+typedef struct FileWatcher FileWatcher;
+
+//////////////////////////// ÖFFENTLICHE FUNKTIONEN ////////////////////////////
+
+/**
+ * Beginnt die Überwachung eines Verzeichnisses samt Unterverzeichnissen.
+ *
+ * @param directory der Pfad des Verzeichnisses mit abschließendem '/'
+ * @return die Überwachung oder NULL, wenn sie nicht möglich ist
+ */
+FileWatcher* filewatch_createWatcher(const char* directory);
+
+/**
+ * Ruft für jede seit dem letzten Aufruf geänderte Datei die Funktion auf,
+ * jede Datei höchstens einmal. Wartet nie auf neue Ereignisse.
+ * Die Pfade setzen sich aus dem überwachten Verzeichnis und dem Pfad
+ * darunter zusammen, z.B. "./res/shader/model/model.frag".
+ *
+ * @param watcher die Überwachung oder NULL
+ * @param callback die aufzurufende Funktion
+ * @param userData wird an callback durchgereicht
+ * @return die Anzahl der geänderten Dateien
+ */
+int filewatch_poll(FileWatcher* watcher, FileWatchFunc callback, void* userData);
+
+/**
+ * Beendet eine Überwachung.
+ *
+ * @param watcher die Überwachung oder NULL
+ */
+void filewatch_deleteWatcher(FileWatcher* watcher);
+
+#endif // FILEWATCH_H
@@ -0,0 +1,106 @@
+/**
+ * Modul für die Daten der Kamera, die alle Shader eines Frames teilen.
+ *
+ * Copyright (C) 2023, FH Wedel
+ * Autor: Joshua-Scott Schöttke, Ilana Schmara
+ */
+
+#include "framedata.h"
+
+#include <string.h>
+
+#include "shader.h"
+
+////////////////////////////// LOKALE DATENTYPEN ///////////////////////////////
+
+// Inhalt des Blocks im Layout std140. Nach dem vec3 füllt ein float die
+// 16 Byte auf, die beiden vec2 teilen sich danach wieder 16 Byte.
+typedef struct
+{
+    mat4 viewMatrix;
+    mat4 projectionMatrix;
+    mat4 viewProjectionMatrix;
+    mat4 inverseViewMatrix;
+    mat4 inverseProjectionMatrix;
+    mat4 screenToWorld;
+    vec3 viewPos;
+    float padding;
+    vec2 screenSize;
+    vec2 renderSize;
+} FrameDataBlock;
+
+// Datenstruktur mit dem Uniform Buffer.
+struct FrameData
+{
+    GLuint buffer;
+    FrameDataBlock block;
+};
+
+//////////////////////////// ÖFFENTLICHE FUNKTIONEN ////////////////////////////
+
+FrameData* framedata_createFrameData(void)
+{
+    FrameData* frame = malloc(sizeof(FrameData));
+    memset(frame, 0, sizeof(FrameData));
+
+    glGenBuffers(1, &frame->buffer);
+    glBindBuffer(GL_UNIFORM_BUFFER, frame->buffer);
+    glBufferData(GL_UNIFORM_BUFFER, sizeof(FrameDataBlock), &frame->block, GL_DYNAMIC_DRAW);
+    common_labelObjectByType(GL_BUFFER, frame->buffer, "Frame Data");
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+
+    glBindBufferBase(GL_UNIFORM_BUFFER, FRAMEDATA_BINDING, frame->buffer);
+    shader_registerUniformBlock(FRAMEDATA_BLOCK_NAME, FRAMEDATA_BINDING);
+
+    return frame;
+}
+
+void framedata_update(FrameData* frame, mat4* projectionMatrix, mat4* viewMatrix,
+                      vec3 viewPos, vec2 screenSize, vec2 renderSize)
+{
+    FrameDataBlock* block = &frame->block;
+
+    glm_mat4_copy(*viewMatrix, block->viewMatrix);
+    glm_mat4_copy(*projectionMatrix, block->projectionMatrix);
+    glm_mat4_mul(*projectionMatrix, *viewMatrix, block->viewProjectionMatrix);
+    glm_mat4_inv(*viewMatrix, block->inverseViewMatrix);
+    glm_mat4_inv(*projectionMatrix, block->inverseProjectionMatrix);
+
+    // Texturkoordinate und Tiefe aus [0, 1] in NDC umrechnen. Bei
+    // dynamischer Auflösung wird nur ein Teil des GBuffers beschrieben.
+    mat4 textureToNdc = GLM_MAT4_IDENTITY_INIT;
+    textureToNdc[0][0] = 2.0f * screenSize[0] / renderSize[0];
+    textureToNdc[1][1] = 2.0f * screenSize[1] / renderSize[1];
+    textureToNdc[2][2] = 2.0f;
+    textureToNdc[3][0] = -1.0f;
+    textureToNdc[3][1] = -1.0f;
+    textureToNdc[3][2] = -1.0f;
+
+    mat4 inverseViewProjection;
+    glm_mat4_inv(block->viewProjectionMatrix, inverseViewProjection);
+    glm_mat4_mul(inverseViewProjection, textureToNdc, block->screenToWorld);
+
+    glm_vec3_copy(viewPos, block->viewPos);
+    memcpy(block->screenSize, screenSize, sizeof(vec2));
+    memcpy(block->renderSize, renderSize, sizeof(vec2));
+
+    // Der ganze Buffer wird neu angelegt, damit der Treiber nicht auf
+    // Zeichenaufrufe des letzten Frames warten muss.
+    glBindBuffer(GL_UNIFORM_BUFFER, frame->buffer);
+    glBufferData(GL_UNIFORM_BUFFER, sizeof(FrameDataBlock), block, GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+
+    // Andere Module könnten den Binding Point belegt haben.
+    glBindBufferBase(GL_UNIFORM_BUFFER, FRAMEDATA_BINDING, frame->buffer);
+}
+
+void framedata_deleteFrameData(FrameData* frame)
+{
+    if (!frame)
+    {
+        return;
+    }
+
+    glDeleteBuffers(1, &frame->buffer);
+    free(frame);
+}
@@ -0,0 +1,79 @@
+/**
+ * Modul für die Daten der Kamera, die alle Shader eines Frames teilen.
+ *
+ * Die Daten liegen in einem Uniform Buffer (std140), der einmal pro Frame
+ * hochgeladen und an FRAMEDATA_BINDING gebunden wird. Der Block wird beim
+ * Anlegen über shader_registerUniformBlock angemeldet, die Shader müssen
+ * danach gebaut werden. Jeder Shader, der die Daten braucht, enthält:
+ *
+ * layout (std140) uniform FrameData
+ * {
+ *     mat4 u_viewMatrix;
+ *     mat4 u_projectionMatrix;
+ *     mat4 u_viewProjectionMatrix;
+ *     mat4 u_inverseViewMatrix;
+ *     mat4 u_inverseProjectionMatrix;
+ *     mat4 u_screenToWorld;    // (Texturkoordinate, Tiefe) -> World-Space
+ *     vec3 u_viewPos;          // Position der Kamera
+ *     vec2 u_screenSize;       // Größe des GBuffers
+ *     vec2 u_renderSize;       // Größe des gerenderten Bereichs
+ * };
+ *
+ * Der Block hat keinen Instanznamen, die Namen entsprechen den früheren
+ * einzelnen Uniforms. Die Model Matrix bleibt ein Uniform je Objekt.
+ *
+ * Copyright (C) 2023, FH Wedel
+ * Autor: Joshua-Scott Schöttke, Ilana Schmara
+ */
+
+#ifndef FRAMEDATA_H
+#define FRAMEDATA_H
+
+#include "common.h"
+
+////////////////////////////////// KONSTANTEN //////////////////////////////////
+
+// Name des Blocks in den Shadern
+#define FRAMEDATA_BLOCK_NAME "FrameData"
+
+// Binding Point des Uniform Buffers
+#define FRAMEDATA_BINDING 0
+
+//////////////////////////// ÖFFENTLICHE DATENTYPEN ////////////////////////////
+
+// Datenstruktur mit dem Uniform Buffer.
+struct FrameData;
+typedef struct FrameData FrameData;
+
+//////////////////////////// ÖFFENTLICHE FUNKTIONEN ////////////////////////////
+
+/**
+ * Legt den Uniform Buffer an, bindet ihn an FRAMEDATA_BINDING und meldet
+ * den Block bei den Shadern an.
+ *
+ * @return die neuen Daten
+ */
+FrameData* framedata_createFrameData(void);
+
+/**
+ * Berechnet alle abgeleiteten Matrizen und lädt die Daten hoch.
+ * Muss einmal pro Frame vor dem ersten Pass aufgerufen werden.
+ *
+ * @param frame die Daten des Frames
+ * @param projectionMatrix die Projektions Matrix der Kamera
+ * @param viewMatrix die View Matrix der Kamera
+ * @param viewPos die Position der Kamera
+ * @param screenSize die Größe des GBuffers in Pixeln
+ * @param renderSize die Größe des gerenderten Bereichs in Pixeln
+ */
+void framedata_update(FrameData* frame, mat4* projectionMatrix, mat4* viewMatrix,
+                      vec3 viewPos, vec2 screenSize, vec2 renderSize);
+
+/**
+ * Löscht den Uniform Buffer.
+ *
+ * @param frame die zu löschenden Daten
+ */
+void framedata_deleteFrameData(FrameData* frame);
+
+#endif // FRAMEDATA_H
@@ -9,6 +9,8 @@
 
 #include <string.h>
 
+#include "glstate.h"
+
 ////////////////////////////// LOKALE DATENTYPEN ///////////////////////////////
 
 // GBuffer Datentyp.
@@ -17,33 +19,110 @@ struct GBuffer
     // Frame-Buffer-Object => FBO
     GLuint fbo;
     GLuint textures[GBUFFER_NUM_COLORATTACH];
-    GLuint rboDepth;
+    GLuint depthTexture;
+    GBufferLayout layout;
+    int width;
+    int height;
+};
+
+// GBuffer Pool Datentyp.
+struct GBufferPool
+{
+    GBuffer* gbuffer;
+    int allocations;
+
+    // Zuletzt angefragte Größe und Zeitpunkt ihrer letzten Änderung.
+    int requestedWidth;
+    int requestedHeight;
+    double lastChange;
 };
 
+////////////////////////////// LOKALE FUNKTIONEN ///////////////////////////////
+
+/**
+ * Liefert das Format eines Color Attachments für den angegebenen Aufbau.
+ *
+ * @param layout der Aufbau des GBuffers
+ * @param attachment das Color Attachment
+ * @param internalFormat Rückgabe des internen Formats
+ * @param format Rückgabe des Formats der Pixeldaten
+ * @return false, wenn das Attachment in diesem Aufbau nicht verwendet wird
+ */
+static bool gbuffer_getFormat(GBufferLayout layout, GBUFFER_TEXTURE_TYPE attachment,
+                              GLint* internalFormat, GLenum* format)
+{
+    if (layout == GBUFFER_LAYOUT_COMPACT)
+    {
+        switch (attachment)
+        {
+        case GBUFFER_COLORATTACH_NORMAL:
+            *internalFormat = GL_RG16;
+            *format = GL_RG;
+            return true;
+        case GBUFFER_COLORATTACH_ALBEDOSPEC:
+            *internalFormat = GL_RGBA8;
+            *format = GL_RGBA;
+            return true;
+        case GBUFFER_COLORATTACH_EMISSION:
+            *internalFormat = GL_R11F_G11F_B10F;
+            *format = GL_RGB;
+            return true;
+        default:
+            // Position und Texturkoordinaten werden nicht gespeichert.
+            return false;
+        }
+    }
+
+    //if texture id is ALBEDOSPEC using RGBA
+    *internalFormat = (attachment == GBUFFER_COLORATTACH_ALBEDOSPEC) ? GL_RGBA32F : GL_RGB32F;
+    *format = (attachment == GBUFFER_COLORATTACH_ALBEDOSPEC) ? GL_RGBA : GL_RGB;
+    return true;
+}
+
+/**
+ * Rundet eine Kantenlänge auf die nächste Größenstufe des Pools auf.
+ *
+ * @param size die Kantenlänge in Pixeln
+ * @return die aufgerundete Kantenlänge, mindestens eine Stufe
+ */
+static int gbuffer_roundToBucket(int size)
+{
+    int buckets = (size + GBUFFER_POOL_BUCKET - 1) / GBUFFER_POOL_BUCKET;
+    return (buckets > 0 ? buckets : 1) * GBUFFER_POOL_BUCKET;
+}
+
 //////////////////////////// ÖFFENTLICHE FUNKTIONEN ////////////////////////////
 
-GBuffer* gbuffer_createGBuffer(int width, int height)
+GBuffer* gbuffer_createGBuffer(int width, int height, GBufferLayout layout)
 {
     // Wie immer muss zuerst der Speicher für den GBuffer angefordert werden.
     GBuffer* gbuffer = malloc(sizeof(GBuffer));
     memset(gbuffer, 0, sizeof(GBuffer));
+    gbuffer->layout = layout;
+    gbuffer->width = width;
+    gbuffer->height = height;
 
     // Dann erstellen wir unser FBO (Framebuffer Object) und binden es direkt.
     glGenFramebuffers(1, &gbuffer->fbo);
-    glBindFramebuffer(GL_FRAMEBUFFER, gbuffer->fbo);
+    glstate_bindFramebuffer(GL_FRAMEBUFFER, gbuffer->fbo);
 
     //Exposure Tone Mapping
 
-    // Texturen anlegen
-    glGenTextures(sizeof(gbuffer->textures) / sizeof(gbuffer->textures[0]), gbuffer->textures);
-
     glGenTextures(1, &gbuffer->textures[GBUFFER_COLORATTACH_FINAL]); // allocate output (final) texture
 
-    for (unsigned int i = 0; i < GBUFFER_NUM_COLORATTACH; i++) {
+    for (unsigned int i = 0; i < GBUFFER_COLORATTACH_FINAL; i++) {
+        // Nicht benötigte Attachments bleiben leer.
+        GLint internalFormat;
+        GLenum format;
+        if (!gbuffer_getFormat(layout, i, &internalFormat, &format))
+        {
+            continue;
+        }
+
         // creates the storage area of the texture (without initializing it)
-        glBindTexture(GL_TEXTURE_2D, gbuffer->textures[i]);
-        //if texture id is ALBEDOSPEC using RGBA
-        glTexImage2D(GL_TEXTURE_2D, 0, (i == GBUFFER_COLORATTACH_ALBEDOSPEC) ? GL_RGBA32F : GL_RGB32F, width, height, 0, (i == GBUFFER_COLORATTACH_ALBEDOSPEC) ? GL_RGBA : GL_RGB, GL_FLOAT, NULL);
+        glGenTextures(1, &gbuffer->textures[i]);
+        glstate_bindTexture(GL_TEXTURE_2D, gbuffer->textures[i]);
+        glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, width, height, 0, format, GL_FLOAT, NULL);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST); // prevents unnecessary interpolation between the texels that might create some fine distortions
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
         // attaches the texture to the FBO as a target
@@ -70,18 +149,28 @@ GBuffer* gbuffer_createGBuffer(int width, int height)
     }
     // --- Tiefenbuffer ---
 
-    // Textur für Depth & Stencil Buffer
-    glGenRenderbuffers(1, &gbuffer->rboDepth);
-    glBindRenderbuffer(GL_RENDERBUFFER, gbuffer->rboDepth);
-    common_labelObjectByType(GL_RENDERBUFFER, gbuffer->rboDepth, "GBuffer Depth");
+    // Textur für Depth & Stencil Buffer. Statt eines Renderbuffers wird eine
+    // Textur verwendet, damit die Lichtpässe die Tiefe auslesen können.
+    glGenTextures(1, &gbuffer->depthTexture);
+    glstate_bindTexture(GL_TEXTURE_2D, gbuffer->depthTexture);
+    common_labelObjectByType(GL_TEXTURE, gbuffer->depthTexture, "GBuffer Depth");
 
-    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH32F_STENCIL8, width, height);
-    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, gbuffer->rboDepth);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH32F_STENCIL8, width, height, 0, GL_DEPTH_STENCIL, GL_FLOAT_32_UNSIGNED_INT_24_8_REV, NULL);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_TEXTURE_2D, gbuffer->depthTexture, 0);
 
 
     // --- Finales Ausgabebild ---
-    glBindTexture(GL_TEXTURE_2D, gbuffer->textures[GBUFFER_COLORATTACH_FINAL]);
+    glstate_bindTexture(GL_TEXTURE_2D, gbuffer->textures[GBUFFER_COLORATTACH_FINAL]);
     glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA16F, width, height, 0, GL_RGBA, GL_FLOAT, NULL);
+    // Bei dynamischer Auflösung wird das Bild im PostProcess linear hochskaliert.
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
     common_labelObjectByType(GL_TEXTURE, gbuffer->textures[GBUFFER_COLORATTACH_FINAL], "Final");
 
     // Die Textur an das FBO binden.
@@ -94,9 +183,7 @@ GBuffer* gbuffer_createGBuffer(int width, int height)
     );
 
     // explicitly tell OpenGl which color attachments to be used (of. FB)
-    // enable writing to all six textures
-    GLenum drawBuffer[] = { GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1, GL_COLOR_ATTACHMENT2, GL_COLOR_ATTACHMENT3, GL_COLOR_ATTACHMENT4, GL_COLOR_ATTACHMENT5 };
-    glDrawBuffers(sizeof(drawBuffer) / sizeof(drawBuffer[0]), drawBuffer); // supplying array if attachment locations 
+    gbuffer_bindGBufferForGeomPass(gbuffer);
 
 
     // Wir prüfen dann noch, ob das FBO erfolgreich angelegt wurde.
@@ -135,28 +222,41 @@ GBuffer* gbuffer_createGBuffer(int width, int height)
 
     // Zum Schluss wechseln wir zurück zum Standard FBO und 
     // geben den GBuffer zurück.
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glstate_bindFramebuffer(GL_FRAMEBUFFER, 0);
     return gbuffer;
 }
 
+void gbuffer_getSize(GBuffer* gbuffer, int* width, int* height)
+{
+    *width = gbuffer->width;
+    *height = gbuffer->height;
+}
+
+GBufferLayout gbuffer_getLayout(GBuffer* gbuffer)
+{
+    return gbuffer->layout;
+}
+
 void gbuffer_clearFinalTexture(GBuffer *gbuffer)
 {
-    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, gbuffer->fbo);
+    glstate_bindFramebuffer(GL_DRAW_FRAMEBUFFER, gbuffer->fbo);
     glDrawBuffer(GL_COLOR_ATTACHMENT0 + GBUFFER_COLORATTACH_FINAL);
     glClear(GL_COLOR_BUFFER_BIT);
 }
 
 void gbuffer_bindGBufferForGeomPass(GBuffer *gbuffer)
 {
-    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, gbuffer->fbo);
+    glstate_bindFramebuffer(GL_DRAW_FRAMEBUFFER, gbuffer->fbo);
 
-    // Die zu verwendenden Attribute konfigurieren.
+    // Die zu verwendenden Attribute konfigurieren. Im kompakten GBuffer
+    // werden Position und Texturkoordinaten verworfen.
+    bool compact = gbuffer->layout == GBUFFER_LAYOUT_COMPACT;
     GLenum drawBuffer[] = {
-        GL_COLOR_ATTACHMENT0 + GBUFFER_COLORATTACH_POSITION, // location 0
+        compact ? GL_NONE : GL_COLOR_ATTACHMENT0 + GBUFFER_COLORATTACH_POSITION, // location 0
         GL_COLOR_ATTACHMENT0 + GBUFFER_COLORATTACH_NORMAL, // location 1
         GL_COLOR_ATTACHMENT0 + GBUFFER_COLORATTACH_ALBEDOSPEC, // location 2
         GL_COLOR_ATTACHMENT0 + GBUFFER_COLORATTACH_EMISSION, // location 3
-        GL_COLOR_ATTACHMENT0 + GBUFFER_COLORATTACH_TEXCOORD, // location 4
+        compact ? GL_NONE : GL_COLOR_ATTACHMENT0 + GBUFFER_COLORATTACH_TEXCOORD, // location 4
         GL_COLOR_ATTACHMENT0 + GBUFFER_COLORATTACH_FINAL, // location 5
     };
 
@@ -167,20 +267,26 @@ void gbuffer_bindGBufferForGeomPass(GBuffer *gbuffer)
 
 void gbuffer_bindGBufferForStencilPass(GBuffer* gbuffer)
 {
-    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, gbuffer->fbo);
+    glstate_bindFramebuffer(GL_DRAW_FRAMEBUFFER, gbuffer->fbo);
     glDrawBuffer(GL_NONE);
 }
 
 void gbuffer_bindGBufferForLightPass(GBuffer *gbuffer)
 {
-    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, gbuffer->fbo);
+    glstate_bindFramebuffer(GL_DRAW_FRAMEBUFFER, gbuffer->fbo);
     glDrawBuffer(GL_COLOR_ATTACHMENT0 + GBUFFER_COLORATTACH_FINAL);
     for (unsigned int i = 0; i < sizeof(gbuffer->textures) / sizeof(gbuffer->textures[0]); i++) {
-        glActiveTexture(GL_TEXTURE0 + i); 
-        glBindTexture(GL_TEXTURE_2D, gbuffer->textures[GBUFFER_COLORATTACH_POSITION + i]);
+        glstate_activeTexture(GL_TEXTURE0 + i); 
+        glstate_bindTexture(GL_TEXTURE_2D, gbuffer->textures[GBUFFER_COLORATTACH_POSITION + i]);
     }
 }
 
+void gbuffer_bindDepthTexture(GBuffer* gbuffer, GLenum textureUnit)
+{
+    glstate_activeTexture(textureUnit);
+    glstate_bindTexture(GL_TEXTURE_2D, gbuffer->depthTexture);
+}
+
 void gbuffer_bindGBufferForTextureRead(GBUFFER_TEXTURE_TYPE textureType)
 {
     // Auswahl von welchem Attachment gelesen werden soll.
@@ -189,38 +295,101 @@ void gbuffer_bindGBufferForTextureRead(GBUFFER_TEXTURE_TYPE textureType)
 
 void gbuffer_bindGBufferForReadingTextures()
 {
-    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0); 
+    glstate_bindFramebuffer(GL_DRAW_FRAMEBUFFER, 0); 
     for (unsigned int i = 0; i < GBUFFER_NUM_COLORATTACH; i++) {
-        glActiveTexture(GL_TEXTURE0 + i); 
-        glBindTexture(GL_TEXTURE_2D, GL_COLOR_ATTACHMENT0 + i);
+        glstate_activeTexture(GL_TEXTURE0 + i); 
+        glstate_bindTexture(GL_TEXTURE_2D, GL_COLOR_ATTACHMENT0 + i);
     }
 }
 
 
 void gbuffer_bindGBufferForFinalPass(GBuffer* gbuffer)
 {
-    glBindFramebuffer(GL_READ_FRAMEBUFFER, gbuffer->fbo);
+    glstate_bindFramebuffer(GL_READ_FRAMEBUFFER, gbuffer->fbo);
     glReadBuffer(GL_COLOR_ATTACHMENT0 + GBUFFER_COLORATTACH_FINAL);
-    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+    glstate_bindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
 }
 
 void gbuffer_bindForReading(GBuffer* gbuffer) {
-    glBindFramebuffer(GL_READ_FRAMEBUFFER, gbuffer->fbo);
+    glstate_bindFramebuffer(GL_READ_FRAMEBUFFER, gbuffer->fbo);
 };
 
 void gbuffer_deleteGBuffer(GBuffer *gbuffer)
 {
     // FBO löschen.
-    glDeleteFramebuffers(1, &gbuffer->fbo);
+    glstate_deleteFramebuffers(1, &gbuffer->fbo);
 
     // Die angehängten Texturen löschen.
-    glDeleteTextures(1, &gbuffer->textures[GBUFFER_COLORATTACH_POSITION]);
-    glDeleteTextures(1, &gbuffer->textures[GBUFFER_COLORATTACH_NORMAL]);
-    glDeleteTextures(1, &gbuffer->textures[GBUFFER_COLORATTACH_ALBEDOSPEC]);
-    glDeleteTextures(1, &gbuffer->textures[GBUFFER_COLORATTACH_EMISSION]);
-    glDeleteTextures(1, &gbuffer->textures[GBUFFER_COLORATTACH_TEXCOORD]);
-    glDeleteTextures(1, &gbuffer->textures[GBUFFER_COLORATTACH_FINAL]);
-    glDeleteRenderbuffers(1, &gbuffer->rboDepth);
+    glstate_deleteTextures(1, &gbuffer->textures[GBUFFER_COLORATTACH_POSITION]);
+    glstate_deleteTextures(1, &gbuffer->textures[GBUFFER_COLORATTACH_NORMAL]);
+    glstate_deleteTextures(1, &gbuffer->textures[GBUFFER_COLORATTACH_ALBEDOSPEC]);
+    glstate_deleteTextures(1, &gbuffer->textures[GBUFFER_COLORATTACH_EMISSION]);
+    glstate_deleteTextures(1, &gbuffer->textures[GBUFFER_COLORATTACH_TEXCOORD]);
+    glstate_deleteTextures(1, &gbuffer->textures[GBUFFER_COLORATTACH_FINAL]);
+    glstate_deleteTextures(1, &gbuffer->depthTexture);
 
     free(gbuffer);
 }
+
+GBufferPool* gbuffer_createPool(void)
+{
+    GBufferPool* pool = malloc(sizeof(GBufferPool));
+    memset(pool, 0, sizeof(GBufferPool));
+    return pool;
+}
+
+GBuffer* gbuffer_acquireFromPool(GBufferPool* pool, int width, int height, GBufferLayout layout)
+{
+    double now = glfwGetTime();
+    if (width != pool->requestedWidth || height != pool->requestedHeight)
+    {
+        pool->requestedWidth = width;
+        pool->requestedHeight = height;
+        pool->lastChange = now;
+    }
+
+    int bucketWidth = gbuffer_roundToBucket(width);
+    int bucketHeight = gbuffer_roundToBucket(height);
+
+    GBuffer* current = pool->gbuffer;
+    bool reallocate = current == NULL || current->layout != layout;
+    if (!reallocate)
+    {
+        // Vergrößern sofort, Verkleinern erst wenn die Größe stabil ist.
+        bool tooSmall = width > current->width || height > current->height;
+        bool tooLarge = bucketWidth < current->width || bucketHeight < current->height;
+        bool settled = now - pool->lastChange >= GBUFFER_POOL_SETTLE_TIME;
+        reallocate = tooSmall || (tooLarge && settled);
+    }
+
+    if (reallocate)
+    {
+        if (current)
+        {
+            gbuffer_deleteGBuffer(current);
+        }
+        pool->gbuffer = gbuffer_createGBuffer(bucketWidth, bucketHeight, layout);
+        pool->allocations++;
+    }
+
+    return pool->gbuffer;
+}
+
+int gbuffer_getPoolAllocations(GBufferPool* pool)
+{
+    return pool->allocations;
+}
+
+void gbuffer_deletePool(GBufferPool* pool)
+{
+    if (!pool)
+    {
+        return;
+    }
+
+    if (pool->gbuffer)
+    {
+        gbuffer_deleteGBuffer(pool->gbuffer);
+    }
+    free(pool);
+}
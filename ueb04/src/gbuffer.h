@@ -17,6 +17,15 @@
 
 #include "common.h"
 
+////////////////////////////////// KONSTANTEN //////////////////////////////////
+
+// Kantenlänge der Größenstufen in Pixeln, auf die der Pool aufrundet.
+#define GBUFFER_POOL_BUCKET 256
+
+// Zeit in Sekunden, die sich die Fenstergröße nicht ändern darf, bevor der
+// Pool einen zu großen GBuffer verkleinert.
+#define GBUFFER_POOL_SETTLE_TIME 0.5
+
 //////////////////////////// ÖFFENTLICHE DATENTYPEN ////////////////////////////
 
 // Aufzählungstyp für die unterschiedlichen Color Attachments des GBuffers.
@@ -31,10 +40,33 @@ typedef enum {
     GBUFFER_NUM_COLORATTACH
 } GBUFFER_TEXTURE_TYPE;
 
+// Aufbau des GBuffers.
+//
+// GBUFFER_LAYOUT_FULL speichert alle Attribute als 32 Bit Float Texturen.
+//
+// GBUFFER_LAYOUT_COMPACT verzichtet auf Position und Texturkoordinaten. Die
+// Position wird in den Lichtpässen aus dem Tiefenbuffer rekonstruiert. Die
+// Normale wird oktaedrisch kodiert in RG16 gespeichert, Albedo/Spekular in
+// RGBA8 und die Emission in R11G11B10F.
+typedef enum {
+    GBUFFER_LAYOUT_FULL,
+    GBUFFER_LAYOUT_COMPACT,
+} GBufferLayout;
+
 // GBuffer Datentyp.
 struct GBuffer;
 typedef struct GBuffer GBuffer;
 
+// Pool, der einen GBuffer über Größenänderungen des Fensters hinweg verwaltet.
+//
+// Der GBuffer wird auf die nächste Größenstufe aufgerundet angelegt, es wird
+// nur in den Bereich links unten gerendert (Viewport/Scissor). Vergrößert wird
+// erst, wenn das Fenster die aktuelle Stufe verlässt. Verkleinert wird erst,
+// wenn sich die Größe für GBUFFER_POOL_SETTLE_TIME nicht mehr geändert hat.
+// Das Ziehen am Fensterrand löst so kaum noch Neuanlagen aus.
+struct GBufferPool;
+typedef struct GBufferPool GBufferPool;
+
 //////////////////////////// ÖFFENTLICHE FUNKTIONEN ////////////////////////////
 
 /**
@@ -42,9 +74,27 @@ typedef struct GBuffer GBuffer;
  * 
  * @param width die Breite des Buffers
  * @param height die Höhe des Buffers
+ * @param layout der Aufbau der Color Attachments
  * @return der neue GBuffer
  */
-GBuffer *gbuffer_createGBuffer(int width, int height);
+GBuffer *gbuffer_createGBuffer(int width, int height, GBufferLayout layout);
+
+/**
+ * Liefert die tatsächliche Größe der Texturen des GBuffers.
+ *
+ * @param gbuffer der GBuffer
+ * @param width Rückgabe der Breite
+ * @param height Rückgabe der Höhe
+ */
+void gbuffer_getSize(GBuffer* gbuffer, int* width, int* height);
+
+/**
+ * Liefert den Aufbau des GBuffers.
+ *
+ * @param gbuffer der GBuffer
+ * @return der Aufbau der Color Attachments
+ */
+GBufferLayout gbuffer_getLayout(GBuffer* gbuffer);
 
 /**
  * Bindet das GBuffer FBO, setzt die finale Render Ausgabe als DrawBuffer und 
@@ -78,6 +128,15 @@ void gbuffer_bindGBufferForStencilPass(GBuffer *gbuffer);
  */
 void gbuffer_bindGBufferForLightPass(GBuffer *gbuffer);
 
+/**
+ * Bindet die Tiefentextur des GBuffers an die angegebene Textureinheit.
+ * Die Tiefe darf nur gelesen werden, solange nicht in sie geschrieben wird.
+ *
+ * @param gbuffer der GBuffer
+ * @param textureUnit die Textureinheit (GL_TEXTURE0, ...)
+ */
+void gbuffer_bindDepthTexture(GBuffer* gbuffer, GLenum textureUnit);
+
 /**
  * Setzt die Textur zum Lesen aus dem Framebuffer
  *
@@ -112,4 +171,40 @@ void gbuffer_bindForReading(GBuffer* gbuffer);
  */
 void gbuffer_deleteGBuffer(GBuffer* gbuffer);
 
+/**
+ * Erstellt einen neuen, leeren GBuffer Pool.
+ *
+ * @return der neue Pool
+ */
+GBufferPool* gbuffer_createPool(void);
+
+/**
+ * Liefert einen GBuffer, der mindestens die angegebene Größe und den
+ * angegebenen Aufbau hat. Der bisherige GBuffer wird nur dann gelöscht und
+ * neu angelegt, wenn er nicht mehr passt oder sich die Größe gesetzt hat und
+ * eine kleinere Stufe ausreicht. Zuvor gelieferte Zeiger werden dabei ungültig.
+ *
+ * @param pool der Pool
+ * @param width die benötigte Breite
+ * @param height die benötigte Höhe
+ * @param layout der benötigte Aufbau
+ * @return der GBuffer
+ */
+GBuffer* gbuffer_acquireFromPool(GBufferPool* pool, int width, int height, GBufferLayout layout);
+
+/**
+ * Liefert die Anzahl der GBuffer, die der Pool bisher angelegt hat.
+ *
+ * @param pool der Pool
+ * @return die Anzahl der Allokationen
+ */
+int gbuffer_getPoolAllocations(GBufferPool* pool);
+
+/**
+ * Löscht den Pool inklusive des verwalteten GBuffers.
+ *
+ * @param pool der zu löschende Pool
+ */
+void gbuffer_deletePool(GBufferPool* pool);
+
 #endif // GBUFFER_H
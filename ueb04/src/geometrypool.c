@@ -0,0 +1,257 @@
+/**
+ * Modul für gemeinsame Vertex- und Index-Buffer mehrerer Meshes.
+ *
+ * Copyright (C) 2023, FH Wedel
+ * Autor: Joshua-Scott Schöttke, Ilana Schmara
+ */
+
+#include "geometrypool.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include <sesp/stb_ds.h>
+
+#include "glstate.h"
+#include "mesh.h"
+
+////////////////////////////// LOKALE DATENTYPEN ///////////////////////////////
+
+// Datenstruktur der gemeinsamen Buffer.
+struct GeometryPool
+{
+    GLuint vao;             // Vertex Array Object
+    GLuint vbo;             // gemeinsamer Vertex Buffer
+    GLuint ebo;             // gemeinsamer Element Buffer
+    GLuint indirectBuffer;  // alle Draw Befehle in der Reihenfolge der Meshes
+
+    // Dynamisches Array (stb_ds) der Draw Befehle
+    GeometryDrawCommand* commands;
+
+    // Dynamische Arrays (stb_ds) der gesammelten Daten bis zum Hochladen
+    Vertex* vertices;
+    GLint* indices;
+
+    bool uploaded;
+};
+
+// Funktion aus GL_ARB_multi_draw_indirect
+typedef void (APIENTRYP GeometryMultiDrawFunc)(GLenum mode, GLenum type,
+                                               const void* indirect,
+                                               GLsizei drawCount, GLsizei stride);
+
+// Ob bereits nach der Erweiterung gesucht wurde, und die geladene Funktion
+static bool geometryMultiDrawChecked = false;
+static GeometryMultiDrawFunc geometryMultiDraw = NULL;
+
+////////////////////////////// LOKALE FUNKTIONEN ///////////////////////////////
+
+/**
+ * Liefert den Primitivtyp und legt für Tessellation die Größe der Patches
+ * fest.
+ *
+ * @param isModel true, wenn Patches für die Tessellation gezeichnet werden
+ * @return GL_PATCHES oder GL_TRIANGLES
+ */
+static GLenum geometrypool_prepareMode(bool isModel)
+{
+    if (isModel)
+    {
+        // Für Tessellation muss zuerst die Anzahl der Patches
+        // festgelegt werden.
+        glPatchParameteri(GL_PATCH_VERTICES, 3);
+        return GL_PATCHES;
+    }
+
+    return GL_TRIANGLES;
+}
+
+/**
+ * Zeichnet einen Befehl ohne Indirect Buffer.
+ *
+ * @param mode der Primitivtyp
+ * @param command der Befehl
+ */
+static void geometrypool_drawBaseVertex(GLenum mode,
+                                        const GeometryDrawCommand* command)
+{
+    glDrawElementsBaseVertex(mode, command->count, GL_UNSIGNED_INT,
+        (void*)(command->firstIndex * sizeof(GLint)), command->baseVertex);
+}
+
+//////////////////////////// ÖFFENTLICHE FUNKTIONEN ////////////////////////////
+
+GeometryPool* geometrypool_createPool(void)
+{
+    GeometryPool* pool = malloc(sizeof(GeometryPool));
+    memset(pool, 0, sizeof(GeometryPool));
+
+    return pool;
+}
+
+int geometrypool_addGeometry(GeometryPool* pool, const struct Vertex* vertices,
+                             GLuint vertexCount, const GLint* indices,
+                             GLuint indexCount)
+{
+    if (pool->uploaded)
+    {
+        fprintf(stderr, "Error: Cannot add geometry to an uploaded pool!\n");
+        return -1;
+    }
+
+    GeometryDrawCommand command = {
+        indexCount, 1, (GLuint)stbds_arrlenu(pool->indices),
+        (GLint)stbds_arrlen(pool->vertices), 0
+    };
+    stbds_arrput(pool->commands, command);
+
+    // Die Indices bleiben lokal, der Versatz steckt in baseVertex.
+    memcpy(stbds_arraddnptr(pool->vertices, vertexCount), vertices,
+           vertexCount * sizeof(Vertex));
+    memcpy(stbds_arraddnptr(pool->indices, indexCount), indices,
+           indexCount * sizeof(GLint));
+
+    return (int)stbds_arrlen(pool->commands) - 1;
+}
+
+void geometrypool_upload(GeometryPool* pool, const char* label)
+{
+    // Dann legen wir die benötigten Buffer und Objekte an.
+    glGenVertexArrays(1, &pool->vao);
+    glGenBuffers(1, &pool->vbo);
+    glGenBuffers(1, &pool->ebo);
+    glGenBuffers(1, &pool->indirectBuffer);
+
+    // Ab jetzt binden wir das VAO.
+    glstate_bindVertexArray(pool->vao);
+
+    // Die folgenden Befehle übertragen die Vertexdaten an OpenGL.
+    glBindBuffer(GL_ARRAY_BUFFER, pool->vbo);
+    glBufferData(GL_ARRAY_BUFFER, stbds_arrlenu(pool->vertices) * sizeof(Vertex),
+                 pool->vertices, GL_STATIC_DRAW);
+
+    // Und diese Befehle legen die Indicies fest.
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, pool->ebo);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, stbds_arrlenu(pool->indices) * sizeof(GLint),
+                 pool->indices, GL_STATIC_DRAW);
+
+    // Vertex Position, Normale, Texturkoordinaten, Tangente und Bitangente
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex),
+                          (void*)offsetof(Vertex, position));
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex),
+                          (void*)offsetof(Vertex, normal));
+    glEnableVertexAttribArray(3);
+    glVertexAttribPointer(3, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex),
+                          (void*)offsetof(Vertex, texCoord));
+    glEnableVertexAttribArray(4);
+    glVertexAttribPointer(4, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex),
+                          (void*)offsetof(Vertex, tangent));
+    glEnableVertexAttribArray(5);
+    glVertexAttribPointer(5, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex),
+                          (void*)offsetof(Vertex, biTangent));
+
+    glstate_bindVertexArray(0);
+
+    // Die Befehle für alle Meshes ändern sich nach dem Laden nicht mehr.
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, pool->indirectBuffer);
+    glBufferData(GL_DRAW_INDIRECT_BUFFER,
+                 stbds_arrlenu(pool->commands) * sizeof(GeometryDrawCommand),
+                 pool->commands, GL_STATIC_DRAW);
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+
+    common_labelObjectByType(GL_VERTEX_ARRAY, pool->vao, label);
+    common_labelObjectByType(GL_BUFFER, pool->vbo, label);
+    common_labelObjectByType(GL_BUFFER, pool->ebo, label);
+    common_labelObjectByType(GL_BUFFER, pool->indirectBuffer, label);
+
+    stbds_arrfree(pool->vertices);
+    stbds_arrfree(pool->indices);
+    pool->uploaded = true;
+}
+
+const GeometryDrawCommand* geometrypool_getCommand(GeometryPool* pool, int index)
+{
+    return &pool->commands[index];
+}
+
+bool geometrypool_supportsMultiDraw(void)
+{
+    if (!geometryMultiDrawChecked)
+    {
+        geometryMultiDrawChecked = true;
+
+        // Die Erweiterung ist nicht in GLAD enthalten.
+        if (glfwExtensionSupported("GL_ARB_multi_draw_indirect"))
+        {
+            geometryMultiDraw = (GeometryMultiDrawFunc)glfwGetProcAddress("glMultiDrawElementsIndirect");
+        }
+    }
+
+    return geometryMultiDraw != NULL;
+}
+
+void geometrypool_draw(GeometryPool* pool, int index, bool isModel)
+{
+    GLenum mode = geometrypool_prepareMode(isModel);
+
+    glstate_bindVertexArray(pool->vao);
+    geometrypool_drawBaseVertex(mode, &pool->commands[index]);
+}
+
+int geometrypool_drawAll(GeometryPool* pool, bool isModel)
+{
+    return geometrypool_drawCommands(pool, pool->indirectBuffer, 0,
+        pool->commands, (int)stbds_arrlen(pool->commands), isModel);
+}
+
+int geometrypool_drawCommands(GeometryPool* pool, GLuint indirectBuffer,
+                              int first, const GeometryDrawCommand* commands,
+                              int count, bool isModel)
+{
+    if (count <= 0)
+    {
+        return 0;
+    }
+
+    GLenum mode = geometrypool_prepareMode(isModel);
+    glstate_bindVertexArray(pool->vao);
+
+    if (geometrypool_supportsMultiDraw())
+    {
+        // Die Bindung des Indirect Buffers gehört nicht zum VAO.
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, indirectBuffer);
+        geometryMultiDraw(mode, GL_UNSIGNED_INT,
+            (void*)(first * sizeof(GeometryDrawCommand)), count, 0);
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+        return 1;
+    }
+
+    for (int i = 0; i < count; i++)
+    {
+        geometrypool_drawBaseVertex(mode, &commands[i]);
+    }
+    return count;
+}
+
+void geometrypool_deletePool(GeometryPool* pool)
+{
+    if (pool == NULL)
+    {
+        return;
+    }
+
+    if (pool->uploaded)
+    {
+        glDeleteBuffers(1, &pool->vbo);
+        glDeleteBuffers(1, &pool->ebo);
+        glDeleteBuffers(1, &pool->indirectBuffer);
+        glstate_deleteVertexArrays(1, &pool->vao);
+    }
+
+    stbds_arrfree(pool->commands);
+    stbds_arrfree(pool->vertices);
+    stbds_arrfree(pool->indices);
+    free(pool);
+}
@@ -0,0 +1,135 @@
+/**
+ * Modul für gemeinsame Vertex- und Index-Buffer mehrerer Meshes.
+ *
+ * Alle Meshes eines Modells werden in einen gemeinsamen VBO und EBO mit
+ * einem VAO gelegt. Jedes Mesh erhält dabei einen Draw Befehl im Format von
+ * glDrawElementsIndirect, der beim Hochladen in einen Indirect Buffer
+ * geschrieben wird. So kann ein ganzes Modell mit einem einzigen Aufruf von
+ * glMultiDrawElementsIndirect gezeichnet werden, ohne zwischen den Meshes
+ * das VAO zu wechseln.
+ *
+ * glMultiDrawElementsIndirect gehört erst zu OpenGL 4.3 und wird daher über
+ * GL_ARB_multi_draw_indirect geladen. Fehlt die Erweiterung, wird jeder
+ * Befehl einzeln mit glDrawElementsBaseVertex gezeichnet.
+ *
+ * Copyright (C) 2023, FH Wedel
+ * Autor: Joshua-Scott Schöttke, Ilana Schmara
+ */
+
+#ifndef GEOMETRYPOOL_H
+#define GEOMETRYPOOL_H
+
+#include "common.h"
+
+//////////////////////////// ÖFFENTLICHE DATENTYPEN ////////////////////////////
+
+// Ein Draw Befehl im Layout, das glDrawElementsIndirect erwartet.
+typedef struct {
+    GLuint count;           // Anzahl der Indices
+    GLuint instanceCount;   // immer 1
+    GLuint firstIndex;      // erster Index im gemeinsamen EBO
+    GLint baseVertex;       // erster Vertex im gemeinsamen VBO
+    GLuint baseInstance;    // muss vor OpenGL 4.2 immer 0 sein
+} GeometryDrawCommand;
+
+// Datenstruktur der gemeinsamen Buffer.
+struct GeometryPool;
+typedef struct GeometryPool GeometryPool;
+
+// Vertex Layout aus mesh.h
+struct Vertex;
+
+//////////////////////////// ÖFFENTLICHE FUNKTIONEN ////////////////////////////
+
+/**
+ * Legt einen neuen, leeren Pool an. Die Buffer entstehen erst beim Hochladen.
+ *
+ * @return der neue Pool
+ */
+GeometryPool* geometrypool_createPool(void);
+
+/**
+ * Hängt die Geometrie eines Meshes an. Die Daten werden kopiert und bis zum
+ * Hochladen gesammelt.
+ *
+ * @param pool der noch nicht hochgeladene Pool
+ * @param vertices die Vertices
+ * @param vertexCount die Anzahl der Vertices
+ * @param indices die Indices, bezogen auf den ersten Vertex des Meshes
+ * @param indexCount die Anzahl der Indices
+ * @return die Nummer des Draw Befehls für das Mesh
+ */
+int geometrypool_addGeometry(GeometryPool* pool, const struct Vertex* vertices,
+                             GLuint vertexCount, const GLint* indices,
+                             GLuint indexCount);
+
+/**
+ * Legt VAO, VBO, EBO und den Indirect Buffer mit allen Draw Befehlen an und
+ * gibt die gesammelten Daten frei. Danach können keine Meshes mehr
+ * angehängt werden.
+ *
+ * @param pool der Pool
+ * @param label das Label der OpenGL Objekte
+ */
+void geometrypool_upload(GeometryPool* pool, const char* label);
+
+/**
+ * Liefert einen Draw Befehl des Pools.
+ *
+ * @param pool der Pool
+ * @param index die Nummer aus geometrypool_addGeometry
+ * @return der Befehl, gültig bis zum Löschen des Pools
+ */
+const GeometryDrawCommand* geometrypool_getCommand(GeometryPool* pool, int index);
+
+/**
+ * Prüft beim ersten Aufruf, ob glMultiDrawElementsIndirect verfügbar ist.
+ *
+ * @return true, wenn Multi Draw Indirect genutzt wird
+ */
+bool geometrypool_supportsMultiDraw(void);
+
+/**
+ * Zeichnet einen einzelnen Befehl des Pools mit glDrawElementsBaseVertex.
+ *
+ * @param pool der hochgeladene Pool
+ * @param index die Nummer des Befehls
+ * @param isModel true, wenn Patches für die Tessellation gezeichnet werden
+ */
+void geometrypool_draw(GeometryPool* pool, int index, bool isModel);
+
+/**
+ * Zeichnet alle Befehle des Pools in der Reihenfolge, in der sie angehängt
+ * wurden, mit Multi Draw Indirect aus dem beim Hochladen gefüllten Buffer.
+ *
+ * @param pool der hochgeladene Pool
+ * @param isModel true, wenn Patches für die Tessellation gezeichnet werden
+ * @return die Anzahl der abgesetzten Draw Calls
+ */
+int geometrypool_drawAll(GeometryPool* pool, bool isModel);
+
+/**
+ * Zeichnet eine Folge von Befehlen, die bereits in einem Indirect Buffer
+ * liegen, z.B. in der Reihenfolge einer Render Queue. Ohne Multi Draw
+ * Indirect werden die Befehle aus dem Speicher einzeln gezeichnet.
+ *
+ * @param pool der hochgeladene Pool, zu dem die Befehle gehören
+ * @param indirectBuffer der Buffer mit den Befehlen
+ * @param first die Position des ersten Befehls im Buffer
+ * @param commands die Befehle im Speicher, gleicher Inhalt wie im Buffer
+ * @param count die Anzahl der Befehle
+ * @param isModel true, wenn Patches für die Tessellation gezeichnet werden
+ * @return die Anzahl der abgesetzten Draw Calls
+ */
+int geometrypool_drawCommands(GeometryPool* pool, GLuint indirectBuffer,
+                              int first, const GeometryDrawCommand* commands,
+                              int count, bool isModel);
+
+/**
+ * Löscht einen Pool samt seiner OpenGL Objekte.
+ *
+ * @param pool der zu löschende Pool oder NULL
+ */
+void geometrypool_deletePool(GeometryPool* pool);
+
+#endif // GEOMETRYPOOL_H
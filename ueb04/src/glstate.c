@@ -0,0 +1,368 @@
+/**
+ * Modul zum Zwischenspeichern des OpenGL Zustands.
+ *
+ * Copyright (C) 2023, FH Wedel
+ * Autor: Joshua-Scott Schöttke, Ilana Schmara
+ */
+
+#include "glstate.h"
+
+#include <string.h>
+
+////////////////////////////////// KONSTANTEN //////////////////////////////////
+
+// Markiert einen unbekannten Wert
+#define GLSTATE_UNKNOWN 0xFFFFFFFFu
+
+// Anzahl der gemerkten Textureinheiten, höhere werden immer weitergegeben
+#define GLSTATE_TEXTURE_UNITS 32
+
+// Anzahl der gemerkten Texturziele (siehe glstate_getTargetIndex)
+#define GLSTATE_TEXTURE_TARGETS 5
+
+// Anzahl der gemerkten Zustände (siehe glstate_getCapIndex)
+#define GLSTATE_CAPS 6
+
+////////////////////////////// LOKALE DATENTYPEN ///////////////////////////////
+
+// Der gemerkte Zustand. Unbekannte Werte sind GLSTATE_UNKNOWN, bei den
+// Zuständen -1.
+struct GLState
+{
+    GLuint program;
+    GLuint vao;
+    GLenum activeUnit;
+    GLuint textures[GLSTATE_TEXTURE_UNITS][GLSTATE_TEXTURE_TARGETS];
+    GLuint drawFramebuffer;
+    GLuint readFramebuffer;
+    int caps[GLSTATE_CAPS];
+    GLenum blendEquation;
+    GLenum blendSrc;
+    GLenum blendDst;
+    int depthMask;
+    GLenum cullFace;
+
+    GLStateStats stats;
+};
+
+// Es gibt nur einen OpenGL Kontext.
+static struct GLState glState;
+static bool glStateInitialized = false;
+
+////////////////////////////// LOKALE FUNKTIONEN ///////////////////////////////
+
+/**
+ * Vergisst beim ersten Aufruf den Zustand.
+ */
+static void glstate_init(void)
+{
+    if (!glStateInitialized)
+    {
+        glStateInitialized = true;
+        glstate_invalidate();
+    }
+}
+
+/**
+ * Zählt einen Aufruf.
+ *
+ * @param changed ob der Aufruf an OpenGL weitergegeben wird
+ * @return changed
+ */
+static bool glstate_count(bool changed)
+{
+    if (changed)
+    {
+        glState.stats.issued++;
+    }
+    else
+    {
+        glState.stats.skipped++;
+    }
+    return changed;
+}
+
+/**
+ * Liefert den Index eines Texturziels.
+ *
+ * @param target das Ziel
+ * @return der Index oder -1, wenn das Ziel nicht gemerkt wird
+ */
+static int glstate_getTargetIndex(GLenum target)
+{
+    switch (target)
+    {
+        case GL_TEXTURE_2D: return 0;
+        case GL_TEXTURE_2D_ARRAY: return 1;
+        case GL_TEXTURE_BUFFER: return 2;
+        case GL_TEXTURE_CUBE_MAP: return 3;
+        case GL_TEXTURE_CUBE_MAP_ARRAY: return 4;
+        default: return -1;
+    }
+}
+
+/**
+ * Liefert den Index eines Zustands für glEnable / glDisable.
+ *
+ * @param cap der Zustand
+ * @return der Index oder -1, wenn der Zustand nicht gemerkt wird
+ */
+static int glstate_getCapIndex(GLenum cap)
+{
+    switch (cap)
+    {
+        case GL_BLEND: return 0;
+        case GL_DEPTH_TEST: return 1;
+        case GL_CULL_FACE: return 2;
+        case GL_STENCIL_TEST: return 3;
+        case GL_SCISSOR_TEST: return 4;
+        case GL_DEPTH_CLAMP: return 5;
+        default: return -1;
+    }
+}
+
+/**
+ * Setzt einen Zustand für glEnable / glDisable.
+ *
+ * @param cap der Zustand
+ * @param enabled ob er eingeschaltet wird
+ */
+static void glstate_setCap(GLenum cap, bool enabled)
+{
+    glstate_init();
+
+    int index = glstate_getCapIndex(cap);
+    if (index >= 0)
+    {
+        if (!glstate_count(glState.caps[index] != (int)enabled))
+        {
+            return;
+        }
+        glState.caps[index] = enabled;
+    }
+    else
+    {
+        glstate_count(true);
+    }
+
+    if (enabled)
+    {
+        glEnable(cap);
+    }
+    else
+    {
+        glDisable(cap);
+    }
+}
+
+//////////////////////////// ÖFFENTLICHE FUNKTIONEN ////////////////////////////
+
+void glstate_invalidate(void)
+{
+    GLStateStats stats = glState.stats;
+    memset(&glState, 0xFF, sizeof(glState));
+    glState.stats = stats;
+
+    for (int i = 0; i < GLSTATE_CAPS; i++)
+    {
+        glState.caps[i] = -1;
+    }
+    glState.depthMask = -1;
+}
+
+GLStateStats glstate_resetStats(void)
+{
+    GLStateStats stats = glState.stats;
+    glState.stats.issued = 0;
+    glState.stats.skipped = 0;
+    return stats;
+}
+
+void glstate_useProgram(GLuint program)
+{
+    glstate_init();
+    if (glstate_count(glState.program != program))
+    {
+        glState.program = program;
+        glUseProgram(program);
+    }
+}
+
+void glstate_bindVertexArray(GLuint vao)
+{
+    glstate_init();
+    if (glstate_count(glState.vao != vao))
+    {
+        glState.vao = vao;
+        glBindVertexArray(vao);
+    }
+}
+
+void glstate_activeTexture(GLenum unit)
+{
+    glstate_init();
+    if (glstate_count(glState.activeUnit != unit))
+    {
+        glState.activeUnit = unit;
+        glActiveTexture(unit);
+    }
+}
+
+void glstate_bindTexture(GLenum target, GLuint texture)
+{
+    glstate_init();
+
+    // Ohne bekannte Einheit oder bekanntes Ziel immer weitergeben.
+    GLuint unit = glState.activeUnit - GL_TEXTURE0;
+    int index = glstate_getTargetIndex(target);
+    if (glState.activeUnit == GLSTATE_UNKNOWN || unit >= GLSTATE_TEXTURE_UNITS
+        || index < 0)
+    {
+        glstate_count(true);
+        glBindTexture(target, texture);
+        return;
+    }
+
+    if (glstate_count(glState.textures[unit][index] != texture))
+    {
+        glState.textures[unit][index] = texture;
+        glBindTexture(target, texture);
+    }
+}
+
+void glstate_bindFramebuffer(GLenum target, GLuint framebuffer)
+{
+    glstate_init();
+
+    bool draw = target != GL_READ_FRAMEBUFFER;
+    bool read = target != GL_DRAW_FRAMEBUFFER;
+    bool changed = (draw && glState.drawFramebuffer != framebuffer)
+        || (read && glState.readFramebuffer != framebuffer);
+
+    if (glstate_count(changed))
+    {
+        if (draw)
+        {
+            glState.drawFramebuffer = framebuffer;
+        }
+        if (read)
+        {
+            glState.readFramebuffer = framebuffer;
+        }
+        glBindFramebuffer(target, framebuffer);
+    }
+}
+
+void glstate_enable(GLenum cap)
+{
+    glstate_setCap(cap, true);
+}
+
+void glstate_disable(GLenum cap)
+{
+    glstate_setCap(cap, false);
+}
+
+void glstate_blendEquation(GLenum mode)
+{
+    glstate_init();
+    if (glstate_count(glState.blendEquation != mode))
+    {
+        glState.blendEquation = mode;
+        glBlendEquation(mode);
+    }
+}
+
+void glstate_blendFunc(GLenum sfactor, GLenum dfactor)
+{
+    glstate_init();
+    if (glstate_count(glState.blendSrc != sfactor || glState.blendDst != dfactor))
+    {
+        glState.blendSrc = sfactor;
+        glState.blendDst = dfactor;
+        glBlendFunc(sfactor, dfactor);
+    }
+}
+
+void glstate_depthMask(GLboolean flag)
+{
+    glstate_init();
+    if (glstate_count(glState.depthMask != (flag ? 1 : 0)))
+    {
+        glState.depthMask = flag ? 1 : 0;
+        glDepthMask(flag);
+    }
+}
+
+void glstate_cullFace(GLenum mode)
+{
+    glstate_init();
+    if (glstate_count(glState.cullFace != mode))
+    {
+        glState.cullFace = mode;
+        glCullFace(mode);
+    }
+}
+
+void glstate_deleteProgram(GLuint program)
+{
+    // Ein aktives Programm bleibt bis zum nächsten Wechsel bestehen, danach
+    // kann OpenGL den Namen wieder vergeben.
+    if (program != 0 && glState.program == program)
+    {
+        glState.program = GLSTATE_UNKNOWN;
+    }
+    glDeleteProgram(program);
+}
+
+void glstate_deleteVertexArrays(GLsizei n, const GLuint* arrays)
+{
+    // OpenGL löst gelöschte Objekte selbst, der Name kann danach neu
+    // vergeben werden.
+    for (GLsizei i = 0; i < n; i++)
+    {
+        if (arrays[i] != 0 && glState.vao == arrays[i])
+        {
+            glState.vao = 0;
+        }
+    }
+    glDeleteVertexArrays(n, arrays);
+}
+
+void glstate_deleteTextures(GLsizei n, const GLuint* textures)
+{
+    for (GLsizei i = 0; i < n; i++)
+    {
+        for (int unit = 0; unit < GLSTATE_TEXTURE_UNITS && textures[i] != 0; unit++)
+        {
+            for (int target = 0; target < GLSTATE_TEXTURE_TARGETS; target++)
+            {
+                if (glState.textures[unit][target] == textures[i])
+                {
+                    glState.textures[unit][target] = 0;
+                }
+            }
+        }
+    }
+    glDeleteTextures(n, textures);
+}
+
+void glstate_deleteFramebuffers(GLsizei n, const GLuint* framebuffers)
+{
+    for (GLsizei i = 0; i < n; i++)
+    {
+        if (framebuffers[i] == 0)
+        {
+            continue;
+        }
+        if (glState.drawFramebuffer == framebuffers[i])
+        {
+            glState.drawFramebuffer = 0;
+        }
+        if (glState.readFramebuffer == framebuffers[i])
+        {
+            glState.readFramebuffer = 0;
+        }
+    }
+    glDeleteFramebuffers(n, framebuffers);
+}
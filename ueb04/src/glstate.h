@@ -0,0 +1,157 @@
+/**
+ * Modul zum Zwischenspeichern des OpenGL Zustands.
+ *
+ * Das Modul merkt sich das aktive Programm, das VAO, die Texturen jeder
+ * Einheit, die Framebuffer sowie Blending, Tiefentest und Culling. Aufrufe,
+ * die nichts ändern würden, werden nicht an OpenGL weitergegeben, sondern
+ * nur gezählt.
+ *
+ * Damit der gemerkte Zustand stimmt, MÜSSEN alle Änderungen dieser Zustände
+ * über die Funktionen hier laufen, auch das Löschen der Objekte. Ändert
+ * fremder Code den Zustand (z.B. die GUI), muss danach glstate_invalidate
+ * aufgerufen werden.
+ *
+ * Copyright (C) 2023, FH Wedel
+ * Autor: Joshua-Scott Schöttke, Ilana Schmara
+ */
+
+#ifndef GLSTATE_H
+#define GLSTATE_H
+
+#include "common.h"
+
+//////////////////////////// ÖFFENTLICHE DATENTYPEN ////////////////////////////
+
+// Zähler seit dem letzten glstate_resetStats.
+typedef struct {
+    unsigned int issued;    // an OpenGL weitergegebene Aufrufe
+    unsigned int skipped;   // übersprungene, redundante Aufrufe
+} GLStateStats;
+
+//////////////////////////// ÖFFENTLICHE FUNKTIONEN ////////////////////////////
+
+/**
+ * Vergisst den gesamten gemerkten Zustand, so dass die nächsten Aufrufe
+ * in jedem Fall an OpenGL gehen.
+ */
+void glstate_invalidate(void);
+
+/**
+ * Liefert die Zähler und setzt sie zurück, z.B. einmal pro Frame.
+ *
+ * @return die Zähler seit dem letzten Aufruf
+ */
+GLStateStats glstate_resetStats(void);
+
+/**
+ * Entspricht glUseProgram.
+ *
+ * @param program das Programm oder 0
+ */
+void glstate_useProgram(GLuint program);
+
+/**
+ * Entspricht glBindVertexArray.
+ *
+ * @param vao das VAO oder 0
+ */
+void glstate_bindVertexArray(GLuint vao);
+
+/**
+ * Entspricht glActiveTexture.
+ *
+ * @param unit die Textureinheit (GL_TEXTURE0 + i)
+ */
+void glstate_activeTexture(GLenum unit);
+
+/**
+ * Entspricht glBindTexture für die aktive Textureinheit.
+ *
+ * @param target das Ziel, z.B. GL_TEXTURE_2D
+ * @param texture die Textur oder 0
+ */
+void glstate_bindTexture(GLenum target, GLuint texture);
+
+/**
+ * Entspricht glBindFramebuffer.
+ *
+ * @param target GL_FRAMEBUFFER, GL_DRAW_FRAMEBUFFER oder GL_READ_FRAMEBUFFER
+ * @param framebuffer der Framebuffer oder 0
+ */
+void glstate_bindFramebuffer(GLenum target, GLuint framebuffer);
+
+/**
+ * Entspricht glEnable. Nicht gemerkte Zustände werden immer weitergegeben.
+ *
+ * @param cap der Zustand, z.B. GL_BLEND
+ */
+void glstate_enable(GLenum cap);
+
+/**
+ * Entspricht glDisable. Nicht gemerkte Zustände werden immer weitergegeben.
+ *
+ * @param cap der Zustand, z.B. GL_BLEND
+ */
+void glstate_disable(GLenum cap);
+
+/**
+ * Entspricht glBlendEquation.
+ *
+ * @param mode die Gleichung
+ */
+void glstate_blendEquation(GLenum mode);
+
+/**
+ * Entspricht glBlendFunc.
+ *
+ * @param sfactor der Faktor der Quelle
+ * @param dfactor der Faktor des Ziels
+ */
+void glstate_blendFunc(GLenum sfactor, GLenum dfactor);
+
+/**
+ * Entspricht glDepthMask.
+ *
+ * @param flag ob in den Tiefenpuffer geschrieben wird
+ */
+void glstate_depthMask(GLboolean flag);
+
+/**
+ * Entspricht glCullFace.
+ *
+ * @param mode die verworfenen Seiten
+ */
+void glstate_cullFace(GLenum mode);
+
+/**
+ * Entspricht glDeleteProgram.
+ *
+ * @param program das zu löschende Programm
+ */
+void glstate_deleteProgram(GLuint program);
+
+/**
+ * Entspricht glDeleteVertexArrays.
+ *
+ * @param n die Anzahl
+ * @param arrays die zu löschenden VAOs
+ */
+void glstate_deleteVertexArrays(GLsizei n, const GLuint* arrays);
+
+/**
+ * Entspricht glDeleteTextures.
+ *
+ * @param n die Anzahl
+ * @param textures die zu löschenden Texturen
+ */
+void glstate_deleteTextures(GLsizei n, const GLuint* textures);
+
+/**
+ * Entspricht glDeleteFramebuffers.
+ *
+ * @param n die Anzahl
+ * @param framebuffers die zu löschenden Framebuffer
+ */
+void glstate_deleteFramebuffers(GLsizei n, const GLuint* framebuffers);
+
+#endif // GLSTATE_H
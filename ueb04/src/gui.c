@@ -12,14 +12,20 @@
 
 #include "window.h"
 #include "input.h"
+#include "rendering.h"
+#include "shadow.h"
+#include "glstate.h"
+#include "geometrypool.h"
 
  ////////////////////////////////// KONSTANTEN //////////////////////////////////
 
 #define MAX_VERTEX_BUFFER 512 * 1024
 #define MAX_ELEMENT_BUFFER 128 * 1024
 
-#define STATS_WIDTH (80)
-#define STATS_HEIGHT (30)
+#define STATS_WIDTH (190)
+#define STATS_LINE_HEIGHT (18)
+#define STATS_LINES (18)
+#define STATS_HEIGHT (STATS_LINES * (STATS_LINE_HEIGHT + 4) + 8)
 
 // Definitionen der Fenster IDs
 #define GUI_WINDOW_HELP "window_help"
@@ -455,24 +461,10 @@ static void gui_renderMenu(ProgContext* ctx, struct nk_context* nk)
 						input->showTess = !input->showTess;
 					}
 
-					static float s_innerSlider = 1.0f;
-					static float s_outerSlider = 1.0f;
-
-					nk_label(nk, "Tess Inner", NK_TEXT_LEFT);
-					if (nk_slider_float(nk, 1.0f, &s_innerSlider, 10.0f, 1.0f))
-					{
-						if (s_tesselation) {
-							input->rendering.tessInner = s_innerSlider;
-						}
-						
-					}
-					nk_label(nk, "Tess Outer", NK_TEXT_LEFT);
-					if (nk_slider_float(nk, 1.0f, &s_outerSlider, 10.0f, 1.0f))
-					{
-						if (s_tesselation) {
-							input->rendering.tessOuter = s_outerSlider;
-						}
-					}
+					// Angestrebte Kantenlänge auf dem Bildschirm, kleinere
+					// Werte unterteilen feiner
+					nk_label(nk, "Pixel pro Kante", NK_TEXT_LEFT);
+					nk_slider_float(nk, 2.0f, &input->rendering.tessEdgePixels, 64.0f, 1.0f);
 					nk_tree_pop(nk);
 				}
 
@@ -504,6 +496,60 @@ static void gui_renderMenu(ProgContext* ctx, struct nk_context* nk)
 				nk_tree_pop(nk);
 			}
 
+			if (nk_tree_push(nk, NK_TREE_TAB, "Beleuchtung", NK_MINIMIZED))
+			{
+				// Verfahren für die Punktlichter
+				nk_layout_row_dynamic(nk, 25, 1);
+				LightingMode mode = input->lightingMode;
+				mode = nk_option_label(nk, "Lichtvolumen (Stencil)", mode == LIGHTING_VOLUMES) ? LIGHTING_VOLUMES : mode;
+				mode = nk_option_label(nk, "Tiled (16x16 Kacheln)", mode == LIGHTING_TILED) ? LIGHTING_TILED : mode;
+				mode = nk_option_label(nk, "Clustered (CPU)", mode == LIGHTING_CLUSTERED) ? LIGHTING_CLUSTERED : mode;
+				input->lightingMode = mode;
+
+				// Aufbau des GBuffers
+				nk_bool compact = input->compactGBuffer;
+				if (nk_checkbox_label(nk, "Kompakter GBuffer", &compact))
+				{
+					input->compactGBuffer = compact;
+				}
+
+				// Lichtpässe mit beiden Aufbauten vergleichen
+				RenderingStats* stats = rendering_getStats(ctx);
+				if (stats->benchmarkRunning)
+				{
+					nk_label(nk, "Benchmark läuft ...", NK_TEXT_LEFT);
+				}
+				else if (nk_button_label(nk, "GBuffer Benchmark"))
+				{
+					input->runGBufferBenchmark = true;
+				}
+
+				char line[64];
+				snprintf(line, sizeof(line), "Voll: %.3f ms", stats->benchmarkFullMs);
+				nk_label(nk, line, NK_TEXT_LEFT);
+				snprintf(line, sizeof(line), "Kompakt: %.3f ms", stats->benchmarkCompactMs);
+				nk_label(nk, line, NK_TEXT_LEFT);
+
+				nk_tree_pop(nk);
+			}
+
+			if (nk_tree_push(nk, NK_TREE_TAB, "Dynamische Auflösung", NK_MINIMIZED))
+			{
+				nk_layout_row_dynamic(nk, 25, 1);
+				nk_bool dynamic = input->dynamicResolution;
+				if (nk_checkbox_label(nk, "Aktiv", &dynamic))
+				{
+					input->dynamicResolution = dynamic;
+				}
+
+				// Ziel-Frametime der GPU und Grenzen des Skalierungsfaktors
+				nk_property_float(nk, "#Ziel (ms):", 1.0f, &input->targetFrameMs, 100.0f, 0.5f, 0.1f);
+				nk_property_float(nk, "#Minimum:", 0.25f, &input->minRenderScale, input->maxRenderScale, 0.05f, 0.01f);
+				nk_property_float(nk, "#Maximum:", input->minRenderScale, &input->maxRenderScale, 1.0f, 0.05f, 0.01f);
+
+				nk_tree_pop(nk);
+			}
+
 			if (nk_tree_push(nk, NK_TREE_TAB, "Shader Auswahl", NK_MINIMIZED))
 			{
 				enum choice { PHONG, DEBUG };
@@ -513,6 +559,20 @@ static void gui_renderMenu(ProgContext* ctx, struct nk_context* nk)
 				s_choice = nk_option_label(nk, "Debug", s_choice == DEBUG) ? DEBUG : s_choice;
 
 				input->shaderChoice = s_choice;
+
+				// Kosten der Uniforms je Draw: per Name und per Kennung
+				nk_layout_row_dynamic(nk, 25, 1);
+				if (nk_button_label(nk, "Uniform Benchmark"))
+				{
+					input->runUniformBenchmark = true;
+				}
+
+				RenderingStats* stats = rendering_getStats(ctx);
+				char line[64];
+				snprintf(line, sizeof(line), "Namen: %.3f us / Draw", stats->uniformNameUs);
+				nk_label(nk, line, NK_TEXT_LEFT);
+				snprintf(line, sizeof(line), "Kennungen: %.3f us / Draw", stats->uniformHandleUs);
+				nk_label(nk, line, NK_TEXT_LEFT);
 				nk_tree_pop(nk);
 			}
 			if (nk_tree_push(nk, NK_TREE_TAB, "Nebel", NK_MINIMIZED))
@@ -546,12 +606,56 @@ static void gui_renderMenu(ProgContext* ctx, struct nk_context* nk)
 					input->rendering.exposure = s_floatExposure;
 				}
 
+				// Automatische Belichtung, der Exposure Wert dient dann als Korrektur
+				nk_bool autoExposure = input->autoExposure;
+				if (nk_checkbox_label(nk, "Auto Exposure", &autoExposure))
+				{
+					input->autoExposure = autoExposure;
+				}
+				nk_property_float(nk, "#Anpassung (1/s):", 0.1f, &input->exposureAdaptation, 10.0f, 0.1f, 0.01f);
+
 				nk_label(nk, "Gamma", NK_TEXT_LEFT);
 				if (nk_slider_float(nk, 0.0f, &s_floatGamma, 10.0f, 0.2f))
 				{
 					input->rendering.gamma = s_floatGamma;
 				}
 
+				// Bloom der hellen Bereiche
+				nk_bool bloom = input->showBloom;
+				if (nk_checkbox_label(nk, "Bloom", &bloom))
+				{
+					input->showBloom = bloom;
+				}
+				nk_property_float(nk, "#Schwelle:", 0.0f, &input->bloomThreshold, 10.0f, 0.1f, 0.01f);
+				nk_property_float(nk, "#Übergang:", 0.0f, &input->bloomKnee, 5.0f, 0.1f, 0.01f);
+				nk_property_float(nk, "#Stärke:", 0.0f, &input->bloomIntensity, 1.0f, 0.01f, 0.005f);
+
+				// Farbkorrektur nach dem Tone Mapping
+				nk_bool grading = input->showGrading;
+				if (nk_checkbox_label(nk, "Farbkorrektur", &grading))
+				{
+					input->showGrading = grading;
+				}
+				nk_property_float(nk, "#Kontrast:", 0.0f, &input->contrast, 3.0f, 0.1f, 0.01f);
+				nk_property_float(nk, "#Sättigung:", 0.0f, &input->saturation, 3.0f, 0.1f, 0.01f);
+
+				// Abdunklung des Bildrands
+				nk_bool vignette = input->showVignette;
+				if (nk_checkbox_label(nk, "Vignette", &vignette))
+				{
+					input->showVignette = vignette;
+				}
+				nk_property_float(nk, "#Vignette:", 0.0f, &input->vignetteStrength, 1.0f, 0.05f, 0.01f);
+
+				// Tiefenunschärfe um die Fokusebene
+				nk_bool depthOfField = input->showDepthOfField;
+				if (nk_checkbox_label(nk, "Tiefenunschärfe", &depthOfField))
+				{
+					input->showDepthOfField = depthOfField;
+				}
+				nk_property_float(nk, "#Fokus:", 0.1f, &input->focusDistance, 200.0f, 0.5f, 0.05f);
+				nk_property_float(nk, "#Blende:", 0.0f, &input->aperture, 4.0f, 0.05f, 0.01f);
+
 				nk_tree_pop(nk);
 			}
 			if (nk_tree_push(nk, NK_TREE_TAB, "Schatten", NK_MINIMIZED))
@@ -560,10 +664,22 @@ static void gui_renderMenu(ProgContext* ctx, struct nk_context* nk)
 				{
 					input->showShadow = !input->showShadow;
 				}
-				nk_property_float(nk, "#Expression:", -1000.0f, &input->expression, 1000.0f, 0.005f, 0.001f);
-				nk_property_float(nk, "#Distance:", -1000.0f, &input->distance, 1000.0f, 0.005f, 0.001f);
-				nk_property_float(nk, "#Near Plane:", -1000.0f, &input->nearPlane, 1000.0f, 0.005f, 0.001f);
-				nk_property_float(nk, "#Far Plane:", -1000.0f, &input->farPlane, 1000.0f, 0.005f, 0.001f);
+				nk_property_int(nk, "#Kaskaden:", 1, &input->shadowCascades, SHADOW_MAX_CASCADES, 1, 1.0f);
+				nk_property_float(nk, "#Reichweite:", 1.0f, &input->shadowDistance, 200.0f, 1.0f, 0.5f);
+
+				// Anteil der logarithmischen Aufteilung der Kaskaden
+				nk_label(nk, "Aufteilung", NK_TEXT_LEFT);
+				nk_slider_float(nk, 0.0f, &input->shadowSplitLambda, 1.0f, 0.01f);
+
+				// Weichzeichnung der Schattenkanten
+				nk_label(nk, "Filter", NK_TEXT_LEFT);
+				ShadowFilter filter = input->shadowFilter;
+				filter = nk_option_label(nk, "Hardware 2x2", filter == SHADOW_FILTER_HARDWARE) ? SHADOW_FILTER_HARDWARE : filter;
+				filter = nk_option_label(nk, "Bilinear 4 Taps", filter == SHADOW_FILTER_BILINEAR4) ? SHADOW_FILTER_BILINEAR4 : filter;
+				filter = nk_option_label(nk, "Poisson 8", filter == SHADOW_FILTER_POISSON8) ? SHADOW_FILTER_POISSON8 : filter;
+				filter = nk_option_label(nk, "Poisson 16", filter == SHADOW_FILTER_POISSON16) ? SHADOW_FILTER_POISSON16 : filter;
+				input->shadowFilter = filter;
+				nk_property_float(nk, "#Radius (Texel):", 0.5f, &input->shadowFilterRadius, 8.0f, 0.25f, 0.05f);
 
 				nk_tree_pop(nk);
 			}
@@ -594,11 +710,78 @@ static void gui_renderStats(ProgContext* ctx, struct nk_context* nk)
 			NK_WINDOW_NO_SCROLLBAR | NK_WINDOW_BACKGROUND |
 			NK_WINDOW_NO_INPUT))
 		{
+			RenderingStats* stats = rendering_getStats(ctx);
+			char line[64];
+
 			// FPS Anzeigen
-			nk_layout_row_dynamic(nk, 25, 1);
-			char fpsString[15];
-			snprintf(fpsString, 14, "FPS: %d", win->fps);
-			nk_label(nk, fpsString, NK_TEXT_LEFT);
+			nk_layout_row_dynamic(nk, STATS_LINE_HEIGHT, 1);
+			snprintf(line, sizeof(line), "FPS: %d", win->fps);
+			nk_label(nk, line, NK_TEXT_LEFT);
+
+			// GPU Zeiten anzeigen
+			snprintf(line, sizeof(line), "GPU Szene: %.2f ms", stats->frameMs);
+			nk_label(nk, line, NK_TEXT_LEFT);
+			snprintf(line, sizeof(line), "Punktlichter: %.2f ms", stats->pointLightMs);
+			nk_label(nk, line, NK_TEXT_LEFT);
+			snprintf(line, sizeof(line), "Richtungslicht: %.2f ms", stats->dirLightMs);
+			nk_label(nk, line, NK_TEXT_LEFT);
+
+			// GPU Zeit der Bloom Kette anzeigen
+			snprintf(line, sizeof(line), "Bloom: %.2f ms", stats->bloomMs);
+			nk_label(nk, line, NK_TEXT_LEFT);
+
+			// GPU Zeit der automatischen Belichtung
+			snprintf(line, sizeof(line), "Auto Exposure: %.2f ms", stats->exposureMs);
+			nk_label(nk, line, NK_TEXT_LEFT);
+
+			// GPU Zeit der Tiefenunschärfe in halber Auflösung
+			snprintf(line, sizeof(line), "Tiefenunschärfe: %.2f ms", stats->dofMs);
+			nk_label(nk, line, NK_TEXT_LEFT);
+
+			// Vollbild-Pässe des PostProcess nach dem Zusammenfassen
+			snprintf(line, sizeof(line), "PostProcess Pässe: %d", stats->postProcessPasses);
+			nk_label(nk, line, NK_TEXT_LEFT);
+
+			// Übersetzte Shader-Varianten der Materialien
+			snprintf(line, sizeof(line), "Shader Varianten: %d", stats->modelVariants);
+			nk_label(nk, line, NK_TEXT_LEFT);
+
+			// Faktor der dynamischen Auflösung anzeigen
+			snprintf(line, sizeof(line), "Auflösung: %d %%", (int)(stats->renderScale * 100.0f + 0.5f));
+			nk_label(nk, line, NK_TEXT_LEFT);
+
+			// Neuanlagen des GBuffers, z.B. beim Ändern der Fenstergröße
+			snprintf(line, sizeof(line), "GBuffer Allokationen: %d", stats->gbufferAllocations);
+			nk_label(nk, line, NK_TEXT_LEFT);
+
+			// Gerenderte und aus dem Cache genutzte Schattenkaskaden
+			snprintf(line, sizeof(line), "Schatten: %u neu / %u Cache", stats->shadowRendered, stats->shadowSkipped);
+			nk_label(nk, line, NK_TEXT_LEFT);
+
+			// Punktlichter, die Schatten werfen
+			snprintf(line, sizeof(line), "Punktschatten: %u", stats->pointShadowCount);
+			nk_label(nk, line, NK_TEXT_LEFT);
+
+			// CPU Zeit der Lichtzuordnung anzeigen
+			snprintf(line, sizeof(line), "Cluster (CPU): %.2f ms", stats->clusterMs);
+			nk_label(nk, line, NK_TEXT_LEFT);
+
+			// Punktlichter, die nicht in die Kachelmasken passen
+			snprintf(line, sizeof(line), "Tiled Überlauf: %u Lichter", stats->tiledOverflowLights);
+			nk_label(nk, line, NK_TEXT_LEFT);
+
+			// Zustandswechsel des Renderers, redundante wurden übersprungen
+			snprintf(line, sizeof(line), "GL Zustand: %u / %u redundant", stats->glStateIssued, stats->glStateSkipped);
+			nk_label(nk, line, NK_TEXT_LEFT);
+
+			// Draws des Geometry Pass mit Shader- und Materialwechseln
+			snprintf(line, sizeof(line), "Queue: %u / %u Shader / %u Mat.", stats->queueItems, stats->queueProgramChanges, stats->queueMaterialChanges);
+			nk_label(nk, line, NK_TEXT_LEFT);
+
+			// Draw Calls des Geometry Pass, mit Multi Draw Indirect einer je Folge
+			snprintf(line, sizeof(line), "Draw Calls: %u (%s)", stats->queueDrawCalls,
+				geometrypool_supportsMultiDraw() ? "MDI" : "BaseVertex");
+			nk_label(nk, line, NK_TEXT_LEFT);
 		}
 		nk_end(nk);
 	}
@@ -653,6 +836,9 @@ void gui_render(ProgContext* ctx)
 		MAX_ELEMENT_BUFFER
 	);
 	common_popRenderScope();
+
+	// Nuklear setzt den OpenGL Zustand an glstate vorbei.
+	glstate_invalidate();
 }
 
 void gui_cleanup(ProgContext* ctx)
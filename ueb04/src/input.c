@@ -33,6 +33,22 @@ void input_init(ProgContext* ctx)
     //Shaderauswahl
     data->shaderChoice = 0;
 
+    //Verfahren fuer die Punktlichter
+    data->lightingMode = LIGHTING_TILED;
+
+    //Aufbau des GBuffers
+    data->compactGBuffer = true;
+    data->runGBufferBenchmark = false;
+
+    //Uniforms per Name und per Kennung vergleichen
+    data->runUniformBenchmark = false;
+
+    //Dynamische Aufloesung: Ziel-Frametime in ms und Grenzen des Faktors
+    data->dynamicResolution = true;
+    data->targetFrameMs = 1000.0f / 60.0f;
+    data->minRenderScale = 0.5f;
+    data->maxRenderScale = 1.0f;
+
     //Nebel anzeigen
     data->showFog = false;
 
@@ -91,8 +107,7 @@ void input_init(ProgContext* ctx)
 
     //Tesselation anzeigen und veraendern
     data->showTess = true;
-    data->rendering.tessInner = 1.0f;
-    data->rendering.tessOuter = 1.0f;
+    data->rendering.tessEdgePixels = 8.0f;
 
     //Exposure fuer Tone Mapping
     data->rendering.exposure = 0.95f;
@@ -100,16 +115,35 @@ void input_init(ProgContext* ctx)
     //Gammakorrekturwert
     data->rendering.gamma = 0.8f;
 
-    //Distanz vom Licht richtungvektor
-    data->distance = 2.0f;
-
-    //Distanz vom Licht richtungvektor
-    data->nearPlane = 0.01f;
-
-    //Distanz vom Licht richtungvektor
-    data->farPlane = 120.0f;
-    //Distanz vom Licht richtungvektor
-    data->expression = 10.0f;
+    //Bloom: Schwelle, weicher Uebergang und Staerke
+    data->showBloom = true;
+    data->bloomThreshold = 1.0f;
+    data->bloomKnee = 0.5f;
+    data->bloomIntensity = 0.08f;
+
+    //Farbkorrektur und Vignette im PostProcess
+    data->showGrading = false;
+    data->contrast = 1.0f;
+    data->saturation = 1.0f;
+    data->showVignette = false;
+    data->vignetteStrength = 0.5f;
+
+    //Automatische Belichtung: Geschwindigkeit der Anpassung pro Sekunde
+    data->autoExposure = true;
+    data->exposureAdaptation = 1.5f;
+
+    //Tiefenunschaerfe: Abstand der Fokusebene und Staerke
+    data->showDepthOfField = false;
+    data->focusDistance = 10.0f;
+    data->aperture = 0.5f;
+
+    //Kaskaden der Schatten: Anzahl, Reichweite und logarithmischer Anteil
+    //der Aufteilung
+    data->shadowCascades = 4;
+    data->shadowDistance = 60.0f;
+    data->shadowSplitLambda = 0.75f;
+    data->shadowFilter = SHADOW_FILTER_BILINEAR4;
+    data->shadowFilterRadius = 1.5f;
 
     // Kamera initialisieren
     data->mainCamera = camera_createCamera();
@@ -285,6 +319,9 @@ void input_userSelectedFile(ProgContext* ctx, const char* path)
         }
 
         ctx->input->rendering.userScene = newScene;
+
+        // Zeigt dem Renderer an, dass sich die Szene geändert hat.
+        ctx->input->rendering.sceneVersion++;
 }
 
 void input_cleanup(ProgContext* ctx)
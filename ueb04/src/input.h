@@ -16,6 +16,22 @@
 
 //////////////////////////// ÖFFENTLICHE DATENTYPEN ////////////////////////////
 
+// Verfahren, mit dem die Punktlichter berechnet werden.
+typedef enum {
+    LIGHTING_VOLUMES,       // Eine Kugel je Punktlicht mit Stencil-Maske
+    LIGHTING_TILED,         // Tiled Deferred mit Lichtmasken je Kachel
+    LIGHTING_CLUSTERED,     // Clustered Deferred mit Zuordnung auf der CPU
+} LightingMode;
+
+// PCF Kernel für die Schatten des Richtungslichts. Die Werte müssen mit
+// dirLight.frag übereinstimmen.
+typedef enum {
+    SHADOW_FILTER_HARDWARE,  // Ein Zugriff, 2x2 Vergleiche der Hardware
+    SHADOW_FILTER_BILINEAR4, // Vier Zugriffe mit Zeltgewichtung
+    SHADOW_FILTER_POISSON8,  // Acht gedrehte Poisson Zugriffe
+    SHADOW_FILTER_POISSON16, // 16 gedrehte Poisson Zugriffe
+} ShadowFilter;
+
 // Datenstruktur, die die Zustände des Programms enthält,
 // die durch Benutzereingaben direkt beeinfluss werden können.
 struct InputData
@@ -28,15 +44,38 @@ struct InputData
     bool showShadow;
     bool reloadShader;
     int shaderChoice;
+    LightingMode lightingMode;
+    bool compactGBuffer;
+    bool runGBufferBenchmark;
+    bool runUniformBenchmark;
+    bool dynamicResolution;
+    float targetFrameMs;
+    float minRenderScale;
+    float maxRenderScale;
     bool showTess;
     bool showFog;
+    bool showBloom;
+    float bloomThreshold;
+    float bloomKnee;
+    float bloomIntensity;
+    bool showGrading;
+    float contrast;
+    float saturation;
+    bool showVignette;
+    float vignetteStrength;
+    bool autoExposure;
+    float exposureAdaptation;
+    bool showDepthOfField;
+    float focusDistance;
+    float aperture;
     bool showNormalMap;
     bool showRotation;
     float density;
-    float distance;
-    float nearPlane;
-    float farPlane;
-    float expression;
+    int shadowCascades;
+    float shadowDistance;
+    float shadowSplitLambda;
+    ShadowFilter shadowFilter;
+    float shadowFilterRadius;
 
     struct {
         vec4 clearColor;
@@ -45,11 +84,11 @@ struct InputData
         vec4 lightColor;
         vec4 lightDir;
         Scene* userScene;
+        unsigned int sceneVersion;
         vec3 translate;
         vec3 rotate;
         vec3 scale;
-        float tessInner;
-        float tessOuter;
+        float tessEdgePixels;
         float exposure;
         float gamma;
     } rendering;
@@ -26,6 +26,7 @@
  *      float constant;
  *      float linear;
  *      float quadratic;
+ *      float radius;
  * };
  * 
  * uniform PointLight pointLight;
@@ -36,6 +37,12 @@
 
 #include "light.h"
 
+#include <float.h>
+#include <math.h>
+#include <string.h>
+
+#include "glstate.h"
+
 ////////////////////////////////// KONSTANTEN //////////////////////////////////
 
 #define AMBIENT_FACTOR 0.2f
@@ -46,6 +53,59 @@
 #define DEFAULT_LINEAR 0.14f
 #define DEFAULT_QUADRATIC 0.07f
 
+// Helligkeit, unterhalb derer ein Punktlicht als nicht mehr sichtbar gilt.
+// Entspricht 5/256 der maximalen Helligkeit des Lichtes.
+#define RADIUS_THRESHOLD (5.0f / 256.0f)
+
+////////////////////////////// LOKALE DATENTYPEN ///////////////////////////////
+
+// Datenstruktur für einen LightBuffer.
+struct LightBuffer
+{
+    GLuint buffer;
+    GLuint texture;
+
+    // Zwischenspeicher für das Hochladen, wird nur bei Bedarf vergrößert.
+    float* data;
+    unsigned int capacity;
+};
+
+////////////////////////////// LOKALE FUNKTIONEN ///////////////////////////////
+
+/**
+ * Berechnet den Radius eines Punktlichtes aus seiner Abschwächung. Dazu wird
+ * 1 / (c + l * d + q * d^2) = RADIUS_THRESHOLD / maxHelligkeit nach d
+ * aufgelöst.
+ * 
+ * @param light das Licht, dessen Radius bestimmt werden soll
+ * @return der Radius des Lichtes
+ */
+static float light_calcRadius(PointLight* light)
+{
+    float brightness = glm_vec3_max(light->color);
+    float target = brightness / RADIUS_THRESHOLD;
+
+    // Ohne quadratischen Anteil bleibt eine lineare Gleichung übrig.
+    if (light->quadratic <= 0.0f)
+    {
+        if (light->linear <= 0.0f)
+        {
+            return FLT_MAX;
+        }
+        return fmaxf((target - light->constant) / light->linear, 0.0f);
+    }
+
+    float discriminant = light->linear * light->linear 
+                       - 4.0f * light->quadratic * (light->constant - target);
+    if (discriminant <= 0.0f)
+    {
+        return 0.0f;
+    }
+
+    return fmaxf((-light->linear + sqrtf(discriminant)) 
+                 / (2.0f * light->quadratic), 0.0f);
+}
+
 //////////////////////////// ÖFFENTLICHE FUNKTIONEN ////////////////////////////
 
 DirLight* light_createDirLight(vec3 dir, vec3 color)
@@ -87,6 +147,10 @@ PointLight* light_createPointLightEx(vec3 pos, vec3 color, float constant,
     light->constant = constant;
     light->linear = linear;
     light->quadratic = quadratic;
+    light->radius = light_calcRadius(light);
+
+    light->castShadow = false;
+    light->shadowSlot = -1;
 
     return light;
 }
@@ -101,15 +165,36 @@ void light_activateDirLight(DirLight* light, Shader* shader)
 
 void light_activatePointLight(PointLight* light, Shader* shader)
 {
-    shader_setVec3(shader, "pointLight.pos", &light->position);
-    shader_setVec3(shader, "pointLight.color", &light->color);
-    shader_setVec3(shader, "pointLight.amb", &light->ambient);
-    shader_setVec3(shader, "pointLight.diff", &light->diffuse);
-    shader_setVec3(shader, "pointLight.spec", &light->specular);
-
-    shader_setFloat(shader, "pointLight.constant", light->constant);
-    shader_setFloat(shader, "pointLight.linear", light->linear);
-    shader_setFloat(shader, "pointLight.quadratic", light->quadratic);
+    // Wird für jedes Licht aufgerufen, daher über Kennungen statt Namen.
+    static bool registered = false;
+    static ShaderUniform pos, color, amb, diff, spec;
+    static ShaderUniform constant, linear, quadratic, radius, shadowSlot;
+    if (!registered)
+    {
+        pos = shader_getUniform("pointLight.pos");
+        color = shader_getUniform("pointLight.color");
+        amb = shader_getUniform("pointLight.amb");
+        diff = shader_getUniform("pointLight.diff");
+        spec = shader_getUniform("pointLight.spec");
+        constant = shader_getUniform("pointLight.constant");
+        linear = shader_getUniform("pointLight.linear");
+        quadratic = shader_getUniform("pointLight.quadratic");
+        radius = shader_getUniform("pointLight.radius");
+        shadowSlot = shader_getUniform("pointLight.shadowSlot");
+        registered = true;
+    }
+
+    shader_setVec3ByHandle(shader, pos, &light->position);
+    shader_setVec3ByHandle(shader, color, &light->color);
+    shader_setVec3ByHandle(shader, amb, &light->ambient);
+    shader_setVec3ByHandle(shader, diff, &light->diffuse);
+    shader_setVec3ByHandle(shader, spec, &light->specular);
+
+    shader_setFloatByHandle(shader, constant, light->constant);
+    shader_setFloatByHandle(shader, linear, light->linear);
+    shader_setFloatByHandle(shader, quadratic, light->quadratic);
+    shader_setFloatByHandle(shader, radius, light->radius);
+    shader_setIntByHandle(shader, shadowSlot, light->shadowSlot);
 }
 
 void light_deleteDirLight(DirLight* light)
@@ -123,3 +208,87 @@ void light_deletePointLight(PointLight* light)
     // Aktuell ist kein Cleanup nötig.
     free(light);
 }
+
+LightBuffer* light_createLightBuffer(void)
+{
+    LightBuffer* buffer = malloc(sizeof(LightBuffer));
+    memset(buffer, 0, sizeof(LightBuffer));
+
+    // Der Buffer wird mit Platz für ein Licht angelegt, damit der 
+    // Texture Buffer nie auf einen leeren Speicher zeigt.
+    float empty[LIGHT_BUFFER_TEXELS * 4] = { 0.0f };
+    glGenBuffers(1, &buffer->buffer);
+    glBindBuffer(GL_TEXTURE_BUFFER, buffer->buffer);
+    glBufferData(GL_TEXTURE_BUFFER, sizeof(empty), empty, GL_STREAM_DRAW);
+    common_labelObjectByType(GL_BUFFER, buffer->buffer, "Point Lights");
+
+    glGenTextures(1, &buffer->texture);
+    glstate_bindTexture(GL_TEXTURE_BUFFER, buffer->texture);
+    glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F, buffer->buffer);
+    common_labelObjectByType(GL_TEXTURE, buffer->texture, "Point Lights");
+
+    glstate_bindTexture(GL_TEXTURE_BUFFER, 0);
+    glBindBuffer(GL_TEXTURE_BUFFER, 0);
+
+    return buffer;
+}
+
+void light_updateLightBuffer(LightBuffer* buffer, PointLight** lights, 
+                             unsigned int count)
+{
+    if (count == 0)
+    {
+        return;
+    }
+
+    if (count > buffer->capacity)
+    {
+        buffer->capacity = count;
+        buffer->data = realloc(buffer->data, 
+            sizeof(float) * 4 * LIGHT_BUFFER_TEXELS * buffer->capacity);
+    }
+
+    // Die Lichter in das im Dateikopf beschriebene Format bringen.
+    for (unsigned int i = 0; i < count; i++)
+    {
+        PointLight* light = lights[i];
+        float* texel = buffer->data + i * LIGHT_BUFFER_TEXELS * 4;
+
+        glm_vec3_copy(light->position, texel);
+        texel[3] = light->radius;
+        glm_vec3_copy(light->color, texel + 4);
+        texel[7] = light->constant;
+        glm_vec3_copy(light->ambient, texel + 8);
+        texel[11] = light->linear;
+        glm_vec3_copy(light->diffuse, texel + 12);
+        texel[15] = light->quadratic;
+        glm_vec3_copy(light->specular, texel + 16);
+        texel[19] = (float)light->shadowSlot;
+    }
+
+    // Der alte Inhalt wird verworfen, damit der Treiber nicht auf die
+    // Verwendung im letzten Frame warten muss.
+    GLsizeiptr size = sizeof(float) * 4 * LIGHT_BUFFER_TEXELS * count;
+    glBindBuffer(GL_TEXTURE_BUFFER, buffer->buffer);
+    glBufferData(GL_TEXTURE_BUFFER, size, buffer->data, GL_STREAM_DRAW);
+    glBindBuffer(GL_TEXTURE_BUFFER, 0);
+}
+
+void light_bindLightBuffer(LightBuffer* buffer, GLenum textureUnit)
+{
+    glstate_activeTexture(textureUnit);
+    glstate_bindTexture(GL_TEXTURE_BUFFER, buffer->texture);
+}
+
+void light_deleteLightBuffer(LightBuffer* buffer)
+{
+    if (!buffer)
+    {
+        return;
+    }
+
+    glstate_deleteTextures(1, &buffer->texture);
+    glDeleteBuffers(1, &buffer->buffer);
+    free(buffer->data);
+    free(buffer);
+}
@@ -26,10 +26,22 @@
  *      float constant;
  *      float linear;
  *      float quadratic;
+ *      float radius;
+ *      int shadowSlot;
  * };
  * 
  * uniform PointLight pointLight;
  * 
+ * Sollen viele Punktlichter in einem einzigen Pass berechnet werden, können
+ * sie über einen LightBuffer als Texture Buffer (samplerBuffer, RGBA32F)
+ * übergeben werden. Je Licht werden LIGHT_BUFFER_TEXELS Texel belegt:
+ * 
+ *      Texel 0: pos.xyz,  radius
+ *      Texel 1: color.rgb, constant
+ *      Texel 2: amb.rgb,   linear
+ *      Texel 3: diff.rgb,  quadratic
+ *      Texel 4: spec.rgb,  shadowSlot (-1 = kein Schatten)
+ * 
  * Copyright (C) 2020, FH Wedel
  * Autor: Nicolas Hollmann
  */
@@ -61,6 +73,11 @@
 #include "common.h"
 #include "shader.h"
 
+////////////////////////////////// KONSTANTEN //////////////////////////////////
+
+// Anzahl der RGBA32F Texel, die ein Punktlicht im LightBuffer belegt.
+#define LIGHT_BUFFER_TEXELS 5
+
 //////////////////////////// ÖFFENTLICHE DATENTYPEN ////////////////////////////
 
 // Ein Richtungslicht.
@@ -87,9 +104,21 @@ struct PointLight
     float constant;
     float linear;
     float quadratic;
+
+    // Abstand, ab dem der Beitrag des Lichtes vernachlässigbar ist.
+    float radius;
+
+    // Gibt an, ob das Licht laut Szene Schatten werfen soll.
+    bool castShadow;
+    // Schicht im Cube Map Array der Punktschatten oder -1 (siehe shadow.h).
+    int shadowSlot;
 };
 typedef struct PointLight PointLight;
 
+// Ein Texture Buffer, der die Daten mehrerer Punktlichter enthält.
+struct LightBuffer;
+typedef struct LightBuffer LightBuffer;
+
 //////////////////////////// ÖFFENTLICHE FUNKTIONEN ////////////////////////////
 
 /**
@@ -159,4 +188,37 @@ void light_deleteDirLight(DirLight* light);
  */
 void light_deletePointLight(PointLight* light);
 
+/**
+ * Erzeugt einen neuen, leeren LightBuffer.
+ * 
+ * @return der neue LightBuffer
+ */
+LightBuffer* light_createLightBuffer(void);
+
+/**
+ * Lädt die übergebenen Punktlichter in den LightBuffer hoch.
+ * Für den Aufbau siehe den Dateikopf.
+ * 
+ * @param buffer der LightBuffer
+ * @param lights die Punktlichter
+ * @param count die Anzahl der Punktlichter
+ */
+void light_updateLightBuffer(LightBuffer* buffer, PointLight** lights, 
+                             unsigned int count);
+
+/**
+ * Bindet den LightBuffer als samplerBuffer an die angegebene Textureinheit.
+ * 
+ * @param buffer der LightBuffer
+ * @param textureUnit die Textureinheit (GL_TEXTURE0, ...)
+ */
+void light_bindLightBuffer(LightBuffer* buffer, GLenum textureUnit);
+
+/**
+ * Löscht einen LightBuffer.
+ * 
+ * @param buffer der zu löschende LightBuffer
+ */
+void light_deleteLightBuffer(LightBuffer* buffer);
+
 #endif // LIGHT_H
@@ -9,6 +9,11 @@
 
 #include "material.h"
 
+#include <string.h>
+
+#include <sesp/stb_ds.h>
+
+#include "glstate.h"
 #include "texture.h"
 
 ////////////////////////////// LOKALE DATENTYPEN ///////////////////////////////
@@ -33,10 +38,94 @@ struct Material
 
     bool useEmissionMap;
     GLuint emissionMap;
+
+    // Nummer für die Render Queue, gleiche Materialien teilen sie
+    unsigned int id;
+};
+
+// Kennungen der Uniforms eines Materials (siehe shader_getUniform).
+struct MaterialUniforms
+{
+    bool registered;
+
+    ShaderUniform ambient;
+    ShaderUniform diffuse;
+    ShaderUniform specular;
+    ShaderUniform emission;
+    ShaderUniform shininess;
+
+    ShaderUniform diffuseMap;
+    ShaderUniform specularMap;
+    ShaderUniform normalMap;
+    ShaderUniform emissionMap;
 };
 
+// Werden beim ersten Aktivieren eines Materials angemeldet.
+static struct MaterialUniforms materialUniforms = { false };
+
+// Dynamisches Array (stb_ds) aller bestehenden Materialien. AssImp liefert
+// für jedes Mesh ein eigenes Material, auch wenn mehrere Meshes dasselbe
+// nutzen. Über diese Liste erhalten solche Kopien dieselbe Nummer.
+static Material** materialRegistry = NULL;
+
+// Nummer des nächsten neuen Materials, 0 bleibt frei
+static unsigned int materialNextId = 1;
+
 ////////////////////////////// LOKALE FUNKTIONEN ///////////////////////////////
 
+/**
+ * Prüft, ob zwei Materialien beim Aktivieren dieselben Uniforms und Texturen
+ * setzen würden.
+ * 
+ * @param a das erste Material
+ * @param b das zweite Material
+ * @return true, wenn die Materialien gleich sind
+ */
+static bool material_equals(Material* a, Material* b)
+{
+    #define MATERIAL_EQUAL_TEX(use, map)                                       \
+        (a->use == b->use && (!a->use || a->map == b->map))
+
+    return memcmp(a->ambient, b->ambient, sizeof(vec3)) == 0
+        && memcmp(a->diffuse, b->diffuse, sizeof(vec3)) == 0
+        && memcmp(a->specular, b->specular, sizeof(vec3)) == 0
+        && memcmp(a->emission, b->emission, sizeof(vec3)) == 0
+        && a->shininess == b->shininess
+        && MATERIAL_EQUAL_TEX(useDiffuseMap, diffuseMap)
+        && MATERIAL_EQUAL_TEX(useNormalMap, normalMap)
+        && MATERIAL_EQUAL_TEX(useSpecularMap, specularMap)
+        && MATERIAL_EQUAL_TEX(useEmissionMap, emissionMap);
+
+    #undef MATERIAL_EQUAL_TEX
+}
+
+/**
+ * Vergibt die Nummer eines fertig angelegten Materials und trägt es in die
+ * Liste ein. Texturen werden über ihren Dateinamen wiederverwendet, daher
+ * lassen sich Kopien über die Texturnamen erkennen.
+ * 
+ * @param mat das neue Material
+ */
+static void material_registerMaterial(Material* mat)
+{
+    mat->id = 0;
+    for (ptrdiff_t i = 0; i < stbds_arrlen(materialRegistry); i++)
+    {
+        if (material_equals(mat, materialRegistry[i]))
+        {
+            mat->id = materialRegistry[i]->id;
+            break;
+        }
+    }
+
+    if (mat->id == 0)
+    {
+        mat->id = materialNextId++;
+    }
+
+    stbds_arrput(materialRegistry, mat);
+}
+
 /**
  * Lädt eine Textur aus AssImp in den Speicher.
  * 
@@ -123,6 +212,8 @@ Material* material_createMaterialFromMaps(vec3 ambient, vec3 diffuse,
 
     #undef MATERIAL_LOAD_TEX
 
+    material_registerMaterial(mat);
+
     return mat;
 }
 
@@ -187,6 +278,8 @@ Material* material_createMaterialFromAI(struct aiMaterial* aiMat,
 
     #undef MATERIAL_LOAD_AI_TEX
 
+    material_registerMaterial(mat);
+
     return mat;
 }
 
@@ -195,9 +288,30 @@ void material_useMaterial(Shader* shader, Material* mat)
     // Zuerst müssen wir den Shader aktivieren.
     shader_useShader(shader);
 
+    // Die Namen werden nur einmal in Kennungen übersetzt, danach kostet jedes
+    // Uniform nur noch einen Zugriff auf ein Array.
+    if (!materialUniforms.registered)
+    {
+        #define MATERIAL_REGISTER(term)                                        \
+            materialUniforms.term = shader_getUniform("u_material." #term)
+
+        MATERIAL_REGISTER(ambient);
+        MATERIAL_REGISTER(diffuse);
+        MATERIAL_REGISTER(specular);
+        MATERIAL_REGISTER(emission);
+        MATERIAL_REGISTER(shininess);
+        MATERIAL_REGISTER(diffuseMap);
+        MATERIAL_REGISTER(specularMap);
+        MATERIAL_REGISTER(normalMap);
+        MATERIAL_REGISTER(emissionMap);
+
+        #undef MATERIAL_REGISTER
+        materialUniforms.registered = true;
+    }
+
     // Danach übertragen wir die Materialeigenschaften mit dem folgenden Makro.
     #define MATERIAL_SET_VEC3(term) {                                          \
-        shader_setVec3(shader, "u_material." #term, &mat->term);                 \
+        shader_setVec3ByHandle(shader, materialUniforms.term, &mat->term);     \
     }
 
     MATERIAL_SET_VEC3(ambient);
@@ -208,16 +322,17 @@ void material_useMaterial(Shader* shader, Material* mat)
     #undef MATERIAL_SET_VEC3
     
     // Shininess & dispFactor werden als einzelne Floats übergeben.
-    shader_setFloat(shader, "u_material.shininess", mat->shininess);
+    shader_setFloatByHandle(shader, materialUniforms.shininess, mat->shininess);
 
     // Als nächstes setzen wir die Texturen über das folgende Makro.
+    // Ob eine Textur genutzt wird, steckt bereits in der Variante des
+    // Shaders (siehe material_getFeatures).
     #define MATERIAL_SET_TEX(idx, use, map) {                                  \
-        shader_setBool(shader, "u_material." #use, mat->use);                    \
         if (mat->use)                                                          \
         {                                                                      \
-            glActiveTexture(GL_TEXTURE ## idx);                                \
-            glBindTexture(GL_TEXTURE_2D, mat->map);                            \
-            shader_setInt(shader, "u_material." #map, idx);                      \
+            glstate_activeTexture(GL_TEXTURE ## idx);                                \
+            glstate_bindTexture(GL_TEXTURE_2D, mat->map);                            \
+            shader_setIntByHandle(shader, materialUniforms.map, idx);          \
         }                                                                      \
     }
 
@@ -229,6 +344,21 @@ void material_useMaterial(Shader* shader, Material* mat)
     #undef MATERIAL_SET_TEX
 }
 
+unsigned int material_getFeatures(Material* mat)
+{
+    unsigned int features = 0;
+    features |= mat->useDiffuseMap ? MATERIAL_FEATURE_DIFFUSE_MAP : 0;
+    features |= mat->useSpecularMap ? MATERIAL_FEATURE_SPECULAR_MAP : 0;
+    features |= mat->useNormalMap ? MATERIAL_FEATURE_NORMAL_MAP : 0;
+    features |= mat->useEmissionMap ? MATERIAL_FEATURE_EMISSION_MAP : 0;
+    return features;
+}
+
+unsigned int material_getId(Material* mat)
+{
+    return mat->id;
+}
+
 void material_deleteMaterial(Material* mat)
 {
     // Material nur löschen, wenn es existiert.
@@ -248,5 +378,14 @@ void material_deleteMaterial(Material* mat)
 
     #undef MATERIAL_DELETE_TEX
 
+    for (ptrdiff_t i = 0; i < stbds_arrlen(materialRegistry); i++)
+    {
+        if (materialRegistry[i] == mat)
+        {
+            stbds_arrdelswap(materialRegistry, i);
+            break;
+        }
+    }
+
     free(mat);
 }
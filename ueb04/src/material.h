@@ -24,6 +24,17 @@
 #define MATERIAL_DEFAULT_SHININESS 2
 #define MATERIAL_DEFAULT_EMISSION (vec3){0,0,0}
 
+// Bits der Feature-Maske eines Materials für die Shader-Varianten
+#define MATERIAL_FEATURE_DIFFUSE_MAP (1u << 0)
+#define MATERIAL_FEATURE_SPECULAR_MAP (1u << 1)
+#define MATERIAL_FEATURE_NORMAL_MAP (1u << 2)
+#define MATERIAL_FEATURE_EMISSION_MAP (1u << 3)
+#define MATERIAL_FEATURE_COUNT 4
+
+// Namen der zugehörigen Definitionen im Shader in der Reihenfolge der Bits
+#define MATERIAL_FEATURE_DEFINES \
+    "USE_DIFFUSE_MAP", "USE_SPECULAR_MAP", "USE_NORMAL_MAP", "USE_EMISSION_MAP"
+
 //////////////////////////// ÖFFENTLICHE DATENTYPEN ////////////////////////////
 
 // Datenstruktur für die Repräsentation eines Materials.
@@ -83,6 +94,24 @@ Material* material_createMaterialFromAI(struct aiMaterial* aiMat,
  */
 void material_useMaterial(Shader* shader, Material* mat);
 
+/**
+ * Liefert die Feature-Maske eines Materials, also welche Texturen es nutzt.
+ * 
+ * @param mat das Material
+ * @return die Maske aus MATERIAL_FEATURE_* Bits
+ */
+unsigned int material_getFeatures(Material* mat);
+
+/**
+ * Liefert die Nummer eines Materials. Materialien mit denselben Farben und
+ * Texturen haben dieselbe Nummer, so kann die Render Queue sie
+ * zusammenfassen. Die Nummer ist immer größer 0.
+ * 
+ * @param mat das Material
+ * @return die Nummer des Materials
+ */
+unsigned int material_getId(Material* mat);
+
 /**
  * Löscht ein Material.
  * 
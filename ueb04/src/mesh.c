@@ -8,6 +8,9 @@
  */
 
 #include "mesh.h"
+
+#include <float.h>
+
 #include "input.h"
 
  ////////////////////////////// LOKALE DATENTYPEN ///////////////////////////////
@@ -21,17 +24,20 @@ struct Mesh
 	GLint* indices;
 	GLuint indexCount;
 
-	GLuint vao; // Vertex Array Object
-	GLuint vbo; // Vertex Buffer Object
-	GLuint ebo; // Element Buffer Object
+	// Gemeinsame Buffer des Modells und Nummer des eigenen Draw Befehls
+	GeometryPool* pool;
+	int drawIndex;
 
 	Material* material;
+
+	// Mittelpunkt der Bounding Box im Modellraum
+	vec3 center;
 };
 
 //////////////////////////// ÖFFENTLICHE FUNKTIONEN ////////////////////////////
 
 Mesh* mesh_createMesh(Vertex* vertices, GLuint vertexCount,
-	GLint* indices, GLuint indexCount, Material* material)
+	GLint* indices, GLuint indexCount, Material* material, GeometryPool* pool)
 {
 	// Zuerst wird der Speicher reserviert.
 	Mesh* mesh = malloc(sizeof(Mesh));
@@ -47,86 +53,28 @@ Mesh* mesh_createMesh(Vertex* vertices, GLuint vertexCount,
 	// Außerdem übernehmen wir das Material.
 	mesh->material = material;
 
-	// Dann legen wir die benötigten Buffer und Objekte an.
-	glGenVertexArrays(1, &mesh->vao);
-	glGenBuffers(1, &mesh->vbo);
-	glGenBuffers(1, &mesh->ebo);
-
-	// Ab jetzt binden wir das VAO.
-	glBindVertexArray(mesh->vao);
-
-	// Die folgenden Befehle übertragen die Vertexdaten an OpenGL.
-	glBindBuffer(GL_ARRAY_BUFFER, mesh->vbo);
-	glBufferData(
-		GL_ARRAY_BUFFER,
-		mesh->vertexCount * sizeof(Vertex),
-		&mesh->vertices[0],
-		GL_STATIC_DRAW
-	);
-
-	// Und diese Befehle legen die Indicies fest.
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh->ebo);
-	glBufferData(
-		GL_ELEMENT_ARRAY_BUFFER,
-		mesh->indexCount * sizeof(GLint),
-		&mesh->indices[0],
-		GL_STATIC_DRAW
-	);
-
-	// Vertex Position
-	glEnableVertexAttribArray(0);
-	glVertexAttribPointer(
-		0,                                  // Die Attribut-Position
-		3,                                  // Anzahl der Komponenten
-		GL_FLOAT,                           // Datentyp der Komponenten
-		GL_FALSE,                           // Normalisierung der Daten
-		sizeof(Vertex),                     // Größe eines Datensatzes/Vertex
-		(void*)offsetof(Vertex, position)  // Offset der Daten in einem Vertex
-	);
-
-	// Vertex Normal
-	glEnableVertexAttribArray(1);
-	glVertexAttribPointer(
-		1,                                  // Die Attribut-Position
-		3,                                  // Anzahl der Komponenten
-		GL_FLOAT,                           // Datentyp der Komponenten
-		GL_FALSE,                           // Normalisierung der Daten
-		sizeof(Vertex),                     // Größe eines Datensatzes/Vertex
-		(void*)offsetof(Vertex, normal)    // Offset der Daten in einem Vertex
-	);
-
-	// Vertex Texturkoordinaten
-	glEnableVertexAttribArray(3);
-	glVertexAttribPointer(
-		3,                                  // Die Attribut-Position
-		2,                                  // Anzahl der Komponenten
-		GL_FLOAT,                           // Datentyp der Komponenten
-		GL_FALSE,                           // Normalisierung der Daten
-		sizeof(Vertex),                     // Größe eines Datensatzes/Vertex
-		(void*)offsetof(Vertex, texCoord)  // Offset der Daten in einem Vertex
-	);
-
-	// Vertex Texturkoordinaten
-	glEnableVertexAttribArray(4);
-	glVertexAttribPointer(
-		4,                                  // Die Attribut-Position
-		3,                                  // Anzahl der Komponenten
-		GL_FLOAT,                           // Datentyp der Komponenten
-		GL_FALSE,                           // Normalisierung der Daten
-		sizeof(Vertex),                     // Größe eines Datensatzes/Vertex
-		(void*)offsetof(Vertex, tangent)    // Offset der Daten in einem Vertex
-	);
-
-	// Vertex Texturkoordinaten
-	glEnableVertexAttribArray(5);
-	glVertexAttribPointer(
-		5,                                  // Die Attribut-Position
-		3,                                  // Anzahl der Komponenten
-		GL_FLOAT,                           // Datentyp der Komponenten
-		GL_FALSE,                           // Normalisierung der Daten
-		sizeof(Vertex),                     // Größe eines Datensatzes/Vertex
-		(void*)offsetof(Vertex, biTangent)    // Offset der Daten in einem Vertex
-	);
+	// Der Mittelpunkt der Bounding Box dient der Render Queue als Tiefe.
+	vec3 minPos = { FLT_MAX, FLT_MAX, FLT_MAX };
+	vec3 maxPos = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+	for (GLuint i = 0; i < vertexCount; i++)
+	{
+		glm_vec3_minv(minPos, vertices[i].position, minPos);
+		glm_vec3_maxv(maxPos, vertices[i].position, maxPos);
+	}
+	if (vertexCount > 0)
+	{
+		glm_vec3_add(minPos, maxPos, mesh->center);
+		glm_vec3_scale(mesh->center, 0.5f, mesh->center);
+	}
+	else
+	{
+		glm_vec3_zero(mesh->center);
+	}
+
+	// Die Geometrie landet in den gemeinsamen Buffern des Modells.
+	mesh->pool = pool;
+	mesh->drawIndex = geometrypool_addGeometry(pool, vertices, vertexCount,
+		indices, indexCount);
 
 	return mesh;
 }
@@ -143,22 +91,32 @@ void mesh_drawMesh(Mesh* mesh, Shader* shader, bool isModel)
 	material_useMaterial(shader, mesh->material);
 
 	// Mesh rendern.
-	glBindVertexArray(mesh->vao);
+	mesh_drawMeshGeometry(mesh, isModel);
+}
 
-	if (isModel)
-	{
-		// Für Tessellation muss zuerst die Anzahl der Patches
-		// festgelegt werden.
-		glPatchParameteri(GL_PATCH_VERTICES, 3);
-		// Anders als sonst wird hier der Typ GL_PATCHES statt Triangles
-		// verwendet.
-		glDrawElements(GL_PATCHES, mesh->indexCount, GL_UNSIGNED_INT, 0);
-	}
-	else
-	{
-		glDrawElements(GL_TRIANGLES, mesh->indexCount, GL_UNSIGNED_INT, 0);
-	}
-
+void mesh_drawMeshGeometry(Mesh* mesh, bool isModel)
+{
+	geometrypool_draw(mesh->pool, mesh->drawIndex, isModel);
+}
+
+Material* mesh_getMaterial(Mesh* mesh)
+{
+	return mesh->material;
+}
+
+void mesh_getCenter(Mesh* mesh, vec3 center)
+{
+	glm_vec3_copy(mesh->center, center);
+}
+
+GeometryPool* mesh_getPool(Mesh* mesh)
+{
+	return mesh->pool;
+}
+
+const GeometryDrawCommand* mesh_getDrawCommand(Mesh* mesh)
+{
+	return geometrypool_getCommand(mesh->pool, mesh->drawIndex);
 }
 
 void mesh_deleteMesh(Mesh* mesh)
@@ -176,11 +134,6 @@ void mesh_deleteMesh(Mesh* mesh)
 	// Das Material löschen.
 	material_deleteMaterial(mesh->material);
 
-	// Alle OpenGL Buffer löschen
-	glDeleteBuffers(1, &mesh->vbo);
-	glDeleteBuffers(1, &mesh->ebo);
-	glDeleteVertexArrays(1, &mesh->vao);
-
 	// Das Mesh löschen
 	free(mesh);
 }
@@ -12,9 +12,9 @@
 
 #include "common.h"
 
+#include "geometrypool.h"
 #include "shader.h"
 #include "material.h"
-#include "input.h"
 
 //////////////////////////// ÖFFENTLICHE DATENTYPEN ////////////////////////////
 
@@ -39,16 +39,20 @@ typedef struct Mesh Mesh;
  * Erstellt ein neues Mesh aus Vertex- und Indexdaten.
  * Alle Daten werden dabei übernommen und dürfen vom Aufrufer nicht gelöscht
  * werden. Die Löschung erfolgt automatisch beim Löschen des Meshes.
+ * Die Geometrie wird an einen Pool gehängt und kann erst gezeichnet werden,
+ * wenn dieser hochgeladen wurde. Der Pool muss das Mesh überdauern.
  * 
  * @param vertices die Vertices des Meshes
  * @param vertexCount die Anzahl der Vertices
  * @param indices die Indices des Meshes
  * @param indexCount die Anzahl der Indices
  * @param material das zu verwendende Material
+ * @param pool die gemeinsamen Buffer des Modells
  * @return ein neues Mesh
  */
 Mesh* mesh_createMesh(Vertex* vertices, GLuint vertexCount, 
-                      GLint* indices, GLuint indexCount, Material* material);
+                      GLint* indices, GLuint indexCount, Material* material,
+                      GeometryPool* pool);
 
 /**
  * Zeigt ein Mesh mit einem festgelegten Shader an.
@@ -59,6 +63,48 @@ Mesh* mesh_createMesh(Vertex* vertices, GLuint vertexCount,
  */
 void mesh_drawMesh(Mesh* mesh, Shader* shader, bool isModel);
 
+/**
+ * Zeichnet nur die Geometrie eines Meshes, ohne sein Material zu aktivieren.
+ * Shader und Material müssen bereits aktiviert sein, z.B. durch die Render
+ * Queue, die das Material nur bei einem Wechsel setzt.
+ * 
+ * @param mesh das zu zeichnende Mesh
+ * @param isModel true, wenn Patches für die Tessellation gezeichnet werden
+ */
+void mesh_drawMeshGeometry(Mesh* mesh, bool isModel);
+
+/**
+ * Liefert das Material eines Meshes.
+ * 
+ * @param mesh das Mesh
+ * @return das Material, es gehört weiterhin dem Mesh
+ */
+Material* mesh_getMaterial(Mesh* mesh);
+
+/**
+ * Liefert den Mittelpunkt der Bounding Box eines Meshes im Modellraum.
+ * 
+ * @param mesh das Mesh
+ * @param center erhält den Mittelpunkt
+ */
+void mesh_getCenter(Mesh* mesh, vec3 center);
+
+/**
+ * Liefert die gemeinsamen Buffer, in denen die Geometrie eines Meshes liegt.
+ * 
+ * @param mesh das Mesh
+ * @return der Pool
+ */
+GeometryPool* mesh_getPool(Mesh* mesh);
+
+/**
+ * Liefert den Draw Befehl eines Meshes in seinem Pool.
+ * 
+ * @param mesh das Mesh
+ * @return der Befehl
+ */
+const GeometryDrawCommand* mesh_getDrawCommand(Mesh* mesh);
+
 /**
  * Löscht ein Mesh.
  * 
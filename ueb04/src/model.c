@@ -24,6 +24,9 @@ struct Model
     Mesh** meshes;
     unsigned int meshCount;
     char* directory;
+
+    // Gemeinsame Buffer aller Meshes
+    GeometryPool* pool;
 };
 
 ////////////////////////////// LOKALE FUNKTIONEN ///////////////////////////////
@@ -35,12 +38,14 @@ struct Model
  * @param transform eine Transformation, die auf alle Vertices angewendet wird
  * @param scene die Szene, aus der das Mesh kommt
  * @param directory das Verzeichnis, in dem die Modelldatei liegt
+ * @param pool die gemeinsamen Buffer des Modells
  * @return das neue Mesh
  */
 static Mesh* model_processMesh(struct aiMesh* srcMesh,
                                mat4 transform,
                                const struct aiScene* scene, 
-                               const char* directory)
+                               const char* directory,
+                               GeometryPool* pool)
 {
     // Zuerst prüfen, ob der Primitiventyp Dreiecke ist. Sonst kann kein Mesh
     // aufgebaut werden.
@@ -180,7 +185,7 @@ static Mesh* model_processMesh(struct aiMesh* srcMesh,
     return mesh_createMesh(
         vertices, vertexCount, 
         indices, indexCount,
-        material
+        material, pool
     );
 }
 
@@ -231,7 +236,8 @@ static void model_processNode(Model* model,
                 srcMesh,
                 transform,
                 scene, 
-                model->directory
+                model->directory,
+                model->pool
             );
         }
     }
@@ -284,10 +290,13 @@ Model* model_loadModel(const char* filename)
     // Wir brauchen den Ordnerpfad um die Texturen des Modells zu finden.
     model->directory = utils_getDirectory(filename);
 
-    // Das Modell rekursiv in OpenGL laden.
+    // Das Modell rekursiv laden, die Geometrie aller Meshes wird dabei im
+    // Pool gesammelt und danach auf einmal an OpenGL übergeben.
+    model->pool = geometrypool_createPool();
     mat4 identity;
     glm_mat4_identity(identity);
     model_processNode(model, scene, scene->mRootNode, identity);
+    geometrypool_upload(model->pool, filename);
 
     // Zum Schluss müssen nur noch die Assimp-Ressourcen wieder frei gegeben
     // werden.
@@ -296,12 +305,45 @@ Model* model_loadModel(const char* filename)
     return model;
 }
 
-void model_drawModel(Model* model, Shader* shader, bool isModel)
+int model_drawModel(Model* model, bool isModel)
+{
+    // Alle Meshes liegen in einem Pool und werden mit einem Aufruf
+    // gezeichnet.
+    return geometrypool_drawAll(model->pool, isModel);
+}
+
+void model_submitModel(Model* model, RenderQueue* queue,
+                       ShaderVariants* variants, unsigned int features,
+                       mat4 modelViewMatrix, float maxDepth)
 {
-    // Alle Meshes des Modells werden nacheinander gerendert.
     for (unsigned int i = 0; i < model->meshCount; i++)
     {
-        mesh_drawMesh(model->meshes[i], shader, isModel);
+        Mesh* mesh = model->meshes[i];
+        if (mesh == NULL)
+        {
+            continue;
+        }
+
+        // Die Variante passend zu den Texturen des Materials wählen.
+        Material* material = mesh_getMaterial(mesh);
+        unsigned int mask = features | material_getFeatures(material);
+        Shader* shader = shader_getVariant(variants, mask);
+
+        // Konnte die Variante nicht gebaut werden, fehlt nur dieses Mesh.
+        if (shader == NULL)
+        {
+            continue;
+        }
+
+        // Die Kamera blickt entlang -z, die Tiefe ist also -z im View Space.
+        vec4 center;
+        mesh_getCenter(mesh, center);
+        center[3] = 1.0f;
+        glm_mat4_mulv(modelViewMatrix, center, center);
+
+        uint64_t key = renderqueue_makeKey(RENDERQUEUE_PASS_OPAQUE, mask,
+            material_getId(material), -center[2], maxDepth);
+        renderqueue_submit(queue, key, mesh, shader);
     }
 }
 
@@ -314,6 +356,7 @@ void model_deleteModel(Model* model)
     }
 
     // Danach wird das Modell freigegeben.
+    geometrypool_deletePool(model->pool);
     free(model->meshes);
     free(model->directory);
     free(model);
@@ -10,6 +10,7 @@
 
 #include "common.h"
 
+#include "renderqueue.h"
 #include "shader.h"
 
 //////////////////////////// ÖFFENTLICHE DATENTYPEN ////////////////////////////
@@ -30,12 +31,32 @@ typedef struct Model Model;
 Model* model_loadModel(const char* filename);
 
 /**
- * Zeigt ein 3D Modell an.
+ * Zeigt die Geometrie eines 3D Modells an, ohne die Materialien zu setzen,
+ * z.B. für die Schatten. Der Shader muss bereits aktiviert sein.
+ * Mit Multi Draw Indirect genügt ein einziger Draw Call.
  * 
  * @param model das anzuzeigende 3D Modell
- * @param shader der zu verwendende Shader
+ * @param isModel true, wenn Patches für die Tessellation gezeichnet werden
+ * @return die Anzahl der abgesetzten Draw Calls
  */
-void model_drawModel(Model* model, Shader* shader, bool isModel);
+int model_drawModel(Model* model, bool isModel);
+
+/**
+ * Reicht alle Meshes eines 3D Modells in eine Render Queue ein. Jedes Mesh
+ * nutzt die Variante des Shaders, die zu seinem Material passt. Die
+ * Feature-Maske der Variante dient als Nummer des Programms im Schlüssel,
+ * die Tiefe ist der Abstand des Mittelpunkts eines Meshes zur Kamera.
+ * 
+ * @param model das anzuzeigende 3D Modell
+ * @param queue die Render Queue
+ * @param variants die Varianten des Shaders
+ * @param features die Features, die nicht vom Material abhängen
+ * @param modelViewMatrix die Model View Matrix
+ * @param maxDepth der größte Abstand zur Kamera, z.B. die Far Plane
+ */
+void model_submitModel(Model* model, RenderQueue* queue,
+                       ShaderVariants* variants, unsigned int features,
+                       mat4 modelViewMatrix, float maxDepth);
 
 /**
  * Löscht ein zuvor geladenes 3D Modell wieder.
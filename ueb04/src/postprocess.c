@@ -0,0 +1,507 @@
+/**
+ * Modul für eine Kette von PostProcess Effekten.
+ *
+ * Copyright (C) 2023, FH Wedel
+ * Autor: Joshua-Scott Schöttke, Ilana Schmara
+ */
+
+#include "postprocess.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <sesp/stb_ds.h>
+
+#include "glstate.h"
+#include "utils.h"
+
+////////////////////////////////// KONSTANTEN //////////////////////////////////
+
+// Anzahl der Render Targets für Zwischenergebnisse.
+#define POSTPROCESS_TARGET_COUNT 2
+
+// Anfang jedes zusammengefassten Shaders.
+static const char* POSTPROCESS_FUSED_HEADER =
+    "#version 410 core\n"
+    "\n"
+    "out vec4 FragColor;\n"
+    "\n"
+    "uniform sampler2D u_source;\n"
+    "uniform vec2 u_viewportSize;\n"
+    "uniform vec2 u_renderScale;\n"
+    "\n";
+
+////////////////////////////// LOKALE DATENTYPEN ///////////////////////////////
+
+// Ein registrierter Effekt.
+typedef struct
+{
+    char* name;
+    char* file;
+    bool isPixelEffect;
+    bool enabled;
+    PostProcessUniformFunc setUniforms;
+} PostProcessEffect;
+
+// Ein Vollbild-Pass, der einen Pass-Effekt oder mehrere zusammengefasste
+// Pixel-Effekte ausführt.
+typedef struct
+{
+    Shader* shader;
+    // Indizes der Effekte dieses Passes
+    int* effects;
+} PostProcessPass;
+
+// Datenstruktur mit den Effekten, den erzeugten Pässen und Render Targets.
+struct PostProcessChain
+{
+    // Dynamische Arrays (stb_ds)
+    PostProcessEffect* effects;
+    PostProcessPass* passes;
+
+    // Die Pässe müssen vor dem nächsten Rendern neu erzeugt werden.
+    bool dirty;
+    // Beim letzten Erzeugen ist ein Fehler aufgetreten.
+    bool failed;
+
+    // Leeres VAO für das Vollbild-Dreieck
+    GLuint vao;
+
+    GLuint fbo;
+    GLuint targets[POSTPROCESS_TARGET_COUNT];
+    int targetWidth;
+    int targetHeight;
+};
+
+////////////////////////////// LOKALE FUNKTIONEN ///////////////////////////////
+
+/**
+ * Legt eine Kopie einer Zeichenkette an.
+ *
+ * @param text die zu kopierende Zeichenkette
+ * @return die Kopie, muss mit free freigegeben werden
+ */
+static char* postprocess_copyString(const char* text)
+{
+    size_t length = strlen(text) + 1;
+    char* copy = malloc(length);
+    memcpy(copy, text, length);
+    return copy;
+}
+
+/**
+ * Hängt Text an einen dynamisch wachsenden Quellcode an.
+ *
+ * @param source der Quellcode (stb_ds Array mit abschließender 0)
+ * @param text der anzuhängende Text
+ */
+static void postprocess_appendSource(char** source, const char* text)
+{
+    // Die abschließende 0 wird überschrieben und wieder angehängt.
+    if (stbds_arrlen(*source) > 0)
+    {
+        (void)stbds_arrpop(*source);
+    }
+
+    size_t length = strlen(text);
+    memcpy(stbds_arraddnptr(*source, length), text, length);
+    stbds_arrput(*source, '\0');
+}
+
+/**
+ * Sucht einen Effekt anhand seines Namens.
+ *
+ * @param chain die Kette
+ * @param name der Name des Effekts
+ * @return der Index des Effekts oder -1
+ */
+static int postprocess_findEffect(PostProcessChain* chain, const char* name)
+{
+    for (int i = 0; i < stbds_arrlen(chain->effects); i++)
+    {
+        if (strcmp(chain->effects[i].name, name) == 0)
+        {
+            return i;
+        }
+    }
+    return -1;
+}
+
+/**
+ * Hängt einen Effekt an das Ende der Kette an.
+ *
+ * @param chain die Kette
+ * @param name der Name des Effekts
+ * @param file der Pfad zur GLSL Datei des Effekts
+ * @param isPixelEffect true für einen Pixel-Effekt
+ * @param setUniforms übergibt die Uniforms des Effekts oder NULL
+ */
+static void postprocess_addEffect(PostProcessChain* chain, const char* name,
+                                  const char* file, bool isPixelEffect,
+                                  PostProcessUniformFunc setUniforms)
+{
+    PostProcessEffect effect;
+    effect.name = postprocess_copyString(name);
+    effect.file = postprocess_copyString(file);
+    effect.isPixelEffect = isPixelEffect;
+    effect.enabled = true;
+    effect.setUniforms = setUniforms;
+
+    stbds_arrput(chain->effects, effect);
+    chain->dirty = true;
+}
+
+/**
+ * Löscht alle erzeugten Pässe.
+ *
+ * @param chain die Kette
+ */
+static void postprocess_deletePasses(PostProcessChain* chain)
+{
+    for (int i = 0; i < stbds_arrlen(chain->passes); i++)
+    {
+        if (chain->passes[i].shader)
+        {
+            shader_deleteShader(chain->passes[i].shader);
+        }
+        stbds_arrfree(chain->passes[i].effects);
+    }
+    stbds_arrfree(chain->passes);
+}
+
+/**
+ * Erzeugt den Shader für eine Gruppe aufeinanderfolgender Pixel-Effekte.
+ * Die Funktionen der Effekte werden dabei nacheinander auf die Farbe der
+ * Quelle angewendet. Eine leere Gruppe kopiert die Quelle nur.
+ *
+ * @param chain die Kette
+ * @param effects die Indizes der Effekte
+ * @return der neue Shader oder NULL
+ */
+static Shader* postprocess_createFusedShader(PostProcessChain* chain, int* effects)
+{
+    char* source = NULL;
+    char label[256] = "PostProcess";
+
+    postprocess_appendSource(&source, POSTPROCESS_FUSED_HEADER);
+    for (int i = 0; i < stbds_arrlen(effects); i++)
+    {
+        PostProcessEffect* effect = &chain->effects[effects[i]];
+        char* effectSource = utils_readFile(effect->file);
+        postprocess_appendSource(&source, effectSource);
+        postprocess_appendSource(&source, "\n\n");
+        free(effectSource);
+
+        strncat(label, i == 0 ? " " : "+", sizeof(label) - strlen(label) - 1);
+        strncat(label, effect->name, sizeof(label) - strlen(label) - 1);
+    }
+
+    postprocess_appendSource(&source,
+        "void main()\n"
+        "{\n"
+        "    // Einen halben Texel Abstand zum Rand des genutzten Bereichs halten.\n"
+        "    vec2 uv = gl_FragCoord.xy / u_viewportSize * u_renderScale;\n"
+        "    uv = min(uv, u_renderScale - 0.5 / vec2(textureSize(u_source, 0)));\n"
+        "    vec3 color = texture(u_source, uv).rgb;\n");
+    for (int i = 0; i < stbds_arrlen(effects); i++)
+    {
+        postprocess_appendSource(&source, "    color = ");
+        postprocess_appendSource(&source, chain->effects[effects[i]].name);
+        postprocess_appendSource(&source, "(color, uv);\n");
+    }
+    postprocess_appendSource(&source,
+        "    FragColor = vec4(color, 1.0);\n"
+        "}\n");
+
+    Shader* shader = shader_createShader();
+    bool vertOk = shader_attachShaderFile(shader, GL_VERTEX_SHADER,
+        UTILS_CONST_RES("shader/postProcess/postProcess.vert"));
+    bool fragOk = shader_attachShaderSource(shader, GL_FRAGMENT_SHADER, source,
+                                            label);
+    stbds_arrfree(source);
+
+    if (vertOk && fragOk && shader_buildShader(shader))
+    {
+        return shader;
+    }
+
+    shader_deleteShader(shader);
+    return NULL;
+}
+
+/**
+ * Erzeugt die Pässe aus den aktiven Effekten. Aufeinanderfolgende
+ * Pixel-Effekte landen dabei in einem gemeinsamen Pass.
+ *
+ * @param chain die Kette
+ */
+static void postprocess_buildPasses(PostProcessChain* chain)
+{
+    postprocess_deletePasses(chain);
+    chain->dirty = false;
+    chain->failed = false;
+
+    int* group = NULL;
+    for (int i = 0; i < stbds_arrlen(chain->effects); i++)
+    {
+        PostProcessEffect* effect = &chain->effects[i];
+        if (!effect->enabled)
+        {
+            continue;
+        }
+
+        if (effect->isPixelEffect)
+        {
+            stbds_arrput(group, i);
+            continue;
+        }
+
+        // Ein Pass-Effekt beendet die aktuelle Gruppe.
+        if (stbds_arrlen(group) > 0)
+        {
+            PostProcessPass pass = { postprocess_createFusedShader(chain, group), group };
+            stbds_arrput(chain->passes, pass);
+            group = NULL;
+        }
+
+        PostProcessPass pass = { NULL, NULL };
+        pass.shader = shader_createVeFrShader(effect->name,
+            UTILS_CONST_RES("shader/postProcess/postProcess.vert"), effect->file);
+        stbds_arrput(pass.effects, i);
+        stbds_arrput(chain->passes, pass);
+    }
+
+    // Die letzte Gruppe wird immer angelegt, damit mindestens ein Pass
+    // in den Default-Framebuffer zeichnet.
+    if (stbds_arrlen(group) > 0 || stbds_arrlen(chain->passes) == 0)
+    {
+        PostProcessPass pass = { postprocess_createFusedShader(chain, group), group };
+        stbds_arrput(chain->passes, pass);
+    }
+    else
+    {
+        stbds_arrfree(group);
+    }
+
+    for (int i = 0; i < stbds_arrlen(chain->passes); i++)
+    {
+        chain->failed |= chain->passes[i].shader == NULL;
+    }
+}
+
+/**
+ * Legt die Render Targets für Zwischenergebnisse in der angegebenen Größe an.
+ * Die Texturen werden auf der Arbeits-Textureinheit gebunden, damit die
+ * Eingabe der Kette gebunden bleibt.
+ *
+ * @param chain die Kette
+ * @param width die Breite in Pixeln
+ * @param height die Höhe in Pixeln
+ * @param workUnit die Textureinheit für Zwischenergebnisse
+ */
+static void postprocess_resizeTargets(PostProcessChain* chain, int width, int height,
+                                      int workUnit)
+{
+    if (chain->targetWidth == width && chain->targetHeight == height)
+    {
+        return;
+    }
+
+    glstate_deleteTextures(POSTPROCESS_TARGET_COUNT, chain->targets);
+    glstate_activeTexture(GL_TEXTURE0 + workUnit);
+    glGenTextures(POSTPROCESS_TARGET_COUNT, chain->targets);
+    for (int i = 0; i < POSTPROCESS_TARGET_COUNT; i++)
+    {
+        glstate_bindTexture(GL_TEXTURE_2D, chain->targets[i]);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA16F, width, height, 0, GL_RGBA,
+                     GL_FLOAT, NULL);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        common_labelObjectByType(GL_TEXTURE, chain->targets[i], "PostProcess Target");
+    }
+    glstate_bindTexture(GL_TEXTURE_2D, 0);
+
+    chain->targetWidth = width;
+    chain->targetHeight = height;
+}
+
+//////////////////////////// ÖFFENTLICHE FUNKTIONEN ////////////////////////////
+
+PostProcessChain* postprocess_createChain(void)
+{
+    PostProcessChain* chain = malloc(sizeof(PostProcessChain));
+    memset(chain, 0, sizeof(PostProcessChain));
+
+    // Das Vollbild-Dreieck wird im Vertex Shader aus gl_VertexID erzeugt,
+    // im Core Profile muss trotzdem ein VAO gebunden sein.
+    glGenVertexArrays(1, &chain->vao);
+    glGenFramebuffers(1, &chain->fbo);
+    common_labelObjectByType(GL_FRAMEBUFFER, chain->fbo, "PostProcess");
+
+    chain->dirty = true;
+    return chain;
+}
+
+void postprocess_addPixelEffect(PostProcessChain* chain, const char* name,
+                                const char* file,
+                                PostProcessUniformFunc setUniforms)
+{
+    postprocess_addEffect(chain, name, file, true, setUniforms);
+}
+
+void postprocess_addPassEffect(PostProcessChain* chain, const char* name,
+                               const char* frag,
+                               PostProcessUniformFunc setUniforms)
+{
+    postprocess_addEffect(chain, name, frag, false, setUniforms);
+}
+
+void postprocess_setEffectEnabled(PostProcessChain* chain, const char* name,
+                                  bool enabled)
+{
+    int index = postprocess_findEffect(chain, name);
+    if (index < 0)
+    {
+        fprintf(stderr, "Error: Unknown post process effect \"%s\".\n", name);
+        return;
+    }
+
+    if (chain->effects[index].enabled != enabled)
+    {
+        chain->effects[index].enabled = enabled;
+        chain->dirty = true;
+    }
+}
+
+void postprocess_invalidate(PostProcessChain* chain)
+{
+    chain->dirty = true;
+}
+
+bool postprocess_usesFile(PostProcessChain* chain, const char* file)
+{
+    if (strcmp(file, UTILS_CONST_RES("shader/postProcess/postProcess.vert")) == 0)
+    {
+        return true;
+    }
+
+    for (int i = 0; i < stbds_arrlen(chain->effects); i++)
+    {
+        if (strcmp(chain->effects[i].file, file) == 0)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+int postprocess_getPassCount(PostProcessChain* chain)
+{
+    return (int)stbds_arrlen(chain->passes);
+}
+
+bool postprocess_render(PostProcessChain* chain, int inputUnit, int workUnit,
+                        int bufferWidth, int bufferHeight, vec2 renderRatio,
+                        int screenWidth, int screenHeight, void* userData)
+{
+    if (chain->dirty)
+    {
+        postprocess_buildPasses(chain);
+    }
+    if (chain->failed)
+    {
+        return false;
+    }
+
+    int passCount = (int)stbds_arrlen(chain->passes);
+    if (passCount > 1)
+    {
+        postprocess_resizeTargets(chain, bufferWidth, bufferHeight, workUnit);
+    }
+
+    // Zwischenergebnisse decken nur den genutzten Bereich ab.
+    vec2 regionSize = {
+        ceilf((float)bufferWidth * renderRatio[0]),
+        ceilf((float)bufferHeight * renderRatio[1])
+    };
+    vec2 screenSize = { (float)screenWidth, (float)screenHeight };
+
+    glstate_disable(GL_DEPTH_TEST);
+    glstate_disable(GL_BLEND);
+    glstate_bindVertexArray(chain->vao);
+
+    int sourceUnit = inputUnit;
+    for (int i = 0; i < passCount; i++)
+    {
+        PostProcessPass* pass = &chain->passes[i];
+        bool isLast = i == passCount - 1;
+        GLuint target = chain->targets[i % POSTPROCESS_TARGET_COUNT];
+
+        if (isLast)
+        {
+            glstate_bindFramebuffer(GL_FRAMEBUFFER, 0);
+            glViewport(0, 0, screenWidth, screenHeight);
+        }
+        else
+        {
+            glstate_bindFramebuffer(GL_FRAMEBUFFER, chain->fbo);
+            glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0,
+                                   GL_TEXTURE_2D, target, 0);
+            glViewport(0, 0, (GLsizei)regionSize[0], (GLsizei)regionSize[1]);
+        }
+
+        shader_useShader(pass->shader);
+        shader_setInt(pass->shader, "u_source", sourceUnit);
+        shader_setVec2(pass->shader, "u_viewportSize", isLast ? &screenSize : &regionSize);
+        shader_setVec2(pass->shader, "u_renderScale", (vec2*)renderRatio);
+
+        for (int e = 0; e < stbds_arrlen(pass->effects); e++)
+        {
+            PostProcessEffect* effect = &chain->effects[pass->effects[e]];
+            if (effect->setUniforms)
+            {
+                effect->setUniforms(pass->shader, userData);
+            }
+        }
+
+        common_pushRenderScope("PostProcess Pass");
+        glDrawArrays(GL_TRIANGLES, 0, 3);
+        common_popRenderScope();
+
+        // Das Ergebnis ist die Quelle des nächsten Passes.
+        if (!isLast)
+        {
+            glstate_activeTexture(GL_TEXTURE0 + workUnit);
+            glstate_bindTexture(GL_TEXTURE_2D, target);
+            sourceUnit = workUnit;
+        }
+    }
+
+    glstate_bindVertexArray(0);
+    return true;
+}
+
+void postprocess_deleteChain(PostProcessChain* chain)
+{
+    if (!chain)
+    {
+        return;
+    }
+
+    postprocess_deletePasses(chain);
+    for (int i = 0; i < stbds_arrlen(chain->effects); i++)
+    {
+        free(chain->effects[i].name);
+        free(chain->effects[i].file);
+    }
+    stbds_arrfree(chain->effects);
+
+    glstate_deleteTextures(POSTPROCESS_TARGET_COUNT, chain->targets);
+    glstate_deleteFramebuffers(1, &chain->fbo);
+    glstate_deleteVertexArrays(1, &chain->vao);
+
+    free(chain);
+}
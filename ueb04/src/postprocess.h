@@ -0,0 +1,153 @@
+/**
+ * Modul für eine Kette von PostProcess Effekten.
+ *
+ * Die Effekte werden in der Reihenfolge ihrer Registrierung ausgeführt. Es
+ * gibt zwei Arten von Effekten:
+ *
+ * - Pixel-Effekte bestehen nur aus einer GLSL Funktion, die eine Farbe auf
+ *   eine neue Farbe abbildet. Aufeinanderfolgende Pixel-Effekte werden zu
+ *   einem einzigen, zur Laufzeit erzeugten Shader zusammengefasst und kosten
+ *   so zusammen nur einen Vollbild-Pass.
+ * - Pass-Effekte haben einen eigenen Fragment Shader und lesen die Quelle an
+ *   beliebigen Stellen, z.B. für Weichzeichner. Sie bilden immer einen
+ *   eigenen Pass.
+ *
+ * Zwischenergebnisse liegen abwechselnd in zwei Render Targets (Ping-Pong).
+ * Der letzte Pass zeichnet direkt in den Default-Framebuffer und skaliert
+ * dabei den gerenderten Bereich (dynamische Auflösung) auf das Fenster.
+ *
+ * Alle Pässe nutzen den Vertex Shader postProcess/postProcess.vert, der ohne
+ * Vertexdaten ein Vollbild-Dreieck erzeugt. Jeder Pass erhält:
+ *
+ * uniform sampler2D u_source;      // Ergebnis des vorherigen Passes
+ * uniform vec2 u_viewportSize;     // Größe des Viewports in Pixeln
+ * uniform vec2 u_renderScale;      // genutzter Anteil der Quelle
+ *
+ * Die Texturkoordinate ergibt sich aus
+ * gl_FragCoord.xy / u_viewportSize * u_renderScale.
+ *
+ * Eine Datei für einen Pixel-Effekt enthält kein #version, nur die eigenen
+ * Uniforms und eine Funktion mit dem Namen des Effekts:
+ *
+ * vec3 <name>(vec3 color, vec2 uv);
+ *
+ * Copyright (C) 2023, FH Wedel
+ * Autor: Joshua-Scott Schöttke, Ilana Schmara
+ */
+
+#ifndef POSTPROCESS_H
+#define POSTPROCESS_H
+
+#include "common.h"
+#include "shader.h"
+
+//////////////////////////// ÖFFENTLICHE DATENTYPEN ////////////////////////////
+
+// Datenstruktur mit den Effekten, den erzeugten Pässen und Render Targets.
+struct PostProcessChain;
+typedef struct PostProcessChain PostProcessChain;
+
+// Übergibt die Uniforms eines Effekts an den Shader seines Passes. Der Shader
+// ist dabei bereits aktiviert. userData wird von postprocess_render
+// durchgereicht.
+typedef void (*PostProcessUniformFunc)(Shader* shader, void* userData);
+
+//////////////////////////// ÖFFENTLICHE FUNKTIONEN ////////////////////////////
+
+/**
+ * Erzeugt eine neue, leere PostProcess Kette.
+ *
+ * @return die neue Kette
+ */
+PostProcessChain* postprocess_createChain(void);
+
+/**
+ * Hängt einen Pixel-Effekt an das Ende der Kette an.
+ *
+ * @param chain die Kette
+ * @param name der Name des Effekts und seiner GLSL Funktion
+ * @param file der Pfad zur GLSL Datei des Effekts
+ * @param setUniforms übergibt die Uniforms des Effekts oder NULL
+ */
+void postprocess_addPixelEffect(PostProcessChain* chain, const char* name,
+                                const char* file,
+                                PostProcessUniformFunc setUniforms);
+
+/**
+ * Hängt einen Pass-Effekt an das Ende der Kette an.
+ *
+ * @param chain die Kette
+ * @param name der Name des Effekts
+ * @param frag der Pfad zum Fragment Shader des Effekts
+ * @param setUniforms übergibt die Uniforms des Effekts oder NULL
+ */
+void postprocess_addPassEffect(PostProcessChain* chain, const char* name,
+                               const char* frag,
+                               PostProcessUniformFunc setUniforms);
+
+/**
+ * Aktiviert oder deaktiviert einen Effekt. Deaktivierte Effekte werden beim
+ * Zusammenfassen übersprungen. Ändert sich der Zustand, werden die Pässe vor
+ * dem nächsten Rendern neu erzeugt.
+ *
+ * @param chain die Kette
+ * @param name der Name des Effekts
+ * @param enabled der neue Zustand
+ */
+void postprocess_setEffectEnabled(PostProcessChain* chain, const char* name,
+                                  bool enabled);
+
+/**
+ * Verwirft die erzeugten Pässe, damit sie vor dem nächsten Rendern neu aus
+ * den Dateien erzeugt werden.
+ *
+ * @param chain die Kette
+ */
+void postprocess_invalidate(PostProcessChain* chain);
+
+/**
+ * Prüft, ob die Pässe der Kette aus einer Datei erzeugt werden, z.B. um sie
+ * nach einer Änderung der Datei zu verwerfen.
+ *
+ * @param chain die Kette
+ * @param file der Pfad der Datei
+ * @return true, wenn ein Effekt oder der Vertex Shader die Datei nutzt
+ */
+bool postprocess_usesFile(PostProcessChain* chain, const char* file);
+
+/**
+ * Liefert die Anzahl der Vollbild-Pässe, die die Kette aktuell benötigt.
+ *
+ * @param chain die Kette
+ * @return die Anzahl der Pässe
+ */
+int postprocess_getPassCount(PostProcessChain* chain);
+
+/**
+ * Führt alle Pässe der Kette aus. Der erste Pass liest aus der Textur, die
+ * der Aufrufer bereits an inputUnit gebunden hat, der letzte zeichnet in den
+ * Default-Framebuffer.
+ *
+ * @param chain die Kette
+ * @param inputUnit die Textureinheit mit der Eingabe
+ * @param workUnit die Textureinheit für Zwischenergebnisse
+ * @param bufferWidth die Breite der Eingabe in Pixeln
+ * @param bufferHeight die Höhe der Eingabe in Pixeln
+ * @param renderRatio der genutzte Anteil der Eingabe
+ * @param screenWidth die Breite des Fensters in Pixeln
+ * @param screenHeight die Höhe des Fensters in Pixeln
+ * @param userData wird an die Uniform-Funktionen der Effekte übergeben
+ * @return false, wenn ein Pass nicht erzeugt werden konnte
+ */
+bool postprocess_render(PostProcessChain* chain, int inputUnit, int workUnit,
+                        int bufferWidth, int bufferHeight, vec2 renderRatio,
+                        int screenWidth, int screenHeight, void* userData);
+
+/**
+ * Löscht die Kette samt ihrer Pässe und Render Targets.
+ *
+ * @param chain die zu löschende Kette
+ */
+void postprocess_deleteChain(PostProcessChain* chain);
+
+#endif // POSTPROCESS_H
@@ -7,29 +7,202 @@
 
 #include "rendering.h"
 
+#include <math.h>
+#include <stdio.h>
 #include <string.h>
 
 #include "shader.h"
 #include "model.h"
+#include "material.h"
 #include "utils.h"
 #include "input.h"
 #include "camera.h"
 #include "gbuffer.h"
+#include "light.h"
+#include "tiled.h"
+#include "cluster.h"
+#include "shadow.h"
+#include "bloom.h"
+#include "dof.h"
+#include "exposure.h"
+#include "postprocess.h"
+#include "timer.h"
+#include "filewatch.h"
+#include "framedata.h"
+#include "glstate.h"
+#include "renderqueue.h"
+
+////////////////////////////////// KONSTANTEN //////////////////////////////////
+
+// Textureinheiten, die zusätzlich zu den GBuffer Texturen belegt werden.
+#define RENDERING_UNIT_SHADOW_MAP 6
+#define RENDERING_UNIT_DEPTH 7
+#define RENDERING_UNIT_LIGHTS 8
+#define RENDERING_UNIT_TILE_DEPTH 9
+#define RENDERING_UNIT_TILE_MASK 10
+
+// Das Clustered Lighting teilt sich die Einheiten mit den Kachel-Daten, da
+// immer nur eines der Verfahren aktiv ist.
+#define RENDERING_UNIT_CLUSTER_GRID 9
+#define RENDERING_UNIT_CLUSTER_INDICES 10
+// Hinter den vier Masken des Tiled Lighting
+#define RENDERING_UNIT_POINT_SHADOWS 14
+#define RENDERING_UNIT_BLOOM 15
+// Zwischenergebnisse des PostProcess, die Punktschatten werden dann nicht
+// mehr benötigt.
+#define RENDERING_UNIT_POST_PROCESS 14
+// Ebenen der Tiefenunschaerfe, ebenfalls erst nach den Lichtpaessen
+#define RENDERING_UNIT_DOF_NEAR 10
+#define RENDERING_UNIT_DOF_FAR 11
+#define RENDERING_UNIT_DOF_DEPTH 12
+// Histogramm und mittlere Helligkeit der automatischen Belichtung
+#define RENDERING_UNIT_EXPOSURE_HISTOGRAM 12
+#define RENDERING_UNIT_EXPOSURE 13
+
+// Radius des Tent-Filters beim Vergroeszern der Bloom Stufen in Texeln
+#define RENDERING_BLOOM_RADIUS 1.0f
+
+// Near- und Far-Plane der Kamera
+#define RENDERING_NEAR_PLANE 0.1f
+#define RENDERING_FAR_PLANE 200.0f
+
+// Unterteilung der Kugel für die Lichtvolumen
+#define RENDERING_SPHERE_SLICES 16
+#define RENDERING_SPHERE_STACKS 12
+#define RENDERING_SPHERE_VERTICES (RENDERING_SPHERE_SLICES * RENDERING_SPHERE_STACKS * 6)
+
+// Ablauf des GBuffer Benchmarks: Frames zum Einschwingen und Messen je Aufbau
+#define RENDERING_BENCHMARK_WARMUP 16
+#define RENDERING_BENCHMARK_FRAMES 128
+
+// Anzahl der nachgestellten Draws im Uniform Benchmark
+#define RENDERING_UNIFORM_BENCHMARK_DRAWS 4096
+
+// Uniforms, die je Mesh gesetzt werden: Model Matrix und Material
+#define RENDERING_UNIFORM_BENCHMARK_COUNT 10
+
+// Regelung der dynamischen Auflösung: kleinster erlaubter Faktor, Anteil der
+// Abweichung, der pro Frame ausgeglichen wird, und tolerierte relative
+// Abweichung von der Ziel-Frametime
+#define RENDERING_SCALE_LIMIT 0.25f
+#define RENDERING_SCALE_GAIN 0.1f
+#define RENDERING_SCALE_TOLERANCE 0.05
+
+// Features der Modell Shader, die nicht vom Material abhängen. Sie folgen
+// in der Maske auf die Bits des Materials (siehe material.h).
+#define RENDERING_MODEL_FEATURE_TBN (1u << MATERIAL_FEATURE_COUNT)
+#define RENDERING_MODEL_FEATURE_COMPACT (1u << (MATERIAL_FEATURE_COUNT + 1))
+
+// Namen der Definitionen für alle Bits der Feature-Maske
+static const char* const RENDERING_MODEL_FEATURES[] = {
+	MATERIAL_FEATURE_DEFINES, "USE_TBN", "COMPACT_GBUFFER"
+};
+#define RENDERING_MODEL_FEATURE_COUNT (MATERIAL_FEATURE_COUNT + 2)
 
  ////////////////////////////// LOKALE DATENTYPEN ///////////////////////////////
 
  // Datentyp für alle persistenten Daten des Renderers.
 struct RenderingData {
-	Shader* modelShader;
+	// Varianten der Modell Shader mit und ohne Tessellation
+	ShaderVariants* modelVariants;
+	ShaderVariants* modelDirectVariants;
+
+	// Durchgang mit allen festen Shadern, für das Neuladen einzelner Dateien
+	ShaderBatch* shaderBatch;
+	// Überwacht die Shader-Dateien (nur unter Linux)
+	FileWatcher* shaderWatcher;
 	Shader* dirLightShader;
 	Shader* pointLightShader;
 	Shader* nullShader;
-	Shader* postProcessShader;
 	Shader* dirShadowShader;
 	Shader* pointShadowShader;
+	Shader* tileDepthShader;
+	Shader* tileCullShader;
+	Shader* tiledLightShader;
+	Shader* clusteredLightShader;
+	Shader* thresholdShader;
+	Shader* bloomDownShader;
+	Shader* bloomUpShader;
+	Shader* dofSetupShader;
+	Shader* dofBlurShader;
+	Shader* histogramShader;
+	Shader* exposureAverageShader;
+
+	// Daten für das Tiled Deferred Lighting
+	TiledLighting* tiled;
+	LightBuffer* lightBuffer;
+
+	// Daten für das Clustered Deferred Lighting
+	ClusteredLighting* clusters;
+
+	// Kaskaden für die Schatten des Richtungslichts
+	CascadedShadow* dirShadow;
+
+	// Cube Maps für die Schatten der Punktlichter
+	PointShadows* pointShadows;
+
+	// Stufen für den Bloom Effekt
+	Bloom* bloom;
+
+	// Ziele der Tiefenunschaerfe in halber Aufloesung
+	DepthOfField* dof;
+
+	// Kamera und Bildschirmgroesze fuer alle Shader, einmal pro Frame
+	// hochgeladen
+	FrameData* frameData;
+
+	// Sortiert die Meshes des Geometry Pass nach Shader, Material und Tiefe
+	RenderQueue* renderQueue;
+
+	// Histogramm und mittlere Helligkeit für die automatische Belichtung
+	AutoExposure* autoExposure;
+	// Die Messung lief im letzten Frame, ihr Verlauf ist also aktuell.
+	bool autoExposureActive;
+
+	// Effekte zwischen HDR Buffer und Bildschirm
+	PostProcessChain* postChain;
+
+	// Eingaben, mit denen die Schatten zuletzt gerendert wurden. Die
+	// Lichtrichtung steckt bereits in den Matrizen der Kaskaden, die
+	// Lichtpositionen in den Slots der Punktschatten.
+	mat4 shadowModelMatrix;
+	unsigned int shadowSceneVersion;
+	bool shadowUseTess;
+	float shadowTessEdgePixels;
+
+	// GPU Zeitmessungen für die Statistik
+	GpuTimer* frameTimer;
+	GpuTimer* pointLightTimer;
+	GpuTimer* dirLightTimer;
+	GpuTimer* bloomTimer;
+	GpuTimer* dofTimer;
+	GpuTimer* exposureTimer;
+	RenderingStats stats;
+
+	// Zustand des GBuffer Benchmarks
+	bool benchmarkRunning;
+	GBufferLayout benchmarkLayout;
+	int benchmarkFrame;
+	double benchmarkSum;
+
+	// Verwaltet den GBuffer über Größenänderungen des Fensters hinweg
+	GBufferPool* gbufferPool;
+
+	// Dynamische Auflösung: Skalierungsfaktor, gerenderter Bereich in Pixeln
+	// und dessen Anteil an der Größe des GBuffers
+	float renderScale;
+	vec2 renderSize;
+	vec2 renderRatio;
 };
 typedef struct RenderingData RenderingData;
 
+// Daten, die jede Variante des Modell Shaders beim Aktivieren erhält.
+struct ModelUniforms {
+	InputData* input;
+	mat4* modelMatrix;
+};
+typedef struct ModelUniforms ModelUniforms;
+
 float interval = 0.0f;
 float pauseInterval = 0.0f;
 
@@ -46,15 +219,9 @@ unsigned int cubeVBO = 0;
 
 GBuffer* gBuffer;
 
+// Groesze des GBuffers, fuer die die Kacheln angelegt wurden
 // [0] = width, [1] = height
-int lastScreenSize[2];
-
-const unsigned int DIR_SHADOW_SIZE = 1024;
-
-// create a framebuffer object for rendering the depthMap
-unsigned int depthMapFBO;
-// 2D texture to be used as the framebuffer's depth buffer
-unsigned int depthMap;
+int lastBufferSize[2];
 
 ////////////////////////////// LOKALE FUNKTIONEN ///////////////////////////////
 
@@ -76,7 +243,7 @@ static void rendering_renderQuad()
 		// setup plane VAO
 		glGenVertexArrays(1, &quadVAO);
 		glGenBuffers(1, &quadVBO);
-		glBindVertexArray(quadVAO);
+		glstate_bindVertexArray(quadVAO);
 		glBindBuffer(GL_ARRAY_BUFFER, quadVBO);
 		glBufferData(GL_ARRAY_BUFFER, sizeof(quadVertices), &quadVertices, GL_STATIC_DRAW);
 		glEnableVertexAttribArray(0);
@@ -84,9 +251,86 @@ static void rendering_renderQuad()
 		glEnableVertexAttribArray(1);
 		glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)(3 * sizeof(float)));
 	}
-	glBindVertexArray(quadVAO);
+	glstate_bindVertexArray(quadVAO);
 	glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
-	glBindVertexArray(0);
+	glstate_bindVertexArray(0);
+}
+
+/**
+* Rendert eine Kugel, die die Einheitskugel vollstaendig umschlieszt. Die
+* Dreiecke liegen dafuer etwas auszerhalb, damit das Lichtvolumen keine
+* beleuchteten Pixel abschneidet.
+*/
+static void rendering_renderSphere()
+{
+	if (sphereVAO == 0)
+	{
+		// Die Mitte jeder Facette muss mindestens den Radius 1 haben.
+		float scale = 1.0f / (cosf(GLM_PIf / RENDERING_SPHERE_SLICES) * cosf(GLM_PIf / (2 * RENDERING_SPHERE_STACKS)));
+
+		float* vertices = malloc(sizeof(float) * 3 * RENDERING_SPHERE_VERTICES);
+		float* vertex = vertices;
+		for (int stack = 0; stack < RENDERING_SPHERE_STACKS; stack++)
+		{
+			float theta0 = GLM_PIf * stack / RENDERING_SPHERE_STACKS;
+			float theta1 = GLM_PIf * (stack + 1) / RENDERING_SPHERE_STACKS;
+
+			for (int slice = 0; slice < RENDERING_SPHERE_SLICES; slice++)
+			{
+				float phi0 = 2.0f * GLM_PIf * slice / RENDERING_SPHERE_SLICES;
+				float phi1 = 2.0f * GLM_PIf * (slice + 1) / RENDERING_SPHERE_SLICES;
+
+				// Eckpunkte des Vierecks, gegen den Uhrzeigersinn von auszen
+				vec3 corners[4] = {
+					{ sinf(theta0) * cosf(phi0), cosf(theta0), sinf(theta0) * sinf(phi0) },
+					{ sinf(theta0) * cosf(phi1), cosf(theta0), sinf(theta0) * sinf(phi1) },
+					{ sinf(theta1) * cosf(phi1), cosf(theta1), sinf(theta1) * sinf(phi1) },
+					{ sinf(theta1) * cosf(phi0), cosf(theta1), sinf(theta1) * sinf(phi0) },
+				};
+				int order[6] = { 0, 1, 2, 0, 2, 3 };
+
+				for (int i = 0; i < 6; i++)
+				{
+					glm_vec3_scale(corners[order[i]], scale, vertex);
+					vertex += 3;
+				}
+			}
+		}
+
+		glGenVertexArrays(1, &sphereVAO);
+		glGenBuffers(1, &sphereVBO);
+		glstate_bindVertexArray(sphereVAO);
+		glBindBuffer(GL_ARRAY_BUFFER, sphereVBO);
+		glBufferData(GL_ARRAY_BUFFER, sizeof(float) * 3 * RENDERING_SPHERE_VERTICES, vertices, GL_STATIC_DRAW);
+		glEnableVertexAttribArray(0);
+		glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+		glstate_bindVertexArray(0);
+
+		free(vertices);
+	}
+	glstate_bindVertexArray(sphereVAO);
+	glDrawArrays(GL_TRIANGLES, 0, RENDERING_SPHERE_VERTICES);
+	glstate_bindVertexArray(0);
+}
+
+/**
+* Uebergibt die GBuffer Texturen an einen Licht-Shader. Fuer den kompakten
+* GBuffer wird zusaetzlich die Tiefe uebergeben, die Matrix zur
+* Rekonstruktion der Position steckt im FrameData Block (u_screenToWorld).
+* Der Shader MUSS zuvor bereits aktiviert worden sein.
+*
+* @param shader der Licht-Shader
+*/
+static void rendering_setGBufferUniforms(Shader* shader)
+{
+	gbuffer_bindDepthTexture(gBuffer, GL_TEXTURE0 + RENDERING_UNIT_DEPTH);
+
+	shader_setInt(shader, "u_Position", GBUFFER_COLORATTACH_POSITION);
+	shader_setInt(shader, "u_Normal", GBUFFER_COLORATTACH_NORMAL);
+	shader_setInt(shader, "u_AlbedoSpec", GBUFFER_COLORATTACH_ALBEDOSPEC);
+	shader_setInt(shader, "u_Depth", RENDERING_UNIT_DEPTH);
+	shader_setBool(shader, "u_compactGBuffer", gbuffer_getLayout(gBuffer) == GBUFFER_LAYOUT_COMPACT);
 }
 
 /**
@@ -94,13 +338,25 @@ static void rendering_renderQuad()
 */
 void rendering_deleteAllShader(RenderingData* data)
 {
-	shader_deleteShader(data->modelShader);
+	shader_deleteBatch(data->shaderBatch);
+	shader_deleteVariants(data->modelVariants);
+	shader_deleteVariants(data->modelDirectVariants);
 	shader_deleteShader(data->dirLightShader);
 	shader_deleteShader(data->pointLightShader);
 	shader_deleteShader(data->nullShader);
-	shader_deleteShader(data->postProcessShader);
 	shader_deleteShader(data->dirShadowShader);
 	shader_deleteShader(data->pointShadowShader);
+	shader_deleteShader(data->tileDepthShader);
+	shader_deleteShader(data->tileCullShader);
+	shader_deleteShader(data->tiledLightShader);
+	shader_deleteShader(data->clusteredLightShader);
+	shader_deleteShader(data->thresholdShader);
+	shader_deleteShader(data->bloomDownShader);
+	shader_deleteShader(data->bloomUpShader);
+	shader_deleteShader(data->dofSetupShader);
+	shader_deleteShader(data->dofBlurShader);
+	shader_deleteShader(data->histogramShader);
+	shader_deleteShader(data->exposureAverageShader);
 }
 
 /**
@@ -110,80 +366,247 @@ void rendering_deleteAllShader(RenderingData* data)
  */
 static void rendering_loadShaders(RenderingData* data)
 {
-	data->modelShader = shader_createVeTessFrShader("Model",
+	// Die Varianten werden erst übersetzt, wenn ein Material sie braucht.
+	data->modelVariants = shader_createVariants("Model",
 		UTILS_CONST_RES("shader/model/model.vert"),
 		UTILS_CONST_RES("shader/model/model.tesc"),
 		UTILS_CONST_RES("shader/model/model.tese"),
-		UTILS_CONST_RES("shader/model/model.frag")
+		UTILS_CONST_RES("shader/model/model.frag"),
+		NULL, RENDERING_MODEL_FEATURES, RENDERING_MODEL_FEATURE_COUNT
+	);
+	data->modelDirectVariants = shader_createVariants("ModelDirect",
+		UTILS_CONST_RES("shader/model/model.vert"),
+		NULL, NULL,
+		UTILS_CONST_RES("shader/model/model.frag"),
+		"#define MODEL_DIRECT\n",
+		RENDERING_MODEL_FEATURES, RENDERING_MODEL_FEATURE_COUNT
 	);
-	data->dirLightShader = shader_createVeFrShader("DirLight",
+	// Alle Programme werden gemeinsam abgeschickt und erst danach geprüft,
+	// damit der Treiber sie parallel übersetzen kann.
+	ShaderBatch* batch = shader_createBatch();
+	shader_batchVeFrShader(batch, &data->dirLightShader, "DirLight",
 		UTILS_CONST_RES("shader/dirLight/dirLight.vert"),
 		UTILS_CONST_RES("shader/dirLight/dirLight.frag")
 	);
-	data->pointLightShader = shader_createVeFrShader("PointLight",
+	shader_batchVeFrShader(batch, &data->pointLightShader, "PointLight",
 		UTILS_CONST_RES("shader/pointLight/pointLight.vert"),
 		UTILS_CONST_RES("shader/pointLight/pointLight.frag")
 	);
-	data->nullShader = shader_createVeFrShader("Null",
+	shader_batchVeFrShader(batch, &data->nullShader, "Null",
 		UTILS_CONST_RES("shader/null/null.vert"),
 		UTILS_CONST_RES("shader/null/null.frag")
 	);
-	data->postProcessShader = shader_createVeFrShader("PostProcess",
-		UTILS_CONST_RES("shader/postProcess/postProcess.vert"),
-		UTILS_CONST_RES("shader/postProcess/postProcess.frag")
-	);
-	data->dirShadowShader = shader_createVeFrShader("DirShadow",
+	shader_batchVeFrShader(batch, &data->dirShadowShader, "DirShadow",
 		UTILS_CONST_RES("shader/dirShadow/dirShadow.vert"),
 		UTILS_CONST_RES("shader/dirShadow/dirShadow.frag")
 	);
-	data->pointShadowShader = shader_createVeFrShader("PointShadow",
+	shader_batchVeGeFrShader(batch, &data->pointShadowShader, "PointShadow",
 		UTILS_CONST_RES("shader/pointShadow/pointShadow.vert"),
+		UTILS_CONST_RES("shader/pointShadow/pointShadow.geom"),
 		UTILS_CONST_RES("shader/pointShadow/pointShadow.frag")
 	);
+	shader_batchVeFrShader(batch, &data->tileDepthShader, "TileDepth",
+		UTILS_CONST_RES("shader/tileDepth/tileDepth.vert"),
+		UTILS_CONST_RES("shader/tileDepth/tileDepth.frag")
+	);
+	shader_batchVeFrShader(batch, &data->tileCullShader, "TileCull",
+		UTILS_CONST_RES("shader/tileCull/tileCull.vert"),
+		UTILS_CONST_RES("shader/tileCull/tileCull.frag")
+	);
+	shader_batchVeFrShader(batch, &data->tiledLightShader, "TiledLight",
+		UTILS_CONST_RES("shader/tiledLight/tiledLight.vert"),
+		UTILS_CONST_RES("shader/tiledLight/tiledLight.frag")
+	);
+	shader_batchVeFrShader(batch, &data->clusteredLightShader, "ClusteredLight",
+		UTILS_CONST_RES("shader/clusteredLight/clusteredLight.vert"),
+		UTILS_CONST_RES("shader/clusteredLight/clusteredLight.frag")
+	);
+	shader_batchVeFrShader(batch, &data->thresholdShader, "Threshold",
+		UTILS_CONST_RES("shader/threshold/threshold.vert"),
+		UTILS_CONST_RES("shader/threshold/threshold.frag")
+	);
+	shader_batchVeFrShader(batch, &data->bloomDownShader, "BloomDown",
+		UTILS_CONST_RES("shader/bloomDown/bloomDown.vert"),
+		UTILS_CONST_RES("shader/bloomDown/bloomDown.frag")
+	);
+	shader_batchVeFrShader(batch, &data->bloomUpShader, "BloomUp",
+		UTILS_CONST_RES("shader/bloomUp/bloomUp.vert"),
+		UTILS_CONST_RES("shader/bloomUp/bloomUp.frag")
+	);
+	shader_batchVeFrShader(batch, &data->dofSetupShader, "DoFSetup",
+		UTILS_CONST_RES("shader/depthOfField/depthOfField.vert"),
+		UTILS_CONST_RES("shader/depthOfField/setup.frag")
+	);
+	shader_batchVeFrShader(batch, &data->dofBlurShader, "DoFBlur",
+		UTILS_CONST_RES("shader/depthOfField/depthOfField.vert"),
+		UTILS_CONST_RES("shader/depthOfField/blur.frag")
+	);
+	shader_batchVeFrShader(batch, &data->histogramShader, "Histogram",
+		UTILS_CONST_RES("shader/histogram/histogram.vert"),
+		UTILS_CONST_RES("shader/histogram/histogram.frag")
+	);
+	shader_batchVeFrShader(batch, &data->exposureAverageShader, "ExposureAverage",
+		UTILS_CONST_RES("shader/exposureAverage/exposureAverage.vert"),
+		UTILS_CONST_RES("shader/exposureAverage/exposureAverage.frag")
+	);
+
+	// Der Durchgang bleibt fuer das Neuladen einzelner Dateien bestehen.
+	shader_buildBatch(batch);
+	data->shaderBatch = batch;
+}
+
+/**
+* Laedt alle Shader neu, die eine Datei nutzen. Sie werden im Hintergrund
+* uebersetzt und erst nach erfolgreichem Linken uebernommen (siehe
+* rendering_updateShaderReloads).
+*
+* @param data die zu renderden Daten
+* @param file der Pfad der Datei oder NULL fuer alle Shader
+*/
+static void rendering_reloadShaderFile(RenderingData* data, const char* file)
+{
+	int requested = shader_reloadBatch(data->shaderBatch, file);
+	requested += shader_reloadVariants(data->modelVariants, file);
+	requested += shader_reloadVariants(data->modelDirectVariants, file);
+
+	if (file == NULL || postprocess_usesFile(data->postChain, file))
+	{
+		postprocess_invalidate(data->postChain);
+		requested++;
+	}
+
+	if (file != NULL && requested > 0)
+	{
+		printf("Reloading %d shader(s) for \"%s\".\n", requested, file);
+	}
+}
+
+/**
+* Wird vom FileWatcher fuer jede geaenderte Shader-Datei aufgerufen.
+*
+* @param file der Pfad der Datei
+* @param userData die zu renderden Daten
+*/
+static void rendering_onShaderFileChanged(const char* file, void* userData)
+{
+	rendering_reloadShaderFile(userData, file);
 }
 
 /**
-* Uebergibt die Daten an den Model Shader
+* Uebernimmt fertig uebersetzte Shader.
+*
+* @param data die zu renderden Daten
+*/
+static void rendering_updateShaderReloads(RenderingData* data)
+{
+	int swapped = shader_updateBatch(data->shaderBatch);
+	shader_updateVariants(data->modelVariants);
+	shader_updateVariants(data->modelDirectVariants);
+
+	// Die Schatten-Shader koennen sich geaendert haben.
+	if (swapped > 0)
+	{
+		shadow_invalidate(data->dirShadow);
+		shadow_invalidatePointShadows(data->pointShadows);
+	}
+}
+
+/**
+* Liefert die Varianten des Shaders fuer das Modell. Ohne Tessellation
+* werden Varianten ohne Tessellation Stufen verwendet, damit diese nicht bei
+* Level 1 umsonst durchlaufen werden.
 *
 * @param data die zu renderden Daten
 * @param input gui Input
-* @param projectionMatrix die Projektions Matrix
-* @param viewMatrix die View Matrix
-* @param modelMatrix die Model Matrix
+* @return die Varianten des Shaders
+*/
+static ShaderVariants* rendering_getModelVariants(RenderingData* data, InputData* input)
+{
+	return input->showTess ? data->modelVariants : data->modelDirectVariants;
+}
+
+/**
+* Uebergibt die Uniforms an eine gerade aktivierte Variante des Model Shaders.
+* Die Schalter fuer Normalmap und GBuffer Layout stecken in der Variante.
+*
+* @param shader die Variante des Shaders
+* @param userData die Uniforms (ModelUniforms)
 */
-static void rendering_renderModel(RenderingData* data, InputData* input, mat4* projectionMatrix, mat4* viewMatrix, mat4* modelMatrix)
+static void rendering_setModelUniforms(Shader* shader, void* userData)
 {
-	shader_useShader(data->modelShader);
+	ModelUniforms* uniforms = userData;
+	InputData* input = uniforms->input;
 
-	// Shader projection Matrix uebergeben
-	shader_setMat4(data->modelShader, "u_projectionMatrix", projectionMatrix);
-	// Shader model Matrix uebergeben
-	shader_setMat4(data->modelShader, "u_modelMatrix", modelMatrix);
-	// Shader view Matrix uebergeben
-	shader_setMat4(data->modelShader, "u_viewMatrix", viewMatrix);
+	// Shader model Matrix uebergeben, Kamera und Projektion stecken im
+	// FrameData Block.
+	shader_setMat4(shader, "u_modelMatrix", uniforms->modelMatrix);
 
 	vec3 fogColor;
 	//glm_vec4_copy3(input->rendering.fogColor, fogColor);
-	shader_setVec3(data->modelShader, "u_fogColor", &fogColor);
+	shader_setVec3(shader, "u_fogColor", &fogColor);
 
-	shader_setBool(data->modelShader, "u_useFog", input->showFog);
+	shader_setBool(shader, "u_useFog", input->showFog);
 
-	shader_setFloat(data->modelShader, "u_density", input->density);
+	shader_setFloat(shader, "u_density", input->density);
 
-	shader_setInt(data->modelShader, "u_shaderChoice", input->shaderChoice);
+	shader_setInt(shader, "u_shaderChoice", input->shaderChoice);
+
+	// Tesselation: Level aus der Kantenlaenge auf dem Bildschirm, nicht
+	// sichtbare Patches werden verworfen.
+	shader_setBool(shader, "u_useTess", input->showTess);
+	shader_setFloat(shader, "u_tessEdgePixels", input->rendering.tessEdgePixels);
+	shader_setBool(shader, "u_cullBackfaces", !input->showWireframe);
+}
 
-	shader_setBool(data->modelShader, "u_showNormalMap", input->showNormalMap);
+/**
+* Zeichnet das Modell. Jedes Mesh nutzt die Variante des Model Shaders, die
+* zu seinem Material passt, so dass der Fragment Shader keine Verzweigungen
+* fuer nicht genutzte Texturen enthaelt. Die Meshes laufen ueber die Render
+* Queue, dadurch werden Shader und Material nur bei einem Wechsel gesetzt
+* und gleiche Materialien von vorne nach hinten gezeichnet.
+*
+* @param data die zu renderden Daten
+* @param input gui Input
+* @param viewMatrix die View Matrix
+* @param modelMatrix die Model Matrix
+*/
+static void rendering_renderModel(RenderingData* data, InputData* input, mat4* viewMatrix, mat4* modelMatrix)
+{
+	ModelUniforms uniforms = {
+		input, modelMatrix
+	};
 
-	//Tesselation
-	shader_setBool(data->modelShader, "u_useTess", input->showTess);
-	shader_setFloat(data->modelShader, "u_TessLevelInner", input->rendering.tessInner);
-	shader_setFloat(data->modelShader, "u_TessLevelOuter", input->rendering.tessOuter);
+	unsigned int features = 0;
+	if (input->showNormalMap)
+	{
+		features |= RENDERING_MODEL_FEATURE_TBN;
+	}
+	if (gbuffer_getLayout(gBuffer) == GBUFFER_LAYOUT_COMPACT)
+	{
+		features |= RENDERING_MODEL_FEATURE_COMPACT;
+	}
+
+	mat4 modelViewMatrix;
+	glm_mat4_mul(*viewMatrix, *modelMatrix, modelViewMatrix);
+
+	// Meshes einreichen und sortieren
+	renderqueue_clear(data->renderQueue);
+	model_submitModel(input->rendering.userScene->model, data->renderQueue,
+		rendering_getModelVariants(data, input), features, modelViewMatrix,
+		RENDERING_FAR_PLANE);
+	renderqueue_sort(data->renderQueue);
 
 	// Modell zeichnen
 	common_pushRenderScope("Scene Model");
-	model_drawModel(input->rendering.userScene->model, data->modelShader, input->showTess);
+	RenderQueueStats queueStats = renderqueue_execute(data->renderQueue,
+		rendering_setModelUniforms, &uniforms, input->showTess);
 	common_popRenderScope();
 
+	data->stats.queueItems = queueStats.items;
+	data->stats.queueProgramChanges = queueStats.programChanges;
+	data->stats.queueMaterialChanges = queueStats.materialChanges;
+	data->stats.queueDrawCalls = queueStats.drawCalls;
+
 	// Wireframe vorm Rendern des Frames wieder deaktivieren.
 	glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
 }
@@ -193,10 +616,8 @@ static void rendering_renderModel(RenderingData* data, InputData* input, mat4* p
 *
 * @param data die zu renderden Daten
 * @param input gui Input
-* @param modelMatrix die Model Matrix
-* @param screenSize Die Fenstergroesze
 */
-static void rendering_renderDirLight(RenderingData* data, InputData* input, vec2* screenSize, mat4* modelMatrix, mat4* lightSpaceMatrix) {
+static void rendering_renderDirLight(RenderingData* data, InputData* input) {
 
 	shader_useShader(data->dirLightShader);
 
@@ -216,17 +637,13 @@ static void rendering_renderDirLight(RenderingData* data, InputData* input, vec2
 	// Licht diffuse
 	float matDiffuse = { input->rendering.lightComp[2] };
 
-	vec3 viewPos = { 0.0, 0.0, 0.0 };
-	camera_getPosition(input->mainCamera, viewPos);
-
-	shader_setInt(data->dirLightShader, "u_Position", GBUFFER_COLORATTACH_POSITION);
-	shader_setInt(data->dirLightShader, "u_Normal", GBUFFER_COLORATTACH_NORMAL);
-	shader_setInt(data->dirLightShader, "u_AlbedoSpec", GBUFFER_COLORATTACH_ALBEDOSPEC);
+	rendering_setGBufferUniforms(data->dirLightShader);
 	shader_setInt(data->dirLightShader, "u_Emission", GBUFFER_COLORATTACH_EMISSION);
 
-	shader_setInt(data->dirLightShader, "u_shadowMap", 6);
-
-	shader_setVec2(data->dirLightShader, "u_screenSize", screenSize);
+	shadow_activateCascades(data->dirShadow, data->dirLightShader, RENDERING_UNIT_SHADOW_MAP,
+		input->showShadow && data->dirShadowShader != NULL);
+	shader_setInt(data->dirLightShader, "u_pcfKernel", (int)input->shadowFilter);
+	shader_setFloat(data->dirLightShader, "u_pcfRadius", input->shadowFilterRadius);
 
 	shader_setVec3(data->dirLightShader, "u_lightDirVec", &u_lightDirVec);
 	shader_setVec3(data->dirLightShader, "u_lightColor", &lightColor);
@@ -234,41 +651,60 @@ static void rendering_renderDirLight(RenderingData* data, InputData* input, vec2
 	shader_setFloat(data->dirLightShader, "u_matSpecular", matSpecular);
 	shader_setFloat(data->dirLightShader, "u_matDiffuse", matDiffuse);
 
-	shader_setVec3(data->dirLightShader, "u_viewPos", &viewPos);
-
-	shader_setMat4(data->dirLightShader, "u_modelMatrix", modelMatrix);
-	shader_setMat4(data->dirLightShader, "u_lightSpaceMatrix", lightSpaceMatrix);
-
-
-	glActiveTexture(GL_TEXTURE6);
-	glBindTexture(GL_TEXTURE_2D, depthMap);
-
-	glDisable(GL_DEPTH_TEST);
-	glEnable(GL_BLEND);
-	glBlendEquation(GL_FUNC_ADD);
-	glBlendFunc(GL_ONE, GL_ONE);
+	glstate_disable(GL_DEPTH_TEST);
+	glstate_enable(GL_BLEND);
+	glstate_blendEquation(GL_FUNC_ADD);
+	glstate_blendFunc(GL_ONE, GL_ONE);
 
 	// dirLight zeichnen
 	common_pushRenderScope("Scene dirLight");
 	rendering_renderQuad();
 	common_popRenderScope();
 
-	glDisable(GL_BLEND);
+	glstate_disable(GL_BLEND);
 }
 
 /**
-* Uebergibt die Daten an den Direct Light Shader
+* Markiert im Stencil Buffer alle Pixel, deren Geometrie innerhalb des
+* Lichtvolumens liegt. Von der Kugel werden Vorder- und Rueckseiten
+* gezeichnet: Scheitert der Tiefentest fuer eine Rueckseite, wird der Wert
+* erhoeht, scheitert er fuer eine Vorderseite, wird er verringert. Uebrig
+* bleiben nur Pixel, die vor der Rueckseite und hinter der Vorderseite liegen.
 *
 * @param data die zu renderden Daten
-* @param input gui Input
-* @param modelMatrix die Model Matrix
-* @param screenSize Die Fenstergroesze
+* @param lightMatrix die Model Matrix des Lichtvolumens
 */
-static void rendering_renderPointLight(RenderingData* data, InputData* input, vec2* screenSize, mat4* projectionMatrix, mat4* viewMatrix, mat4* modelMatrix) {
+static void rendering_renderPointLightStencil(RenderingData* data, mat4* lightMatrix)
+{
+	gbuffer_bindGBufferForStencilPass(gBuffer);
 
-	// Lichtfarbe
-	vec3 lightColor;
-	glm_vec4_copy3(input->rendering.lightColor, lightColor);
+	shader_useShader(data->nullShader);
+	shader_setMat4(data->nullShader, "u_modelMatrix", lightMatrix);
+
+	glstate_enable(GL_DEPTH_TEST);
+	glstate_disable(GL_CULL_FACE);
+	glClear(GL_STENCIL_BUFFER_BIT);
+
+	// Der Stencil Test wird nur fuer die Operationen benoetigt.
+	glStencilFunc(GL_ALWAYS, 0, 0);
+	glStencilOpSeparate(GL_BACK, GL_KEEP, GL_INCR_WRAP, GL_KEEP);
+	glStencilOpSeparate(GL_FRONT, GL_KEEP, GL_DECR_WRAP, GL_KEEP);
+
+	rendering_renderSphere();
+}
+
+/**
+* Uebergibt die Daten an den pointLight Shader und zeichnet jedes Licht als
+* Kugel mit dem Radius seiner Abschwaechung. Ueber den Stencil Buffer werden
+* nur die Pixel berechnet, die tatsaechlich im Lichtvolumen liegen.
+* Lichter ohne endlichen Radius werden weiterhin als Vollbild-Quad gezeichnet.
+*
+* @param data die zu renderden Daten
+* @param input gui Input
+* @param firstLight das erste zu zeichnende Licht, alle davor wurden bereits
+*                   von einem anderen Verfahren berechnet
+*/
+static void rendering_renderPointLight(RenderingData* data, InputData* input, unsigned int firstLight) {
 
 	// Licht ambient
 	float matAmbient = { input->rendering.lightComp[0] };
@@ -279,73 +715,703 @@ static void rendering_renderPointLight(RenderingData* data, InputData* input, ve
 	// Licht diffuse
 	float matDiffuse = { input->rendering.lightComp[2] };
 
-	vec3 viewPos = { 0.0, 0.0, 0.0 };
-	camera_getPosition(input->mainCamera, viewPos);
-
 	shader_useShader(data->pointLightShader);
 
-	// Shader projection Matrix uebergeben
-	shader_setMat4(data->pointLightShader, "u_projectionMatrix", projectionMatrix);
-	// Shader model Matrix uebergeben
-	shader_setMat4(data->pointLightShader, "u_modelMatrix", modelMatrix);
-	// Shader view Matrix uebergeben
-	shader_setMat4(data->pointLightShader, "u_viewMatrix", viewMatrix);
-
-	shader_setVec3(data->pointLightShader, "u_viewPos", &viewPos);
-
-	shader_setInt(data->pointLightShader, "u_Position", GBUFFER_COLORATTACH_POSITION);
-	shader_setInt(data->pointLightShader, "u_Normal", GBUFFER_COLORATTACH_NORMAL);
-	shader_setInt(data->pointLightShader, "u_AlbedoSpec", GBUFFER_COLORATTACH_ALBEDOSPEC);
-	shader_setInt(data->pointLightShader, "u_Emission", GBUFFER_COLORATTACH_EMISSION);
-
-	shader_setInt(data->pointLightShader, "u_shadowMap", 4);
-
-	shader_setVec2(data->pointLightShader, "u_screenSize", screenSize);
+	rendering_setGBufferUniforms(data->pointLightShader);
+	shader_setBool(data->pointLightShader, "u_fullscreen", false);
 
 	shader_setFloat(data->pointLightShader, "u_matAmbient", matAmbient);
 	shader_setFloat(data->pointLightShader, "u_matSpecular", matSpecular);
 	shader_setFloat(data->pointLightShader, "u_matDiffuse", matDiffuse);
 
+	shadow_activatePointShadows(data->pointShadows, data->pointLightShader, RENDERING_UNIT_POINT_SHADOWS,
+		input->showShadow && data->pointShadowShader != NULL);
+
 	unsigned int countPointLights = input->rendering.userScene->countPointLights;
 
-	PointLight* light = input->rendering.userScene->pointLights[0];
+	PointLight* light;
+
+	// Die Kugeln muessen gefuellt gezeichnet werden, sonst stimmt die
+	// Zaehlung im Stencil Buffer nicht. Durch Depth Clamping wird die Kugel
+	// nicht von der Near-Plane abgeschnitten, wenn die Kamera im Licht steht.
+	glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+	glstate_enable(GL_DEPTH_CLAMP);
+	glstate_enable(GL_STENCIL_TEST);
+
+	glstate_blendEquation(GL_FUNC_ADD); // GPU will simply add the source and the destination
+	glstate_blendFunc(GL_ONE, GL_ONE); // true addition
 
-	for (unsigned int i = 0; i < countPointLights; i++) {
+	for (unsigned int i = firstLight; i < countPointLights; i++) {
 		light = input->rendering.userScene->pointLights[i];
 
-		glEnable(GL_BLEND); // Enable Blending
-		glBlendEquation(GL_FUNC_ADD); // GPU will simply add the source and the destination
-		glBlendFunc(GL_ONE, GL_ONE); // true addition
+		if (light->radius == FLT_MAX)
+		{
+			// Ohne Radius wirkt das Licht auf den ganzen Bildschirm.
+			glstate_disable(GL_STENCIL_TEST);
+			glstate_disable(GL_DEPTH_TEST);
+			glstate_disable(GL_CULL_FACE);
+			gbuffer_bindGBufferForLightPass(gBuffer);
+
+			shader_useShader(data->pointLightShader);
+			shader_setBool(data->pointLightShader, "u_fullscreen", true);
+			light_activatePointLight(light, data->pointLightShader);
+
+			glstate_enable(GL_BLEND);
+			common_pushRenderScope("Scene pointLight");
+			rendering_renderQuad();
+			common_popRenderScope();
+			glstate_disable(GL_BLEND);
+
+			shader_setBool(data->pointLightShader, "u_fullscreen", false);
+			glstate_enable(GL_STENCIL_TEST);
+			continue;
+		}
+
+		// Kugel um das Licht mit dem Radius der Abschwaechung
+		mat4 lightMatrix;
+		glm_translate_make(lightMatrix, light->position);
+		glm_scale_uni(lightMatrix, light->radius);
+
+		// 1. Pixel im Lichtvolumen markieren
+		common_pushRenderScope("Scene pointLight Stencil");
+		rendering_renderPointLightStencil(data, &lightMatrix);
+		common_popRenderScope();
 
+		// 2. Nur markierte Pixel beleuchten. Es werden die Rueckseiten
+		// gezeichnet, damit das Licht auch sichtbar bleibt, wenn die Kamera
+		// innerhalb der Kugel steht.
+		gbuffer_bindGBufferForLightPass(gBuffer);
+		glStencilFunc(GL_NOTEQUAL, 0, 0xFF);
+		glstate_disable(GL_DEPTH_TEST);
+		glstate_enable(GL_CULL_FACE);
+		glstate_cullFace(GL_FRONT);
+
+		shader_useShader(data->pointLightShader);
+		shader_setMat4(data->pointLightShader, "u_modelMatrix", &lightMatrix);
 		light_activatePointLight(light, data->pointLightShader);
 
-		// pointLight zeichnen
+		glstate_enable(GL_BLEND);
 		common_pushRenderScope("Scene pointLight");
-		rendering_renderQuad();
+		rendering_renderSphere();
 		common_popRenderScope();
-		glDisable(GL_BLEND);
+		glstate_disable(GL_BLEND);
+
+		glstate_cullFace(GL_BACK);
+	}
+
+	// Zustand fuer die folgenden Paesse wiederherstellen.
+	glstate_disable(GL_STENCIL_TEST);
+	glstate_disable(GL_DEPTH_CLAMP);
+	glstate_disable(GL_DEPTH_TEST);
+	gbuffer_bindGBufferForLightPass(gBuffer);
+	if (input->showWireframe)
+	{
+		glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
+		glstate_disable(GL_CULL_FACE);
+	}
+	else
+	{
+		glstate_enable(GL_CULL_FACE);
+	}
+}
+
+/**
+* Berechnet alle Punktlichter per Tiled Deferred Lighting. Zuerst wird der
+* Tiefenbereich jeder Kachel bestimmt, dann die Lichtmaske jeder Kachel und
+* zum Schluss werden alle Lichter in einem einzigen Vollbild-Pass berechnet.
+* Kacheln und Cluster beziehen sich auf den gerenderten Bereich, die
+* Texturkoordinaten dagegen auf die volle Groesze des GBuffers.
+* Lichter ueber TILED_MAX_LIGHTS passen nicht in die Maske einer Kachel und
+* werden danach einzeln ueber den normalen Pfad gezeichnet.
+*
+* @param data die zu renderden Daten
+* @param input gui Input
+*/
+static void rendering_renderTiledPointLights(RenderingData* data, InputData* input)
+{
+	Scene* scene = input->rendering.userScene;
+	if (scene->countPointLights == 0)
+	{
+		return;
+	}
+
+	// Überzählige Lichter passen nicht mehr in die Maske einer Kachel.
+	unsigned int countPointLights = scene->countPointLights;
+	if (countPointLights > TILED_MAX_LIGHTS)
+	{
+		countPointLights = TILED_MAX_LIGHTS;
+	}
+	data->stats.tiledOverflowLights = scene->countPointLights - countPointLights;
+	light_updateLightBuffer(data->lightBuffer, scene->pointLights, countPointLights);
+
+	glstate_disable(GL_DEPTH_TEST);
+	glstate_disable(GL_BLEND);
+
+	// 1. Tiefenbereich der Kacheln bestimmen
+	tiled_bindForDepthPass(data->tiled);
+	gbuffer_bindDepthTexture(gBuffer, GL_TEXTURE0 + RENDERING_UNIT_DEPTH);
+
+	shader_useShader(data->tileDepthShader);
+	shader_setInt(data->tileDepthShader, "u_depth", RENDERING_UNIT_DEPTH);
+
+	common_pushRenderScope("Tile Depth Range");
+	rendering_renderQuad();
+	common_popRenderScope();
+
+	// 2. Lichter den Kacheln zuordnen
+	tiled_bindForCullPass(data->tiled, GL_TEXTURE0 + RENDERING_UNIT_TILE_DEPTH);
+	light_bindLightBuffer(data->lightBuffer, GL_TEXTURE0 + RENDERING_UNIT_LIGHTS);
+
+	shader_useShader(data->tileCullShader);
+	shader_setInt(data->tileCullShader, "u_depthRange", RENDERING_UNIT_TILE_DEPTH);
+	shader_setInt(data->tileCullShader, "u_lights", RENDERING_UNIT_LIGHTS);
+	shader_setInt(data->tileCullShader, "u_lightCount", (int)countPointLights);
+
+	common_pushRenderScope("Tile Light Culling");
+	rendering_renderQuad();
+	common_popRenderScope();
+
+	// 3. Alle Lichter in einem Pass berechnen
+	glViewport(0, 0, (GLsizei)data->renderSize[0], (GLsizei)data->renderSize[1]);
+	gbuffer_bindGBufferForLightPass(gBuffer);
+	tiled_bindForLightPass(data->tiled, GL_TEXTURE0 + RENDERING_UNIT_TILE_MASK);
+
+	shader_useShader(data->tiledLightShader);
+	rendering_setGBufferUniforms(data->tiledLightShader);
+	shader_setInt(data->tiledLightShader, "u_tileMask0", RENDERING_UNIT_TILE_MASK + 0);
+	shader_setInt(data->tiledLightShader, "u_tileMask1", RENDERING_UNIT_TILE_MASK + 1);
+	shader_setInt(data->tiledLightShader, "u_tileMask2", RENDERING_UNIT_TILE_MASK + 2);
+	shader_setInt(data->tiledLightShader, "u_tileMask3", RENDERING_UNIT_TILE_MASK + 3);
+	shader_setInt(data->tiledLightShader, "u_lights", RENDERING_UNIT_LIGHTS);
+	shader_setFloat(data->tiledLightShader, "u_matAmbient", input->rendering.lightComp[0]);
+	shader_setFloat(data->tiledLightShader, "u_matSpecular", input->rendering.lightComp[1]);
+	shader_setFloat(data->tiledLightShader, "u_matDiffuse", input->rendering.lightComp[2]);
+	shadow_activatePointShadows(data->pointShadows, data->tiledLightShader, RENDERING_UNIT_POINT_SHADOWS,
+		input->showShadow && data->pointShadowShader != NULL);
+
+	glstate_enable(GL_BLEND);
+	glstate_blendEquation(GL_FUNC_ADD);
+	glstate_blendFunc(GL_ONE, GL_ONE);
+
+	common_pushRenderScope("Scene tiledPointLight");
+	rendering_renderQuad();
+	common_popRenderScope();
+
+	glstate_disable(GL_BLEND);
+
+	// Die übrigen Lichter einzeln zeichnen, damit sie nicht verloren gehen.
+	if (data->stats.tiledOverflowLights > 0
+		&& data->pointLightShader != NULL && data->nullShader != NULL)
+	{
+		rendering_renderPointLight(data, input, countPointLights);
+	}
+}
+
+/**
+* Berechnet alle Punktlichter per Clustered Deferred Lighting. Die Lichter
+* werden auf der CPU den Clustern zugeordnet, danach werden alle Lichter in
+* einem einzigen Vollbild-Pass berechnet. Die Anzahl der Lichter ist dabei
+* nicht begrenzt.
+*
+* @param data die zu renderden Daten
+* @param input gui Input
+* @param projectionMatrix die Projektions Matrix
+* @param viewMatrix die View Matrix
+*/
+static void rendering_renderClusteredPointLights(RenderingData* data, InputData* input, mat4* projectionMatrix, mat4* viewMatrix)
+{
+	Scene* scene = input->rendering.userScene;
+	if (scene->countPointLights == 0)
+	{
+		data->stats.clusterMs = 0.0;
+		return;
+	}
+
+	// Zuordnung auf der CPU inklusive Upload messen.
+	double start = glfwGetTime();
+	light_updateLightBuffer(data->lightBuffer, scene->pointLights, scene->countPointLights);
+	cluster_updateClusters(data->clusters, scene->pointLights, scene->countPointLights,
+		*viewMatrix, *projectionMatrix, (int)data->renderSize[0], (int)data->renderSize[1],
+		RENDERING_NEAR_PLANE, RENDERING_FAR_PLANE);
+	data->stats.clusterMs = (glfwGetTime() - start) * 1000.0;
+
+	glstate_disable(GL_DEPTH_TEST);
+
+	light_bindLightBuffer(data->lightBuffer, GL_TEXTURE0 + RENDERING_UNIT_LIGHTS);
+
+	shader_useShader(data->clusteredLightShader);
+	cluster_activateClusters(data->clusters, data->clusteredLightShader,
+		RENDERING_UNIT_CLUSTER_GRID, RENDERING_UNIT_CLUSTER_INDICES);
+	rendering_setGBufferUniforms(data->clusteredLightShader);
+	shader_setInt(data->clusteredLightShader, "u_lights", RENDERING_UNIT_LIGHTS);
+	shader_setFloat(data->clusteredLightShader, "u_matAmbient", input->rendering.lightComp[0]);
+	shader_setFloat(data->clusteredLightShader, "u_matSpecular", input->rendering.lightComp[1]);
+	shader_setFloat(data->clusteredLightShader, "u_matDiffuse", input->rendering.lightComp[2]);
+	shadow_activatePointShadows(data->pointShadows, data->clusteredLightShader, RENDERING_UNIT_POINT_SHADOWS,
+		input->showShadow && data->pointShadowShader != NULL);
+
+	glstate_enable(GL_BLEND);
+	glstate_blendEquation(GL_FUNC_ADD);
+	glstate_blendFunc(GL_ONE, GL_ONE);
+
+	common_pushRenderScope("Scene clusteredPointLight");
+	rendering_renderQuad();
+	common_popRenderScope();
+
+	glstate_disable(GL_BLEND);
+}
+
+/**
+* Berechnet den Bloom aus dem HDR Buffer. Die hellen Bereiche werden in halbe
+* Aufloesung uebernommen, schrittweise verkleinert und beim Vergroeszern
+* wieder aufaddiert. Das Ergebnis liegt danach in der ersten Stufe.
+*
+* @param data die zu renderden Daten
+* @param input gui Input
+*/
+static void rendering_renderBloom(RenderingData* data, InputData* input)
+{
+	int mipCount = bloom_getMipCount(data->bloom);
+	if (mipCount == 0)
+	{
+		return;
+	}
+
+	glstate_disable(GL_DEPTH_TEST);
+	glstate_disable(GL_BLEND);
+
+	// 1. Helle Bereiche in halber Aufloesung herausfiltern
+	shader_useShader(data->thresholdShader);
+	shader_setInt(data->thresholdShader, "u_source", GBUFFER_COLORATTACH_FINAL);
+	shader_setFloat(data->thresholdShader, "u_threshold", input->bloomThreshold);
+	shader_setFloat(data->thresholdShader, "u_knee", input->bloomKnee);
+	bloom_bindForMip(data->bloom, 0, data->renderRatio, data->thresholdShader);
+
+	common_pushRenderScope("Bloom Threshold");
+	rendering_renderQuad();
+	common_popRenderScope();
+
+	// 2. Stufenweise verkleinern
+	shader_useShader(data->bloomDownShader);
+	shader_setInt(data->bloomDownShader, "u_source", RENDERING_UNIT_BLOOM);
+
+	common_pushRenderScope("Bloom Downsample");
+	for (int i = 1; i < mipCount; i++)
+	{
+		bloom_bindMipTexture(data->bloom, i - 1, GL_TEXTURE0 + RENDERING_UNIT_BLOOM);
+		bloom_bindForMip(data->bloom, i, data->renderRatio, data->bloomDownShader);
+		rendering_renderQuad();
 	}
+	common_popRenderScope();
+
+	// 3. Stufenweise vergroeszern und auf die groeszere Stufe addieren
+	shader_useShader(data->bloomUpShader);
+	shader_setInt(data->bloomUpShader, "u_source", RENDERING_UNIT_BLOOM);
+	shader_setFloat(data->bloomUpShader, "u_radius", RENDERING_BLOOM_RADIUS);
+
+	glstate_enable(GL_BLEND);
+	glstate_blendEquation(GL_FUNC_ADD);
+	glstate_blendFunc(GL_ONE, GL_ONE);
+
+	common_pushRenderScope("Bloom Upsample");
+	for (int i = mipCount - 1; i > 0; i--)
+	{
+		bloom_bindMipTexture(data->bloom, i, GL_TEXTURE0 + RENDERING_UNIT_BLOOM);
+		bloom_bindForMip(data->bloom, i - 1, data->renderRatio, data->bloomUpShader);
+		rendering_renderQuad();
+	}
+	common_popRenderScope();
+
+	glstate_disable(GL_BLEND);
+	glstate_bindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+/**
+* Uebergibt die gemeinsamen Uniforms aller Paesse der Tiefenunschaerfe fuer
+* die Berechnung des Unschaerfekreises (siehe dof.h).
+* Der Shader MUSS zuvor bereits aktiviert worden sein.
+*
+* @param data die zu renderden Daten
+* @param input gui Input
+* @param shader der Shader des Passes
+*/
+static void rendering_setDepthOfFieldUniforms(RenderingData* data, InputData* input, Shader* shader)
+{
+	gbuffer_bindDepthTexture(gBuffer, GL_TEXTURE0 + RENDERING_UNIT_DEPTH);
+
+	shader_setInt(shader, "u_depth", RENDERING_UNIT_DEPTH);
+	shader_setFloat(shader, "u_focusDistance", input->focusDistance);
+	shader_setFloat(shader, "u_aperture", input->aperture);
+	shader_setFloat(shader, "u_maxRadius", DOF_MAX_RADIUS);
+}
+
+/**
+* Berechnet die Tiefenunschaerfe in halber Aufloesung. Das Ergebnis wird
+* im PostProcess mit dem scharfen Bild gemischt.
+*
+* @param data die zu renderden Daten
+* @param input gui Input
+*/
+static void rendering_renderDepthOfField(RenderingData* data, InputData* input)
+{
+	glstate_disable(GL_DEPTH_TEST);
+	glstate_disable(GL_BLEND);
+
+	// 1. In halbe Aufloesung verkleinern und nach Ebenen trennen
+	shader_useShader(data->dofSetupShader);
+	shader_setInt(data->dofSetupShader, "u_source", GBUFFER_COLORATTACH_FINAL);
+	rendering_setDepthOfFieldUniforms(data, input, data->dofSetupShader);
+	dof_bindForSetup(data->dof, data->renderRatio, data->dofSetupShader);
+
+	common_pushRenderScope("DoF Setup");
+	rendering_renderQuad();
+	common_popRenderScope();
+
+	// 2. Beide Ebenen weichzeichnen
+	shader_useShader(data->dofBlurShader);
+	dof_bindSetupTextures(data->dof, GL_TEXTURE0 + RENDERING_UNIT_DOF_NEAR, GL_TEXTURE0 + RENDERING_UNIT_DOF_FAR);
+	shader_setInt(data->dofBlurShader, "u_near", RENDERING_UNIT_DOF_NEAR);
+	shader_setInt(data->dofBlurShader, "u_far", RENDERING_UNIT_DOF_FAR);
+	shader_setFloat(data->dofBlurShader, "u_maxRadius", DOF_MAX_RADIUS);
+	dof_bindForBlur(data->dof, data->renderRatio, data->dofBlurShader);
+
+	common_pushRenderScope("DoF Blur");
+	rendering_renderQuad();
+	common_popRenderScope();
+
+	glstate_bindFramebuffer(GL_FRAMEBUFFER, 0);
 }
 
 /**
-* Uebergibt die Daten an den postProcess Shader
+* Bestimmt die mittlere Helligkeit des gerenderten Bereichs fuer die
+* automatische Belichtung. Das Ergebnis bleibt auf der GPU und wird direkt
+* im PostProcess gelesen.
 *
-* @param der Programm Context
+* @param data die zu renderden Daten
+* @param input gui Input
+* @param deltaTime die Zeit seit dem letzten Frame in Sekunden
 */
-static void rendering_renderPostProcess(RenderingData* data, InputData* input, vec2* screenSize)
+static void rendering_renderAutoExposure(RenderingData* data, InputData* input, float deltaTime)
 {
-	shader_useShader(data->postProcessShader);
+	glstate_disable(GL_DEPTH_TEST);
+	glstate_disable(GL_BLEND);
+
+	// Nach einer Pause stellt sich die Belichtung sofort ein.
+	if (!data->autoExposureActive)
+	{
+		exposure_reset(data->autoExposure);
+		data->autoExposureActive = true;
+	}
+
+	// 1. Histogramm der logarithmischen Helligkeit
+	shader_useShader(data->histogramShader);
+	shader_setInt(data->histogramShader, "u_source", GBUFFER_COLORATTACH_FINAL);
 
-	shader_setVec2(data->postProcessShader, "u_screenSize", screenSize);
+	common_pushRenderScope("Exposure Histogram");
+	exposure_renderHistogram(data->autoExposure, data->histogramShader,
+		(int)data->renderSize[0], (int)data->renderSize[1]);
+	common_popRenderScope();
 
-	shader_setFloat(data->postProcessShader, "u_exposure", input->rendering.exposure);
-	shader_setFloat(data->postProcessShader, "u_gamma", input->rendering.gamma);
-	shader_setInt(data->postProcessShader, "u_final", GBUFFER_COLORATTACH_FINAL);
+	// 2. Mittelwert bilden und zeitlich angleichen. Der Anteil haengt von
+	// der Frametime ab, damit die Anpassung unabhaengig von den FPS ist.
+	shader_useShader(data->exposureAverageShader);
+	shader_setFloat(data->exposureAverageShader, "u_adaptation",
+		1.0f - expf(-deltaTime * input->exposureAdaptation));
+	exposure_bindForAverage(data->autoExposure, data->exposureAverageShader,
+		RENDERING_UNIT_EXPOSURE_HISTOGRAM, RENDERING_UNIT_EXPOSURE);
 
-	// postProcess zeichnen
-	common_pushRenderScope("Scene PostProcess");
+	common_pushRenderScope("Exposure Average");
 	rendering_renderQuad();
 	common_popRenderScope();
+
+	glstate_bindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+/**
+* Uebergibt die Uniforms der Tiefenunschaerfe an ihren PostProcess Pass und
+* bindet die weichgezeichneten Ebenen.
+*
+* @param shader der Shader des PostProcess Passes
+* @param userData der Programm Context
+*/
+static void rendering_setDepthOfFieldCompositeUniforms(Shader* shader, void* userData)
+{
+	ProgContext* ctx = userData;
+
+	rendering_setDepthOfFieldUniforms(ctx->rendering, ctx->input, shader);
+	dof_bindBlurTextures(ctx->rendering->dof, GL_TEXTURE0 + RENDERING_UNIT_DOF_NEAR,
+		GL_TEXTURE0 + RENDERING_UNIT_DOF_FAR, GL_TEXTURE0 + RENDERING_UNIT_DOF_DEPTH);
+	shader_setInt(shader, "u_near", RENDERING_UNIT_DOF_NEAR);
+	shader_setInt(shader, "u_far", RENDERING_UNIT_DOF_FAR);
+	shader_setInt(shader, "u_halfDepth", RENDERING_UNIT_DOF_DEPTH);
+}
+
+/**
+* Uebergibt die Uniforms des Bloom Effekts. Die erste Stufe enthaelt das
+* fertige Ergebnis des Bloom Passes.
+*
+* @param shader der Shader des PostProcess Passes
+* @param userData der Programm Context
+*/
+static void rendering_setBloomUniforms(Shader* shader, void* userData)
+{
+	ProgContext* ctx = userData;
+
+	bloom_bindMipTexture(ctx->rendering->bloom, 0, GL_TEXTURE0 + RENDERING_UNIT_BLOOM);
+	shader_setInt(shader, "u_bloom", RENDERING_UNIT_BLOOM);
+	shader_setFloat(shader, "u_bloomIntensity", ctx->input->bloomIntensity);
+}
+
+/**
+* Uebergibt die Uniforms des Exposure Tone Mappings.
+*
+* @param shader der Shader des PostProcess Passes
+* @param userData der Programm Context
+*/
+static void rendering_setExposureUniforms(Shader* shader, void* userData)
+{
+	ProgContext* ctx = userData;
+	RenderingData* data = ctx->rendering;
+	InputData* input = ctx->input;
+
+	bool autoExposure = input->autoExposure
+		&& data->histogramShader != NULL && data->exposureAverageShader != NULL;
+
+	exposure_bindResult(data->autoExposure, GL_TEXTURE0 + RENDERING_UNIT_EXPOSURE);
+	shader_setInt(shader, "u_averageLuminance", RENDERING_UNIT_EXPOSURE);
+	shader_setBool(shader, "u_autoExposure", autoExposure);
+	shader_setFloat(shader, "u_exposure", input->rendering.exposure);
+}
+
+/**
+* Uebergibt die Uniforms der Farbkorrektur.
+*
+* @param shader der Shader des PostProcess Passes
+* @param userData der Programm Context
+*/
+static void rendering_setGradingUniforms(Shader* shader, void* userData)
+{
+	ProgContext* ctx = userData;
+	shader_setFloat(shader, "u_contrast", ctx->input->contrast);
+	shader_setFloat(shader, "u_saturation", ctx->input->saturation);
+}
+
+/**
+* Uebergibt die Uniforms der Vignette.
+*
+* @param shader der Shader des PostProcess Passes
+* @param userData der Programm Context
+*/
+static void rendering_setVignetteUniforms(Shader* shader, void* userData)
+{
+	ProgContext* ctx = userData;
+	shader_setFloat(shader, "u_vignetteStrength", ctx->input->vignetteStrength);
+}
+
+/**
+* Uebergibt die Uniforms der Gamma Korrektur.
+*
+* @param shader der Shader des PostProcess Passes
+* @param userData der Programm Context
+*/
+static void rendering_setGammaUniforms(Shader* shader, void* userData)
+{
+	ProgContext* ctx = userData;
+	shader_setFloat(shader, "u_gamma", ctx->input->rendering.gamma);
+}
+
+/**
+* Legt die PostProcess Kette mit allen Effekten in ihrer Reihenfolge an.
+* Die Tiefenunschaerfe liest Nachbarpixel und braucht einen eigenen Pass,
+* alle weiteren Effekte sind Pixel-Effekte und landen zusammen in einem Pass.
+*
+* @return die neue Kette
+*/
+static PostProcessChain* rendering_createPostProcessChain(void)
+{
+	PostProcessChain* chain = postprocess_createChain();
+
+	postprocess_addPassEffect(chain, "depthOfField",
+		UTILS_CONST_RES("shader/depthOfField/depthOfField.frag"), rendering_setDepthOfFieldCompositeUniforms);
+	postprocess_addPixelEffect(chain, "bloom",
+		UTILS_CONST_RES("shader/postProcess/bloom.glsl"), rendering_setBloomUniforms);
+	postprocess_addPixelEffect(chain, "exposure",
+		UTILS_CONST_RES("shader/postProcess/exposure.glsl"), rendering_setExposureUniforms);
+	postprocess_addPixelEffect(chain, "grading",
+		UTILS_CONST_RES("shader/postProcess/grading.glsl"), rendering_setGradingUniforms);
+	postprocess_addPixelEffect(chain, "vignette",
+		UTILS_CONST_RES("shader/postProcess/vignette.glsl"), rendering_setVignetteUniforms);
+	postprocess_addPixelEffect(chain, "gamma",
+		UTILS_CONST_RES("shader/postProcess/gamma.glsl"), rendering_setGammaUniforms);
+
+	return chain;
+}
+
+/**
+* Schaltet die Effekte der PostProcess Kette passend zu den Eingaben an oder
+* aus. Die Kette fasst die Paesse nur neu zusammen, wenn sich etwas aendert.
+*
+* @param data die zu renderden Daten
+* @param input gui Input
+*/
+static void rendering_updatePostProcessChain(RenderingData* data, InputData* input)
+{
+	// Ohne Bloom Pass enthaelt die erste Stufe keine gueltigen Daten.
+	bool bloom = input->showBloom && data->thresholdShader != NULL
+		&& data->bloomDownShader != NULL && data->bloomUpShader != NULL
+		&& bloom_getMipCount(data->bloom) > 0;
+
+	bool depthOfField = input->showDepthOfField
+		&& data->dofSetupShader != NULL && data->dofBlurShader != NULL;
+
+	postprocess_setEffectEnabled(data->postChain, "depthOfField", depthOfField);
+	postprocess_setEffectEnabled(data->postChain, "bloom", bloom);
+	postprocess_setEffectEnabled(data->postChain, "grading", input->showGrading);
+	postprocess_setEffectEnabled(data->postChain, "vignette", input->showVignette);
+}
+
+/**
+* Setzt einmal die Uniforms eines Meshes, entweder ueber die Namen oder ueber
+* die Kennungen (siehe shader_getUniform).
+*
+* @param shader der aktive Shader
+* @param names die Namen in der Reihenfolge von Matrix, 4 Farben,
+*              Glanzfaktor und 4 Texturen
+* @param handles die zugehoerigen Kennungen oder NULL fuer die Namen
+* @param modelMatrix die Model Matrix
+* @param color die Farbe fuer alle Farben des Materials
+*/
+static void rendering_setBenchmarkUniforms(Shader* shader, char** names, ShaderUniform* handles, mat4* modelMatrix, vec3* color)
+{
+	if (handles == NULL)
+	{
+		shader_setMat4(shader, names[0], modelMatrix);
+		for (int i = 1; i < 5; i++)
+		{
+			shader_setVec3(shader, names[i], color);
+		}
+		shader_setFloat(shader, names[5], 2.0f);
+		for (int i = 6; i < RENDERING_UNIFORM_BENCHMARK_COUNT; i++)
+		{
+			shader_setInt(shader, names[i], i - 6);
+		}
+	}
+	else
+	{
+		shader_setMat4ByHandle(shader, handles[0], modelMatrix);
+		for (int i = 1; i < 5; i++)
+		{
+			shader_setVec3ByHandle(shader, handles[i], color);
+		}
+		shader_setFloatByHandle(shader, handles[5], 2.0f);
+		for (int i = 6; i < RENDERING_UNIFORM_BENCHMARK_COUNT; i++)
+		{
+			shader_setIntByHandle(shader, handles[i], i - 6);
+		}
+	}
+}
+
+/**
+* Misst die CPU Kosten der Uniforms je Draw: Fuer RENDERING_UNIFORM_BENCHMARK_DRAWS
+* Meshes werden die Model Matrix und das Material einmal ueber die Namen und
+* einmal ueber die Kennungen gesetzt, ohne zu zeichnen. Vorher laeuft jeder
+* Weg einmal ungemessen, damit Cache und Treiber eingeschwungen sind.
+*
+* @param data die zu renderden Daten
+*/
+static void rendering_runUniformBenchmark(RenderingData* data)
+{
+	// Die Variante mit allen Texturen nutzt alle Uniforms des Materials.
+	unsigned int features = MATERIAL_FEATURE_DIFFUSE_MAP | MATERIAL_FEATURE_SPECULAR_MAP
+		| MATERIAL_FEATURE_NORMAL_MAP | MATERIAL_FEATURE_EMISSION_MAP;
+	Shader* shader = shader_getVariant(data->modelDirectVariants, features);
+	if (shader == NULL)
+	{
+		return;
+	}
+
+	char* names[RENDERING_UNIFORM_BENCHMARK_COUNT] = {
+		"u_modelMatrix",
+		"u_material.ambient", "u_material.diffuse", "u_material.specular", "u_material.emission",
+		"u_material.shininess",
+		"u_material.diffuseMap", "u_material.specularMap", "u_material.normalMap", "u_material.emissionMap"
+	};
+	ShaderUniform handles[RENDERING_UNIFORM_BENCHMARK_COUNT];
+	for (int i = 0; i < RENDERING_UNIFORM_BENCHMARK_COUNT; i++)
+	{
+		handles[i] = shader_getUniform(names[i]);
+	}
+
+	mat4 modelMatrix = GLM_MAT4_IDENTITY_INIT;
+	vec3 color = { 1.0f, 1.0f, 1.0f };
+	double seconds[2] = { 0.0, 0.0 };
+
+	shader_useShader(shader);
+	for (int round = 0; round < 2; round++)
+	{
+		for (int path = 0; path < 2; path++)
+		{
+			ShaderUniform* pathHandles = path == 0 ? NULL : handles;
+
+			// Ausstehende Befehle sollen die Messung nicht verfaelschen.
+			glFinish();
+			double start = glfwGetTime();
+			for (int draw = 0; draw < RENDERING_UNIFORM_BENCHMARK_DRAWS; draw++)
+			{
+				modelMatrix[3][0] = (float)draw;
+				rendering_setBenchmarkUniforms(shader, names, pathHandles, &modelMatrix, &color);
+			}
+			seconds[path] = glfwGetTime() - start;
+		}
+	}
+
+	data->stats.uniformNameUs = seconds[0] * 1000000.0 / RENDERING_UNIFORM_BENCHMARK_DRAWS;
+	data->stats.uniformHandleUs = seconds[1] * 1000000.0 / RENDERING_UNIFORM_BENCHMARK_DRAWS;
+}
+
+/**
+* Passt den Skalierungsfaktor der dynamischen Aufloesung an die zuletzt
+* gemessene GPU Zeit eines Frames an. Da die Kosten der Bildschirm-Paesse mit
+* der Anzahl der Pixel wachsen, also quadratisch mit dem Faktor, wird der
+* Faktor ideal um die Wurzel des Verhaeltnisses von Ziel- zu Messzeit skaliert.
+* Weil die Messung einige Frames alt ist, wird nur ein Teil der Abweichung
+* pro Frame ausgeglichen und kleine Abweichungen werden ignoriert.
+*
+* @param data die zu renderden Daten
+* @param input gui Input
+* @param width die Breite des Fensters
+* @param height die Hoehe des Fensters
+* @param bufferWidth die Breite des GBuffers
+* @param bufferHeight die Hoehe des GBuffers
+*/
+static void rendering_updateRenderScale(RenderingData* data, InputData* input, int width, int height, int bufferWidth, int bufferHeight)
+{
+	float maxScale = glm_clamp(input->maxRenderScale, RENDERING_SCALE_LIMIT, 1.0f);
+	float minScale = glm_clamp(input->minRenderScale, RENDERING_SCALE_LIMIT, maxScale);
+
+	double gpuMs = timer_getLastMilliseconds(data->frameTimer);
+
+	if (!input->dynamicResolution || data->renderScale <= 0.0f)
+	{
+		data->renderScale = maxScale;
+	}
+	// Waehrend des Benchmarks bleibt die Aufloesung fest.
+	else if (!data->benchmarkRunning && gpuMs > 0.0
+		&& fabs(gpuMs - input->targetFrameMs) > input->targetFrameMs * RENDERING_SCALE_TOLERANCE)
+	{
+		float idealScale = data->renderScale * sqrtf((float)(input->targetFrameMs / gpuMs));
+		data->renderScale += (idealScale - data->renderScale) * RENDERING_SCALE_GAIN;
+	}
+	data->renderScale = glm_clamp(data->renderScale, minScale, maxScale);
+
+	// Der GBuffer ist mindestens so grosz wie das Fenster, es wird nur in
+	// den Bereich links unten gerendert.
+	data->renderSize[0] = glm_clamp(roundf((float)width * data->renderScale), 1.0f, (float)bufferWidth);
+	data->renderSize[1] = glm_clamp(roundf((float)height * data->renderScale), 1.0f, (float)bufferHeight);
+	data->renderRatio[0] = data->renderSize[0] / (float)bufferWidth;
+	data->renderRatio[1] = data->renderSize[1] / (float)bufferHeight;
+
+	data->stats.renderScale = data->renderScale;
 }
 
 
@@ -407,7 +1473,7 @@ void rendering_renderCube()
 		glBindBuffer(GL_ARRAY_BUFFER, cubeVBO);
 		glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
 		// link vertex attributes
-		glBindVertexArray(cubeVAO);
+		glstate_bindVertexArray(cubeVAO);
 		glEnableVertexAttribArray(0);
 		glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);
 		glEnableVertexAttribArray(1);
@@ -415,23 +1481,23 @@ void rendering_renderCube()
 		glEnableVertexAttribArray(2);
 		glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));
 		glBindBuffer(GL_ARRAY_BUFFER, 0);
-		glBindVertexArray(0);
+		glstate_bindVertexArray(0);
 	}
 	// render Cube
-	glBindVertexArray(cubeVAO);
+	glstate_bindVertexArray(cubeVAO);
 	glDrawArrays(GL_TRIANGLES, 0, 36);
-	glBindVertexArray(0);
+	glstate_bindVertexArray(0);
 }
 
 
 /**
-* rendert die Scene
-* @param data die Daten um auf den Shader zugreifen zu können
+* rendert die Scene, der Shader muss bereits aktiviert sein
+* @param input gui Input
 */
-void rendering_renderScene(InputData* input, Shader* shader)
+void rendering_renderScene(InputData* input)
 {
 	input->rendering.userScene;
-	model_drawModel(input->rendering.userScene->model, shader, false);
+	model_drawModel(input->rendering.userScene->model, false);
 }
 
 /**
@@ -446,7 +1512,7 @@ void rendering_setProjectionMatrix(ProgContext* ctx, InputData* input, mat4* pro
 {
 	float aspect = (float)ctx->winData->width / (float)ctx->winData->height;
 	float zoom = camera_getZoom(input->mainCamera);
-	glm_perspective(glm_rad(zoom), aspect, 0.1f, 200.0f, *projectionMatrix);
+	glm_perspective(glm_rad(zoom), aspect, RENDERING_NEAR_PLANE, RENDERING_FAR_PLANE, *projectionMatrix);
 }
 
 /*
@@ -471,38 +1537,117 @@ void rendering_setModelMatrix(InputData* input, mat4* modelMatrix)
 	glm_translate(*modelMatrix, input->rendering.translate);
 }
 
-/*
- * Hilfsfunktion zum Initialisieren der Schatten-Einstellungen.
- *
- * @param data die Daten des Programms
- */
-static void rendering_shadowInit(RenderingData* data)
-{
-	glGenFramebuffers(1, &depthMapFBO);
-
-	glGenTextures(1, &depthMap);
-	glBindTexture(GL_TEXTURE_2D, depthMap);
-	common_labelObjectByType(GL_TEXTURE, depthMap, "Shadow Depth");
-	glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT, DIR_SHADOW_SIZE, DIR_SHADOW_SIZE, 0, GL_DEPTH_COMPONENT, GL_FLOAT, NULL);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_BORDER);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_BORDER);
-	float borderColor[] = { 1.0f, 1.0f, 1.0f, 1.0f };
-	glTexParameterfv(GL_TEXTURE_2D, GL_TEXTURE_BORDER_COLOR, borderColor);
-
-	// attach depth texture as FBO
-	glBindFramebuffer(GL_FRAMEBUFFER, depthMapFBO);
-	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, depthMap, 0);
-	glDrawBuffer(GL_NONE); // we don't need a color buffer! explicitly tell OpenGL that
-	glReadBuffer(GL_NONE); // we don't need a color buffer! explicitly tell OpenGL that
-	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+/**
+* Markiert alle Schatten als veraltet, wenn sich die Szene selbst seit dem
+* letzten Rendern der Schatten geaendert hat.
+*
+* @param data die zu renderden Daten
+* @param input gui Input
+* @param modelMatrix die Model Matrix
+*/
+static void rendering_checkShadowInputs(RenderingData* data, InputData* input, mat4* modelMatrix)
+{
+	if (memcmp(data->shadowModelMatrix, *modelMatrix, sizeof(mat4)) != 0
+		|| data->shadowSceneVersion != input->rendering.sceneVersion
+		|| data->shadowUseTess != input->showTess
+		|| data->shadowTessEdgePixels != input->rendering.tessEdgePixels)
+	{
+		shadow_invalidate(data->dirShadow);
+		shadow_invalidatePointShadows(data->pointShadows);
+		glm_mat4_copy(*modelMatrix, data->shadowModelMatrix);
+		data->shadowSceneVersion = input->rendering.sceneVersion;
+		data->shadowUseTess = input->showTess;
+		data->shadowTessEdgePixels = input->rendering.tessEdgePixels;
+	}
+}
+
+/**
+* Rendert die Tiefe der Szene aus Sicht aller schattenwerfenden Punktlichter
+* in das Cube Map Array. Pro Licht wird die Szene nur einmal gezeichnet, der
+* Geometry Shader verteilt die Dreiecke auf die sechs Seiten. Solange sich
+* weder Szene noch Lichter aendern, bleiben die Cube Maps erhalten.
+*
+* @param data die zu renderden Daten
+* @param input gui Input
+* @param modelMatrix die Model Matrix
+*/
+static void rendering_renderPointShadows(RenderingData* data, InputData* input, mat4* modelMatrix)
+{
+	Scene* scene = input->rendering.userScene;
+	int slotCount = shadow_assignPointSlots(data->pointShadows, scene->pointLights, scene->countPointLights);
+	data->stats.pointShadowCount = (unsigned int)slotCount;
+
+	if (!shadow_arePointShadowsDirty(data->pointShadows))
+	{
+		return;
+	}
+
+	glstate_depthMask(GL_TRUE);
+	glstate_enable(GL_DEPTH_TEST);
+
+	shader_useShader(data->pointShadowShader);
+	shader_setMat4(data->pointShadowShader, "u_modelMatrix", modelMatrix);
+
+	common_pushRenderScope("Scene PointShadow");
+	shadow_bindForPointShadows(data->pointShadows);
+	for (int slot = 0; slot < slotCount; slot++)
+	{
+		shadow_setPointShadowSlot(data->pointShadows, slot, data->pointShadowShader);
+		rendering_renderScene(input);
+	}
+	common_popRenderScope();
+
+	glstate_disable(GL_DEPTH_TEST);
+	glstate_depthMask(GL_FALSE);
+	glstate_bindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+/**
+* Rendert die Tiefe der Szene aus Sicht des Richtungslichts in alle Kaskaden.
+* Die Kaskaden werden zuvor an das aktuelle View-Frustum angepasst. Kaskaden,
+* deren Matrix und Szene sich seit dem letzten Rendern nicht geaendert haben,
+* werden uebersprungen.
+*
+* @param data die zu renderden Daten
+* @param input gui Input
+* @param projectionMatrix die Projektions Matrix
+* @param viewMatrix die View Matrix
+* @param modelMatrix die Model Matrix
+*/
+static void rendering_renderDirShadow(RenderingData* data, InputData* input, mat4* projectionMatrix, mat4* viewMatrix, mat4* modelMatrix)
+{
+	vec3 lightDir;
+	glm_vec4_copy3(input->rendering.lightDir, lightDir);
+
+	shadow_updateCascades(data->dirShadow, input->shadowCascades, input->shadowSplitLambda,
+		*viewMatrix, *projectionMatrix, RENDERING_NEAR_PLANE, input->shadowDistance, lightDir);
 
 	shader_useShader(data->dirShadowShader);
-	shader_setInt(data->dirShadowShader, "depthMap", 0);
+	shader_setMat4(data->dirShadowShader, "u_modelMatrix", modelMatrix);
+
+	// Objekte vor der Near-Plane einer Kaskade werden auf diese gedrueckt,
+	// statt abgeschnitten zu werden, und werfen so weiterhin Schatten.
+	// Der Tiefentest ist nach den Lichtpaessen deaktiviert.
+	glstate_enable(GL_DEPTH_TEST);
+	glstate_enable(GL_DEPTH_CLAMP);
 
-	//shader_useShader(data->pointShadowShader);
-	//shader_setInt(data->pointShadowShader, "depthMap", 0);
+	common_pushRenderScope("Scene DirShadow");
+	for (int i = 0; i < shadow_getCascadeCount(data->dirShadow); i++)
+	{
+		if (!shadow_isCascadeDirty(data->dirShadow, i))
+		{
+			data->stats.shadowSkipped++;
+			continue;
+		}
+
+		shadow_bindForCascade(data->dirShadow, i, data->dirShadowShader);
+		rendering_renderScene(input);
+		data->stats.shadowRendered++;
+	}
+	common_popRenderScope();
+
+	glstate_disable(GL_DEPTH_CLAMP);
+	glstate_disable(GL_DEPTH_TEST);
 }
 
 //////////////////////////// ÖFFENTLICHE FUNKTIONEN ////////////////////////////
@@ -516,22 +1661,46 @@ void rendering_init(ProgContext* ctx)
 	memset(data, 0, sizeof(RenderingData));
 
 	// OpenGL Flags setzen.
-	glCullFace(GL_BACK);        // setzten Faceculling auf Back-Face
-	glFrontFace(GL_CCW);        // front Faces sind gegen den Uhrzeigersinn
+	glstate_cullFace(GL_BACK);        // setzten Faceculling auf Back-Face
+	glFrontFace(GL_CCW);              // front Faces sind gegen den Uhrzeigersinn
+
+	glstate_enable(GL_DEPTH_TEST);
 
-	glEnable(GL_DEPTH_TEST);
+	// Der Block mit den Daten der Kamera muss vor dem Bauen der Shader
+	// angemeldet sein.
+	data->frameData = framedata_createFrameData();
+	data->renderQueue = renderqueue_createQueue();
 
-	// Alle Shader laden.
+	// Alle Shader laden und die Dateien auf Aenderungen ueberwachen.
 	rendering_loadShaders(data);
+	data->shaderWatcher = filewatch_createWatcher(UTILS_CONST_RES("shader/"));
 
 	// Bildschirm leeren.
 	glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
 
-	lastScreenSize[0] = ctx->winData->realWidth;
-	lastScreenSize[1] = ctx->winData->realHeight;
-
 	// inform GBuffer about the start of new Frames
-	gBuffer = gbuffer_createGBuffer(ctx->winData->realWidth, ctx->winData->realHeight);
+	data->gbufferPool = gbuffer_createPool();
+	gBuffer = gbuffer_acquireFromPool(data->gbufferPool, ctx->winData->realWidth, ctx->winData->realHeight,
+		ctx->input->compactGBuffer ? GBUFFER_LAYOUT_COMPACT : GBUFFER_LAYOUT_FULL);
+	gbuffer_getSize(gBuffer, &lastBufferSize[0], &lastBufferSize[1]);
+
+	// Kacheln und Lichtdaten für das Tiled Deferred Lighting anlegen.
+	data->tiled = tiled_createTiledLighting(lastBufferSize[0], lastBufferSize[1]);
+	data->bloom = bloom_createBloom(lastBufferSize[0], lastBufferSize[1]);
+	data->dof = dof_createDepthOfField(lastBufferSize[0], lastBufferSize[1]);
+	data->autoExposure = exposure_createAutoExposure();
+	data->postChain = rendering_createPostProcessChain();
+	data->lightBuffer = light_createLightBuffer();
+
+	// Cluster-Gitter und Arbeiter-Threads für das Clustered Lighting anlegen.
+	data->clusters = cluster_createClusteredLighting();
+
+	data->frameTimer = timer_createGpuTimer();
+	data->pointLightTimer = timer_createGpuTimer();
+	data->dirLightTimer = timer_createGpuTimer();
+	data->bloomTimer = timer_createGpuTimer();
+	data->dofTimer = timer_createGpuTimer();
+	data->exposureTimer = timer_createGpuTimer();
 	// Setup cube VAO	
 	float planeVertices[] = {
 		// positions            // normals         // texcoords
@@ -547,7 +1716,7 @@ void rendering_init(ProgContext* ctx)
 	GLuint planeVBO;
 	glGenVertexArrays(1, &planeVAO);
 	glGenBuffers(1, &planeVBO);
-	glBindVertexArray(planeVAO);
+	glstate_bindVertexArray(planeVAO);
 	glBindBuffer(GL_ARRAY_BUFFER, planeVBO);
 	glBufferData(GL_ARRAY_BUFFER, sizeof(planeVertices), &planeVertices, GL_STATIC_DRAW);
 	glEnableVertexAttribArray(0);
@@ -556,56 +1725,103 @@ void rendering_init(ProgContext* ctx)
 	glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3 * sizeof(float)));
 	glEnableVertexAttribArray(2);
 	glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));
-	glBindVertexArray(0);
-	rendering_shadowInit(data);
+	glstate_bindVertexArray(0);
+
+	// Kaskaden für die Schatten des Richtungslichts anlegen.
+	data->dirShadow = shadow_createCascadedShadow();
+
+	// Cube Map Array für die Schatten der Punktlichter anlegen.
+	data->pointShadows = shadow_createPointShadows();
 }
 
 void rendering_draw(ProgContext* ctx)
 {
 	RenderingData* data = ctx->rendering;
 	InputData* input = ctx->input;
-	vec2 screenSize = { (float)ctx->winData->realWidth, (float)ctx->winData->realHeight };
 
-	// Shader vorbereiten.
+	// Zustandswechsel des letzten Frames fuer die Statistik
+	GLStateStats glStats = glstate_resetStats();
+	data->stats.glStateIssued = glStats.issued;
+	data->stats.glStateSkipped = glStats.skipped;
+
+	// Shader vorbereiten. Neu geladen werden nur Shader, deren Dateien sich
+	// geaendert haben, von Hand alle. Die alten Programme bleiben aktiv, bis
+	// die neuen erfolgreich gelinkt sind.
 	if (input->reloadShader == true)
 	{
-		rendering_deleteAllShader(data);
-		rendering_loadShaders(data);
+		rendering_reloadShaderFile(data, NULL);
 		input->reloadShader = false;
 	}
+	filewatch_poll(data->shaderWatcher, rendering_onShaderFileChanged, data);
+	rendering_updateShaderReloads(data);
 
-	if ((lastScreenSize[0] != ctx->winData->realWidth) || (lastScreenSize[1] != ctx->winData->realHeight))
+	// Der Benchmark misst die Lichtpaesse nacheinander mit beiden Aufbauten.
+	if (input->runGBufferBenchmark && !data->benchmarkRunning)
 	{
-		gbuffer_deleteGBuffer(gBuffer);
-		gBuffer = gbuffer_createGBuffer(ctx->winData->realWidth, ctx->winData->realHeight);
-		lastScreenSize[0] = ctx->winData->realWidth;
-		lastScreenSize[1] = ctx->winData->realHeight;
+		data->benchmarkRunning = true;
+		data->benchmarkLayout = GBUFFER_LAYOUT_FULL;
+		data->benchmarkFrame = 0;
+		data->benchmarkSum = 0.0;
 	}
+	input->runGBufferBenchmark = false;
 
-	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+	// Der Uniform Benchmark misst nur die CPU und laeuft sofort.
+	if (input->runUniformBenchmark)
+	{
+		rendering_runUniformBenchmark(data);
+		input->runUniformBenchmark = false;
+	}
+
+	GBufferLayout layout = input->compactGBuffer ? GBUFFER_LAYOUT_COMPACT : GBUFFER_LAYOUT_FULL;
+	if (data->benchmarkRunning)
+	{
+		layout = data->benchmarkLayout;
+	}
+
+	// Der Pool legt den GBuffer nur neu an, wenn das Fenster die Groeszenstufe
+	// verlaesst oder sich die Groesze gesetzt hat.
+	gBuffer = gbuffer_acquireFromPool(data->gbufferPool, ctx->winData->realWidth, ctx->winData->realHeight, layout);
+	data->stats.gbufferAllocations = gbuffer_getPoolAllocations(data->gbufferPool);
+
+	int bufferWidth, bufferHeight;
+	gbuffer_getSize(gBuffer, &bufferWidth, &bufferHeight);
+	vec2 bufferSize = { (float)bufferWidth, (float)bufferHeight };
+
+	if ((lastBufferSize[0] != bufferWidth) || (lastBufferSize[1] != bufferHeight))
+	{
+		tiled_deleteTiledLighting(data->tiled);
+		data->tiled = tiled_createTiledLighting(bufferWidth, bufferHeight);
+		bloom_deleteBloom(data->bloom);
+		data->bloom = bloom_createBloom(bufferWidth, bufferHeight);
+		dof_deleteDepthOfField(data->dof);
+		data->dof = dof_createDepthOfField(bufferWidth, bufferHeight);
+		lastBufferSize[0] = bufferWidth;
+		lastBufferSize[1] = bufferHeight;
+	}
 
+	rendering_updateRenderScale(data, input, ctx->winData->realWidth, ctx->winData->realHeight, bufferWidth, bufferHeight);
+	rendering_updatePostProcessChain(data, input);
+	GLsizei renderWidth = (GLsizei)data->renderSize[0];
+	GLsizei renderHeight = (GLsizei)data->renderSize[1];
 
+	timer_begin(data->frameTimer);
 
+	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
 	// Überprüfen, ob der Wireframe Modus verwendet werden soll.
 	if (input->showWireframe)
 	{
 		glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
-		glDisable(GL_CULL_FACE); // deaktivierung des Face Cullings
+		glstate_disable(GL_CULL_FACE); // deaktivierung des Face Cullings
 	}
 	else
 	{
 		glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
-		glEnable(GL_CULL_FACE);  // aktivierung des Face Cullings
+		glstate_enable(GL_CULL_FACE);  // aktivierung des Face Cullings
 	}
 
 	if (input->rendering.userScene)
 	{
-		// 1. first render to depth map
-		mat4 lightProjection;
-		mat4 lightView;
-		mat4 lightSpaceMatrix;
-
 		// Zuerst die Projection Matrix aufsetzen.
 		mat4 projectionMatrix;
 		rendering_setProjectionMatrix(ctx, input, &projectionMatrix);
@@ -614,150 +1830,237 @@ void rendering_draw(ProgContext* ctx)
 		mat4 viewMatrix;
 		camera_getViewMatrix(input->mainCamera, viewMatrix);
 
+		// Kamera und Bildschirmgroesze einmal fuer alle Shader hochladen.
+		vec3 viewPos;
+		camera_getPosition(input->mainCamera, viewPos);
+		framedata_update(data->frameData, &projectionMatrix, &viewMatrix, viewPos,
+			bufferSize, data->renderSize);
+
 		// ModelMatrix festlegen.
 		mat4 modelMatrix;
 		rendering_setModelMatrix(input, &modelMatrix);
 
+		// Nur den genutzten Bereich des GBuffers leeren.
+		glstate_enable(GL_SCISSOR_TEST);
+		glScissor(0, 0, renderWidth, renderHeight);
+
 		gbuffer_clearFinalTexture(gBuffer);
 
 		// only geometry pass updates the depth buffer
 		// enable writing into depth buffer befor clearing it!
-		glDepthMask(GL_TRUE);
+		glstate_depthMask(GL_TRUE);
 
 		//setting GBuffer object for writing
 		gbuffer_bindGBufferForGeomPass(gBuffer);
-		glEnable(GL_DEPTH_TEST);
+		glstate_enable(GL_DEPTH_TEST);
+
+		// Alle Paesse bis zum PostProcess nutzen nur den Bereich der
+		// dynamischen Aufloesung innerhalb des GBuffers.
+		glViewport(0, 0, renderWidth, renderHeight);
 
 		// prevent anything but this pass from writing into the depth buffer
 		// needs the depth buffer in order to populate the G-Buffer with closest pixels
 		// in lightpass we have a single texel per screen pixel so we don't have anything to write into the depth buffer
 		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT); // clear the current FBO (G buffer)
+		glstate_disable(GL_SCISSOR_TEST);
 
 		// Das Nutzermodell nur dann Rendern, wenn es existiert.
 
-		if (data->modelShader != NULL)
+		if (rendering_getModelVariants(data, input) != NULL)
 		{
-			rendering_renderModel(data, input, &projectionMatrix, &viewMatrix, &modelMatrix);
+			rendering_renderModel(data, input, &viewMatrix, &modelMatrix);
 		}
+		data->stats.modelVariants = shader_getVariantCount(data->modelVariants)
+			+ shader_getVariantCount(data->modelDirectVariants);
 
-		glDepthMask(GL_FALSE);
+		glstate_depthMask(GL_FALSE);
 
-		glBindFramebuffer(GL_FRAMEBUFFER, 0);
+		glstate_bindFramebuffer(GL_FRAMEBUFFER, 0);
 
-		gbuffer_bindGBufferForLightPass(gBuffer);
+		rendering_checkShadowInputs(data, input, &modelMatrix);
 
-		if (data->pointLightShader != NULL)
+		// Die Punktschatten muessen vor den Punktlichtern vorliegen.
+		if (data->pointShadowShader != NULL && input->showShadow)
 		{
-			rendering_renderPointLight(data, input, &screenSize, &projectionMatrix, &viewMatrix, &modelMatrix);
+			rendering_renderPointShadows(data, input, &modelMatrix);
+			glViewport(0, 0, renderWidth, renderHeight);
 		}
 
-		glBindFramebuffer(GL_FRAMEBUFFER, 0);
-
-		glDepthMask(GL_TRUE);
+		gbuffer_bindGBufferForLightPass(gBuffer);
 
-		if (data->dirShadowShader != NULL && input->showShadow)
+		data->stats.tiledOverflowLights = 0;
+		timer_begin(data->pointLightTimer);
+		if (input->lightingMode == LIGHTING_TILED && data->tileDepthShader != NULL
+			&& data->tileCullShader != NULL && data->tiledLightShader != NULL)
 		{
-			glm_mat4_identity(lightProjection);
-			glm_mat4_identity(lightView);
-			glm_mat4_identity(lightSpaceMatrix);
-
-			float near_plane = input->nearPlane, far_plane = input->farPlane;
-			glm_ortho(-input->expression, input->expression, -input->expression, input->expression, near_plane, far_plane, lightProjection);	// orthographic proj. matrix for light src, since all light rays are parallel
-
-			vec3 center = { 0.0f };
-			vec3 up = { 0.0f, 1.0f, 0.0f };
-			// make sure size of the projection frustum correctly contains the objects to be render in the depth map
-			//Create view Matrix
-
-			vec3 lightPos = { 0.0f };
-			glm_vec3_add(lightPos, input->rendering.lightDir, lightPos);
-
-			glm_vec3_scale(lightPos, input->distance, lightPos);
-
-			float isParallel = glm_vec3_dot(up, lightPos);
-			
-		    if(isParallel > (1 - FLT_EPSILON) && isParallel < (1 + FLT_EPSILON))
-			{
-				up[0] = 1.0f;
-			}
-
-			glm_lookat(lightPos, center, up, lightView);
-
-			//light space transformation matrix (transforms each world-space vector into the space visible from the light source)
-			glm_mat4_mul(lightProjection, lightView, lightSpaceMatrix);
-
-			//rendering_shadowInit(data);
-			shader_useShader(data->dirShadowShader);
+			rendering_renderTiledPointLights(data, input);
+		}
+		else if (input->lightingMode == LIGHTING_CLUSTERED && data->clusteredLightShader != NULL)
+		{
+			rendering_renderClusteredPointLights(data, input, &projectionMatrix, &viewMatrix);
+		}
+		else if (data->pointLightShader != NULL && data->nullShader != NULL)
+		{
+			rendering_renderPointLight(data, input, 0);
+		}
+		timer_end(data->pointLightTimer);
 
-			shader_setMat4(data->dirShadowShader, "u_modelMatrix", &modelMatrix);
-			shader_setMat4(data->dirShadowShader, "u_lightSpaceMatrix", &lightSpaceMatrix);
+		glstate_bindFramebuffer(GL_FRAMEBUFFER, 0);
 
-			glViewport(0, 0, DIR_SHADOW_SIZE, DIR_SHADOW_SIZE);
-			glBindFramebuffer(GL_FRAMEBUFFER, depthMapFBO);
-			common_labelObjectByType(GL_FRAMEBUFFER, depthMapFBO, "Shadow Depth");
-			
-			glClear(GL_DEPTH_BUFFER_BIT);
+		glstate_depthMask(GL_TRUE);
 
-			common_pushRenderScope("Scene DirShadow");
-			rendering_renderScene(input, data->dirShadowShader);
-			common_popRenderScope();
+		// 1. first render to depth map
+		if (data->dirShadowShader != NULL && input->showShadow)
+		{
+			rendering_renderDirShadow(data, input, &projectionMatrix, &viewMatrix, &modelMatrix);
 		}
 
-		glDepthMask(GL_FALSE);
+		glstate_depthMask(GL_FALSE);
 
-		glBindFramebuffer(GL_FRAMEBUFFER, 0);
+		glstate_bindFramebuffer(GL_FRAMEBUFFER, 0);
 
 		// 2. then render scene as normal with shadow mapping (using depth map)
 		//Reset view port
-		glViewport(0, 0, ctx->winData->realWidth, ctx->winData->realHeight);
+		glViewport(0, 0, renderWidth, renderHeight);
 
 
 
 		gbuffer_bindGBufferForLightPass(gBuffer);
 
+		timer_begin(data->dirLightTimer);
 		if (data->dirLightShader != NULL)
 		{
-			rendering_renderDirLight(data, input, &screenSize, &modelMatrix, &lightSpaceMatrix);
+			rendering_renderDirLight(data, input);
 		}
+		timer_end(data->dirLightTimer);
 
-		glBindFramebuffer(GL_FRAMEBUFFER, 0);
-		gbuffer_bindGBufferForLightPass(gBuffer);
+		// Die Tiefenunschaerfe wird nur im PostProcess verwendet.
+		timer_begin(data->dofTimer);
+		if (input->shaderChoice == 0 && input->showDepthOfField
+			&& data->dofSetupShader != NULL && data->dofBlurShader != NULL)
+		{
+			rendering_renderDepthOfField(data, input);
+		}
+		timer_end(data->dofTimer);
+
+		// Die automatische Belichtung misst das Bild ohne Bloom.
+		timer_begin(data->exposureTimer);
+		if (input->shaderChoice == 0 && input->autoExposure
+			&& data->histogramShader != NULL && data->exposureAverageShader != NULL)
+		{
+			rendering_renderAutoExposure(data, input, (float)ctx->winData->deltaTime);
+		}
+		else
+		{
+			data->autoExposureActive = false;
+		}
+		timer_end(data->exposureTimer);
 
-		if (data->postProcessShader != NULL)
+		// Der Bloom wird nur im PostProcess verwendet.
+		timer_begin(data->bloomTimer);
+		if (input->shaderChoice == 0 && input->showBloom
+			&& data->thresholdShader != NULL && data->bloomDownShader != NULL && data->bloomUpShader != NULL)
 		{
-			rendering_renderPostProcess(data, input, &screenSize);
+			rendering_renderBloom(data, input);
 		}
+		timer_end(data->bloomTimer);
 
+		glstate_bindFramebuffer(GL_FRAMEBUFFER, 0);
+		gbuffer_bindGBufferForLightPass(gBuffer);
 		gbuffer_bindGBufferForFinalPass(gBuffer);
 
+		// Ab hier wird in voller Aufloesung auf den Bildschirm gezeichnet.
+		glViewport(0, 0, ctx->winData->realWidth, ctx->winData->realHeight);
+
 		if (input->shaderChoice == 0)
 		{
-			glBlitFramebuffer(0, 0, ctx->winData->realWidth, ctx->winData->realHeight,
-				0, 0, ctx->winData->realWidth, ctx->winData->realHeight, GL_COLOR_BUFFER_BIT, GL_LINEAR);
+			// Der letzte PostProcess Pass skaliert den HDR Buffer direkt auf
+			// den Bildschirm. Ist die Kette fehlerhaft, wird nur kopiert.
+			common_pushRenderScope("Scene PostProcess");
+			bool postProcessed = postprocess_render(data->postChain,
+				GBUFFER_COLORATTACH_FINAL, RENDERING_UNIT_POST_PROCESS,
+				bufferWidth, bufferHeight, data->renderRatio,
+				ctx->winData->realWidth, ctx->winData->realHeight, ctx);
+			common_popRenderScope();
+			data->stats.postProcessPasses = postprocess_getPassCount(data->postChain);
 
+			if (!postProcessed)
+			{
+				gbuffer_bindGBufferForFinalPass(gBuffer);
+				glBlitFramebuffer(0, 0, renderWidth, renderHeight,
+					0, 0, ctx->winData->realWidth, ctx->winData->realHeight, GL_COLOR_BUFFER_BIT, GL_LINEAR);
+			}
 		}
 		else if (input->shaderChoice == 1)
 		{
 			GLint HalfWidth = (GLint)((float)(ctx->winData->realWidth / 2.0));
 			GLint HalfHeight = (GLint)((float)(ctx->winData->realHeight / 2.0));
 
-			gbuffer_bindGBufferForTextureRead(GBUFFER_COLORATTACH_POSITION);
-			glBlitFramebuffer(0, 0, ctx->winData->realWidth, ctx->winData->realHeight, 0, 0,
-				HalfWidth, HalfHeight, GL_COLOR_BUFFER_BIT, GL_LINEAR);
+			// Der kompakte GBuffer speichert keine Position.
+			if (gbuffer_getLayout(gBuffer) == GBUFFER_LAYOUT_FULL)
+			{
+				gbuffer_bindGBufferForTextureRead(GBUFFER_COLORATTACH_POSITION);
+				glBlitFramebuffer(0, 0, renderWidth, renderHeight, 0, 0,
+					HalfWidth, HalfHeight, GL_COLOR_BUFFER_BIT, GL_LINEAR);
+			}
 
 			gbuffer_bindGBufferForTextureRead(GBUFFER_COLORATTACH_NORMAL);
-			glBlitFramebuffer(0, 0, ctx->winData->realWidth, ctx->winData->realHeight, HalfWidth, HalfHeight,
+			glBlitFramebuffer(0, 0, renderWidth, renderHeight, HalfWidth, HalfHeight,
 				ctx->winData->realWidth, ctx->winData->realHeight, GL_COLOR_BUFFER_BIT, GL_LINEAR);
 
 			gbuffer_bindGBufferForTextureRead(GBUFFER_COLORATTACH_EMISSION);
-			glBlitFramebuffer(0, 0, ctx->winData->realWidth, ctx->winData->realHeight, 0,
+			glBlitFramebuffer(0, 0, renderWidth, renderHeight, 0,
 				HalfHeight, HalfWidth, ctx->winData->realHeight, GL_COLOR_BUFFER_BIT, GL_LINEAR);
 
 			gbuffer_bindGBufferForTextureRead(GBUFFER_COLORATTACH_ALBEDOSPEC);
-			glBlitFramebuffer(0, 0, ctx->winData->realWidth, ctx->winData->realHeight, HalfWidth, 0,
+			glBlitFramebuffer(0, 0, renderWidth, renderHeight, HalfWidth, 0,
 				ctx->winData->realWidth, HalfHeight, GL_COLOR_BUFFER_BIT, GL_LINEAR);
 		}
 	}
+
+	timer_end(data->frameTimer);
+
+	// Messwerte für die Statistik übernehmen.
+	data->stats.frameMs = timer_getMilliseconds(data->frameTimer);
+	data->stats.pointLightMs = timer_getMilliseconds(data->pointLightTimer);
+	data->stats.dirLightMs = timer_getMilliseconds(data->dirLightTimer);
+	data->stats.bloomMs = timer_getMilliseconds(data->bloomTimer);
+	data->stats.dofMs = timer_getMilliseconds(data->dofTimer);
+	data->stats.exposureMs = timer_getMilliseconds(data->exposureTimer);
+
+	if (data->benchmarkRunning)
+	{
+		// Nach dem Einschwingen die Zeit aller Lichtpaesse aufsummieren.
+		if (data->benchmarkFrame >= RENDERING_BENCHMARK_WARMUP)
+		{
+			data->benchmarkSum += timer_getLastMilliseconds(data->pointLightTimer)
+				+ timer_getLastMilliseconds(data->dirLightTimer);
+		}
+		data->benchmarkFrame++;
+
+		if (data->benchmarkFrame == RENDERING_BENCHMARK_WARMUP + RENDERING_BENCHMARK_FRAMES)
+		{
+			double average = data->benchmarkSum / RENDERING_BENCHMARK_FRAMES;
+			if (data->benchmarkLayout == GBUFFER_LAYOUT_FULL)
+			{
+				data->stats.benchmarkFullMs = average;
+				data->benchmarkLayout = GBUFFER_LAYOUT_COMPACT;
+				data->benchmarkFrame = 0;
+				data->benchmarkSum = 0.0;
+			}
+			else
+			{
+				data->stats.benchmarkCompactMs = average;
+				data->benchmarkRunning = false;
+			}
+		}
+	}
+	data->stats.benchmarkRunning = data->benchmarkRunning;
+}
+
+RenderingStats* rendering_getStats(ProgContext* ctx)
+{
+	return &ctx->rendering->stats;
 }
 
 void rendering_cleanup(ProgContext* ctx)
@@ -765,9 +2068,28 @@ void rendering_cleanup(ProgContext* ctx)
 	RenderingData* data = ctx->rendering;
 
 	// Zum Schluss müssen noch die belegten Ressourcen freigegeben werden.
+	filewatch_deleteWatcher(data->shaderWatcher);
 	rendering_deleteAllShader(data);
 
-	gbuffer_deleteGBuffer(gBuffer);
+	gbuffer_deletePool(data->gbufferPool);
+	tiled_deleteTiledLighting(data->tiled);
+	bloom_deleteBloom(data->bloom);
+	dof_deleteDepthOfField(data->dof);
+	exposure_deleteAutoExposure(data->autoExposure);
+	postprocess_deleteChain(data->postChain);
+	light_deleteLightBuffer(data->lightBuffer);
+	framedata_deleteFrameData(data->frameData);
+	renderqueue_deleteQueue(data->renderQueue);
+	cluster_deleteClusteredLighting(data->clusters);
+	shadow_deleteCascadedShadow(data->dirShadow);
+	shadow_deletePointShadows(data->pointShadows);
+
+	timer_deleteGpuTimer(data->frameTimer);
+	timer_deleteGpuTimer(data->pointLightTimer);
+	timer_deleteGpuTimer(data->dirLightTimer);
+	timer_deleteGpuTimer(data->bloomTimer);
+	timer_deleteGpuTimer(data->dofTimer);
+	timer_deleteGpuTimer(data->exposureTimer);
 
 	free(ctx->rendering);
 }
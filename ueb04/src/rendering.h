@@ -10,6 +10,50 @@
 
 #include "common.h"
 
+//////////////////////////// ÖFFENTLICHE DATENTYPEN ////////////////////////////
+
+// Messwerte des Renderers, die in der Statistik angezeigt werden.
+struct RenderingStats
+{
+    double frameMs;         // GPU Zeit der Szene in ms
+    double pointLightMs;    // GPU Zeit der Punktlichter in ms
+    double clusterMs;       // CPU Zeit der Lichtzuordnung in ms
+    unsigned int tiledOverflowLights;   // Lichter über TILED_MAX_LIGHTS, einzeln gezeichnet
+    double dirLightMs;      // GPU Zeit des Richtungslichts in ms
+    double bloomMs;         // GPU Zeit des Bloom in ms
+    double exposureMs;      // GPU Zeit der automatischen Belichtung in ms
+    double dofMs;           // GPU Zeit der Tiefenunschärfe in ms
+    int postProcessPasses;  // Vollbild-Pässe des PostProcess
+    int modelVariants;      // bisher übersetzte Varianten der Modell Shader
+    float renderScale;      // aktueller Faktor der dynamischen Auflösung
+    int gbufferAllocations; // Anzahl der bisher angelegten GBuffer
+
+    // Kaskaden der Schatten, die neu gerendert bzw. aus dem Cache genutzt wurden
+    unsigned int shadowRendered;
+    unsigned int shadowSkipped;
+    unsigned int pointShadowCount;  // Punktlichter mit eigener Cube Map
+
+    // Zustandswechsel des letzten Frames (siehe glstate.h)
+    unsigned int glStateIssued;     // an OpenGL weitergegeben
+    unsigned int glStateSkipped;    // als redundant übersprungen
+
+    // Abarbeitung der Render Queue im Geometry Pass (siehe renderqueue.h)
+    unsigned int queueItems;            // gezeichnete Meshes
+    unsigned int queueProgramChanges;   // aktivierte Shader
+    unsigned int queueMaterialChanges;  // aktivierte Materialien
+    unsigned int queueDrawCalls;        // Draw Calls, mit MDI einer je Folge
+
+    // Ergebnis des GBuffer Benchmarks: mittlere GPU Zeit aller Lichtpässe
+    bool benchmarkRunning;
+    double benchmarkFullMs;
+    double benchmarkCompactMs;
+
+    // Ergebnis des Uniform Benchmarks: CPU Zeit je Draw in µs
+    double uniformNameUs;
+    double uniformHandleUs;
+};
+typedef struct RenderingStats RenderingStats;
+
 //////////////////////////// ÖFFENTLICHE FUNKTIONEN ////////////////////////////
 
 /**
@@ -26,6 +70,14 @@ void rendering_init(ProgContext* ctx);
  */
 void rendering_draw(ProgContext* ctx);
 
+/**
+ * Liefert die aktuellen Messwerte des Renderers.
+ * 
+ * @param ctx Programmkontext.
+ * @return die Messwerte
+ */
+RenderingStats* rendering_getStats(ProgContext* ctx);
+
 /**
  * Gibt die Ressourcen des Rendering-Moduls wieder frei.
  * 
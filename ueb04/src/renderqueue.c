@@ -0,0 +1,257 @@
+/**
+ * Modul für das sortierte Zeichnen von Meshes.
+ *
+ * Copyright (C) 2023, FH Wedel
+ * Autor: Joshua-Scott Schöttke, Ilana Schmara
+ */
+
+#include "renderqueue.h"
+
+#include <string.h>
+
+#include <sesp/stb_ds.h>
+
+#include "material.h"
+
+////////////////////////////////// KONSTANTEN //////////////////////////////////
+
+// Der Radix Sort verarbeitet den Schlüssel byteweise.
+#define RENDERQUEUE_RADIX_BITS 8
+#define RENDERQUEUE_RADIX_SIZE (1 << RENDERQUEUE_RADIX_BITS)
+#define RENDERQUEUE_RADIX_PASSES (64 / RENDERQUEUE_RADIX_BITS)
+
+// Position der Felder im Schlüssel
+#define RENDERQUEUE_DEPTH_SHIFT 0
+#define RENDERQUEUE_MATERIAL_SHIFT (RENDERQUEUE_DEPTH_SHIFT + RENDERQUEUE_DEPTH_BITS)
+#define RENDERQUEUE_PROGRAM_SHIFT (RENDERQUEUE_MATERIAL_SHIFT + RENDERQUEUE_MATERIAL_BITS)
+#define RENDERQUEUE_PASS_SHIFT (RENDERQUEUE_PROGRAM_SHIFT + RENDERQUEUE_PROGRAM_BITS)
+
+// Maske eines Feldes mit der angegebenen Breite
+#define RENDERQUEUE_MASK(bits) ((UINT64_C(1) << (bits)) - 1)
+
+////////////////////////////// LOKALE DATENTYPEN ///////////////////////////////
+
+// Ein eingereichtes Mesh.
+typedef struct
+{
+    uint64_t key;
+    Mesh* mesh;
+    Shader* shader;
+} RenderQueueItem;
+
+// Datenstruktur einer Render Queue.
+struct RenderQueue
+{
+    // Dynamische Arrays (stb_ds) der Einträge und der Zwischenspeicher
+    // des Radix Sorts, beide behalten ihren Speicher über die Frames
+    RenderQueueItem* items;
+    RenderQueueItem* scratch;
+
+    // Dynamisches Array (stb_ds) der Draw Befehle in sortierter Reihenfolge
+    // und der Buffer, in den sie für Multi Draw Indirect geladen werden
+    GeometryDrawCommand* commands;
+    GLuint indirectBuffer;
+};
+
+//////////////////////////// ÖFFENTLICHE FUNKTIONEN ////////////////////////////
+
+RenderQueue* renderqueue_createQueue(void)
+{
+    RenderQueue* queue = malloc(sizeof(RenderQueue));
+    queue->items = NULL;
+    queue->scratch = NULL;
+    queue->commands = NULL;
+
+    glGenBuffers(1, &queue->indirectBuffer);
+
+    return queue;
+}
+
+uint64_t renderqueue_makeKey(RenderQueuePass pass, unsigned int program,
+                             unsigned int material, float depth, float maxDepth)
+{
+    // Die Tiefe wird auf den Bereich [0, 1] abgebildet und quantisiert.
+    // Transparente Geometrie wird umgekehrt, damit sie von hinten nach vorne
+    // sortiert wird.
+    float normalized = maxDepth > 0.0f ? depth / maxDepth : 0.0f;
+    normalized = glm_clamp(normalized, 0.0f, 1.0f);
+    if (pass == RENDERQUEUE_PASS_TRANSPARENT)
+    {
+        normalized = 1.0f - normalized;
+    }
+    uint64_t quantized = (uint64_t)(normalized
+        * (float)RENDERQUEUE_MASK(RENDERQUEUE_DEPTH_BITS));
+
+    return ((uint64_t)pass & RENDERQUEUE_MASK(RENDERQUEUE_PASS_BITS))
+               << RENDERQUEUE_PASS_SHIFT
+         | ((uint64_t)program & RENDERQUEUE_MASK(RENDERQUEUE_PROGRAM_BITS))
+               << RENDERQUEUE_PROGRAM_SHIFT
+         | ((uint64_t)material & RENDERQUEUE_MASK(RENDERQUEUE_MATERIAL_BITS))
+               << RENDERQUEUE_MATERIAL_SHIFT
+         | (quantized & RENDERQUEUE_MASK(RENDERQUEUE_DEPTH_BITS))
+               << RENDERQUEUE_DEPTH_SHIFT;
+}
+
+void renderqueue_submit(RenderQueue* queue, uint64_t key, Mesh* mesh,
+                        Shader* shader)
+{
+    RenderQueueItem item = { key, mesh, shader };
+    stbds_arrput(queue->items, item);
+}
+
+void renderqueue_sort(RenderQueue* queue)
+{
+    size_t count = stbds_arrlenu(queue->items);
+    if (count < 2)
+    {
+        return;
+    }
+
+    stbds_arrsetlen(queue->scratch, count);
+
+    // LSD Radix Sort: vom niedrigsten zum höchsten Byte wird jeweils stabil
+    // nach diesem Byte verteilt. Alle Histogramme entstehen in einem Durchlauf.
+    size_t histograms[RENDERQUEUE_RADIX_PASSES][RENDERQUEUE_RADIX_SIZE];
+    memset(histograms, 0, sizeof(histograms));
+    for (size_t i = 0; i < count; i++)
+    {
+        uint64_t key = queue->items[i].key;
+        for (int pass = 0; pass < RENDERQUEUE_RADIX_PASSES; pass++)
+        {
+            histograms[pass][(key >> (pass * RENDERQUEUE_RADIX_BITS))
+                             & (RENDERQUEUE_RADIX_SIZE - 1)]++;
+        }
+    }
+
+    RenderQueueItem* source = queue->items;
+    RenderQueueItem* target = queue->scratch;
+    for (int pass = 0; pass < RENDERQUEUE_RADIX_PASSES; pass++)
+    {
+        int shift = pass * RENDERQUEUE_RADIX_BITS;
+        size_t* histogram = histograms[pass];
+
+        // Haben alle Schlüssel dasselbe Byte, ändert sich die Reihenfolge
+        // nicht. Das betrifft z.B. die ungenutzten Bits von Pass und Programm.
+        if (histogram[(source[0].key >> shift) & (RENDERQUEUE_RADIX_SIZE - 1)]
+            == count)
+        {
+            continue;
+        }
+
+        // Aus den Häufigkeiten werden die Startpositionen der Fächer.
+        size_t offset = 0;
+        for (int digit = 0; digit < RENDERQUEUE_RADIX_SIZE; digit++)
+        {
+            size_t digitCount = histogram[digit];
+            histogram[digit] = offset;
+            offset += digitCount;
+        }
+
+        for (size_t i = 0; i < count; i++)
+        {
+            size_t digit = (source[i].key >> shift) & (RENDERQUEUE_RADIX_SIZE - 1);
+            target[histogram[digit]++] = source[i];
+        }
+
+        RenderQueueItem* swap = source;
+        source = target;
+        target = swap;
+    }
+
+    // Das Ergebnis liegt nach einer ungeraden Anzahl an Durchläufen im
+    // Zwischenspeicher, dann werden einfach die Arrays getauscht.
+    if (source != queue->items)
+    {
+        queue->scratch = queue->items;
+        queue->items = source;
+    }
+}
+
+RenderQueueStats renderqueue_execute(RenderQueue* queue, ShaderSetupFunc setup,
+                                     void* userData, bool isModel)
+{
+    RenderQueueStats stats = { 0, 0, 0, 0 };
+
+    // Die beim Laden erzeugten Befehle werden in die Reihenfolge der Queue
+    // gebracht. So kann jede Folge von Meshes mit demselben Shader, Material
+    // und Pool mit einem Aufruf gezeichnet werden.
+    int count = (int)stbds_arrlen(queue->items);
+    stbds_arrsetlen(queue->commands, count);
+    for (int i = 0; i < count; i++)
+    {
+        queue->commands[i] = *mesh_getDrawCommand(queue->items[i].mesh);
+    }
+
+    if (count > 0 && geometrypool_supportsMultiDraw())
+    {
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, queue->indirectBuffer);
+        glBufferData(GL_DRAW_INDIRECT_BUFFER,
+                     count * sizeof(GeometryDrawCommand), queue->commands,
+                     GL_STREAM_DRAW);
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+    }
+
+    Shader* activeShader = NULL;
+    unsigned int activeMaterial = 0;
+    int first = 0;
+    while (first < count)
+    {
+        RenderQueueItem* item = &queue->items[first];
+
+        // Uniforms gehören zum Programm, nach einem Wechsel des Shaders
+        // muss daher auch das Material neu gesetzt werden.
+        if (item->shader != activeShader)
+        {
+            activeShader = item->shader;
+            activeMaterial = 0;
+            shader_useShader(activeShader);
+            setup(activeShader, userData);
+            stats.programChanges++;
+        }
+
+        Material* material = mesh_getMaterial(item->mesh);
+        if (material_getId(material) != activeMaterial)
+        {
+            activeMaterial = material_getId(material);
+            material_useMaterial(activeShader, material);
+            stats.materialChanges++;
+        }
+
+        // Alle folgenden Meshes ohne Zustandswechsel zusammenfassen.
+        GeometryPool* pool = mesh_getPool(item->mesh);
+        int end = first + 1;
+        while (end < count
+               && queue->items[end].shader == activeShader
+               && material_getId(mesh_getMaterial(queue->items[end].mesh)) == activeMaterial
+               && mesh_getPool(queue->items[end].mesh) == pool)
+        {
+            end++;
+        }
+
+        stats.drawCalls += geometrypool_drawCommands(pool, queue->indirectBuffer,
+            first, &queue->commands[first], end - first, isModel);
+        stats.items += end - first;
+        first = end;
+    }
+
+    return stats;
+}
+
+void renderqueue_clear(RenderQueue* queue)
+{
+    stbds_arrsetlen(queue->items, 0);
+}
+
+void renderqueue_deleteQueue(RenderQueue* queue)
+{
+    if (queue == NULL)
+    {
+        return;
+    }
+
+    stbds_arrfree(queue->items);
+    stbds_arrfree(queue->scratch);
+    stbds_arrfree(queue->commands);
+    glDeleteBuffers(1, &queue->indirectBuffer);
+    free(queue);
+}
@@ -0,0 +1,131 @@
+/**
+ * Modul für das sortierte Zeichnen von Meshes.
+ *
+ * Ein Pass reicht zuerst alle Meshes mit einem 64 Bit Schlüssel ein, danach
+ * wird die Queue per Radix Sort sortiert und abgearbeitet. Der Schlüssel
+ * setzt sich vom höchsten zum niedrigsten Bit so zusammen:
+ *
+ *  | Pass (4) | Programm (12) | Material (24) | Tiefe (24) |
+ *
+ * Dadurch liegen alle Meshes einer Shader-Variante und darin alle Meshes
+ * eines Materials direkt hintereinander, Shader und Material werden also
+ * nur bei einem Wechsel aktiviert. Innerhalb eines Materials wird deckende
+ * Geometrie von vorne nach hinten gezeichnet, so verwirft der frühe
+ * Tiefentest möglichst viele Fragmente. Transparente Geometrie wird von
+ * hinten nach vorne gezeichnet.
+ *
+ * Copyright (C) 2023, FH Wedel
+ * Autor: Joshua-Scott Schöttke, Ilana Schmara
+ */
+
+#ifndef RENDERQUEUE_H
+#define RENDERQUEUE_H
+
+#include <stdint.h>
+
+#include "common.h"
+#include "mesh.h"
+#include "shader.h"
+
+////////////////////////////////// KONSTANTEN //////////////////////////////////
+
+// Breite der Felder des Schlüssels in Bits
+#define RENDERQUEUE_PASS_BITS 4
+#define RENDERQUEUE_PROGRAM_BITS 12
+#define RENDERQUEUE_MATERIAL_BITS 24
+#define RENDERQUEUE_DEPTH_BITS 24
+
+//////////////////////////// ÖFFENTLICHE DATENTYPEN ////////////////////////////
+
+// Durchgänge in der Reihenfolge, in der sie gezeichnet werden.
+typedef enum {
+    RENDERQUEUE_PASS_OPAQUE,        // deckend, von vorne nach hinten
+    RENDERQUEUE_PASS_TRANSPARENT    // transparent, von hinten nach vorne
+} RenderQueuePass;
+
+// Zähler der letzten Abarbeitung einer Queue.
+typedef struct {
+    unsigned int items;             // gezeichnete Meshes
+    unsigned int programChanges;    // aktivierte Shader
+    unsigned int materialChanges;   // aktivierte Materialien
+    unsigned int drawCalls;         // abgesetzte Draw Calls
+} RenderQueueStats;
+
+// Datenstruktur einer Render Queue.
+struct RenderQueue;
+typedef struct RenderQueue RenderQueue;
+
+//////////////////////////// ÖFFENTLICHE FUNKTIONEN ////////////////////////////
+
+/**
+ * Legt eine neue, leere Render Queue an.
+ *
+ * @return die neue Queue
+ */
+RenderQueue* renderqueue_createQueue(void);
+
+/**
+ * Setzt den Sortierschlüssel eines Meshes zusammen. Zu große Nummern werden
+ * abgeschnitten, die Tiefe wird auf RENDERQUEUE_DEPTH_BITS Bits quantisiert.
+ *
+ * @param pass der Durchgang
+ * @param program die Nummer des Shaders, z.B. die Feature-Maske der Variante
+ * @param material die Nummer des Materials (siehe material_getId)
+ * @param depth der Abstand zur Kamera entlang der Blickrichtung
+ * @param maxDepth der größte Abstand, z.B. die Far Plane
+ * @return der Schlüssel
+ */
+uint64_t renderqueue_makeKey(RenderQueuePass pass, unsigned int program,
+                             unsigned int material, float depth, float maxDepth);
+
+/**
+ * Reicht ein Mesh zum Zeichnen ein.
+ *
+ * @param queue die Queue
+ * @param key der Sortierschlüssel (siehe renderqueue_makeKey)
+ * @param mesh das Mesh
+ * @param shader der Shader, mit dem das Mesh gezeichnet wird
+ */
+void renderqueue_submit(RenderQueue* queue, uint64_t key, Mesh* mesh,
+                        Shader* shader);
+
+/**
+ * Sortiert alle eingereichten Meshes aufsteigend nach ihrem Schlüssel.
+ * Der Radix Sort ist stabil und überspringt Bytes, die bei allen Schlüsseln
+ * gleich sind.
+ *
+ * @param queue die Queue
+ */
+void renderqueue_sort(RenderQueue* queue);
+
+/**
+ * Zeichnet alle Meshes in der Reihenfolge der Queue. Wechselt der Shader,
+ * wird er aktiviert und setup übergibt seine Uniforms. Das Material wird nur
+ * gesetzt, wenn es sich ändert oder ein neuer Shader aktiv ist. Folgen von
+ * Meshes ohne Wechsel werden mit Multi Draw Indirect gezeichnet, sofern
+ * verfügbar (siehe geometrypool.h).
+ *
+ * @param queue die sortierte Queue
+ * @param setup übergibt die Uniforms an einen neu aktivierten Shader
+ * @param userData wird an setup durchgereicht
+ * @param isModel true, wenn Patches für die Tessellation gezeichnet werden
+ * @return die Zähler dieser Abarbeitung
+ */
+RenderQueueStats renderqueue_execute(RenderQueue* queue, ShaderSetupFunc setup,
+                                     void* userData, bool isModel);
+
+/**
+ * Leert eine Queue für das nächste Frame. Der Speicher bleibt erhalten.
+ *
+ * @param queue die Queue
+ */
+void renderqueue_clear(RenderQueue* queue);
+
+/**
+ * Löscht eine Render Queue.
+ *
+ * @param queue die zu löschende Queue oder NULL
+ */
+void renderqueue_deleteQueue(RenderQueue* queue);
+
+#endif // RENDERQUEUE_H
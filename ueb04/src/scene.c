@@ -215,6 +215,7 @@ static void scene_parsePointLight(struct json_value_s* lightVal, Scene* scene)
     vec3 color;
     bool posSet = false;
     bool colorSet = false;
+    bool castShadow = false;
 
     struct json_object_element_s* pointLightElem = lightObj->start;
     while (pointLightElem)
@@ -227,6 +228,10 @@ static void scene_parsePointLight(struct json_value_s* lightVal, Scene* scene)
         {
             colorSet = scene_parseVec3(pointLightElem->value, "rgb", color);
         }
+        else if (strcmp(pointLightElem->name->string, "shadow") == 0)
+        {
+            castShadow = json_value_is_true(pointLightElem->value);
+        }
 
         pointLightElem = pointLightElem->next;
     }
@@ -241,6 +246,7 @@ static void scene_parsePointLight(struct json_value_s* lightVal, Scene* scene)
     }
 
     PointLight* light = light_createPointLight(pos, color);
+    light->castShadow = castShadow;
     scene_addPointLight(scene, light);
 }
 
@@ -8,12 +8,59 @@
 #include "shader.h"
 
 #include <stdio.h>
+#include <stdint.h>
+#include <string.h>
 #include <sesp/stb_ds.h>
 
+#ifdef _WIN32
+    #include <direct.h>
+#else
+    #include <sys/stat.h>
+#endif
+
+#include "glstate.h"
 #include "utils.h"
 
+////////////////////////////////// KONSTANTEN //////////////////////////////////
+
+// Verzeichnis für übersetzte Programme (siehe shader_buildShader).
+#ifndef SHADER_CACHE_PATH
+    #define SHADER_CACHE_PATH "./shadercache/"
+#endif
+
+// Kennung am Anfang jeder Datei im Cache
+#define SHADER_CACHE_MAGIC 0x50534553u
+
+// Länge der Pfade im Cache
+#define SHADER_CACHE_PATH_LENGTH 256
+
+// GL_COMPLETION_STATUS_KHR, fehlt in GLAD wie die ganze Erweiterung
+#define SHADER_COMPLETION_STATUS 0x91B1
+
+// Startwert und Faktor des FNV-1a Hashes
+#define SHADER_HASH_OFFSET 14695981039346656037ull
+#define SHADER_HASH_PRIME 1099511628211ull
+
 ////////////////////////////// LOKALE DATENTYPEN ///////////////////////////////
 
+// Quellcode eines Bestandteils, der erst beim Bauen übersetzt wird.
+struct ShaderSource
+{
+    GLenum type;
+    char* source;
+    char* name;
+    char* defines;
+    bool isFile;
+};
+
+// Datei eines Bestandteils, bleibt für das Neuladen erhalten.
+struct ShaderStage
+{
+    GLenum type;
+    char* file;
+    char* defines;
+};
+
 // Implementierung der Datenstruktur, die einen Shader repräsentiert.
 // Dadurch, dass das Struct erst hier vollständig definiert wird, sind die
 // Eigenschaften eiens Shaders nur in dieser Datei sichtbar.
@@ -21,47 +68,211 @@ struct Shader
 {
     GLuint id;
     bool linked;
-    int fileCount;
-    GLuint* shaderFiles;
+    int sourceCount;
+    struct ShaderSource* sources;
+
+    // Dateien der Bestandteile. Quellcode aus dem Speicher lässt sich nicht
+    // neu laden.
+    int stageCount;
+    struct ShaderStage* stages;
+    bool reloadable;
+
+    // Ersatz, der gerade im Hintergrund übersetzt wird, oder NULL
+    struct ShaderBatchEntry* reload;
+
     struct UniformHashmap {
         char* key;
         GLint value;
     } *uniforms;
+
+    // Locations mit der Kennung aus shader_getUniform als Index (stb_ds)
+    GLint* handleLocations;
+};
+
+// Anzahl der Stufen, aus denen eine Variante bestehen kann
+#define SHADER_VARIANT_STAGES 4
+
+// Höchstzahl der Features, die Tabelle hat 2^n Einträge
+#define SHADER_VARIANT_MAX_FEATURES 8
+
+// Implementierung der Varianten eines Shaders.
+struct ShaderVariants
+{
+    char* label;
+    char* files[SHADER_VARIANT_STAGES];
+    char* defines;
+    char** features;
+    int featureCount;
+
+    // Varianten mit der Feature-Maske als Index, NULL bei Fehlern. built
+    // merkt sich, welche Masken bereits versucht wurden.
+    Shader** shaders;
+    bool* built;
+    int builtCount;
+};
+
+// Die Stufen in der Reihenfolge der Dateien einer Variante
+static const GLenum SHADER_VARIANT_TYPES[SHADER_VARIANT_STAGES] = {
+    GL_VERTEX_SHADER,
+    GL_TESS_CONTROL_SHADER,
+    GL_TESS_EVALUATION_SHADER,
+    GL_FRAGMENT_SHADER
+};
+
+// Ein Shader, der gemeinsam mit anderen gebaut wird.
+struct ShaderBatchEntry
+{
+    Shader* shader;
+    char* label;
+    Shader** result;
+
+    GLuint program;
+    GLuint* glslShaders;    // abgeschickte Bestandteile, NULL bei Cache-Treffer
+    bool useCache;
+    char cachePath[SHADER_CACHE_PATH_LENGTH];
+    uint64_t cacheHash;
+};
+
+// Implementierung eines Durchgangs, in dem mehrere Shader gebaut werden.
+struct ShaderBatch
+{
+    struct ShaderBatchEntry* entries;
+};
+
+// Funktion aus GL_KHR_parallel_shader_compile bzw. der ARB Variante
+typedef void (APIENTRYP ShaderMaxCompilerThreadsFunc)(GLuint count);
+
+// Ob bereits versucht wurde, paralleles Übersetzen einzuschalten, und ob
+// der Treiber es unterstützt
+static bool shaderParallelChecked = false;
+static bool shaderParallelCompile = false;
+
+// Zustand des Caches, wird beim ersten Bauen ermittelt:
+// -1 = unbekannt, 0 = vom Treiber nicht unterstützt, 1 = aktiv
+static int shaderCacheState = -1;
+
+// Hash über Hersteller, Renderer und Version des Treibers
+static uint64_t shaderDriverHash;
+
+// Ein Uniform Block mit festem Binding Point.
+struct ShaderUniformBlock
+{
+    const char* name;
+    GLuint binding;
 };
 
+// Dynamisches Array (stb_ds) der angemeldeten Uniform Blöcke
+static struct ShaderUniformBlock* shaderUniformBlocks = NULL;
+
+// Dynamisches Array (stb_ds) der Namen aller Uniform Kennungen, die Kennung
+// ist der Index. Die Namen bleiben bis zum Programmende bestehen.
+static char** shaderUniformNames = NULL;
+
 ////////////////////////////// LOKALE FUNKTIONEN ///////////////////////////////
 
 /**
- * Hilfsfunktion zum Laden eines Shaders aus einer Datei.
- * Der Shader wird direkt kompiliert.
+ * Legt eine Kopie einer Zeichenkette an.
+ * 
+ * @param text die zu kopierende Zeichenkette oder NULL
+ * @return die Kopie oder NULL, muss mit free freigegeben werden
+ */
+static char* shader_copyString(const char* text)
+{
+    if (text == NULL)
+    {
+        return NULL;
+    }
+
+    size_t length = strlen(text) + 1;
+    char* copy = malloc(length);
+    memcpy(copy, text, length);
+    return copy;
+}
+
+/**
+ * Übersetzt die Variante eines Shaders für eine Feature-Maske.
+ * 
+ * @param variants die Varianten
+ * @param featureMask die gesetzten Features
+ * @return die neue Variante oder NULL bei Fehlern
+ */
+static Shader* shader_buildVariant(ShaderVariants* variants, unsigned int featureMask)
+{
+    // Zuerst die gemeinsamen Definitionen, dann eine Zeile pro Feature
+    size_t length = (variants->defines ? strlen(variants->defines) : 0) + 1;
+    for (int i = 0; i < variants->featureCount; i++)
+    {
+        length += strlen("#define \n") + strlen(variants->features[i]);
+    }
+
+    char* defines = malloc(length);
+    strcpy(defines, variants->defines ? variants->defines : "");
+    for (int i = 0; i < variants->featureCount; i++)
+    {
+        if (featureMask & (1u << i))
+        {
+            strcat(defines, "#define ");
+            strcat(defines, variants->features[i]);
+            strcat(defines, "\n");
+        }
+    }
+
+    Shader* shader = shader_createShader();
+    bool success = true;
+    for (int i = 0; i < SHADER_VARIANT_STAGES; i++)
+    {
+        if (variants->files[i] != NULL)
+        {
+            success &= shader_attachShaderFileDefines(shader,
+                SHADER_VARIANT_TYPES[i], variants->files[i], defines);
+        }
+    }
+    free(defines);
+
+    if (success && shader_buildShader(shader))
+    {
+        char label[256];
+        snprintf(label, sizeof(label), "%s (0x%x)", variants->label, featureMask);
+        common_labelObjectByType(GL_PROGRAM, shader->id, label);
+        return shader;
+    }
+
+    shader_deleteShader(shader);
+    return NULL;
+}
+
+/**
+ * Schickt Shader-Quellcode zum Übersetzen ab, ohne auf das Ergebnis zu
+ * warten (siehe shader_checkGLSLShader).
  * 
  * @param type die Art Shader, die erzeugt werden soll
- * @param file der Pfad zum Shader-Quellcode
- * @param success signalisiert, ob die erzeugung erfolgreich war
+ * @param source der Quellcode
  * @return die ID des neu erzeugten Shaders
  */
-static GLuint shader_createGLSLShader(GLenum type, const char* file, 
-                                      bool* success)
+static GLuint shader_submitGLSLShader(GLenum type, const char* source)
 {
-    // Grundsätzlich gehen wir von einem Erfolg aus.
-    *success = true;
-
-    // Zuerst erstellen wir einen neuen, leeren Shader.
+    // Zuerst erstellen wir einen neuen, leeren Shader und weisen ihm den
+    // Quellcode zu.
     GLuint shader = glCreateShader(type);
-
-    // Danach laden wir den Quellcode des Shaders aus der 
-    // angegebenen Datei. Dieser wird dem neuen Shader zugewiesen.
-    const char* source = utils_readFile(file);
     glShaderSource(shader, 1, &source, NULL);
 
     // Als nächstes kann der Shader kompiliert werden.
     glCompileShader(shader);
 
-    // Außerdem kann der Speicher für den Quellcode wieder freigegeben werden.
-    free((void*) source);
+    return shader;
+}
 
-    // Zum Schluss muss festgestellt werden, ob Fehler beim Kompilieren
-    // aufgetreten sind.
+/**
+ * Stellt fest, ob beim Übersetzen eines abgeschickten Shaders Fehler
+ * aufgetreten sind, und gibt diese aus. Erst diese Abfrage wartet auf den
+ * Treiber.
+ * 
+ * @param shader die ID des Shaders
+ * @param source der zugehörige Quellcode
+ * @return true, wenn der Shader übersetzt wurde
+ */
+static bool shader_checkGLSLShader(GLuint shader, struct ShaderSource* source)
+{
     GLint successId;
     glGetShaderiv(shader, GL_COMPILE_STATUS, &successId);
     if (!successId)
@@ -80,22 +291,605 @@ static GLuint shader_createGLSLShader(GLenum type, const char* file,
         fprintf(
             stderr, 
             "Error on shader compilation of file \"%s\":\n\t%s\n", 
-            file, buffer
+            source->name, buffer
         );
 
-        // Nach der Meldung geben wir die neu erstellten Ressourcen wieder frei.
         free(buffer);
-        glDeleteShader(shader);
-
-        // Den Misserfolg an die aufrufende Funktion melden.
-        *success = false;
+        return false;
     }
 
     // Label setzen, damit der Shader in RenderDoc leichter erkennbar ist.
-    common_labelObjectByFilename(GL_SHADER, shader, file);
+    if (source->isFile)
+    {
+        common_labelObjectByFilename(GL_SHADER, shader, source->name);
+    }
+    else
+    {
+        common_labelObjectByType(GL_SHADER, shader, source->name);
+    }
 
-    // Bei Erfolg geben wir die ID des neuen Shaders zurück.
-    return shader;
+    return true;
+}
+
+/**
+ * Hilfsfunktion zum Einfügen zusätzlicher Präprozessor-Definitionen hinter
+ * der #version Zeile eines Quellcodes. Eine #line Anweisung sorgt dafür,
+ * dass die Zeilennummern in Fehlermeldungen weiter zur Datei passen.
+ * 
+ * @param source der Quellcode, wird freigegeben
+ * @param defines die Definitionen
+ * @return der neue Quellcode, muss mit free freigegeben werden
+ */
+static char* shader_insertDefines(char* source, const char* defines)
+{
+    // Die #version Zeile muss die erste Anweisung bleiben.
+    char* rest = strchr(source, '\n');
+    rest = rest ? rest + 1 : source + strlen(source);
+    size_t versionLength = (size_t)(rest - source);
+
+    const char* lineDirective = "#line 2\n";
+    size_t length = versionLength + strlen(defines) + strlen(lineDirective)
+                  + strlen(rest) + 1;
+    char* combined = malloc(length);
+    memcpy(combined, source, versionLength);
+    combined[versionLength] = '\0';
+    strcat(combined, defines);
+    strcat(combined, lineDirective);
+    strcat(combined, rest);
+    free(source);
+
+    return combined;
+}
+
+/**
+ * Merkt sich den Quellcode eines Bestandteils für shader_buildShader.
+ * 
+ * @param shader der Shader
+ * @param type die Art des Bestandteils
+ * @param source der Quellcode, gehört danach dem Shader
+ * @param name Dateiname oder Bezeichnung für Fehlermeldungen
+ * @param defines die eingefügten Definitionen oder NULL
+ * @param isFile true, wenn name ein Dateipfad ist
+ * @return true, wenn der Shader noch nicht gelinkt war
+ */
+static bool shader_addSource(Shader* shader, GLenum type, char* source,
+                             const char* name, const char* defines, bool isFile)
+{
+    // Wenn der Shader bereits gelinkt wurde, darf kein neuer Quellcode 
+    // hinzugefügt werden.
+    if (shader->linked)
+    {
+        fprintf(stderr, "Cannot attach a source to an already linked shader!\n");
+        free(source);
+        return false;
+    }
+
+    shader->sourceCount++;
+    shader->sources = realloc(
+        shader->sources, 
+        sizeof(struct ShaderSource) * shader->sourceCount
+    );
+
+    struct ShaderSource* entry = &shader->sources[shader->sourceCount - 1];
+    entry->type = type;
+    entry->source = source;
+    entry->name = shader_copyString(name);
+    entry->defines = shader_copyString(defines);
+    entry->isFile = isFile;
+
+    return true;
+}
+
+/**
+ * Gibt die gemerkten Quellcodes eines Shaders frei.
+ * 
+ * @param shader der Shader
+ */
+static void shader_freeSources(Shader* shader)
+{
+    for (int i = 0; i < shader->sourceCount; i++)
+    {
+        free(shader->sources[i].source);
+        free(shader->sources[i].name);
+        free(shader->sources[i].defines);
+    }
+    free(shader->sources);
+    shader->sources = NULL;
+    shader->sourceCount = 0;
+}
+
+/**
+ * Merkt sich die Datei eines Bestandteils für das Neuladen.
+ * 
+ * @param shader der Shader
+ * @param type die Art des Bestandteils
+ * @param file der Pfad zur Datei
+ * @param defines die Definitionen oder NULL
+ */
+static void shader_addStage(Shader* shader, GLenum type, const char* file,
+                            const char* defines)
+{
+    shader->stageCount++;
+    shader->stages = realloc(
+        shader->stages,
+        sizeof(struct ShaderStage) * shader->stageCount
+    );
+
+    struct ShaderStage* stage = &shader->stages[shader->stageCount - 1];
+    stage->type = type;
+    stage->file = shader_copyString(file);
+    stage->defines = shader_copyString(defines);
+}
+
+/**
+ * Erweitert einen FNV-1a Hash um einen Speicherbereich.
+ * 
+ * @param hash der bisherige Hash
+ * @param data die Daten
+ * @param size die Größe der Daten in Bytes
+ * @return der neue Hash
+ */
+static uint64_t shader_hash(uint64_t hash, const void* data, size_t size)
+{
+    const unsigned char* bytes = data;
+    for (size_t i = 0; i < size; i++)
+    {
+        hash ^= bytes[i];
+        hash *= SHADER_HASH_PRIME;
+    }
+    return hash;
+}
+
+/**
+ * Prüft beim ersten Aufruf, ob der Treiber übersetzte Programme ausgeben
+ * kann, und bildet den Hash über die Kennung des Treibers. Nach einem
+ * Treiber-Update passen so keine alten Einträge mehr.
+ * 
+ * @return true, wenn der Cache genutzt werden kann
+ */
+static bool shader_isCacheAvailable(void)
+{
+    if (shaderCacheState < 0)
+    {
+        GLint formatCount = 0;
+        glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formatCount);
+        shaderCacheState = formatCount > 0 ? 1 : 0;
+
+        const GLenum names[] = { GL_VENDOR, GL_RENDERER, GL_VERSION };
+        shaderDriverHash = SHADER_HASH_OFFSET;
+        for (int i = 0; i < 3; i++)
+        {
+            const char* value = (const char*)glGetString(names[i]);
+            value = value ? value : "";
+            shaderDriverHash = shader_hash(shaderDriverHash, value, strlen(value) + 1);
+        }
+
+        // Das Verzeichnis darf bereits existieren.
+        if (shaderCacheState)
+        {
+#ifdef _WIN32
+            _mkdir(SHADER_CACHE_PATH);
+#else
+            mkdir(SHADER_CACHE_PATH, 0755);
+#endif
+        }
+    }
+
+    return shaderCacheState == 1;
+}
+
+/**
+ * Bestimmt den Eintrag eines Shaders im Cache. Der Pfad ergibt sich nur aus
+ * Art, Datei bzw. Bezeichnung und Definitionen der Bestandteile, jedes
+ * Programm belegt also genau eine Datei. Ändert sich der Quellcode oder der
+ * Treiber, wird diese Datei überschrieben, statt dass alte Einträge liegen
+ * bleiben. Ob der Eintrag noch passt, zeigt der Hash über alle Quellcodes
+ * und die Kennung des Treibers, der in der Datei mitgespeichert wird.
+ * 
+ * @param shader der Shader mit den gemerkten Quellcodes
+ * @param path erhält den Pfad
+ * @param size die Größe von path
+ * @return der Hash über den Inhalt
+ */
+static uint64_t shader_getCachePath(Shader* shader, char* path, size_t size)
+{
+    uint64_t slot = SHADER_HASH_OFFSET;
+    uint64_t hash = shaderDriverHash;
+    for (int i = 0; i < shader->sourceCount; i++)
+    {
+        struct ShaderSource* entry = &shader->sources[i];
+        const char* name = entry->name ? entry->name : "";
+        const char* defines = entry->defines ? entry->defines : "";
+        slot = shader_hash(slot, &entry->type, sizeof(entry->type));
+        slot = shader_hash(slot, name, strlen(name) + 1);
+        slot = shader_hash(slot, defines, strlen(defines) + 1);
+        hash = shader_hash(hash, &entry->type, sizeof(entry->type));
+        hash = shader_hash(hash, entry->source, strlen(entry->source) + 1);
+    }
+
+    snprintf(path, size, "%s%016llx.bin", SHADER_CACHE_PATH,
+             (unsigned long long)slot);
+    return hash;
+}
+
+/**
+ * Übergibt ein Programm aus dem Cache an den Treiber. Ob er es annimmt,
+ * zeigt erst der Link-Status (siehe shader_finishEntry). Ein veralteter
+ * Eintrag bleibt liegen, er wird nach dem Übersetzen überschrieben.
+ * 
+ * @param program das noch leere Programm
+ * @param path der Pfad im Cache
+ * @param hash der erwartete Hash über den Inhalt
+ * @return true, wenn ein passender Eintrag gefunden und übergeben wurde
+ */
+static bool shader_submitBinary(GLuint program, const char* path, uint64_t hash)
+{
+    FILE* f = fopen(path, "rb");
+    if (f == NULL)
+    {
+        return false;
+    }
+
+    uint32_t header[2] = { 0, 0 };
+    uint64_t storedHash = 0;
+    bool success = fread(header, sizeof(uint32_t), 2, f) == 2
+                && header[0] == SHADER_CACHE_MAGIC
+                && fread(&storedHash, sizeof(uint64_t), 1, f) == 1;
+    if (success && storedHash != hash)
+    {
+        fclose(f);
+        return false;
+    }
+
+    // Der Rest der Datei ist das Programm im Format des Treibers.
+    long start = ftell(f);
+    fseek(f, 0, SEEK_END);
+    long length = ftell(f) - start;
+    fseek(f, start, SEEK_SET);
+
+    void* binary = NULL;
+    success = success && length > 0;
+    if (success)
+    {
+        binary = malloc((size_t)length);
+        success = fread(binary, 1, (size_t)length, f) == (size_t)length;
+    }
+    fclose(f);
+
+    if (success)
+    {
+        glProgramBinary(program, (GLenum)header[1], binary, (GLsizei)length);
+    }
+    else
+    {
+        remove(path);
+    }
+    free(binary);
+
+    return success;
+}
+
+/**
+ * Legt ein gelinktes Programm im Cache ab. Fehler beim Schreiben werden
+ * ignoriert, dann wird beim nächsten Start eben neu übersetzt.
+ * 
+ * @param program das gelinkte Programm
+ * @param path der Pfad im Cache
+ * @param hash der Hash über den Inhalt
+ */
+static void shader_saveBinary(GLuint program, const char* path, uint64_t hash)
+{
+    GLint length = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0)
+    {
+        return;
+    }
+
+    void* binary = malloc((size_t)length);
+    GLenum format = 0;
+    glGetProgramBinary(program, length, &length, &format, binary);
+
+    FILE* f = fopen(path, "wb");
+    if (f != NULL)
+    {
+        uint32_t header[2] = { SHADER_CACHE_MAGIC, (uint32_t)format };
+        fwrite(header, sizeof(uint32_t), 2, f);
+        fwrite(&hash, sizeof(uint64_t), 1, f);
+        fwrite(binary, 1, (size_t)length, f);
+        fclose(f);
+    }
+
+    free(binary);
+}
+
+/**
+ * Schaltet beim ersten Aufruf das parallele Übersetzen im Treiber ein, falls
+ * GL_KHR_parallel_shader_compile oder GL_ARB_parallel_shader_compile
+ * vorhanden ist. Dann blockieren glCompileShader und glLinkProgram nicht,
+ * sondern erst die Abfrage des Status.
+ */
+static void shader_enableParallelCompile(void)
+{
+    if (shaderParallelChecked)
+    {
+        return;
+    }
+    shaderParallelChecked = true;
+
+    // Die Erweiterungen sind nicht in GLAD enthalten.
+    ShaderMaxCompilerThreadsFunc maxThreads = NULL;
+    if (glfwExtensionSupported("GL_KHR_parallel_shader_compile"))
+    {
+        maxThreads = (ShaderMaxCompilerThreadsFunc)glfwGetProcAddress("glMaxShaderCompilerThreadsKHR");
+    }
+    else if (glfwExtensionSupported("GL_ARB_parallel_shader_compile"))
+    {
+        maxThreads = (ShaderMaxCompilerThreadsFunc)glfwGetProcAddress("glMaxShaderCompilerThreadsARB");
+    }
+
+    // 0xFFFFFFFF überlässt dem Treiber die Anzahl der Threads.
+    if (maxThreads)
+    {
+        maxThreads(0xFFFFFFFFu);
+        shaderParallelCompile = true;
+    }
+}
+
+/**
+ * Prüft, ob ein Shader gebaut werden kann.
+ * 
+ * @param shader der Shader
+ * @return true, wenn er nicht gelinkt ist und Quellcode angehängt wurde
+ */
+static bool shader_canBuild(Shader* shader)
+{
+    // Der Shader darf nicht bereits gelinkt sein.
+    if (shader->linked)
+    {
+        fprintf(stderr, "Cannot build a shader that is already linked!\n");
+        return false;
+    }
+
+    // Dem Shader muss mindestens eine Datei hinzugefügt worden sein.
+    if (!shader->sources)
+    {
+        fprintf(stderr, "Cannot build a shader with no attached files!\n");
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * Schickt alle gemerkten Quellcodes zum Übersetzen ab und linkt sie, ohne
+ * den Status abzufragen.
+ * 
+ * @param entry der Eintrag mit Shader und leerem Programm
+ */
+static void shader_submitCompile(struct ShaderBatchEntry* entry)
+{
+    Shader* shader = entry->shader;
+    entry->glslShaders = malloc(sizeof(GLuint) * shader->sourceCount);
+    for (int i = 0; i < shader->sourceCount; i++)
+    {
+        entry->glslShaders[i] = shader_submitGLSLShader(
+            shader->sources[i].type, shader->sources[i].source);
+        glAttachShader(entry->program, entry->glslShaders[i]);
+    }
+
+    // Dannach kann das Programm gelinkt werden. Schlägt ein Bestandteil
+    // fehl, schlägt auch das Linken fehl. Der Hinweis sorgt dafür, dass das
+    // Ergebnis für den Cache ausgelesen werden kann.
+    glProgramParameteri(entry->program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    glLinkProgram(entry->program);
+}
+
+/**
+ * Schickt einen Shader ab: Liegt er im Cache, wird das Programm direkt
+ * übergeben, ansonsten werden alle Bestandteile übersetzt und gelinkt.
+ * 
+ * @param entry der Eintrag mit dem Shader
+ */
+static void shader_submitEntry(struct ShaderBatchEntry* entry)
+{
+    shader_enableParallelCompile();
+
+    entry->program = glCreateProgram();
+    entry->glslShaders = NULL;
+    entry->useCache = shader_isCacheAvailable();
+    if (entry->useCache)
+    {
+        entry->cacheHash = shader_getCachePath(entry->shader, entry->cachePath,
+                                               sizeof(entry->cachePath));
+        if (shader_submitBinary(entry->program, entry->cachePath, entry->cacheHash))
+        {
+            return;
+        }
+    }
+
+    shader_submitCompile(entry);
+}
+
+/**
+ * Bindet alle angemeldeten Uniform Blöcke, die ein Programm nutzt, an ihre
+ * Binding Points.
+ * 
+ * @param program das gelinkte Programm
+ */
+static void shader_bindUniformBlocks(GLuint program)
+{
+    for (ptrdiff_t i = 0; i < stbds_arrlen(shaderUniformBlocks); i++)
+    {
+        GLuint index = glGetUniformBlockIndex(program, shaderUniformBlocks[i].name);
+        if (index != GL_INVALID_INDEX)
+        {
+            glUniformBlockBinding(program, index, shaderUniformBlocks[i].binding);
+        }
+    }
+}
+
+/**
+ * Fragt die Locations aller Uniform Kennungen ab, die der Shader noch nicht
+ * kennt. Beim Bauen sind das alle bisher angemeldeten, später angemeldete
+ * Kennungen werden beim ersten Zugriff nachgeholt.
+ * 
+ * @param shader der gelinkte Shader
+ */
+static void shader_resolveUniforms(Shader* shader)
+{
+    ptrdiff_t count = stbds_arrlen(shaderUniformNames);
+    for (ptrdiff_t i = stbds_arrlen(shader->handleLocations); i < count; i++)
+    {
+        stbds_arrput(shader->handleLocations,
+                     glGetUniformLocation(shader->id, shaderUniformNames[i]));
+    }
+}
+
+/**
+ * Fragt das Ergebnis eines abgeschickten Shaders ab, gibt Fehler aus und
+ * füllt bei Erfolg das Shaderobjekt. Lehnt der Treiber ein Programm aus dem
+ * Cache ab, wird der Eintrag ohne Meldung gelöscht und neu übersetzt.
+ * 
+ * @param entry der abgeschickte Eintrag
+ * @return true, wenn der Shader gelinkt ist
+ */
+static bool shader_finishEntry(struct ShaderBatchEntry* entry)
+{
+    Shader* shader = entry->shader;
+    GLint isLinked = GL_FALSE;
+
+    if (entry->glslShaders == NULL)
+    {
+        glGetProgramiv(entry->program, GL_LINK_STATUS, &isLinked);
+        if (!isLinked)
+        {
+            remove(entry->cachePath);
+            glstate_deleteProgram(entry->program);
+            entry->program = glCreateProgram();
+            shader_submitCompile(entry);
+        }
+    }
+
+    if (entry->glslShaders != NULL)
+    {
+        // Zuerst werden alle Bestandteile geprüft, damit alle Meldungen
+        // ausgegeben werden.
+        bool compiled = true;
+        for (int i = 0; i < shader->sourceCount; i++)
+        {
+            compiled &= shader_checkGLSLShader(entry->glslShaders[i], &shader->sources[i]);
+        }
+
+        // Zum Schluss muss festgestellt werden, ob Fehler beim Linken
+        // aufgetreten sind.
+        glGetProgramiv(entry->program, GL_LINK_STATUS, &isLinked);
+        if (compiled && !isLinked)
+        {
+            // Wenn es einen Fehler gab, geben wir eine Meldung auf der
+            // Konsole aus. Dazu muss erst die Länge der Meldung abgerufen
+            // werden, bevor diese in den neu erstellten Buffer geladen
+            // werden kann.
+            GLint logSize = 0;
+            glGetProgramiv(entry->program, GL_INFO_LOG_LENGTH, &logSize);
+
+            GLchar* buffer = (GLchar*) malloc(logSize);
+            glGetProgramInfoLog(entry->program, logSize, &logSize, buffer);
+            fprintf(stderr, "Error on shader linking:\n\t%s\n", buffer);
+            free(buffer);
+        }
+
+        // Nach dem Linken sollten immer alle Shader vom Programm getrennt
+        // werden, danach werden die einzelnen Bestandteile nicht mehr
+        // benötigt.
+        for (int i = 0; i < shader->sourceCount; i++)
+        {
+            glDetachShader(entry->program, entry->glslShaders[i]);
+            glDeleteShader(entry->glslShaders[i]);
+        }
+        free(entry->glslShaders);
+        entry->glslShaders = NULL;
+
+        if (isLinked && entry->useCache)
+        {
+            shader_saveBinary(entry->program, entry->cachePath, entry->cacheHash);
+        }
+    }
+
+    if (!isLinked)
+    {
+        // Der Fehlschlag wird dem Aufrufer mitgeteilt.
+        glstate_deleteProgram(entry->program);
+        return false;
+    }
+
+    // Block Bindings gehören zum Programm, auch bei einem Treffer im Cache
+    // werden sie daher neu gesetzt.
+    shader_bindUniformBlocks(entry->program);
+
+    // Jetzt kann das Shaderobjekt vollständig gefüllt werden. Die Quellcodes
+    // werden nicht mehr benötigt.
+    shader->linked = true;
+    shader->id = entry->program;
+    shader_freeSources(shader);
+
+    stbds_arrsetlen(shader->handleLocations, 0);
+    shader_resolveUniforms(shader);
+
+    return true;
+}
+
+/**
+ * Verwirft ein laufendes Neuladen eines Shaders samt Ersatz.
+ * 
+ * @param shader der Shader
+ */
+static void shader_cancelReload(Shader* shader)
+{
+    struct ShaderBatchEntry* entry = shader->reload;
+    if (entry == NULL)
+    {
+        return;
+    }
+
+    // Noch abgeschickte Bestandteile und das Programm freigeben.
+    if (entry->glslShaders)
+    {
+        for (int i = 0; i < entry->shader->sourceCount; i++)
+        {
+            glDeleteShader(entry->glslShaders[i]);
+        }
+        free(entry->glslShaders);
+    }
+    glstate_deleteProgram(entry->program);
+
+    shader_deleteShader(entry->shader);
+    free(entry);
+    shader->reload = NULL;
+}
+
+/**
+ * Prüft, ob alle Dateien eines Shaders gelesen werden können. Beim
+ * Speichern ersetzen manche Editoren die Datei, dann fehlt sie kurzzeitig.
+ * 
+ * @param shader der Shader
+ * @return true, wenn alle Dateien vorhanden sind
+ */
+static bool shader_canReadStages(Shader* shader)
+{
+    for (int i = 0; i < shader->stageCount; i++)
+    {
+        FILE* f = fopen(shader->stages[i].file, "rb");
+        if (f == NULL)
+        {
+            fprintf(stderr, "Cannot reload shader, \"%s\" is missing.\n",
+                    shader->stages[i].file);
+            return false;
+        }
+        fclose(f);
+    }
+
+    return true;
 }
 
 /**
@@ -114,14 +908,31 @@ static GLint shader_getUniformLocation(Shader* shader, const char* name)
     GLint location = stbds_shget(shader->uniforms, name);
     if (location < -1)
     {
-        // Wenn wir keine Location gecached haben, rufen wir sie von OpenGL ab.
-        location = glGetUniformLocation(shader->id, name);
-
-        // Danach sichern wir sie auch gleich im Cache.
-        stbds_shput(shader->uniforms, name, location);
+        // Wenn wir keine Location gecached haben, rufen wir sie von OpenGL ab.
+        location = glGetUniformLocation(shader->id, name);
+
+        // Danach sichern wir sie auch gleich im Cache.
+        stbds_shput(shader->uniforms, name, location);
+    }
+
+    return location;
+}
+
+/**
+ * Hilfsfunktion zum Abrufen der Location einer Uniform Kennung.
+ * 
+ * @param shader der Shader
+ * @param uniform die Kennung aus shader_getUniform
+ * @return die Uniform Location oder -1 wenn sie garnicht existiert
+ */
+static GLint shader_getHandleLocation(Shader* shader, ShaderUniform uniform)
+{
+    if (uniform >= stbds_arrlen(shader->handleLocations))
+    {
+        shader_resolveUniforms(shader);
     }
 
-    return location;
+    return shader->handleLocations[uniform];
 }
 
 //////////////////////////// ÖFFENTLICHE FUNKTIONEN ////////////////////////////
@@ -132,121 +943,296 @@ Shader* shader_createShader()
     Shader* shader = malloc(sizeof(Shader));
     shader->id = 0;
     shader->linked = false;
-    shader->fileCount = 0;
-    shader->shaderFiles = NULL;
+    shader->sourceCount = 0;
+    shader->sources = NULL;
+    shader->stageCount = 0;
+    shader->stages = NULL;
+    shader->reloadable = true;
+    shader->reload = NULL;
     shader->uniforms = NULL;
     stbds_sh_new_arena(shader->uniforms);
     stbds_shdefault(shader->uniforms, -2);
+    shader->handleLocations = NULL;
 
     return shader;
 }
 
 bool shader_attachShaderFile(Shader* shader, GLenum type, const char* file)
 {
-    // Wenn der Shader bereits gelinkt wurde, darf keine neue Datei 
-    // hinzugefügt werden.
-    if (shader->linked)
+    // Den Quellcode des Shaders aus der angegebenen Datei laden. Übersetzt
+    // wird erst beim Bauen, falls das Programm nicht im Cache liegt.
+    char* source = utils_readFile(file);
+    if (!shader_addSource(shader, type, source, file, NULL, true))
     {
-        fprintf(stderr, "Cannot attach a file to an already linked shader!\n");
         return false;
     }
 
-    // Zuerst laden und kompilieren wir die angegebene Datei.
-    bool success;
-    GLuint glslShader = shader_createGLSLShader(type, file, &success);
+    shader_addStage(shader, type, file, NULL);
+    return true;
+}
 
-    // Danach wird geprüft, ob die Operation erfolgreich war.
-    if (success)
+bool shader_attachShaderFileDefines(Shader* shader, GLenum type,
+                                    const char* file, const char* defines)
+{
+    // Ohne Definitionen wird die Datei unverändert übernommen.
+    if (defines == NULL || defines[0] == '\0')
     {
-        // Wenn ja fügen wir die neue Shader ID zum Array mit allen IDs hinzu.
-        shader->fileCount++;
-        shader->shaderFiles = realloc(
-            shader->shaderFiles, 
-            sizeof(GLuint) * shader->fileCount
-        );
-        shader->shaderFiles[shader->fileCount - 1] = glslShader;
+        return shader_attachShaderFile(shader, type, file);
     }
 
-    return success;
+    char* source = shader_insertDefines(utils_readFile(file), defines);
+    if (!shader_addSource(shader, type, source, file, defines, true))
+    {
+        return false;
+    }
+
+    shader_addStage(shader, type, file, defines);
+    return true;
+}
+
+bool shader_attachShaderSource(Shader* shader, GLenum type, const char* source,
+                               const char* label)
+{
+    shader->reloadable = false;
+    return shader_addSource(shader, type, shader_copyString(source), label, NULL, false);
 }
 
 bool shader_buildShader(Shader* shader)
 {
-    // Der Shader darf nicht bereits gelinkt sein.
-    if (shader->linked)
+    if (!shader_canBuild(shader))
     {
-        fprintf(stderr, "Cannot build a shader that is already linked!\n");
         return false;
     }
 
-    // Dem Shader muss mindestens eine Datei hinzugefügt worden sein.
-    if (!shader->shaderFiles)
+    struct ShaderBatchEntry entry;
+    memset(&entry, 0, sizeof(entry));
+    entry.shader = shader;
+
+    shader_submitEntry(&entry);
+    return shader_finishEntry(&entry);
+}
+
+ShaderBatch* shader_createBatch(void)
+{
+    ShaderBatch* batch = malloc(sizeof(ShaderBatch));
+    batch->entries = NULL;
+    return batch;
+}
+
+void shader_addToBatch(ShaderBatch* batch, Shader* shader, const char* label,
+                       Shader** result)
+{
+    // Bis der Durchgang gebaut ist, gibt es noch keinen fertigen Shader.
+    *result = NULL;
+    if (!shader_canBuild(shader))
     {
-        fprintf(stderr, "Cannot build a shader with no attached files!\n");
-        return false;
+        shader_deleteShader(shader);
+        return;
     }
 
-    // Benötigte Variablen und ein neues Shader-Programm anlegen.
-    bool success = true;
-    int i;
-    GLuint newProgram = glCreateProgram();
-    
-    // Wir iterieren über alle Shader-Dateien und hängen sie an das neue
-    // Programm mit an.
-    for (i = 0; i < shader->fileCount; i++)
+    struct ShaderBatchEntry entry;
+    memset(&entry, 0, sizeof(entry));
+    entry.shader = shader;
+    entry.label = shader_copyString(label);
+    entry.result = result;
+    stbds_arrput(batch->entries, entry);
+}
+
+int shader_buildBatch(ShaderBatch* batch)
+{
+    int count = (int)stbds_arrlen(batch->entries);
+
+    // Erst werden alle Shader abgeschickt, damit der Treiber sie parallel
+    // übersetzen kann. Dabei wird nie auf ein Ergebnis gewartet.
+    for (int i = 0; i < count; i++)
+    {
+        shader_submitEntry(&batch->entries[i]);
+    }
+
+    // Danach werden die Ergebnisse in derselben Reihenfolge abgefragt.
+    // Fehlgeschlagene Shader behält der Durchgang, damit sie nach einer
+    // Korrektur der Dateien neu geladen werden können.
+    int failed = 0;
+    for (int i = 0; i < count; i++)
     {
-        glAttachShader(newProgram, shader->shaderFiles[i]);
+        struct ShaderBatchEntry* entry = &batch->entries[i];
+        if (shader_finishEntry(entry))
+        {
+            // Label setzen, damit der Shader in RenderDoc leichter
+            // erkennbar ist.
+            common_labelObjectByType(GL_PROGRAM, entry->shader->id, entry->label);
+            *entry->result = entry->shader;
+        }
+        else
+        {
+            failed++;
+        }
     }
 
-    // Dannach kann das Programm gelinkt werden.
-    glLinkProgram(newProgram);
+    return failed;
+}
 
-    // Zum Schluss muss festgestellt werden, ob Fehler beim Linken
-    // aufgetreten sind.
-    GLint isLinked;
-    glGetProgramiv(newProgram, GL_LINK_STATUS, &isLinked);
-    if (!isLinked)
+int shader_reloadBatch(ShaderBatch* batch, const char* file)
+{
+    int requested = 0;
+    for (ptrdiff_t i = 0; i < stbds_arrlen(batch->entries); i++)
     {
-        // Wenn es einen Fehler gab, geben wir eine Meldung auf der Konsole aus.
-        // Dazu muss erst die Länge der Meldung abgerufen werden, bevor diese 
-        // in den neu erstellten Buffer geladen werden kann.
-        GLint logSize = 0;
-        glGetProgramiv(newProgram, GL_INFO_LOG_LENGTH, &logSize);
+        Shader* shader = batch->entries[i].shader;
+        if ((file == NULL || shader_usesFile(shader, file))
+            && shader_requestReload(shader))
+        {
+            requested++;
+        }
+    }
 
-        GLchar* buffer = (GLchar*) malloc(logSize);
-        glGetProgramInfoLog(newProgram, logSize, &logSize, buffer);
-        fprintf(stderr, "Error on shader linking:\n\t%s\n", buffer);
+    return requested;
+}
 
-        // Nach der Meldung geben wir die neu erstellten Ressourcen wieder frei.
-        free(buffer);
-        glDeleteProgram(newProgram);
+int shader_updateBatch(ShaderBatch* batch)
+{
+    int swapped = 0;
+    for (ptrdiff_t i = 0; i < stbds_arrlen(batch->entries); i++)
+    {
+        struct ShaderBatchEntry* entry = &batch->entries[i];
+        if (shader_updateReload(entry->shader) == SHADER_RELOAD_DONE)
+        {
+            // Ein zuvor fehlgeschlagener Shader wird erst jetzt eingetragen.
+            common_labelObjectByType(GL_PROGRAM, entry->shader->id, entry->label);
+            *entry->result = entry->shader;
+            swapped++;
+        }
+    }
 
-        // Der Fehlschlag wird dem Aufrufer mitgeteilt.
-        success = false;
+    return swapped;
+}
+
+void shader_deleteBatch(ShaderBatch* batch)
+{
+    if (!batch)
+    {
+        return;
     }
-    else
+
+    // Eingetragene Shader gehören dem Aufrufer, nur die fehlgeschlagenen
+    // werden hier gelöscht.
+    for (ptrdiff_t i = 0; i < stbds_arrlen(batch->entries); i++)
     {
-        // Nach dem Linken sollten immer alle Shader 
-        // vom Programm getrennt werden.
-        // Außerdem werden bach dem Linken die einzelnen Bestandteile nicht mehr 
-        // benötigt und müssen frei gegeben werden. Das Löschen wird jedoch 
-        // solange aufgeschoben, bis die Shader von allen Programmen getrennt 
-        // wurden.  Deswegen haben wir sie bereits im letzten Schritt getrennt.
-        for (i = 0; i < shader->fileCount; i++)
+        struct ShaderBatchEntry* entry = &batch->entries[i];
+        if (*entry->result != entry->shader)
         {
-            glDetachShader(newProgram, shader->shaderFiles[i]);
-            glDeleteShader(shader->shaderFiles[i]);
+            shader_deleteShader(entry->shader);
         }
+        free(entry->label);
+    }
+
+    stbds_arrfree(batch->entries);
+    free(batch);
+}
 
-        // Jetzt kann das Shaderobjekt vollständig gefüllt werden.
-        shader->linked = true;
-        shader->id = newProgram;
-        free(shader->shaderFiles);
-        shader->shaderFiles = NULL;
-        shader->fileCount = 0;
+bool shader_usesFile(Shader* shader, const char* file)
+{
+    for (int i = 0; i < shader->stageCount; i++)
+    {
+        if (strcmp(shader->stages[i].file, file) == 0)
+        {
+            return true;
+        }
     }
 
-    return success;
+    return false;
+}
+
+bool shader_requestReload(Shader* shader)
+{
+    if (!shader->reloadable || shader->stageCount == 0
+        || !shader_canReadStages(shader))
+    {
+        return false;
+    }
+
+    // Wurde die Datei erneut geändert, ist ein laufender Ersatz veraltet.
+    shader_cancelReload(shader);
+
+    Shader* replacement = shader_createShader();
+    for (int i = 0; i < shader->stageCount; i++)
+    {
+        struct ShaderStage* stage = &shader->stages[i];
+        shader_attachShaderFileDefines(replacement, stage->type, stage->file,
+                                       stage->defines);
+    }
+
+    // Der Ersatz wird nur abgeschickt, das Ergebnis fragt
+    // shader_updateReload ab.
+    struct ShaderBatchEntry* entry = malloc(sizeof(struct ShaderBatchEntry));
+    memset(entry, 0, sizeof(struct ShaderBatchEntry));
+    entry->shader = replacement;
+    shader_submitEntry(entry);
+    shader->reload = entry;
+
+    return true;
+}
+
+ShaderReloadState shader_updateReload(Shader* shader)
+{
+    struct ShaderBatchEntry* entry = shader->reload;
+    if (entry == NULL)
+    {
+        return SHADER_RELOAD_NONE;
+    }
+
+    // Mit parallelem Übersetzen lässt sich ohne Warten abfragen, ob der
+    // Treiber fertig ist. Ansonsten wartet die Abfrage einmalig.
+    if (shaderParallelCompile)
+    {
+        GLint completed = GL_TRUE;
+        glGetProgramiv(entry->program, SHADER_COMPLETION_STATUS, &completed);
+        if (!completed)
+        {
+            return SHADER_RELOAD_PENDING;
+        }
+    }
+
+    shader->reload = NULL;
+    Shader* replacement = entry->shader;
+    bool success = shader_finishEntry(entry);
+    free(entry);
+
+    if (!success)
+    {
+        // Das alte Programm bleibt aktiv.
+        shader_deleteShader(replacement);
+        return SHADER_RELOAD_FAILED;
+    }
+
+    // Das neue Programm übernehmen. Die Locations der Uniforms können sich
+    // geändert haben.
+    if (shader->linked)
+    {
+        glstate_deleteProgram(shader->id);
+    }
+    shader->id = replacement->id;
+    shader->linked = true;
+    shader_freeSources(shader);
+
+    stbds_shfree(shader->uniforms);
+    stbds_sh_new_arena(shader->uniforms);
+    stbds_shdefault(shader->uniforms, -2);
+
+    // Die Kennungen wurden bereits für das neue Programm aufgelöst.
+    stbds_arrfree(shader->handleLocations);
+    shader->handleLocations = replacement->handleLocations;
+    replacement->handleLocations = NULL;
+
+    replacement->linked = false;
+    shader_deleteShader(replacement);
+
+    return SHADER_RELOAD_DONE;
+}
+
+void shader_registerUniformBlock(const char* name, GLuint binding)
+{
+    struct ShaderUniformBlock block = { name, binding };
+    stbds_arrput(shaderUniformBlocks, block);
 }
 
 void shader_useShader(Shader* shader)
@@ -258,7 +1244,7 @@ void shader_useShader(Shader* shader)
         return;
     }
     // Zum Verwenden reicht ein einfacher Aufruf der folgenden Funktion:
-    glUseProgram(shader->id);
+    glstate_useProgram(shader->id);
 }
 
 void shader_deleteShader(Shader* shader)
@@ -272,82 +1258,134 @@ void shader_deleteShader(Shader* shader)
     // Wenn der Shader gelinkt wurde, muss das Programm gelöscht werden.
     if (shader->linked)
     {
-        glDeleteProgram(shader->id);
+        glstate_deleteProgram(shader->id);
     }
 
-    // Wenn noch Dateien angehängt sind, müssen diese gelöscht werden.
-    if (shader->shaderFiles)
+    // Wenn noch Quellcodes angehängt sind, müssen diese gelöscht werden.
+    shader_freeSources(shader);
+
+    // Ein laufendes Neuladen wird verworfen.
+    shader_cancelReload(shader);
+
+    for (int i = 0; i < shader->stageCount; i++)
     {
-        for (int i = 0; i < shader->fileCount; i++)
-        {
-            glDeleteShader(shader->shaderFiles[i]);
-        }
-        free(shader->shaderFiles);
+        free(shader->stages[i].file);
+        free(shader->stages[i].defines);
     }
+    free(shader->stages);
 
-    // Uniform Hashmap freigeben.
+    // Uniform Hashmap und Locations der Kennungen freigeben.
     stbds_shfree(shader->uniforms);
+    stbds_arrfree(shader->handleLocations);
 
     // Zum Schluss kann der Speicher wieder freigegeben werden.
     free(shader);
 }
 
-Shader* shader_createVeFrShader(const char* label, const char* vert, const char* frag)
+void shader_batchVeFrShader(ShaderBatch* batch, Shader** result,
+                            const char* label, const char* vert,
+                            const char* frag)
 {
-    // Zuerst werden alle benötigten Bestandteile des Shaders angelegt,
-    // egal ob einer Fehler verursacht.
+    // Die Dateien werden erst beim Bauen des Durchgangs übersetzt.
     Shader* newShader = shader_createShader();
-    bool vertOk = shader_attachShaderFile(newShader, GL_VERTEX_SHADER, vert);
-    bool fragOk = shader_attachShaderFile(newShader, GL_FRAGMENT_SHADER, frag);
+    shader_attachShaderFile(newShader, GL_VERTEX_SHADER, vert);
+    shader_attachShaderFile(newShader, GL_FRAGMENT_SHADER, frag);
+    shader_addToBatch(batch, newShader, label, result);
+}
 
-    // Danach wird auf mögliche Fehler geprüft.
-    if (vertOk && fragOk)
-    {
-        // Wenn keine Fehler aufgetreten sind, kann der Shader gebaut werden.
-        if (shader_buildShader(newShader))
-        {
-            // Wenn dies erfolgreich war, geben wir dem neuen Shader ein Label
-            // und geben dann die ID zurück.
-            common_labelObjectByType(GL_PROGRAM, newShader->id, label);
-            return newShader;
-        }
-    }
+void shader_batchVeFrShaderDefines(ShaderBatch* batch, Shader** result,
+                                   const char* label, const char* vert,
+                                   const char* frag, const char* defines)
+{
+    Shader* newShader = shader_createShader();
+    shader_attachShaderFileDefines(newShader, GL_VERTEX_SHADER, vert, defines);
+    shader_attachShaderFileDefines(newShader, GL_FRAGMENT_SHADER, frag, defines);
+    shader_addToBatch(batch, newShader, label, result);
+}
 
-    // Sollte ein Problem aufgetreten sein, wird der Shader wieder gelöscht und
-    // NULL zurückgegeben.
-    shader_deleteShader(newShader);
-    return NULL;
+void shader_batchVeTessFrShader(ShaderBatch* batch, Shader** result,
+                                const char* label, const char* vert,
+                                const char* tesc, const char* tese,
+                                const char* frag)
+{
+    Shader* newShader = shader_createShader();
+    shader_attachShaderFile(newShader, GL_VERTEX_SHADER, vert);
+    shader_attachShaderFile(newShader, GL_TESS_CONTROL_SHADER, tesc);
+    shader_attachShaderFile(newShader, GL_TESS_EVALUATION_SHADER, tese);
+    shader_attachShaderFile(newShader, GL_FRAGMENT_SHADER, frag);
+    shader_addToBatch(batch, newShader, label, result);
+}
+
+void shader_batchVeGeFrShader(ShaderBatch* batch, Shader** result,
+                              const char* label, const char* vert,
+                              const char* geom, const char* frag)
+{
+    Shader* newShader = shader_createShader();
+    shader_attachShaderFile(newShader, GL_VERTEX_SHADER, vert);
+    shader_attachShaderFile(newShader, GL_GEOMETRY_SHADER, geom);
+    shader_attachShaderFile(newShader, GL_FRAGMENT_SHADER, frag);
+    shader_addToBatch(batch, newShader, label, result);
+}
+
+Shader* shader_createVeFrShader(const char* label, const char* vert, const char* frag)
+{
+    // Ein einzelner Shader ist ein Durchgang mit nur einem Eintrag.
+    Shader* newShader;
+    ShaderBatch* batch = shader_createBatch();
+    shader_batchVeFrShader(batch, &newShader, label, vert, frag);
+    shader_buildBatch(batch);
+    shader_deleteBatch(batch);
+    return newShader;
+}
+
+Shader* shader_createVeFrShaderDefines(const char* label, const char* vert,
+                                       const char* frag, const char* defines)
+{
+    Shader* newShader;
+    ShaderBatch* batch = shader_createBatch();
+    shader_batchVeFrShaderDefines(batch, &newShader, label, vert, frag, defines);
+    shader_buildBatch(batch);
+    shader_deleteBatch(batch);
+    return newShader;
 }
 
 Shader* shader_createVeTessFrShader(const char* label,
     const char* vert, const char* tesc,
     const char* tese, const char* frag)
 {
-    // Zuerst werden alle benötigten Bestandteile des Shaders angelegt,
-    // egal ob einer Fehler verursacht.
-    Shader* newShader = shader_createShader();
-    bool vertOk = shader_attachShaderFile(newShader, GL_VERTEX_SHADER, vert);
-    bool tescOk = shader_attachShaderFile(newShader, GL_TESS_CONTROL_SHADER, tesc);
-    bool teseOk = shader_attachShaderFile(newShader, GL_TESS_EVALUATION_SHADER, tese);
-    bool fragOk = shader_attachShaderFile(newShader, GL_FRAGMENT_SHADER, frag);
+    Shader* newShader;
+    ShaderBatch* batch = shader_createBatch();
+    shader_batchVeTessFrShader(batch, &newShader, label, vert, tesc, tese, frag);
+    shader_buildBatch(batch);
+    shader_deleteBatch(batch);
+    return newShader;
+}
+
+Shader* shader_createVeGeFrShader(const char* label, const char* vert,
+    const char* geom, const char* frag)
+{
+    Shader* newShader;
+    ShaderBatch* batch = shader_createBatch();
+    shader_batchVeGeFrShader(batch, &newShader, label, vert, geom, frag);
+    shader_buildBatch(batch);
+    shader_deleteBatch(batch);
+    return newShader;
+}
 
-    // Danach wird auf mögliche Fehler geprüft.
-    if (vertOk && tescOk && teseOk && fragOk)
+ShaderUniform shader_getUniform(const char* name)
+{
+    // Die Suche läuft nur einmal je Aufrufer, daher reicht ein Vergleich
+    // aller bisherigen Namen.
+    for (ptrdiff_t i = 0; i < stbds_arrlen(shaderUniformNames); i++)
     {
-        // Wenn keine Fehler aufgetreten sind, kann der Shader gebaut werden.
-        if (shader_buildShader(newShader))
+        if (strcmp(shaderUniformNames[i], name) == 0)
         {
-            // Wenn dies erfolgreich war, geben wir dem neuen Shader ein Label
-            // und geben dann die ID zurück.
-            common_labelObjectByType(GL_PROGRAM, newShader->id, label);
-            return newShader;
+            return (ShaderUniform)i;
         }
     }
 
-    // Sollte ein Problem aufgetreten sein, wird der Shader wieder gelöscht und
-    // NULL zurückgegeben.
-    shader_deleteShader(newShader);
-    return NULL;
+    stbds_arrput(shaderUniformNames, shader_copyString(name));
+    return (ShaderUniform)(stbds_arrlen(shaderUniformNames) - 1);
 }
 
 void shader_setMat4(Shader* shader, char* name, mat4* mat)
@@ -356,6 +1394,12 @@ void shader_setMat4(Shader* shader, char* name, mat4* mat)
     glUniformMatrix4fv(location, 1, GL_FALSE, (float*) mat);
 }
 
+void shader_setMat4Array(Shader* shader, char* name, mat4* mats, int count)
+{
+    GLint location = shader_getUniformLocation(shader, name);
+    glUniformMatrix4fv(location, count, GL_FALSE, (float*) mats);
+}
+
 void shader_setVec2(Shader* shader, char* name, vec2* vec2)
 {
     GLint location = shader_getUniformLocation(shader, name);
@@ -368,6 +1412,12 @@ void shader_setVec3(Shader* shader, char* name, vec3* vec3)
     glUniform3fv(location, 1, (float*) vec3);
 }
 
+void shader_setVec4(Shader* shader, char* name, vec4* vec4)
+{
+    GLint location = shader_getUniformLocation(shader, name);
+    glUniform4fv(location, 1, (float*) vec4);
+}
+
 void shader_setInt(Shader* shader, char* name, int val)
 {
     GLint location = shader_getUniformLocation(shader, name);
@@ -380,10 +1430,204 @@ void shader_setFloat(Shader* shader, char* name, float val)
     glUniform1f(location, val);
 }
 
+void shader_setFloatArray(Shader* shader, char* name, float* vals, int count)
+{
+    GLint location = shader_getUniformLocation(shader, name);
+    glUniform1fv(location, count, vals);
+}
+
 void shader_setBool(Shader* shader, char* name, bool val)
 {
     GLint location = shader_getUniformLocation(shader, name);
     glUniform1i(location, val);
 }
 
+void shader_setMat4ByHandle(Shader* shader, ShaderUniform uniform, mat4* mat)
+{
+    GLint location = shader_getHandleLocation(shader, uniform);
+    glUniformMatrix4fv(location, 1, GL_FALSE, (float*) mat);
+}
+
+void shader_setMat4ArrayByHandle(Shader* shader, ShaderUniform uniform,
+                                 mat4* mats, int count)
+{
+    GLint location = shader_getHandleLocation(shader, uniform);
+    glUniformMatrix4fv(location, count, GL_FALSE, (float*) mats);
+}
+
+void shader_setVec2ByHandle(Shader* shader, ShaderUniform uniform, vec2* vec2)
+{
+    GLint location = shader_getHandleLocation(shader, uniform);
+    glUniform2fv(location, 1, (float*) vec2);
+}
+
+void shader_setVec3ByHandle(Shader* shader, ShaderUniform uniform, vec3* vec3)
+{
+    GLint location = shader_getHandleLocation(shader, uniform);
+    glUniform3fv(location, 1, (float*) vec3);
+}
+
+void shader_setVec4ByHandle(Shader* shader, ShaderUniform uniform, vec4* vec4)
+{
+    GLint location = shader_getHandleLocation(shader, uniform);
+    glUniform4fv(location, 1, (float*) vec4);
+}
+
+void shader_setIntByHandle(Shader* shader, ShaderUniform uniform, int val)
+{
+    GLint location = shader_getHandleLocation(shader, uniform);
+    glUniform1i(location, val);
+}
+
+void shader_setFloatByHandle(Shader* shader, ShaderUniform uniform, float val)
+{
+    GLint location = shader_getHandleLocation(shader, uniform);
+    glUniform1f(location, val);
+}
+
+void shader_setFloatArrayByHandle(Shader* shader, ShaderUniform uniform,
+                                  float* vals, int count)
+{
+    GLint location = shader_getHandleLocation(shader, uniform);
+    glUniform1fv(location, count, vals);
+}
+
+void shader_setBoolByHandle(Shader* shader, ShaderUniform uniform, bool val)
+{
+    GLint location = shader_getHandleLocation(shader, uniform);
+    glUniform1i(location, val);
+}
+
+ShaderVariants* shader_createVariants(const char* label, const char* vert,
+                                      const char* tesc, const char* tese,
+                                      const char* frag, const char* defines,
+                                      const char* const* features,
+                                      int featureCount)
+{
+    ShaderVariants* variants = malloc(sizeof(ShaderVariants));
+    memset(variants, 0, sizeof(ShaderVariants));
+
+    variants->label = shader_copyString(label);
+    variants->files[0] = shader_copyString(vert);
+    variants->files[1] = shader_copyString(tesc);
+    variants->files[2] = shader_copyString(tese);
+    variants->files[3] = shader_copyString(frag);
+    variants->defines = shader_copyString(defines);
+
+    if (featureCount > SHADER_VARIANT_MAX_FEATURES)
+    {
+        fprintf(stderr, "Error: Shader variants \"%s\" use %d features, only %d supported.\n",
+                label, featureCount, SHADER_VARIANT_MAX_FEATURES);
+        featureCount = SHADER_VARIANT_MAX_FEATURES;
+    }
+
+    variants->featureCount = featureCount;
+    variants->features = malloc(sizeof(char*) * (size_t)featureCount);
+    for (int i = 0; i < featureCount; i++)
+    {
+        variants->features[i] = shader_copyString(features[i]);
+    }
+
+    size_t tableSize = (size_t)1 << featureCount;
+    variants->shaders = calloc(tableSize, sizeof(Shader*));
+    variants->built = calloc(tableSize, sizeof(bool));
+
+    return variants;
+}
+
+Shader* shader_getVariant(ShaderVariants* variants, unsigned int featureMask)
+{
+    // Bits ohne Feature ändern nichts am Shader.
+    featureMask &= (1u << variants->featureCount) - 1u;
+
+    // Bereits übersetzte oder fehlgeschlagene Varianten direkt liefern.
+    if (!variants->built[featureMask])
+    {
+        variants->shaders[featureMask] = shader_buildVariant(variants, featureMask);
+        variants->built[featureMask] = true;
+        variants->builtCount++;
+    }
+
+    return variants->shaders[featureMask];
+}
+
+int shader_reloadVariants(ShaderVariants* variants, const char* file)
+{
+    bool uses = file == NULL;
+    for (int i = 0; i < SHADER_VARIANT_STAGES && !uses; i++)
+    {
+        uses = variants->files[i] != NULL && strcmp(variants->files[i], file) == 0;
+    }
+    if (!uses)
+    {
+        return 0;
+    }
+
+    int requested = 0;
+    size_t tableSize = (size_t)1 << variants->featureCount;
+    for (size_t i = 0; i < tableSize; i++)
+    {
+        if (variants->shaders[i] != NULL)
+        {
+            requested += shader_requestReload(variants->shaders[i]) ? 1 : 0;
+        }
+        else if (variants->built[i])
+        {
+            // Fehlgeschlagene Varianten bei der nächsten Anfrage neu bauen.
+            variants->built[i] = false;
+            variants->builtCount--;
+        }
+    }
+
+    return requested;
+}
+
+void shader_updateVariants(ShaderVariants* variants)
+{
+    size_t tableSize = (size_t)1 << variants->featureCount;
+    for (size_t i = 0; i < tableSize; i++)
+    {
+        Shader* shader = variants->shaders[i];
+        if (shader != NULL && shader_updateReload(shader) == SHADER_RELOAD_DONE)
+        {
+            char label[256];
+            snprintf(label, sizeof(label), "%s (0x%x)", variants->label, (unsigned int)i);
+            common_labelObjectByType(GL_PROGRAM, shader->id, label);
+        }
+    }
+}
+
+int shader_getVariantCount(ShaderVariants* variants)
+{
+    return variants->builtCount;
+}
+
+void shader_deleteVariants(ShaderVariants* variants)
+{
+    if (!variants)
+    {
+        return;
+    }
+
+    size_t tableSize = (size_t)1 << variants->featureCount;
+    for (size_t i = 0; i < tableSize; i++)
+    {
+        shader_deleteShader(variants->shaders[i]);
+    }
+    free(variants->shaders);
+    free(variants->built);
+
+    for (int i = 0; i < variants->featureCount; i++)
+    {
+        free(variants->features[i]);
+    }
+    free(variants->features);
 
+    for (int i = 0; i < SHADER_VARIANT_STAGES; i++)
+    {
+        free(variants->files[i]);
+    }
+    free(variants->defines);
+    free(variants->label);
+    free(variants);
+}
@@ -16,6 +16,36 @@
 struct Shader;
 typedef struct Shader Shader;
 
+// Datenstruktur für alle Varianten (Permutationen) eines Shaders. Eine
+// Variante entsteht aus denselben Dateien, denen für jedes gesetzte Bit
+// einer Feature-Maske ein #define vorangestellt wird. Varianten werden erst
+// bei der ersten Anfrage übersetzt und danach wiederverwendet.
+struct ShaderVariants;
+typedef struct ShaderVariants ShaderVariants;
+
+// Datenstruktur für einen Durchgang, in dem mehrere Shader gemeinsam gebaut
+// werden. Alle Programme werden zuerst abgeschickt und erst danach wird ihr
+// Status abgefragt, so kann der Treiber sie parallel übersetzen.
+struct ShaderBatch;
+typedef struct ShaderBatch ShaderBatch;
+
+// Zustand beim Neuladen eines Shaders im Hintergrund.
+typedef enum {
+    SHADER_RELOAD_NONE,     // es wird nichts neu geladen
+    SHADER_RELOAD_PENDING,  // der Treiber übersetzt noch
+    SHADER_RELOAD_DONE,     // das neue Programm wurde übernommen
+    SHADER_RELOAD_FAILED    // Fehler, das alte Programm bleibt aktiv
+} ShaderReloadState;
+
+// Übergibt die Uniforms an einen Shader, der gerade aktiviert wurde.
+typedef void (*ShaderSetupFunc)(Shader* shader, void* userData);
+
+// Kennung eines Uniforms über alle Shader hinweg (siehe shader_getUniform).
+// Jeder Shader löst die Kennungen beim Bauen in seine Locations auf, danach
+// kostet das Setzen nur noch einen Zugriff auf ein Array statt einer Suche
+// nach dem Namen.
+typedef int ShaderUniform;
+
 //////////////////////////// ÖFFENTLICHE FUNKTIONEN ////////////////////////////
 
 /**
@@ -27,8 +57,8 @@ Shader* shader_createShader();
 
 /**
  * Hängt eine GLSL Datei an einen bestehenden Shader an.
- * Der Code wird dabei auch sofort übersetzt und nur bei erfolg an den
- * Shader gehängt.
+ * Der Code wird erst von shader_buildShader übersetzt, damit das Übersetzen
+ * bei einem Treffer im Cache ganz entfallen kann.
  * 
  * Bei Misserfolg gibt die Funktion eine Fehlermeldung aus.
  * 
@@ -39,17 +69,156 @@ Shader* shader_createShader();
  */
 bool shader_attachShaderFile(Shader* shader, GLenum type, const char* file);
 
+/**
+ * Hängt Quellcode aus dem Speicher an einen bestehenden Shader an, z.B. einen
+ * zur Laufzeit erzeugten Shader. Ansonsten wie shader_attachShaderFile.
+ * 
+ * @param shader der Shader an den der Quellcode angehängt werden soll.
+ * @param type der Shadertyp des Quellcodes.
+ * @param source der Quellcode.
+ * @param label Bezeichnung für Fehlermeldungen und RenderDoc.
+ * @return true, wenn die operation erfolgreich war, false wenn nicht.
+ */
+bool shader_attachShaderSource(Shader* shader, GLenum type, const char* source,
+                               const char* label);
+
+/**
+ * Hängt eine GLSL Datei mit zusätzlichen Präprozessor-Definitionen an einen
+ * bestehenden Shader an. Die Definitionen werden direkt hinter der
+ * #version Zeile eingefügt, die Zeilennummern in Fehlermeldungen beziehen
+ * sich weiterhin auf die Datei. Ansonsten wie shader_attachShaderFile.
+ * 
+ * @param shader der Shader an den die Datei angehängt werden soll.
+ * @param type der Shadertyp der Datei.
+ * @param file der Pfad zur Datei.
+ * @param defines die Definitionen, z.B. "#define FOO\n", oder NULL.
+ * @return true, wenn die operation erfolgreich war, false wenn nicht.
+ */
+bool shader_attachShaderFileDefines(Shader* shader, GLenum type,
+                                    const char* file, const char* defines);
+
 /**
  * Baut einen Shader zusammen (linken) nachdem mehrere Dateien an ihn
  * gehängt wurden.
  * 
- * Bei Misserfolg gibt die Funktion eine Fehlermeldung aus.
+ * Gelinkte Programme werden mit glGetProgramBinary im Verzeichnis
+ * SHADER_CACHE_PATH abgelegt. Der Schlüssel ist ein Hash über alle
+ * Quellcodes sowie Hersteller, Renderer und Version des Treibers, so dass
+ * geänderte Dateien oder ein neuer Treiber automatisch neu übersetzt werden.
+ * Lehnt der Treiber einen Eintrag ab, wird er verworfen und neu übersetzt.
+ * 
+ * Bei Misserfolg gibt die Funktion eine Fehlermeldung aus, auch für Fehler
+ * beim Übersetzen der einzelnen Dateien.
  * 
  * @param shader der Shader, der gebaut werden soll.
  * @return true, wenn die operation erfolgreich war, false wenn nicht.
  */
 bool shader_buildShader(Shader* shader);
 
+/**
+ * Legt einen neuen, leeren Durchgang an.
+ * 
+ * @return der neue Durchgang
+ */
+ShaderBatch* shader_createBatch(void);
+
+/**
+ * Fügt einen Shader, an den bereits alle Dateien gehängt wurden, zu einem
+ * Durchgang hinzu. Der Durchgang übernimmt den Shader.
+ * 
+ * @param batch der Durchgang
+ * @param shader der noch nicht gebaute Shader
+ * @param label das Label des Programms
+ * @param result erhält beim Bauen den Shader oder NULL bei Fehlern
+ */
+void shader_addToBatch(ShaderBatch* batch, Shader* shader, const char* label,
+                       Shader** result);
+
+/**
+ * Baut alle Shader eines Durchgangs. Zuerst werden alle Bestandteile
+ * übersetzt und gelinkt bzw. aus dem Cache übergeben, ohne auf den Treiber
+ * zu warten. Erst danach werden Fehler abgefragt und ausgegeben. Mit
+ * GL_KHR_parallel_shader_compile übersetzt der Treiber dabei auf mehreren
+ * Threads.
+ * 
+ * Der Durchgang bleibt danach bestehen, damit seine Shader mit
+ * shader_reloadBatch neu geladen werden können. Das gilt auch für
+ * fehlgeschlagene Shader, die dann nachträglich eingetragen werden.
+ * 
+ * @param batch der Durchgang
+ * @return die Anzahl der Shader, die nicht gebaut werden konnten
+ */
+int shader_buildBatch(ShaderBatch* batch);
+
+/**
+ * Lädt alle Shader eines gebauten Durchgangs neu, die eine Datei nutzen
+ * (siehe shader_requestReload).
+ * 
+ * @param batch der Durchgang
+ * @param file der Pfad der geänderten Datei oder NULL für alle Shader
+ * @return die Anzahl der Shader, die neu übersetzt werden
+ */
+int shader_reloadBatch(ShaderBatch* batch, const char* file);
+
+/**
+ * Übernimmt fertig übersetzte Shader eines Durchgangs (siehe
+ * shader_updateReload). Zuvor fehlgeschlagene Shader werden dabei in ihr
+ * Ziel eingetragen. Sollte einmal pro Frame aufgerufen werden.
+ * 
+ * @param batch der Durchgang
+ * @return die Anzahl der übernommenen Programme
+ */
+int shader_updateBatch(ShaderBatch* batch);
+
+/**
+ * Löscht einen Durchgang samt der Shader, die nicht gebaut werden konnten.
+ * Gebaute Shader gehören dem Aufrufer und bleiben erhalten.
+ * 
+ * @param batch der Durchgang
+ */
+void shader_deleteBatch(ShaderBatch* batch);
+
+/**
+ * Prüft, ob ein Shader aus einer Datei gebaut wurde.
+ * 
+ * @param shader der Shader
+ * @param file der Pfad der Datei, so wie er beim Anhängen übergeben wurde
+ * @return true, wenn der Shader die Datei nutzt
+ */
+bool shader_usesFile(Shader* shader, const char* file);
+
+/**
+ * Übersetzt einen Shader im Hintergrund neu aus seinen Dateien. Das alte
+ * Programm bleibt aktiv, bis shader_updateReload das neue übernimmt. Ein
+ * noch laufendes Neuladen wird verworfen. Shader mit Quellcode aus dem
+ * Speicher können nicht neu geladen werden.
+ * 
+ * @param shader der Shader
+ * @return true, wenn das Neuladen gestartet wurde
+ */
+bool shader_requestReload(Shader* shader);
+
+/**
+ * Prüft, ob das Neuladen eines Shaders abgeschlossen ist, und übernimmt bei
+ * Erfolg das neue Programm. Die Uniforms müssen danach neu gesetzt werden.
+ * Ohne GL_KHR_parallel_shader_compile wartet der Aufruf auf den Treiber.
+ * 
+ * @param shader der Shader
+ * @return der Zustand des Neuladens
+ */
+ShaderReloadState shader_updateReload(Shader* shader);
+
+/**
+ * Meldet einen Uniform Block an, der in allen Shadern an denselben Binding
+ * Point gebunden wird. GLSL 4.10 kennt kein layout(binding), daher wird die
+ * Zuordnung nach jedem erfolgreichen Linken gesetzt, auch beim Neuladen.
+ * Nur Shader, die danach gebaut werden, sind betroffen.
+ * 
+ * @param name der Name des Blocks im GLSL Code, muss gültig bleiben
+ * @param binding der Binding Point (GL_UNIFORM_BUFFER)
+ */
+void shader_registerUniformBlock(const char* name, GLuint binding);
+
 /**
  * Aktiviert einen Shader für die Benutzung.
  * Der Shader muss bereits gebaut worden sein.
@@ -78,6 +247,21 @@ void shader_deleteShader(Shader* shader);
  */
 Shader* shader_createVeFrShader(const char* label, const char* vert, const char* frag);
 
+/**
+ * Hilfsfunktion zum Anlegen eines Shaders, der aus einem Vertex- und
+ * einem Fragmentshader besteht. Beiden werden dieselben
+ * Präprozessor-Definitionen vorangestellt (siehe
+ * shader_attachShaderFileDefines), so lassen sich mehrere Varianten aus
+ * denselben Dateien bauen.
+ * 
+ * Bei Misserfolg gibt die Funktion eine Fehlermeldung aus.
+ * 
+ * @return ein Shader, der aus den übergebenen Dateien gebaut wurde oder NULL
+ *         wenn etwas schief gegangen ist.
+ */
+Shader* shader_createVeFrShaderDefines(const char* label, const char* vert,
+                                       const char* frag, const char* defines);
+
 /**
  * Hilfsfunktion zum Anlegen eines Shaders, der aus einem Vertex- ,
  * Tessellation- und einem Fragmentshader besteht.
@@ -91,6 +275,75 @@ Shader* shader_createVeTessFrShader(const char* label,
     const char* vert, const char* tesc,
     const char* tese, const char* frag);
 
+/**
+ * Hilfsfunktion zum Anlegen eines Shaders, der aus einem Vertex-,
+ * Geometry- und einem Fragmentshader besteht.
+ *
+ * Bei Misserfolg gibt die Funktion eine Fehlermeldung aus.
+ *
+ * @return ein Shader, der aus den übergebenen Dateien gebaut wurde oder NULL
+ *         wenn etwas schief gegangen ist.
+ */
+Shader* shader_createVeGeFrShader(const char* label, const char* vert,
+    const char* geom, const char* frag);
+
+/**
+ * Fügt einen Shader aus einem Vertex- und einem Fragmentshader zu einem
+ * Durchgang hinzu (siehe shader_createVeFrShader).
+ * 
+ * @param batch der Durchgang
+ * @param result erhält beim Bauen den Shader oder NULL bei Fehlern
+ */
+void shader_batchVeFrShader(ShaderBatch* batch, Shader** result,
+                            const char* label, const char* vert,
+                            const char* frag);
+
+/**
+ * Fügt einen Shader aus einem Vertex- und einem Fragmentshader mit
+ * Präprozessor-Definitionen zu einem Durchgang hinzu (siehe
+ * shader_createVeFrShaderDefines).
+ * 
+ * @param batch der Durchgang
+ * @param result erhält beim Bauen den Shader oder NULL bei Fehlern
+ */
+void shader_batchVeFrShaderDefines(ShaderBatch* batch, Shader** result,
+                                   const char* label, const char* vert,
+                                   const char* frag, const char* defines);
+
+/**
+ * Fügt einen Shader mit Tessellation zu einem Durchgang hinzu (siehe
+ * shader_createVeTessFrShader).
+ * 
+ * @param batch der Durchgang
+ * @param result erhält beim Bauen den Shader oder NULL bei Fehlern
+ */
+void shader_batchVeTessFrShader(ShaderBatch* batch, Shader** result,
+                                const char* label, const char* vert,
+                                const char* tesc, const char* tese,
+                                const char* frag);
+
+/**
+ * Fügt einen Shader mit Geometry Shader zu einem Durchgang hinzu (siehe
+ * shader_createVeGeFrShader).
+ * 
+ * @param batch der Durchgang
+ * @param result erhält beim Bauen den Shader oder NULL bei Fehlern
+ */
+void shader_batchVeGeFrShader(ShaderBatch* batch, Shader** result,
+                              const char* label, const char* vert,
+                              const char* geom, const char* frag);
+
+/**
+ * Liefert die Kennung eines Uniforms. Derselbe Name ergibt immer dieselbe
+ * Kennung, sie gilt für alle Shader und übersteht das Neuladen. Die Kennung
+ * sollte einmalig abgefragt und vom Aufrufer gespeichert werden, z.B. in
+ * einem statischen Struct.
+ * 
+ * @param name der Name der Uniform Variable, z.B. "u_material.diffuse"
+ * @return die Kennung
+ */
+ShaderUniform shader_getUniform(const char* name);
+
 /**
  * Übergibt eine 4x4 Matrix an einen Shader über eine Uniform-Variable.
  * Der Shader muss zuvor mit shader_useShader aktiviert worden sein!
@@ -101,6 +354,18 @@ Shader* shader_createVeTessFrShader(const char* label,
  */
 void shader_setMat4(Shader* shader, char* name, mat4* mat);
 
+/**
+ * Übergibt ein Array aus 4x4 Matrizen an einen Shader über eine
+ * Uniform-Variable.
+ * Der Shader muss zuvor mit shader_useShader aktiviert worden sein!
+ * 
+ * @param shader der Shader, bei dem die Uniform Variable gesetzt werden soll
+ * @param name der Name des Uniform Arrays
+ * @param mats die 4x4 Matrizen
+ * @param count die Anzahl der Matrizen
+ */
+void shader_setMat4Array(Shader* shader, char* name, mat4* mats, int count);
+
 /**
  * Übergibt einen 2D Vektor an einen Shader über eine Uniform-Variable.
  * Der Shader muss zuvor mit shader_useShader aktiviert worden sein!
@@ -121,6 +386,16 @@ void shader_setVec2(Shader* shader, char* name, vec2* vec2);
  */
 void shader_setVec3(Shader* shader, char* name, vec3* vec3);
 
+/**
+ * Übergibt einen 4D Vektor an einen Shader über eine Uniform-Variable.
+ * Der Shader muss zuvor mit shader_useShader aktiviert worden sein!
+ * 
+ * @param shader der Shader, bei dem die Uniform Variable gesetzt werden soll
+ * @param name der Name der Uniform Variable
+ * @param vec4 der 4D Vektor
+ */
+void shader_setVec4(Shader* shader, char* name, vec4* vec4);
+
 /**
  * Übergibt einen Integer an einen Shader über eine Uniform-Variable.
  * Der Shader muss zuvor mit shader_useShader aktiviert worden sein!
@@ -141,6 +416,17 @@ void shader_setInt(Shader* shader, char* name, int val);
  */
 void shader_setFloat(Shader* shader, char* name, float val);
 
+/**
+ * Übergibt ein Array aus Floats an einen Shader über eine Uniform-Variable.
+ * Der Shader muss zuvor mit shader_useShader aktiviert worden sein!
+ * 
+ * @param shader der Shader, bei dem die Uniform Variable gesetzt werden soll
+ * @param name der Name des Uniform Arrays
+ * @param vals die Werte
+ * @param count die Anzahl der Werte
+ */
+void shader_setFloatArray(Shader* shader, char* name, float* vals, int count);
+
 /**
  * Übergibt einen Boolean an einen Shader über eine Uniform-Variable.
  * Der Shader muss zuvor mit shader_useShader aktiviert worden sein!
@@ -151,4 +437,87 @@ void shader_setFloat(Shader* shader, char* name, float val);
  */
 void shader_setBool(Shader* shader, char* name, bool val);
 
+/**
+ * Die folgenden Funktionen entsprechen den Funktionen oben, erhalten aber
+ * statt des Namens die Kennung aus shader_getUniform. Sie sind für Uniforms
+ * gedacht, die für jedes Objekt oder jedes Licht gesetzt werden.
+ * Der Shader muss zuvor mit shader_useShader aktiviert worden sein!
+ */
+void shader_setMat4ByHandle(Shader* shader, ShaderUniform uniform, mat4* mat);
+void shader_setMat4ArrayByHandle(Shader* shader, ShaderUniform uniform,
+                                 mat4* mats, int count);
+void shader_setVec2ByHandle(Shader* shader, ShaderUniform uniform, vec2* vec2);
+void shader_setVec3ByHandle(Shader* shader, ShaderUniform uniform, vec3* vec3);
+void shader_setVec4ByHandle(Shader* shader, ShaderUniform uniform, vec4* vec4);
+void shader_setIntByHandle(Shader* shader, ShaderUniform uniform, int val);
+void shader_setFloatByHandle(Shader* shader, ShaderUniform uniform, float val);
+void shader_setFloatArrayByHandle(Shader* shader, ShaderUniform uniform,
+                                  float* vals, int count);
+void shader_setBoolByHandle(Shader* shader, ShaderUniform uniform, bool val);
+
+/**
+ * Legt die Verwaltung der Varianten eines Shaders an. Dabei wird noch keine
+ * Variante übersetzt. Nicht benötigte Stufen werden als NULL übergeben.
+ * 
+ * @param label ein Name für die Varianten
+ * @param vert der Pfad zum Vertex-Shader
+ * @param tesc der Pfad zum Tessellation Control Shader oder NULL
+ * @param tese der Pfad zum Tessellation Evaluation Shader oder NULL
+ * @param frag der Pfad zum Fragment-Shader
+ * @param defines Definitionen, die allen Varianten vorangestellt werden,
+ *        oder NULL
+ * @param features die Namen der Definitionen für die Bits der Maske
+ * @param featureCount die Anzahl der Features
+ * @return die neuen Varianten
+ */
+ShaderVariants* shader_createVariants(const char* label, const char* vert,
+                                      const char* tesc, const char* tese,
+                                      const char* frag, const char* defines,
+                                      const char* const* features,
+                                      int featureCount);
+
+/**
+ * Liefert die Variante für eine Feature-Maske und übersetzt sie, falls sie
+ * noch nicht existiert. Auch fehlgeschlagene Varianten werden gemerkt, damit
+ * sie nicht in jedem Frame neu übersetzt werden.
+ * 
+ * @param variants die Varianten
+ * @param featureMask die gesetzten Features
+ * @return die Variante oder NULL, wenn sie nicht gebaut werden konnte
+ */
+Shader* shader_getVariant(ShaderVariants* variants, unsigned int featureMask);
+
+/**
+ * Lädt alle übersetzten Varianten neu, wenn sie eine Datei nutzen (siehe
+ * shader_requestReload). Fehlgeschlagene Varianten werden bei der nächsten
+ * Anfrage neu gebaut.
+ * 
+ * @param variants die Varianten
+ * @param file der Pfad der geänderten Datei oder NULL für alle Varianten
+ * @return die Anzahl der Varianten, die neu übersetzt werden
+ */
+int shader_reloadVariants(ShaderVariants* variants, const char* file);
+
+/**
+ * Übernimmt fertig übersetzte Varianten (siehe shader_updateReload).
+ * 
+ * @param variants die Varianten
+ */
+void shader_updateVariants(ShaderVariants* variants);
+
+/**
+ * Liefert die Anzahl der bisher übersetzten Varianten.
+ * 
+ * @param variants die Varianten
+ * @return die Anzahl der Varianten
+ */
+int shader_getVariantCount(ShaderVariants* variants);
+
+/**
+ * Löscht alle Varianten eines Shaders.
+ * 
+ * @param variants die zu löschenden Varianten
+ */
+void shader_deleteVariants(ShaderVariants* variants);
+
 #endif // SHADER_H
@@ -0,0 +1,432 @@
+/**
+ * Modul für die Schatten des Richtungslichts (Cascaded Shadow Maps) und der
+ * Punktlichter (Cube Map Array).
+ *
+ * Copyright (C) 2023, FH Wedel
+ * Autor: Joshua-Scott Schöttke, Ilana Schmara
+ */
+
+#include "shadow.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "glstate.h"
+
+////////////////////////////// LOKALE DATENTYPEN ///////////////////////////////
+
+// Datenstruktur mit den Kaskaden und ihren Projektionen.
+struct CascadedShadow
+{
+    GLuint fbo;
+    GLuint depthArray;
+
+    int cascadeCount;
+
+    // Light-Space Matrix und Ende (Distanz im View-Space) jeder Kaskade.
+    mat4 matrices[SHADOW_MAX_CASCADES];
+    vec4 splits;
+
+    // Matrix, mit der jede Kaskade zuletzt gerendert wurde.
+    mat4 renderedMatrices[SHADOW_MAX_CASCADES];
+    bool cascadeValid[SHADOW_MAX_CASCADES];
+};
+
+// Datenstruktur mit den Cube Maps der Punktlichter.
+struct PointShadows
+{
+    GLuint fbo;
+    GLuint cubeArray;
+
+    // Position und Reichweite der Lichter in den vergebenen Slots.
+    int slotCount;
+    vec3 positions[SHADOW_MAX_POINT_LIGHTS];
+    float farPlanes[SHADOW_MAX_POINT_LIGHTS];
+
+    bool valid;
+};
+
+////////////////////////////// LOKALE FUNKTIONEN ///////////////////////////////
+
+/**
+ * Berechnet die Light-Space Matrix einer Kaskade.
+ *
+ * Der Abschnitt des Frustums wird von der kleinsten Kugel umschlossen, deren
+ * Mittelpunkt auf der Blickachse liegt. Ihr Radius hängt nur von den Grenzen
+ * des Abschnitts ab, nicht von der Ausrichtung der Kamera. Zusammen mit dem
+ * Einrasten auf ganze Texel bleibt die Projektion dadurch beim Drehen und
+ * Bewegen der Kamera stabil.
+ *
+ * @param inverseView die inverse View Matrix der Kamera
+ * @param lightView die View Matrix des Lichts (nur Rotation)
+ * @param tanSquared Summe der quadrierten Tangenten der halben Öffnungswinkel
+ * @param splitNear der Beginn des Abschnitts im View-Space
+ * @param splitFar das Ende des Abschnitts im View-Space
+ * @param dest Rückgabe der Light-Space Matrix
+ */
+static void shadow_fitCascade(mat4 inverseView, mat4 lightView, float tanSquared,
+                              float splitNear, float splitFar, mat4 dest)
+{
+    // Optimaler Mittelpunkt der Kugel entlang der Blickachse.
+    float centerDepth = fminf(splitFar,
+        0.5f * (splitNear + splitFar) * (1.0f + tanSquared));
+    float radiusNear = sqrtf((centerDepth - splitNear) * (centerDepth - splitNear)
+                           + splitNear * splitNear * tanSquared);
+    float radiusFar = sqrtf((splitFar - centerDepth) * (splitFar - centerDepth)
+                          + splitFar * splitFar * tanSquared);
+    float radius = fmaxf(radiusNear, radiusFar);
+
+    vec3 viewCenter = { 0.0f, 0.0f, -centerDepth };
+    vec3 worldCenter;
+    vec3 lightCenter;
+    glm_mat4_mulv3(inverseView, viewCenter, 1.0f, worldCenter);
+    glm_mat4_mulv3(lightView, worldCenter, 1.0f, lightCenter);
+
+    // Die Kugel auf ganze Texel einrasten. Die Tiefe wird ebenso gerastert,
+    // damit die Matrix bei kleinen Bewegungen unverändert bleibt.
+    float texelSize = 2.0f * radius / (float)SHADOW_CASCADE_SIZE;
+    float left = floorf((lightCenter[0] - radius) / texelSize) * texelSize;
+    float bottom = floorf((lightCenter[1] - radius) / texelSize) * texelSize;
+    float front = floorf((-lightCenter[2] - radius) / texelSize) * texelSize;
+
+    // Objekte zwischen Licht und Kugel werfen trotzdem Schatten, da sie
+    // beim Rendern per GL_DEPTH_CLAMP auf die Near-Plane gedrückt werden.
+    mat4 lightProjection;
+    glm_ortho(left, left + 2.0f * radius, bottom, bottom + 2.0f * radius,
+              front, front + 2.0f * radius + texelSize, lightProjection);
+
+    glm_mat4_mul(lightProjection, lightView, dest);
+}
+
+/**
+ * Berechnet die View-Projection Matrizen der sechs Seiten einer Cube Map in
+ * der Reihenfolge +X, -X, +Y, -Y, +Z, -Z, die auch für gl_Layer gilt.
+ *
+ * @param position die Position des Lichts
+ * @param farPlane die Reichweite des Lichts
+ * @param dest Rückgabe der sechs Matrizen
+ */
+static void shadow_calcFaceMatrices(vec3 position, float farPlane, mat4 dest[6])
+{
+    static const float directions[6][3] = {
+        {  1.0f,  0.0f,  0.0f }, { -1.0f,  0.0f,  0.0f },
+        {  0.0f,  1.0f,  0.0f }, {  0.0f, -1.0f,  0.0f },
+        {  0.0f,  0.0f,  1.0f }, {  0.0f,  0.0f, -1.0f }
+    };
+    static const float ups[6][3] = {
+        {  0.0f, -1.0f,  0.0f }, {  0.0f, -1.0f,  0.0f },
+        {  0.0f,  0.0f,  1.0f }, {  0.0f,  0.0f, -1.0f },
+        {  0.0f, -1.0f,  0.0f }, {  0.0f, -1.0f,  0.0f }
+    };
+
+    mat4 projection;
+    glm_perspective(glm_rad(90.0f), 1.0f, SHADOW_POINT_NEAR, farPlane, projection);
+
+    for (int i = 0; i < 6; i++)
+    {
+        vec3 direction = { directions[i][0], directions[i][1], directions[i][2] };
+        vec3 up = { ups[i][0], ups[i][1], ups[i][2] };
+
+        mat4 view;
+        glm_look(position, direction, up, view);
+        glm_mat4_mul(projection, view, dest[i]);
+    }
+}
+
+//////////////////////////// ÖFFENTLICHE FUNKTIONEN ////////////////////////////
+
+CascadedShadow* shadow_createCascadedShadow(void)
+{
+    CascadedShadow* shadow = malloc(sizeof(CascadedShadow));
+    memset(shadow, 0, sizeof(CascadedShadow));
+
+    glGenTextures(1, &shadow->depthArray);
+    glstate_bindTexture(GL_TEXTURE_2D_ARRAY, shadow->depthArray);
+    glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_DEPTH_COMPONENT32F,
+                 SHADOW_CASCADE_SIZE, SHADOW_CASCADE_SIZE, SHADOW_MAX_CASCADES,
+                 0, GL_DEPTH_COMPONENT, GL_FLOAT, NULL);
+    // Mit Tiefenvergleich und linearem Filter liefert jeder Zugriff im
+    // Shader bereits vier gewichtete Vergleiche (Hardware PCF).
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_COMPARE_MODE,
+                    GL_COMPARE_REF_TO_TEXTURE);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_COMPARE_FUNC, GL_LEQUAL);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_BORDER);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_BORDER);
+    float borderColor[] = { 1.0f, 1.0f, 1.0f, 1.0f };
+    glTexParameterfv(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_BORDER_COLOR, borderColor);
+    common_labelObjectByType(GL_TEXTURE, shadow->depthArray, "Shadow Cascades");
+
+    // Die Schichten werden erst beim Rendern der Kaskaden angehängt.
+    glGenFramebuffers(1, &shadow->fbo);
+    glstate_bindFramebuffer(GL_FRAMEBUFFER, shadow->fbo);
+    glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT,
+                              shadow->depthArray, 0, 0);
+    glDrawBuffer(GL_NONE);
+    glReadBuffer(GL_NONE);
+
+    GLenum fboState = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+    if (fboState != GL_FRAMEBUFFER_COMPLETE)
+    {
+        fprintf(stderr, "Error: FBO \"Shadow Cascades\" not complete (0x%x).\n",
+                fboState);
+    }
+    common_labelObjectByType(GL_FRAMEBUFFER, shadow->fbo, "Shadow Cascades");
+
+    glstate_bindFramebuffer(GL_FRAMEBUFFER, 0);
+    return shadow;
+}
+
+void shadow_updateCascades(CascadedShadow* shadow, int cascadeCount,
+                           float splitLambda, mat4 viewMatrix,
+                           mat4 projectionMatrix, float nearPlane,
+                           float shadowDistance, vec3 lightDir)
+{
+    if (cascadeCount < 1)
+    {
+        cascadeCount = 1;
+    }
+    if (cascadeCount > SHADOW_MAX_CASCADES)
+    {
+        cascadeCount = SHADOW_MAX_CASCADES;
+    }
+    shadow->cascadeCount = cascadeCount;
+
+    // Öffnungswinkel direkt aus der Projektion ablesen.
+    float tanX = 1.0f / projectionMatrix[0][0];
+    float tanY = 1.0f / projectionMatrix[1][1];
+    float tanSquared = tanX * tanX + tanY * tanY;
+
+    mat4 inverseView;
+    glm_mat4_inv(viewMatrix, inverseView);
+
+    // Das Licht schaut aus seiner Richtung auf den Ursprung. Die Position
+    // ergibt sich erst aus der Projektion der jeweiligen Kaskade.
+    vec3 eye;
+    glm_vec3_normalize_to(lightDir, eye);
+    vec3 center = { 0.0f, 0.0f, 0.0f };
+    vec3 up = { 0.0f, 1.0f, 0.0f };
+    if (fabsf(glm_vec3_dot(eye, up)) > 0.99f)
+    {
+        up[0] = 1.0f;
+        up[1] = 0.0f;
+    }
+    mat4 lightView;
+    glm_lookat(eye, center, up, lightView);
+
+    float splitNear = nearPlane;
+    for (int i = 0; i < cascadeCount; i++)
+    {
+        float p = (float)(i + 1) / (float)cascadeCount;
+        float logSplit = nearPlane * powf(shadowDistance / nearPlane, p);
+        float uniformSplit = nearPlane + (shadowDistance - nearPlane) * p;
+        float splitFar = splitLambda * logSplit + (1.0f - splitLambda) * uniformSplit;
+
+        shadow_fitCascade(inverseView, lightView, tanSquared, splitNear, splitFar,
+                          shadow->matrices[i]);
+        shadow->splits[i] = splitFar;
+        splitNear = splitFar;
+    }
+}
+
+int shadow_getCascadeCount(CascadedShadow* shadow)
+{
+    return shadow->cascadeCount;
+}
+
+void shadow_invalidate(CascadedShadow* shadow)
+{
+    for (int i = 0; i < SHADOW_MAX_CASCADES; i++)
+    {
+        shadow->cascadeValid[i] = false;
+    }
+}
+
+bool shadow_isCascadeDirty(CascadedShadow* shadow, int cascade)
+{
+    // Die Matrizen werden jedes Frame deterministisch berechnet, bei
+    // gleichen Eingaben sind sie also bitweise identisch.
+    return !shadow->cascadeValid[cascade]
+        || memcmp(shadow->matrices[cascade], shadow->renderedMatrices[cascade],
+                  sizeof(mat4)) != 0;
+}
+
+void shadow_bindForCascade(CascadedShadow* shadow, int cascade, Shader* shader)
+{
+    glstate_bindFramebuffer(GL_FRAMEBUFFER, shadow->fbo);
+    glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT,
+                              shadow->depthArray, 0, cascade);
+    glViewport(0, 0, SHADOW_CASCADE_SIZE, SHADOW_CASCADE_SIZE);
+    glClear(GL_DEPTH_BUFFER_BIT);
+
+    shader_setMat4(shader, "u_lightSpaceMatrix", &shadow->matrices[cascade]);
+
+    glm_mat4_copy(shadow->matrices[cascade], shadow->renderedMatrices[cascade]);
+    shadow->cascadeValid[cascade] = true;
+}
+
+void shadow_activateCascades(CascadedShadow* shadow, Shader* shader, int unit,
+                             bool enabled)
+{
+    glstate_activeTexture(GL_TEXTURE0 + unit);
+    glstate_bindTexture(GL_TEXTURE_2D_ARRAY, shadow->depthArray);
+
+    shader_setInt(shader, "u_shadowMap", unit);
+    shader_setInt(shader, "u_cascadeCount", enabled ? shadow->cascadeCount : 0);
+    shader_setVec4(shader, "u_cascadeSplits", &shadow->splits);
+    shader_setMat4Array(shader, "u_lightSpaceMatrices", shadow->matrices,
+                        SHADOW_MAX_CASCADES);
+}
+
+void shadow_deleteCascadedShadow(CascadedShadow* shadow)
+{
+    if (!shadow)
+    {
+        return;
+    }
+
+    glstate_deleteFramebuffers(1, &shadow->fbo);
+    glstate_deleteTextures(1, &shadow->depthArray);
+
+    free(shadow);
+}
+
+PointShadows* shadow_createPointShadows(void)
+{
+    PointShadows* shadows = malloc(sizeof(PointShadows));
+    memset(shadows, 0, sizeof(PointShadows));
+
+    // Der Vergleich mit der Referenztiefe erfolgt in der Hardware, durch den
+    // linearen Filter werden dabei gleich vier Texel gemittelt.
+    glGenTextures(1, &shadows->cubeArray);
+    glstate_bindTexture(GL_TEXTURE_CUBE_MAP_ARRAY, shadows->cubeArray);
+    glTexImage3D(GL_TEXTURE_CUBE_MAP_ARRAY, 0, GL_DEPTH_COMPONENT32F,
+                 SHADOW_POINT_SIZE, SHADOW_POINT_SIZE,
+                 SHADOW_MAX_POINT_LIGHTS * 6, 0, GL_DEPTH_COMPONENT, GL_FLOAT,
+                 NULL);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP_ARRAY, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP_ARRAY, GL_TEXTURE_COMPARE_MODE,
+                    GL_COMPARE_REF_TO_TEXTURE);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP_ARRAY, GL_TEXTURE_COMPARE_FUNC, GL_LEQUAL);
+    common_labelObjectByType(GL_TEXTURE, shadows->cubeArray, "Point Shadows");
+
+    // Das ganze Array wird angehängt, die Schicht wählt der Geometry Shader.
+    glGenFramebuffers(1, &shadows->fbo);
+    glstate_bindFramebuffer(GL_FRAMEBUFFER, shadows->fbo);
+    glFramebufferTexture(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT,
+                         shadows->cubeArray, 0);
+    glDrawBuffer(GL_NONE);
+    glReadBuffer(GL_NONE);
+
+    GLenum fboState = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+    if (fboState != GL_FRAMEBUFFER_COMPLETE)
+    {
+        fprintf(stderr, "Error: FBO \"Point Shadows\" not complete (0x%x).\n",
+                fboState);
+    }
+    common_labelObjectByType(GL_FRAMEBUFFER, shadows->fbo, "Point Shadows");
+
+    glstate_bindFramebuffer(GL_FRAMEBUFFER, 0);
+    return shadows;
+}
+
+int shadow_assignPointSlots(PointShadows* shadows, PointLight** lights,
+                            unsigned int count)
+{
+    int slotCount = 0;
+    for (unsigned int i = 0; i < count; i++)
+    {
+        PointLight* light = lights[i];
+        light->shadowSlot = -1;
+        if (!light->castShadow || slotCount == SHADOW_MAX_POINT_LIGHTS)
+        {
+            continue;
+        }
+
+        int slot = slotCount++;
+        float farPlane = fminf(light->radius, SHADOW_POINT_MAX_FAR);
+        light->shadowSlot = slot;
+
+        if (slot >= shadows->slotCount
+            || !glm_vec3_eqv(shadows->positions[slot], light->position)
+            || shadows->farPlanes[slot] != farPlane)
+        {
+            glm_vec3_copy(light->position, shadows->positions[slot]);
+            shadows->farPlanes[slot] = farPlane;
+            shadows->valid = false;
+        }
+    }
+
+    if (slotCount != shadows->slotCount)
+    {
+        shadows->slotCount = slotCount;
+        shadows->valid = false;
+    }
+
+    return slotCount;
+}
+
+void shadow_invalidatePointShadows(PointShadows* shadows)
+{
+    shadows->valid = false;
+}
+
+bool shadow_arePointShadowsDirty(PointShadows* shadows)
+{
+    return !shadows->valid && shadows->slotCount > 0;
+}
+
+void shadow_bindForPointShadows(PointShadows* shadows)
+{
+    // Bei einem geschichteten Framebuffer leert glClear alle Schichten.
+    glstate_bindFramebuffer(GL_FRAMEBUFFER, shadows->fbo);
+    glViewport(0, 0, SHADOW_POINT_SIZE, SHADOW_POINT_SIZE);
+    glClear(GL_DEPTH_BUFFER_BIT);
+
+    shadows->valid = true;
+}
+
+void shadow_setPointShadowSlot(PointShadows* shadows, int slot, Shader* shader)
+{
+    mat4 faceMatrices[6];
+    shadow_calcFaceMatrices(shadows->positions[slot], shadows->farPlanes[slot],
+                            faceMatrices);
+
+    shader_setMat4Array(shader, "u_faceMatrices", faceMatrices, 6);
+    shader_setInt(shader, "u_layerBase", slot * 6);
+    shader_setVec3(shader, "u_lightPos", &shadows->positions[slot]);
+    shader_setFloat(shader, "u_farPlane", shadows->farPlanes[slot]);
+}
+
+void shadow_activatePointShadows(PointShadows* shadows, Shader* shader, int unit,
+                                 bool enabled)
+{
+    glstate_activeTexture(GL_TEXTURE0 + unit);
+    glstate_bindTexture(GL_TEXTURE_CUBE_MAP_ARRAY, shadows->cubeArray);
+
+    shader_setFloatArray(shader, "u_pointShadowFar", shadows->farPlanes,
+                         SHADOW_MAX_POINT_LIGHTS);
+
+    shader_setInt(shader, "u_pointShadowMap", unit);
+    shader_setBool(shader, "u_pointShadowsEnabled",
+                   enabled && shadows->slotCount > 0);
+}
+
+void shadow_deletePointShadows(PointShadows* shadows)
+{
+    if (!shadows)
+    {
+        return;
+    }
+
+    glstate_deleteFramebuffers(1, &shadows->fbo);
+    glstate_deleteTextures(1, &shadows->cubeArray);
+
+    free(shadows);
+}
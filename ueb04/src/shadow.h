@@ -0,0 +1,249 @@
+/**
+ * Modul für die Schatten des Richtungslichts (Cascaded Shadow Maps) und der
+ * Punktlichter (Cube Map Array).
+ *
+ * Das View-Frustum der Kamera wird entlang der Blickrichtung in bis zu
+ * SHADOW_MAX_CASCADES Abschnitte (Kaskaden) geteilt. Jede Kaskade bekommt eine
+ * eigene orthographische Projektion, die genau ihren Abschnitt umschließt und
+ * in eine Schicht eines GL_TEXTURE_2D_ARRAY gerendert wird. Nahe Bereiche
+ * erhalten so deutlich mehr Auflösung als weit entfernte.
+ *
+ * Damit die Schatten beim Bewegen der Kamera nicht flimmern, umschließt jede
+ * Projektion eine Kugel mit fester Größe und wird in Schritten von ganzen
+ * Texeln verschoben.
+ *
+ * Jede Kaskade merkt sich, mit welcher Matrix sie zuletzt gerendert wurde.
+ * Ändert sich weder die Matrix noch die Szene, muss sie nicht neu gerendert
+ * werden. Durch das Einrasten auf Texel bleibt die Matrix auch bei kleinen
+ * Kamerabewegungen häufig gleich.
+ *
+ * Im Shader wird die Kaskade über die Tiefe im View-Space ausgewählt:
+ *
+ * uniform sampler2DArrayShadow u_shadowMap;
+ * uniform mat4 u_lightSpaceMatrices[SHADOW_MAX_CASCADES];
+ * uniform vec4 u_cascadeSplits;   // Ende jeder Kaskade im View-Space
+ * uniform int u_cascadeCount;     // 0 = keine Schatten
+ *
+ * Punktlichter, die in der Szene als Schattenwerfer markiert sind, erhalten
+ * einen von SHADOW_MAX_POINT_LIGHTS Slots. Jeder Slot ist eine Cube Map in
+ * einem GL_TEXTURE_CUBE_MAP_ARRAY (Schichten slot * 6 bis slot * 6 + 5). Die
+ * Szene wird pro Licht nur einmal gezeichnet, ein Geometry Shader verteilt
+ * jedes Dreieck über gl_Layer auf die sechs Seiten. Gespeichert wird der
+ * Abstand zum Licht geteilt durch die Reichweite des Slots. Im Shader wird
+ * mit Tiefenvergleich der Hardware gesampelt:
+ *
+ * uniform samplerCubeArrayShadow u_pointShadowMap;
+ * uniform float u_pointShadowFar[SHADOW_MAX_POINT_LIGHTS];
+ * uniform bool u_pointShadowsEnabled;
+ *
+ * Copyright (C) 2023, FH Wedel
+ * Autor: Joshua-Scott Schöttke, Ilana Schmara
+ */
+
+#ifndef SHADOW_H
+#define SHADOW_H
+
+#include "common.h"
+#include "light.h"
+#include "shader.h"
+
+////////////////////////////////// KONSTANTEN //////////////////////////////////
+
+// Maximale Anzahl der Kaskaden. Muss mit den Shadern übereinstimmen.
+#define SHADOW_MAX_CASCADES 4
+
+// Kantenlänge einer Kaskade in Texeln.
+#define SHADOW_CASCADE_SIZE 2048
+
+// Maximale Anzahl schattenwerfender Punktlichter. Muss mit den Shadern
+// übereinstimmen.
+#define SHADOW_MAX_POINT_LIGHTS 8
+
+// Kantenlänge einer Seite der Cube Maps in Texeln.
+#define SHADOW_POINT_SIZE 512
+
+// Near-Plane und größte Reichweite der Punktschatten.
+#define SHADOW_POINT_NEAR 0.05f
+#define SHADOW_POINT_MAX_FAR 200.0f
+
+//////////////////////////// ÖFFENTLICHE DATENTYPEN ////////////////////////////
+
+// Datenstruktur mit den Kaskaden und ihren Projektionen.
+struct CascadedShadow;
+typedef struct CascadedShadow CascadedShadow;
+
+// Datenstruktur mit den Cube Maps der Punktlichter.
+struct PointShadows;
+typedef struct PointShadows PointShadows;
+
+//////////////////////////// ÖFFENTLICHE FUNKTIONEN ////////////////////////////
+
+/**
+ * Erzeugt die Texturen und den Framebuffer für die Cascaded Shadow Maps.
+ *
+ * @return die neuen Schattendaten
+ */
+CascadedShadow* shadow_createCascadedShadow(void);
+
+/**
+ * Teilt das View-Frustum in Kaskaden und berechnet deren Projektionen.
+ *
+ * Die Grenzen der Kaskaden werden zwischen einer gleichmäßigen und einer
+ * logarithmischen Aufteilung gemischt. Ein splitLambda von 0 teilt
+ * gleichmäßig, 1 rein logarithmisch.
+ *
+ * @param shadow die Schattendaten
+ * @param cascadeCount die Anzahl der Kaskaden (1 bis SHADOW_MAX_CASCADES)
+ * @param splitLambda die Gewichtung der logarithmischen Aufteilung
+ * @param viewMatrix die View Matrix der Kamera
+ * @param projectionMatrix die (symmetrische) perspektivische Projektion
+ * @param nearPlane die Near-Plane der Kamera
+ * @param shadowDistance die Distanz, bis zu der Schatten berechnet werden
+ * @param lightDir die Richtung zum Licht
+ */
+void shadow_updateCascades(CascadedShadow* shadow, int cascadeCount,
+                           float splitLambda, mat4 viewMatrix,
+                           mat4 projectionMatrix, float nearPlane,
+                           float shadowDistance, vec3 lightDir);
+
+/**
+ * Liefert die Anzahl der aktuell verwendeten Kaskaden.
+ *
+ * @param shadow die Schattendaten
+ * @return die Anzahl der Kaskaden
+ */
+int shadow_getCascadeCount(CascadedShadow* shadow);
+
+/**
+ * Markiert alle Kaskaden als veraltet, z.B. weil sich die Szene geändert hat.
+ *
+ * @param shadow die Schattendaten
+ */
+void shadow_invalidate(CascadedShadow* shadow);
+
+/**
+ * Prüft, ob eine Kaskade neu gerendert werden muss. Das ist der Fall, wenn
+ * sie seit dem letzten shadow_invalidate nicht gerendert wurde oder sich ihre
+ * Light-Space Matrix seitdem geändert hat.
+ *
+ * @param shadow die Schattendaten
+ * @param cascade der Index der Kaskade
+ * @return true, wenn die Kaskade neu gerendert werden muss
+ */
+bool shadow_isCascadeDirty(CascadedShadow* shadow, int cascade);
+
+/**
+ * Bindet die Schicht einer Kaskade zum Rendern, setzt den Viewport, leert die
+ * Tiefe und übergibt die Light-Space Matrix als u_lightSpaceMatrix. Die
+ * Kaskade gilt danach als aktuell.
+ * Der Shader MUSS zuvor bereits aktiviert worden sein.
+ *
+ * @param shadow die Schattendaten
+ * @param cascade der Index der Kaskade
+ * @param shader der Shader, mit dem die Szene gerendert wird
+ */
+void shadow_bindForCascade(CascadedShadow* shadow, int cascade, Shader* shader);
+
+/**
+ * Bindet die Schattentextur an die angegebene Textureinheit und übergibt
+ * die Kaskaden per Uniform an den Shader. Ist enabled false, wird
+ * u_cascadeCount auf 0 gesetzt und der Shader berechnet keine Schatten.
+ * Der Shader MUSS zuvor bereits aktiviert worden sein.
+ *
+ * Für mehr Informationen siehe den Dateikopf.
+ *
+ * @param shadow die Schattendaten
+ * @param shader der Licht-Shader
+ * @param unit der Index der Textureinheit
+ * @param enabled gibt an, ob Schatten berechnet werden sollen
+ */
+void shadow_activateCascades(CascadedShadow* shadow, Shader* shader, int unit,
+                             bool enabled);
+
+/**
+ * Löscht die Schattendaten.
+ *
+ * @param shadow die zu löschenden Schattendaten
+ */
+void shadow_deleteCascadedShadow(CascadedShadow* shadow);
+
+/**
+ * Erzeugt das Cube Map Array und den Framebuffer für die Punktschatten.
+ *
+ * @return die neuen Punktschatten
+ */
+PointShadows* shadow_createPointShadows(void);
+
+/**
+ * Vergibt die Slots an die ersten SHADOW_MAX_POINT_LIGHTS Punktlichter, die
+ * Schatten werfen sollen, und setzt deren shadowSlot. Alle anderen Lichter
+ * erhalten -1. Ändert sich dabei ein Slot, gelten die Punktschatten als
+ * veraltet.
+ *
+ * @param shadows die Punktschatten
+ * @param lights die Punktlichter der Szene
+ * @param count die Anzahl der Punktlichter
+ * @return die Anzahl der vergebenen Slots
+ */
+int shadow_assignPointSlots(PointShadows* shadows, PointLight** lights,
+                            unsigned int count);
+
+/**
+ * Markiert die Punktschatten als veraltet, z.B. weil sich die Szene geändert
+ * hat.
+ *
+ * @param shadows die Punktschatten
+ */
+void shadow_invalidatePointShadows(PointShadows* shadows);
+
+/**
+ * Prüft, ob die Punktschatten neu gerendert werden müssen.
+ *
+ * @param shadows die Punktschatten
+ * @return true, wenn die Punktschatten neu gerendert werden müssen
+ */
+bool shadow_arePointShadowsDirty(PointShadows* shadows);
+
+/**
+ * Bindet das gesamte Cube Map Array zum Rendern, setzt den Viewport und leert
+ * die Tiefe aller Schichten. Die Punktschatten gelten danach als aktuell.
+ *
+ * @param shadows die Punktschatten
+ */
+void shadow_bindForPointShadows(PointShadows* shadows);
+
+/**
+ * Übergibt die Matrizen der sechs Seiten (u_faceMatrices), die erste Schicht
+ * (u_layerBase), die Position (u_lightPos) und die Reichweite (u_farPlane)
+ * eines Slots an den Schatten-Shader.
+ * Der Shader MUSS zuvor bereits aktiviert worden sein.
+ *
+ * @param shadows die Punktschatten
+ * @param slot der Slot des Lichts
+ * @param shader der Shader, mit dem die Szene gerendert wird
+ */
+void shadow_setPointShadowSlot(PointShadows* shadows, int slot, Shader* shader);
+
+/**
+ * Bindet das Cube Map Array an die angegebene Textureinheit und übergibt die
+ * Reichweiten der Slots per Uniform an den Shader.
+ * Der Shader MUSS zuvor bereits aktiviert worden sein.
+ *
+ * Für mehr Informationen siehe den Dateikopf.
+ *
+ * @param shadows die Punktschatten
+ * @param shader der Licht-Shader
+ * @param unit der Index der Textureinheit
+ * @param enabled gibt an, ob Schatten berechnet werden sollen
+ */
+void shadow_activatePointShadows(PointShadows* shadows, Shader* shader, int unit,
+                                 bool enabled);
+
+/**
+ * Löscht die Punktschatten.
+ *
+ * @param shadows die zu löschenden Punktschatten
+ */
+void shadow_deletePointShadows(PointShadows* shadows);
+
+#endif // SHADOW_H
@@ -12,6 +12,7 @@
 #include <time.h>
 #include <sesp/stb_image.h>
 
+#include "glstate.h"
 #include "utils.h"
 #include <stb/stb_ds.h>
 
@@ -167,7 +168,7 @@ static void texture_loadFromDDS(GLuint textureId, const char* filename)
     }
 
     // Das neue Textur-Objekt binden/aktivieren.
-    glBindTexture(GL_TEXTURE_2D, textureId);
+    glstate_bindTexture(GL_TEXTURE_2D, textureId);
 
     // Als nächstes extrahieren wir relevante Informationen, um die
     // Textur und die Mipmaps an OpenGL zu übergeben.
@@ -269,7 +270,7 @@ static void texture_loadFromImage(GLuint textureId, const char* filename)
     }
 
     // Das neue Textur-Objekt binden/aktivieren.
-    glBindTexture(GL_TEXTURE_2D, textureId);
+    glstate_bindTexture(GL_TEXTURE_2D, textureId);
 
     // Die Texturdaten an OpenGL übergeben.
     glTexImage2D(
@@ -323,7 +324,7 @@ GLuint texture_loadTexture(const char* filename, GLenum wrapping)
     // Wir stellen noch einmal sicher, dass die Textur auch gebunden ist.
     // Eigentlich sollte sie bereits in den Ladefunktionen gebunden worden sein.
     // Wenn jedoch ein Fehler aufgetreten ist, findet das Binden nicht statt.
-    glBindTexture(GL_TEXTURE_2D, textureId);
+    glstate_bindTexture(GL_TEXTURE_2D, textureId);
 
     // Danach stellen wir ein, welcher Texture-Wrapping Modus verwendet werden
     // soll. Dieser findet verwendung, wenn Texturdaten an Koordinaten 
@@ -378,7 +379,7 @@ void texture_deleteTexture(GLuint textureId)
     // Dadurch entsteht aber ein einheitliches Interface. Außerdem kann diese
     // Funktion später auch genutzt werden, um zusätzliche Ressourcen frei zu
     // geben (z.B. das entfernen der Textur aus einem Cache).
-    glDeleteTextures(1, &textureId);
+    glstate_deleteTextures(1, &textureId);
 }
 
 void texture_saveScreenshot(ProgContext* ctx)
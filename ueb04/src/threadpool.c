@@ -0,0 +1,253 @@
+/**
+ * Modul für das parallele Abarbeiten von Aufgaben auf mehreren CPU-Kernen.
+ *
+ * Unter Windows werden die Threads der Win32 API verwendet, auf allen anderen
+ * Systemen POSIX Threads.
+ *
+ * Copyright (C) 2023, FH Wedel
+ * Autor: Joshua-Scott Schöttke, Ilana Schmara
+ */
+
+#include "threadpool.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+    #define WIN32_LEAN_AND_MEAN
+    #include <windows.h>
+#else
+    #include <pthread.h>
+    #include <unistd.h>
+#endif
+
+//////////////////////////////// PLATTFORM API /////////////////////////////////
+
+#ifdef _WIN32
+    typedef HANDLE Thread;
+    typedef CRITICAL_SECTION Mutex;
+    typedef CONDITION_VARIABLE Condition;
+
+    #define THREAD_FUNCTION DWORD WINAPI
+    #define THREAD_RETURN 0
+
+    #define mutexInit(m) InitializeCriticalSection(m)
+    #define mutexDestroy(m) DeleteCriticalSection(m)
+    #define mutexLock(m) EnterCriticalSection(m)
+    #define mutexUnlock(m) LeaveCriticalSection(m)
+    #define conditionInit(c) InitializeConditionVariable(c)
+    #define conditionDestroy(c) ((void)(c))
+    #define conditionWait(c, m) SleepConditionVariableCS((c), (m), INFINITE)
+    #define conditionSignal(c) WakeConditionVariable(c)
+    #define conditionBroadcast(c) WakeAllConditionVariable(c)
+#else
+    typedef pthread_t Thread;
+    typedef pthread_mutex_t Mutex;
+    typedef pthread_cond_t Condition;
+
+    #define THREAD_FUNCTION void*
+    #define THREAD_RETURN NULL
+
+    #define mutexInit(m) pthread_mutex_init((m), NULL)
+    #define mutexDestroy(m) pthread_mutex_destroy(m)
+    #define mutexLock(m) pthread_mutex_lock(m)
+    #define mutexUnlock(m) pthread_mutex_unlock(m)
+    #define conditionInit(c) pthread_cond_init((c), NULL)
+    #define conditionDestroy(c) pthread_cond_destroy(c)
+    #define conditionWait(c, m) pthread_cond_wait((c), (m))
+    #define conditionSignal(c) pthread_cond_signal(c)
+    #define conditionBroadcast(c) pthread_cond_broadcast(c)
+#endif
+
+////////////////////////////// LOKALE DATENTYPEN ///////////////////////////////
+
+// Datenstruktur eines Thread-Pools.
+struct ThreadPool
+{
+    int threadCount;
+    Thread* threads;
+
+    // Schützt alle folgenden Felder.
+    Mutex mutex;
+    // Signalisiert den Arbeitern einen neuen Auftrag oder das Beenden.
+    Condition workAvailable;
+    // Signalisiert dem Auftraggeber, dass alle Aufgaben erledigt sind.
+    Condition workDone;
+
+    // Der aktuelle Auftrag.
+    ThreadPoolTask task;
+    void* userData;
+    int taskCount;
+    int nextTask;
+    int finishedTasks;
+
+    // Wird mit jedem Auftrag erhöht, damit ein Arbeiter erkennt, ob er den
+    // aktuellen Auftrag bereits gesehen hat.
+    unsigned int generation;
+    bool shutdown;
+};
+
+////////////////////////////// LOKALE FUNKTIONEN ///////////////////////////////
+
+/**
+ * Arbeitet Aufgaben des aktuellen Auftrags ab, bis keine mehr übrig sind.
+ * Der Mutex muss beim Aufruf gesperrt sein und ist es danach wieder.
+ *
+ * @param pool der Thread-Pool
+ */
+static void threadpool_runTasks(ThreadPool* pool)
+{
+    while (pool->nextTask < pool->taskCount)
+    {
+        int index = pool->nextTask++;
+
+        // Die Aufgabe selbst wird ohne Sperre ausgeführt.
+        mutexUnlock(&pool->mutex);
+        pool->task(index, pool->userData);
+        mutexLock(&pool->mutex);
+
+        pool->finishedTasks++;
+        if (pool->finishedTasks == pool->taskCount)
+        {
+            conditionSignal(&pool->workDone);
+        }
+    }
+}
+
+/**
+ * Hauptfunktion der Arbeiter-Threads.
+ *
+ * @param arg der Thread-Pool
+ */
+static THREAD_FUNCTION threadpool_worker(void* arg)
+{
+    ThreadPool* pool = arg;
+    unsigned int seenGeneration = 0;
+
+    mutexLock(&pool->mutex);
+    while (true)
+    {
+        // Auf einen neuen Auftrag warten.
+        while (!pool->shutdown && pool->generation == seenGeneration)
+        {
+            conditionWait(&pool->workAvailable, &pool->mutex);
+        }
+
+        if (pool->shutdown)
+        {
+            break;
+        }
+
+        seenGeneration = pool->generation;
+        threadpool_runTasks(pool);
+    }
+    mutexUnlock(&pool->mutex);
+
+    return THREAD_RETURN;
+}
+
+//////////////////////////// ÖFFENTLICHE FUNKTIONEN ////////////////////////////
+
+int threadpool_getProcessorCount(void)
+{
+#ifdef _WIN32
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    int count = (int)info.dwNumberOfProcessors;
+#else
+    int count = (int)sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+
+    return count > 0 ? count : 1;
+}
+
+ThreadPool* threadpool_createThreadPool(int threadCount)
+{
+    ThreadPool* pool = malloc(sizeof(ThreadPool));
+    memset(pool, 0, sizeof(ThreadPool));
+
+    mutexInit(&pool->mutex);
+    conditionInit(&pool->workAvailable);
+    conditionInit(&pool->workDone);
+
+    pool->threads = malloc(sizeof(Thread) * (threadCount > 0 ? threadCount : 1));
+
+    // Threads, die nicht gestartet werden können, werden einfach ausgelassen.
+    // Im Zweifel erledigt der aufrufende Thread alle Aufgaben allein.
+    for (int i = 0; i < threadCount; i++)
+    {
+#ifdef _WIN32
+        Thread thread = CreateThread(NULL, 0, threadpool_worker, pool, 0, NULL);
+        bool started = thread != NULL;
+#else
+        Thread thread;
+        bool started = pthread_create(&thread, NULL, threadpool_worker, pool) == 0;
+#endif
+        if (started)
+        {
+            pool->threads[pool->threadCount++] = thread;
+        }
+    }
+
+    return pool;
+}
+
+void threadpool_parallelFor(ThreadPool* pool, int count, ThreadPoolTask task,
+                            void* userData)
+{
+    if (count <= 0)
+    {
+        return;
+    }
+
+    mutexLock(&pool->mutex);
+
+    // Neuen Auftrag einstellen und alle Arbeiter wecken.
+    pool->task = task;
+    pool->userData = userData;
+    pool->taskCount = count;
+    pool->nextTask = 0;
+    pool->finishedTasks = 0;
+    pool->generation++;
+    conditionBroadcast(&pool->workAvailable);
+
+    // Der aufrufende Thread hilft mit, statt nur zu warten.
+    threadpool_runTasks(pool);
+
+    while (pool->finishedTasks < pool->taskCount)
+    {
+        conditionWait(&pool->workDone, &pool->mutex);
+    }
+
+    mutexUnlock(&pool->mutex);
+}
+
+void threadpool_deleteThreadPool(ThreadPool* pool)
+{
+    if (!pool)
+    {
+        return;
+    }
+
+    mutexLock(&pool->mutex);
+    pool->shutdown = true;
+    conditionBroadcast(&pool->workAvailable);
+    mutexUnlock(&pool->mutex);
+
+    for (int i = 0; i < pool->threadCount; i++)
+    {
+#ifdef _WIN32
+        WaitForSingleObject(pool->threads[i], INFINITE);
+        CloseHandle(pool->threads[i]);
+#else
+        pthread_join(pool->threads[i], NULL);
+#endif
+    }
+
+    conditionDestroy(&pool->workAvailable);
+    conditionDestroy(&pool->workDone);
+    mutexDestroy(&pool->mutex);
+
+    free(pool->threads);
+    free(pool);
+}
@@ -0,0 +1,64 @@
+/**
+ * Modul für das parallele Abarbeiten von Aufgaben auf mehreren CPU-Kernen.
+ *
+ * Die Arbeiter-Threads werden einmalig angelegt und warten zwischen den
+ * Aufträgen. Ein Auftrag besteht aus einer Anzahl unabhängiger Aufgaben, die
+ * von allen Threads, inklusive des aufrufenden, abgearbeitet werden.
+ *
+ * Copyright (C) 2023, FH Wedel
+ * Autor: Joshua-Scott Schöttke, Ilana Schmara
+ */
+
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <stdbool.h>
+
+//////////////////////////// ÖFFENTLICHE DATENTYPEN ////////////////////////////
+
+// Funktion, die eine einzelne Aufgabe eines Auftrags abarbeitet.
+typedef void (*ThreadPoolTask)(int index, void* userData);
+
+// Ein Pool aus Arbeiter-Threads.
+struct ThreadPool;
+typedef struct ThreadPool ThreadPool;
+
+//////////////////////////// ÖFFENTLICHE FUNKTIONEN ////////////////////////////
+
+/**
+ * Liefert die Anzahl der verfügbaren logischen Prozessoren.
+ *
+ * @return die Anzahl der Prozessoren, mindestens 1
+ */
+int threadpool_getProcessorCount(void);
+
+/**
+ * Erzeugt einen neuen Thread-Pool.
+ *
+ * @param threadCount die Anzahl der zusätzlichen Arbeiter-Threads, bei 0 wird
+ *                    alles im aufrufenden Thread abgearbeitet
+ * @return der neue Thread-Pool
+ */
+ThreadPool* threadpool_createThreadPool(int threadCount);
+
+/**
+ * Führt die Aufgabe für alle Indizes von 0 bis count - 1 parallel aus und
+ * kehrt erst zurück, wenn alle Aufgaben abgearbeitet wurden. Die Reihenfolge
+ * der Indizes ist nicht festgelegt.
+ *
+ * @param pool der Thread-Pool
+ * @param count die Anzahl der Aufgaben
+ * @param task die Funktion, die für jede Aufgabe aufgerufen wird
+ * @param userData beliebige Daten, die an die Funktion übergeben werden
+ */
+void threadpool_parallelFor(ThreadPool* pool, int count, ThreadPoolTask task,
+                            void* userData);
+
+/**
+ * Beendet alle Arbeiter-Threads und löscht den Thread-Pool.
+ *
+ * @param pool der zu löschende Thread-Pool
+ */
+void threadpool_deleteThreadPool(ThreadPool* pool);
+
+#endif // THREADPOOL_H
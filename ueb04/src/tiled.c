@@ -0,0 +1,159 @@
+/**
+ * Modul für Tiled Deferred Lighting.
+ *
+ * Copyright (C) 2023, FH Wedel
+ * Autor: Joshua-Scott Schöttke, Ilana Schmara
+ */
+
+#include "tiled.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include "glstate.h"
+
+////////////////////////////// LOKALE DATENTYPEN ///////////////////////////////
+
+// Datenstruktur mit den Kachel-Texturen und Framebuffern.
+struct TiledLighting
+{
+    int tilesX;
+    int tilesY;
+
+    // Tiefenbereich (min, max) je Kachel im View-Space.
+    GLuint depthFbo;
+    GLuint depthRangeTexture;
+
+    // Bitmasken der Punktlichter je Kachel.
+    GLuint maskFbo;
+    GLuint maskTextures[TILED_MASK_COUNT];
+};
+
+////////////////////////////// LOKALE FUNKTIONEN ///////////////////////////////
+
+/**
+ * Legt eine Textur mit einem Texel pro Kachel an.
+ *
+ * @param tiled die Tiled Lighting Daten
+ * @param internalFormat das interne Format der Textur
+ * @param format das Format der Pixeldaten
+ * @param type der Datentyp der Pixeldaten
+ * @param label der Name der Textur
+ * @return die ID der neuen Textur
+ */
+static GLuint tiled_createTileTexture(TiledLighting* tiled, GLint internalFormat,
+                                      GLenum format, GLenum type,
+                                      const char* label)
+{
+    GLuint texture;
+    glGenTextures(1, &texture);
+    glstate_bindTexture(GL_TEXTURE_2D, texture);
+    glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, tiled->tilesX, tiled->tilesY,
+                 0, format, type, NULL);
+
+    // Integer-Texturen dürfen nicht gefiltert werden.
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    common_labelObjectByType(GL_TEXTURE, texture, label);
+
+    return texture;
+}
+
+/**
+ * Prüft, ob das aktuell gebundene FBO vollständig ist.
+ *
+ * @param label der Name des FBOs für die Fehlermeldung
+ */
+static void tiled_checkFramebuffer(const char* label)
+{
+    GLenum fboState = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+    if (fboState != GL_FRAMEBUFFER_COMPLETE)
+    {
+        fprintf(stderr, "Error: FBO \"%s\" not complete (0x%x).\n",
+                label, fboState);
+    }
+}
+
+//////////////////////////// ÖFFENTLICHE FUNKTIONEN ////////////////////////////
+
+TiledLighting* tiled_createTiledLighting(int width, int height)
+{
+    TiledLighting* tiled = malloc(sizeof(TiledLighting));
+    memset(tiled, 0, sizeof(TiledLighting));
+
+    // Angeschnittene Kacheln am Rand zählen mit.
+    tiled->tilesX = (width + TILED_TILE_SIZE - 1) / TILED_TILE_SIZE;
+    tiled->tilesY = (height + TILED_TILE_SIZE - 1) / TILED_TILE_SIZE;
+
+    // --- Tiefenbereich ---
+    tiled->depthRangeTexture = tiled_createTileTexture(tiled, GL_RG32F,
+        GL_RG, GL_FLOAT, "Tile Depth Range");
+
+    glGenFramebuffers(1, &tiled->depthFbo);
+    glstate_bindFramebuffer(GL_FRAMEBUFFER, tiled->depthFbo);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0,
+                           GL_TEXTURE_2D, tiled->depthRangeTexture, 0);
+    tiled_checkFramebuffer("Tile Depth Range");
+    common_labelObjectByType(GL_FRAMEBUFFER, tiled->depthFbo, "Tile Depth Range");
+
+    // --- Lichtmasken ---
+    glGenFramebuffers(1, &tiled->maskFbo);
+    glstate_bindFramebuffer(GL_FRAMEBUFFER, tiled->maskFbo);
+
+    GLenum drawBuffer[TILED_MASK_COUNT];
+    for (int i = 0; i < TILED_MASK_COUNT; i++)
+    {
+        tiled->maskTextures[i] = tiled_createTileTexture(tiled, GL_RGBA32UI,
+            GL_RGBA_INTEGER, GL_UNSIGNED_INT, "Tile Light Mask");
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0 + i,
+                               GL_TEXTURE_2D, tiled->maskTextures[i], 0);
+        drawBuffer[i] = GL_COLOR_ATTACHMENT0 + i;
+    }
+    glDrawBuffers(TILED_MASK_COUNT, drawBuffer);
+    tiled_checkFramebuffer("Tile Light Mask");
+    common_labelObjectByType(GL_FRAMEBUFFER, tiled->maskFbo, "Tile Light Mask");
+
+    glstate_bindFramebuffer(GL_FRAMEBUFFER, 0);
+    return tiled;
+}
+
+void tiled_bindForDepthPass(TiledLighting* tiled)
+{
+    glstate_bindFramebuffer(GL_DRAW_FRAMEBUFFER, tiled->depthFbo);
+    glViewport(0, 0, tiled->tilesX, tiled->tilesY);
+}
+
+void tiled_bindForCullPass(TiledLighting* tiled, GLenum depthRangeUnit)
+{
+    glstate_bindFramebuffer(GL_DRAW_FRAMEBUFFER, tiled->maskFbo);
+    glViewport(0, 0, tiled->tilesX, tiled->tilesY);
+
+    glstate_activeTexture(depthRangeUnit);
+    glstate_bindTexture(GL_TEXTURE_2D, tiled->depthRangeTexture);
+}
+
+void tiled_bindForLightPass(TiledLighting* tiled, GLenum firstMaskUnit)
+{
+    for (int i = 0; i < TILED_MASK_COUNT; i++)
+    {
+        glstate_activeTexture(firstMaskUnit + i);
+        glstate_bindTexture(GL_TEXTURE_2D, tiled->maskTextures[i]);
+    }
+}
+
+void tiled_deleteTiledLighting(TiledLighting* tiled)
+{
+    if (!tiled)
+    {
+        return;
+    }
+
+    glstate_deleteFramebuffers(1, &tiled->depthFbo);
+    glstate_deleteFramebuffers(1, &tiled->maskFbo);
+    glstate_deleteTextures(1, &tiled->depthRangeTexture);
+    glstate_deleteTextures(TILED_MASK_COUNT, tiled->maskTextures);
+
+    free(tiled);
+}
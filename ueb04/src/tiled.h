@@ -0,0 +1,87 @@
+/**
+ * Modul für Tiled Deferred Lighting.
+ *
+ * Der Bildschirm wird in Kacheln zu TILED_TILE_SIZE x TILED_TILE_SIZE Pixeln
+ * aufgeteilt. Die Punktlichter werden dann in drei Pässen berechnet:
+ *
+ *  1. Für jede Kachel wird der Tiefenbereich der Geometrie bestimmt.
+ *  2. Für jede Kachel wird eine Bitmaske aller Punktlichter erstellt, deren
+ *     Radius das Frustum der Kachel samt Tiefenbereich schneidet.
+ *  3. Ein einziger Vollbild-Pass berechnet je Pixel nur die Lichter, die in
+ *     der Maske seiner Kachel gesetzt sind.
+ *
+ * Da nur ein OpenGL 4.1 Kontext zur Verfügung steht, werden alle Pässe mit
+ * Fragment-Shadern umgesetzt, die in Texturen mit je einem Texel pro Kachel
+ * schreiben. Die Lichtdaten selbst liegen in einem LightBuffer.
+ *
+ * Copyright (C) 2023, FH Wedel
+ * Autor: Joshua-Scott Schöttke, Ilana Schmara
+ */
+
+#ifndef TILED_H
+#define TILED_H
+
+#include "common.h"
+
+////////////////////////////////// KONSTANTEN //////////////////////////////////
+
+// Kantenlänge einer Kachel in Pixeln. Muss mit den Shadern übereinstimmen.
+#define TILED_TILE_SIZE 16
+
+// Anzahl der RGBA32UI Texturen, aus denen die Lichtmaske einer Kachel besteht.
+#define TILED_MASK_COUNT 4
+
+// Maximale Anzahl an Punktlichtern, die pro Frame berücksichtigt werden.
+#define TILED_MAX_LIGHTS (TILED_MASK_COUNT * 4 * 32)
+
+//////////////////////////// ÖFFENTLICHE DATENTYPEN ////////////////////////////
+
+// Datenstruktur mit den Kachel-Texturen und Framebuffern.
+struct TiledLighting;
+typedef struct TiledLighting TiledLighting;
+
+//////////////////////////// ÖFFENTLICHE FUNKTIONEN ////////////////////////////
+
+/**
+ * Erzeugt die Kachel-Texturen für einen Bildschirm der angegebenen Größe.
+ *
+ * @param width die Breite des Bildschirms in Pixeln
+ * @param height die Höhe des Bildschirms in Pixeln
+ * @return die neuen Daten für das Tiled Lighting
+ */
+TiledLighting* tiled_createTiledLighting(int width, int height);
+
+/**
+ * Bindet das FBO für den Tiefenbereich der Kacheln und setzt den Viewport
+ * auf die Anzahl der Kacheln.
+ *
+ * @param tiled die Tiled Lighting Daten
+ */
+void tiled_bindForDepthPass(TiledLighting* tiled);
+
+/**
+ * Bindet das FBO für die Lichtmasken, setzt den Viewport auf die Anzahl der
+ * Kacheln und bindet den Tiefenbereich der Kacheln als Textur.
+ *
+ * @param tiled die Tiled Lighting Daten
+ * @param depthRangeUnit Textureinheit für den Tiefenbereich (GL_TEXTURE0, ...)
+ */
+void tiled_bindForCullPass(TiledLighting* tiled, GLenum depthRangeUnit);
+
+/**
+ * Bindet die Lichtmasken als Texturen an aufeinander folgende
+ * Textureinheiten. Das aktuell gebundene FBO wird nicht verändert.
+ *
+ * @param tiled die Tiled Lighting Daten
+ * @param firstMaskUnit die Textureinheit der ersten Maske (GL_TEXTURE0, ...)
+ */
+void tiled_bindForLightPass(TiledLighting* tiled, GLenum firstMaskUnit);
+
+/**
+ * Löscht die Tiled Lighting Daten.
+ *
+ * @param tiled die zu löschenden Daten
+ */
+void tiled_deleteTiledLighting(TiledLighting* tiled);
+
+#endif // TILED_H
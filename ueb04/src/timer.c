@@ -0,0 +1,139 @@
+/**
+ * Modul für das Messen von Zeiten auf der GPU.
+ *
+ * Copyright (C) 2023, FH Wedel
+ * Autor: Joshua-Scott Schöttke, Ilana Schmara
+ */
+
+#include "timer.h"
+
+#include <string.h>
+
+////////////////////////////////// KONSTANTEN //////////////////////////////////
+
+// Anzahl der Messungen, die gleichzeitig auf der GPU ausstehen dürfen.
+#define TIMER_QUERY_COUNT 4
+
+// Gewichtung einer neuen Messung für den geglätteten Wert.
+#define TIMER_SMOOTHING 0.1
+
+////////////////////////////// LOKALE DATENTYPEN ///////////////////////////////
+
+// Datenstruktur eines GPU Timers.
+struct GpuTimer
+{
+    // Je Messung ein Query für den Start und eines für das Ende.
+    GLuint queries[TIMER_QUERY_COUNT][2];
+
+    // Index der Messung, die als nächstes geschrieben wird.
+    int current;
+    // Anzahl der Messungen, deren Ergebnis noch nicht gelesen wurde.
+    int pending;
+    // Gibt an, ob timer_begin in diesem Frame eine Messung gestartet hat.
+    bool active;
+
+    double lastMs;
+    double smoothedMs;
+    bool hasResult;
+};
+
+////////////////////////////// LOKALE FUNKTIONEN ///////////////////////////////
+
+/**
+ * Liest alle bereits fertigen Messungen aus, ohne auf die GPU zu warten.
+ *
+ * @param timer der Timer
+ */
+static void timer_collectResults(GpuTimer* timer)
+{
+    while (timer->pending > 0)
+    {
+        int oldest = (timer->current - timer->pending + TIMER_QUERY_COUNT)
+                   % TIMER_QUERY_COUNT;
+
+        // Ist das End-Query fertig, ist es auch das Start-Query.
+        GLint available = GL_FALSE;
+        glGetQueryObjectiv(timer->queries[oldest][1],
+                           GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available)
+        {
+            break;
+        }
+
+        GLuint64 start = 0;
+        GLuint64 end = 0;
+        glGetQueryObjectui64v(timer->queries[oldest][0], GL_QUERY_RESULT, &start);
+        glGetQueryObjectui64v(timer->queries[oldest][1], GL_QUERY_RESULT, &end);
+
+        timer->lastMs = (double)(end - start) / 1000000.0;
+        if (timer->hasResult)
+        {
+            timer->smoothedMs += (timer->lastMs - timer->smoothedMs) * TIMER_SMOOTHING;
+        }
+        else
+        {
+            timer->smoothedMs = timer->lastMs;
+            timer->hasResult = true;
+        }
+
+        timer->pending--;
+    }
+}
+
+//////////////////////////// ÖFFENTLICHE FUNKTIONEN ////////////////////////////
+
+GpuTimer* timer_createGpuTimer(void)
+{
+    GpuTimer* timer = malloc(sizeof(GpuTimer));
+    memset(timer, 0, sizeof(GpuTimer));
+
+    glGenQueries(TIMER_QUERY_COUNT * 2, &timer->queries[0][0]);
+
+    return timer;
+}
+
+void timer_begin(GpuTimer* timer)
+{
+    timer_collectResults(timer);
+
+    // Sind alle Queries noch in Benutzung, wird dieser Frame ausgelassen.
+    timer->active = timer->pending < TIMER_QUERY_COUNT;
+    if (timer->active)
+    {
+        glQueryCounter(timer->queries[timer->current][0], GL_TIMESTAMP);
+    }
+}
+
+void timer_end(GpuTimer* timer)
+{
+    if (!timer->active)
+    {
+        return;
+    }
+
+    glQueryCounter(timer->queries[timer->current][1], GL_TIMESTAMP);
+    timer->current = (timer->current + 1) % TIMER_QUERY_COUNT;
+    timer->pending++;
+    timer->active = false;
+}
+
+double timer_getMilliseconds(GpuTimer* timer)
+{
+    return timer->smoothedMs;
+}
+
+double timer_getLastMilliseconds(GpuTimer* timer)
+{
+    return timer->lastMs;
+}
+
+void timer_deleteGpuTimer(GpuTimer* timer)
+{
+    if (!timer)
+    {
+        return;
+    }
+
+    glDeleteQueries(TIMER_QUERY_COUNT * 2, &timer->queries[0][0]);
+    free(timer);
+}
@@ -0,0 +1,72 @@
+/**
+ * Modul für das Messen von Zeiten auf der GPU.
+ *
+ * Die Messung erfolgt über Timestamp-Queries. Da die Ergebnisse erst einige
+ * Frames später zur Verfügung stehen, hält jeder Timer mehrere Queries vor
+ * und liest nur bereits fertige Ergebnisse aus. Die CPU muss so nie auf die
+ * GPU warten. Im Gegensatz zu GL_TIME_ELAPSED dürfen sich die Messungen
+ * mehrerer Timer beliebig überlappen oder verschachteln.
+ *
+ * Copyright (C) 2023, FH Wedel
+ * Autor: Joshua-Scott Schöttke, Ilana Schmara
+ */
+
+#ifndef TIMER_H
+#define TIMER_H
+
+#include "common.h"
+
+//////////////////////////// ÖFFENTLICHE DATENTYPEN ////////////////////////////
+
+// Ein Timer, der die Dauer eines Abschnitts auf der GPU misst.
+struct GpuTimer;
+typedef struct GpuTimer GpuTimer;
+
+//////////////////////////// ÖFFENTLICHE FUNKTIONEN ////////////////////////////
+
+/**
+ * Erzeugt einen neuen GPU Timer.
+ *
+ * @return der neue Timer
+ */
+GpuTimer* timer_createGpuTimer(void);
+
+/**
+ * Markiert den Beginn des zu messenden Abschnitts. Sind noch zu viele
+ * Messungen ausstehend, wird der Abschnitt in diesem Frame nicht gemessen.
+ *
+ * @param timer der Timer
+ */
+void timer_begin(GpuTimer* timer);
+
+/**
+ * Markiert das Ende des zu messenden Abschnitts.
+ *
+ * @param timer der Timer
+ */
+void timer_end(GpuTimer* timer);
+
+/**
+ * Liefert die geglättete Dauer der letzten Messungen in Millisekunden.
+ *
+ * @param timer der Timer
+ * @return die Dauer in ms oder 0, wenn noch kein Ergebnis vorliegt
+ */
+double timer_getMilliseconds(GpuTimer* timer);
+
+/**
+ * Liefert die Dauer der zuletzt fertiggestellten Messung in Millisekunden.
+ *
+ * @param timer der Timer
+ * @return die Dauer in ms oder 0, wenn noch kein Ergebnis vorliegt
+ */
+double timer_getLastMilliseconds(GpuTimer* timer);
+
+/**
+ * Löscht einen GPU Timer.
+ *
+ * @param timer der zu löschende Timer
+ */
+void timer_deleteGpuTimer(GpuTimer* timer);
+
+#endif // TIMER_H